@@ -30,9 +30,11 @@
 
 
 #include "../physics/misc/serialization.h"
+#include "../physics/misc/shapeClassCache.h"
 
 #include "worlds.h"
-#include "tickerThread.h"
+#include "../physics/threading/physicsDriver.h"
+#include "../physics/misc/tickTrace.h"
 #include "worldBuilder.h"
 
 #include "io/serialization.h"
@@ -47,16 +49,21 @@
 #include "../engine/event/keyEvent.h"
 #include "../engine/input/keyboard.h"
 #include "../engine/event/windowEvent.h"
+#include "../engine/io/import.h"
 
 #include "builtinWorlds.h"
 
 #define TICKS_PER_SECOND 120.0
-#define TICK_SKIP_TIME std::chrono::milliseconds(1000)
+#define MAX_CATCH_UP_TICKS 8
+#define SHAPE_CLASS_CACHE_FILE "shapeClassCache.bin"
+#define PHYSICS_TRACE_SECONDS 5.0
 
 namespace P3D::Application {
 
-TickerThread physicsThread;
 PlayerWorld world(1 / TICKS_PER_SECOND);
+PhysicsDriver physicsThread(world, MAX_CATCH_UP_TICKS);
+TickTraceRecorder physicsTrace(PHYSICS_TRACE_SECONDS);
+std::size_t physicsTraceCount = 0;
 Screen screen;
 
 void init(const Util::ParsedArgs& cmdArgs);
@@ -67,11 +74,30 @@ void setupDebug();
 
 void loadFile(const char* file);
 
+void loadShapeClassCache() {
+	std::ifstream input(SHAPE_CLASS_CACHE_FILE, std::ios::binary);
+	if(!input.is_open()) return;
+
+	try {
+		ShapeClassCache::instance.deserializeDerivedData(input);
+	} catch(SerializationException& ex) {
+		Log::warn("Ignoring shape class cache %s: %s", SHAPE_CLASS_CACHE_FILE, ex.what());
+	}
+}
+
+void saveShapeClassCache() {
+	std::ofstream output(SHAPE_CLASS_CACHE_FILE, std::ios::binary);
+	ShapeClassCache::instance.serializeDerivedData(output);
+}
+
 void init(const Util::ParsedArgs& cmdArgs) {
 	auto start = high_resolution_clock::now();
 
 	Log::init("latest.log");
 
+	// meshes are parsed on the physics workers, which are idle until the world is loaded
+	OBJImport::setJobSystem(&getJobSystem());
+
 	Log::info(Util::printAndParseCPUIDArgs(cmdArgs));
 	bool quickBoot = cmdArgs.hasFlag("quickBoot");
 
@@ -83,6 +109,9 @@ void init(const Util::ParsedArgs& cmdArgs) {
 	/*ResourceManager::add<Graphics::TextureResource>("floorMaterial", "../res/textures/floor/floor_color.jpg");
 	WorldImportExport::registerTexture(ResourceManager::get<Graphics::TextureResource>("floorMaterial"));*/
 
+	Log::info("Loading shape class cache");
+	loadShapeClassCache();
+
 	Log::info("Initializing world");
 	WorldBuilder::init();
 
@@ -106,6 +135,11 @@ void init(const Util::ParsedArgs& cmdArgs) {
 
 	Log::info("Initializing physics");
 	setupPhysics();
+	std::string traceSpikeMillis = cmdArgs.getOptional("traceSpikeMs");
+	if (!traceSpikeMillis.empty()) {
+		physicsTrace.setSpikeTrigger(std::stod(traceSpikeMillis), "physicsSpike");
+		physicsTrace.start();
+	}
 	Log::info("Initializing debug");
 	setupDebug();
 
@@ -189,19 +223,13 @@ void setupWorld(const Util::ParsedArgs& cmdArgs) {
 }
 
 void setupPhysics() {
-	physicsThread = TickerThread(TICKS_PER_SECOND, TICK_SKIP_TIME, [] () {
-		physicsMeasure.mark(PhysicsProcess::OTHER);
-
+	physicsThread.traceRecorder = &physicsTrace;
+	physicsThread.onTickStart = [] () {
 		Graphics::AppDebug::logTickStart();
-		world.tick();
+	};
+	physicsThread.onTickEnd = [] () {
 		Graphics::AppDebug::logTickEnd();
-
-		physicsMeasure.end();
-
-		GJKCollidesIterationStatistics.nextTally();
-		GJKNoCollidesIterationStatistics.nextTally();
-		EPAIterationStatistics.nextTally();
-	});
+	};
 }
 
 void setupDebug() {
@@ -262,6 +290,9 @@ void stop(int returnCode) {
 	Log::info("Closing screen");
 	screen.onClose();
 
+	Log::info("Saving shape class cache");
+	saveShapeClassCache();
+
 	Log::stop();
 	exit(returnCode);
 }
@@ -301,10 +332,29 @@ double getSpeed() {
 	return physicsThread.getSpeed();
 }
 
+JobSystem& getJobSystem() {
+	return physicsThread.getJobSystem();
+}
+
 void runTick() {
 	physicsThread.runTick();
 }
 
+void recordPhysicsTrace() {
+	if (!physicsTrace.isRecording()) {
+		physicsTrace.start();
+		Log::info("Recording the last %.0f seconds of physics ticks", PHYSICS_TRACE_SECONDS);
+		return;
+	}
+
+	std::string path = "physicsTrace" + std::to_string(physicsTraceCount++) + ".json";
+	if (physicsTrace.write(path)) {
+		Log::info("Wrote physics trace to %s", path.c_str());
+	} else {
+		Log::error("Could not write physics trace to %s", path.c_str());
+	}
+}
+
 void toggleFlying() {
 	world.asyncModification([] () {
 		if (screen.camera.flying) {
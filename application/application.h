@@ -1,5 +1,7 @@
 #pragma once
 
+class JobSystem;
+
 namespace P3D::Engine {
 class Event;
 };
@@ -20,7 +22,11 @@ void runTick();
 void setSpeed(double newSpeed);
 double getSpeed();
 void stop(int returnCode);
+// starts recording a Chrome trace of the physics ticks, or writes what was recorded when already recording
+void recordPhysicsTrace();
 void toggleFlying();
+// the workers shared by physics and rendering
+JobSystem& getJobSystem();
 void onEvent(Engine::Event& event);
 
 };
\ No newline at end of file
@@ -132,6 +132,10 @@ bool StandardInputHandler::onKeyPress(Engine::KeyPressEvent& event) {
 	KEY_BIND(KeyboardOptions::Debug::pies) {
 		renderPiesEnabled = !renderPiesEnabled;
 	}
+
+	KEY_BIND(KeyboardOptions::Debug::trace) {
+		recordPhysicsTrace();
+	}
 	
 	KEY_BIND(KeyboardOptions::Part::makeMainPart) {
 		Log::info("Made %s the main part of it's physical", screen.registry.getOr<Comp::Name>(screen.selectedPart->entity, "").name.c_str());
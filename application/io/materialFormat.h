@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+	Layout of the material the application writes in front of the name of every part in a .world file
+	Kept free of application types, so tools that copy part data without interpreting it can skip over materials
+*/
+namespace P3D::Application::MaterialFormat {
+
+typedef std::uint32_t TextureID;
+
+// the ALBEDO to DISPLACEMENT maps, in the order of Comp::Material::Map
+constexpr std::size_t TEXTURE_COUNT = 8;
+// albedo as rgba, followed by metalness, roughness and ao
+constexpr std::size_t FLOAT_COUNT = 4 + 3;
+
+constexpr std::size_t SIZE = TEXTURE_COUNT * sizeof(TextureID) + FLOAT_COUNT * sizeof(float);
+
+};
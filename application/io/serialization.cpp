@@ -1,6 +1,7 @@
 #include "core.h"
 
 #include "serialization.h"
+#include "materialFormat.h"
 
 #include "../util/fileUtils.h"
 
@@ -15,18 +16,25 @@
 #include "../physics/externalforces/gravityForce.h"
 #include "../physics/misc/toString.h"
 #include "../physics/misc/serialization.h"
+#include "../physics/misc/mappedWorldFormat.h"
+#include "../util/mappedFile.h"
 
 #include <fstream>
 #include <sstream>
+#include <memory>
 
 namespace P3D::Application {
 
-FixedSharedObjectSerializerDeserializer<Graphics::Texture*> textureSerializer{nullptr};
+FixedSharedObjectSerializerDeserializer<Graphics::Texture*, MaterialFormat::TextureID> textureSerializer{nullptr};
 
 void WorldImportExport::registerTexture(Graphics::Texture* texture) {
 	textureSerializer.registerObject(texture);
 }
 
+// the batch runner copies materials by MaterialFormat::SIZE, so the layout below must match it
+static_assert(Comp::Material::DISPLACEMENT == 1 << (MaterialFormat::TEXTURE_COUNT - 1), "Every map of a material must be serialized");
+static_assert(sizeof(Color) + 3 * sizeof(float) == MaterialFormat::FLOAT_COUNT * sizeof(float), "Material floats do not match MaterialFormat");
+
 static void serializeMaterial(const Comp::Material& material, std::ostream& ostream) {
 	textureSerializer.serialize(material.get(Comp::Material::ALBEDO), ostream);
 	textureSerializer.serialize(material.get(Comp::Material::NORMAL), ostream);
@@ -151,23 +159,31 @@ void WorldImportExport::saveWorld(const char* fileName, const World<ExtendedPart
 	openWriteFile(file, fileName);
 
 	Serializer serializer;
-	serializer.serializeWorld(world, file);
+	serializer.serializeWorldMapped(world, file);
 
 	file.close();
 }
+
 void WorldImportExport::loadWorld(const char* fileName, World<ExtendedPart>& world) {
-	std::ifstream file;
-	openReadFile(file, fileName);
+	std::string fullPath = Util::getFullPath(fileName);
+	Log::info("Reading file %s", fullPath.c_str());
 
-	if(!file.is_open()) {
-		throw std::runtime_error("Could not open file!");
-	}
+	std::shared_ptr<Util::MappedFile> mappedFile = std::make_shared<Util::MappedFile>(fullPath);
 
 	Deserializer deserializer;
-	deserializer.deserializeWorld(world, file);
+	if(MappedWorldFormat::isMappedWorldFile(mappedFile->getData(), mappedFile->getSize())) {
+		// the polyhedra point into the mapping, their shape classes keep it alive
+		deserializer.deserializeWorldMapped(world, mappedFile->getData(), mappedFile->getSize(), mappedFile);
+	} else {
+		// worlds saved before the mapped format are read as a stream
+		mappedFile.reset();
+
+		std::ifstream file;
+		openReadFile(file, fileName);
+		deserializer.deserializeWorld(world, file);
+		file.close();
+	}
 
 	assert(world.isValid());
-
-	file.close();
 }
 };
@@ -109,6 +109,8 @@ void DebugOverlay::onRender(Engine::Registry64& registry) {
 		iterationChart.position = Vec2f(-leftSide + 0.1f, -0.3f);
 		iterationChart.render();
 
+		renderProfileTree(physicsMeasure.getLastTick(), "Physics Zones", physicsMeasure.labels, Vec2f(-leftSide + 1.0f, 0.25f));
+
 		Graphics::graphicsMeasure.mark(Graphics::GraphicsProcess::WAIT_FOR_LOCK);
 		screen->world->syncReadOnlyOperation([this]() {
 			Screen* screen = static_cast<Screen*>(this->ptr);
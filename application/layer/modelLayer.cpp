@@ -6,6 +6,7 @@
 #include "shader/shaders.h"
 #include "extendedPart.h"
 #include "worlds.h"
+#include "application.h"
 #include "../../graphics/resource/textureResource.h"
 
 #include "../engine/ecs/registry.h"
@@ -22,6 +23,8 @@
 #include "../physics/math/linalg/vec.h"
 #include "../physics/sharedLockGuard.h"
 #include "../physics/misc/filters/visibilityFilter.h"
+#include "../physics/misc/worldSnapshot.h"
+#include "../physics/threading/jobSystem.h"
 
 #include "../util/resource/resourceManager.h"
 #include "../layer/shadowLayer.h"
@@ -39,21 +42,21 @@ enum class RelationToSelectedPart {
 	MAINPHYSICAL_ATTACH
 };
 
-static RelationToSelectedPart getRelationToSelectedPart(const Part* selectedPart, const Part* testPart) {
+static RelationToSelectedPart getRelationToSelectedPart(const PartSnapshot* selectedPart, const PartSnapshot* testPart) {
 	if (selectedPart == nullptr)
 		return RelationToSelectedPart::NONE;
 
-	if (testPart == selectedPart)
+	if (testPart->part == selectedPart->part)
 		return RelationToSelectedPart::SELF;
 
 	if (selectedPart->parent != nullptr && testPart->parent != nullptr) {
 		if (testPart->parent == selectedPart->parent) {
-			if (testPart->isMainPart())
+			if (testPart->isMainPart)
 				return RelationToSelectedPart::MAINPART;
 			else
 				return RelationToSelectedPart::DIRECT_ATTACH;
-		} else if (testPart->parent->mainPhysical == selectedPart->parent->mainPhysical) {
-			if (testPart->parent->isMainPhysical())
+		} else if (testPart->mainPhysical == selectedPart->mainPhysical) {
+			if (testPart->isMainPhysical)
 				return RelationToSelectedPart::MAINPHYSICAL_ATTACH;
 			else
 				return RelationToSelectedPart::PHYSICAL_ATTACH;
@@ -63,8 +66,8 @@ static RelationToSelectedPart getRelationToSelectedPart(const Part* selectedPart
 	return RelationToSelectedPart::NONE;
 }
 
-static Color getAmbientForPartForSelected(Screen* screen, Part* part) {
-	switch (getRelationToSelectedPart(screen->selectedPart, part)) {
+static Color getAmbientForPartForSelected(const PartSnapshot* selectedPart, const PartSnapshot* part) {
+	switch (getRelationToSelectedPart(selectedPart, part)) {
 		case RelationToSelectedPart::NONE:
 			return Color(0.0f, 0, 0, 0);
 		case RelationToSelectedPart::SELF:
@@ -82,15 +85,79 @@ static Color getAmbientForPartForSelected(Screen* screen, Part* part) {
 	return Color(0, 0, 0, 0);
 }
 
-static Color getAlbedoForPart(Screen* screen, ExtendedPart* part) {
-	Color computedAmbient = getAmbientForPartForSelected(screen, part);
+// The live data of a part belongs to the physics thread, so attached parts are drawn as they are in the snapshot, and not at all before they are in one
+static void renderHitbox(const WorldSnapshot& snapshot, Engine::Registry64& registry, Engine::Registry64::entity_type entity) {
+	Ref<Comp::Transform> transform = registry.get<Comp::Transform>(entity);
+	Ref<Comp::Hitbox> hitbox = registry.get<Comp::Hitbox>(entity);
+	if (transform.invalid() || hitbox.invalid())
+		return;
+
+	GlobalCFrame cframe;
+	DiagonalMat3 scale;
+	if (transform->isPartAttached()) {
+		const PartSnapshot* partSnapshot = snapshot.find(transform->getPart());
+		if (partSnapshot == nullptr)
+			return;
+		cframe = partSnapshot->cframe;
+		scale = partSnapshot->scale;
+	} else {
+		cframe = transform->getCFrame();
+		scale = transform->getScale();
+	}
+
+	const ShapeClass* shapeClass;
+	if (hitbox->isPartAttached()) {
+		const PartSnapshot* partSnapshot = snapshot.find(hitbox->getPart());
+		if (partSnapshot == nullptr)
+			return;
+		shapeClass = partSnapshot->baseShape;
+	} else {
+		Shape shape = hitbox->getShape();
+		shapeClass = shape.baseShape;
+		scale = scale * shape.scale;
+	}
+
+	VisualData data = MeshRegistry::getOrCreateMeshFor(shapeClass);
+
+	Shaders::debugShader.updateModel(cframe.asMat4WithPreScale(scale));
+	MeshRegistry::meshes[data.id]->render();
+}
+
+static Color getAlbedoForPart(Screen* screen, Engine::Registry64::entity_type entity, const PartSnapshot* selectedPart, const PartSnapshot* part) {
+	Color computedAmbient = getAmbientForPartForSelected(selectedPart, part);
 
-	if (part->entity == screen->intersectedEntity)
+	if (entity == screen->intersectedEntity)
 		computedAmbient += Vec4f(-0.1f, -0.1f, -0.1f, 0);
 
 	return computedAmbient;
 }
 
+ModelLayer::CachedEntity& ModelLayer::getCachedEntity(Engine::Registry64::entity_type entity) {
+	std::size_t index = Engine::Registry64::getIndex(entity);
+	if (index >= entityCache.size())
+		entityCache.resize(index + 1);
+
+	// A destroyed entity whose index was reused
+	CachedEntity& cached = entityCache[index];
+	if (cached.entity != entity) {
+		cached = CachedEntity();
+		cached.entity = entity;
+	}
+
+	return cached;
+}
+
+void ModelLayer::resolveCachedEntity(Engine::Registry64& registry, CachedEntity& cached) {
+	cached.resolved = true;
+	cached.mesh = nullptr;
+	cached.material = nullptr;
+	if (!registry.has<Comp::Transform>(cached.entity))
+		return;
+
+	cached.mesh = registry.get<Comp::Mesh>(cached.entity).get();
+	cached.material = registry.get<Comp::Material>(cached.entity).get();
+}
+
 void ModelLayer::onInit(Engine::Registry64& registry) {
 	using namespace Graphics;
 	Screen* screen = static_cast<Screen*>(this->ptr);
@@ -101,6 +168,9 @@ void ModelLayer::onInit(Engine::Registry64& registry) {
 
 	// Instance batch manager
 	manager = new InstanceBatchManager<Uniform>(DEFAULT_UNIFORM_BUFFER_LAYOUT);
+
+	// Render prep runs on the workers of physics, a pool of its own would oversubscribe the CPU
+	renderJobs = &getJobSystem();
 }
 
 void ModelLayer::onUpdate(Engine::Registry64& registry) {
@@ -156,128 +226,139 @@ void ModelLayer::onRender(Engine::Registry64& registry) {
 
 	graphicsMeasure.mark(PHYSICALS);
 	
-	// Filter on mesh ID and transparency
-	struct EntityInfo {
-		Engine::Registry64::entity_type entity = 0;
-		Comp::Transform transform;
-		Comp::Material material;
-		Ref<Comp::Mesh> mesh;
-		Ref<Comp::Collider> collider;
+	// Part transforms are read from the snapshot of the latest tick, so rendering never waits for the world lock
+	// While paused nothing ticks, so edits are made visible by publishing a snapshot here
+	if (isPaused())
+		screen->world->publishSnapshot();
+	screen->world->pullSnapshot();
+	const WorldSnapshot& snapshot = screen->world->getSnapshots().latest();
+	const PartSnapshot* selectedPartSnapshot = snapshot.find(screen->selectedPart);
+
+	// Components are only looked up again once entities gained or lost a mesh, material or transform
+	std::size_t generations[3] {
+		registry.getComponentGeneration<Comp::Mesh>(),
+		registry.getComponentGeneration<Comp::Material>(),
+		registry.getComponentGeneration<Comp::Transform>()
 	};
-	
-	std::map<double, EntityInfo> transparentEntities;
-	screen->world->syncReadOnlyOperation([this, &transparentEntities, screen, &registry] () {
+	if (!std::equal(std::begin(generations), std::end(generations), std::begin(cachedGenerations))) {
+		for (CachedEntity& cached : entityCache)
+			cached.resolved = false;
+		std::copy(std::begin(generations), std::end(generations), std::begin(cachedGenerations));
+	}
+
+	// Only the parts that moved since the last applied snapshot get their model matrix recomputed, without touching the registry
+	snapshot.forEachChangeSince(appliedSnapshotSequence, [this] (std::uint64_t tag, const GlobalCFrame& cframe, const DiagonalMat3& scale) {
+		if (tag == 0)
+			return;
+
+		CachedEntity& cached = getCachedEntity(static_cast<Engine::Registry64::entity_type>(tag));
+		cached.modelMatrix = cframe.asMat4WithPreScale(scale);
+		cached.modelMatrixValid = true;
+	});
+	appliedSnapshotSequence = snapshot.sequence;
+
+	static const Comp::Material defaultMaterial;
+	auto addRenderItem = [&] (Engine::Registry64::entity_type entity, const Comp::Mesh& mesh, const Comp::Material& material, const PartSnapshot* partSnapshot, const Position& position) {
+		RenderItem item;
+		item.entity = entity;
+		item.mesh = mesh.id;
+		item.mode = mesh.mode;
+		item.material = material;
+		item.partSnapshot = partSnapshot;
+		item.transparent = item.material.albedo.w < 1.0f;
+		item.depth = static_cast<float>(lengthSquared(Vec3(screen->camera.cframe.position - position)));
+		renderItems.push_back(item);
+	};
+
+	{
 		VisibilityFilter filter = VisibilityFilter::forWindow(screen->camera.cframe.position, screen->camera.getForwardDirection(), screen->camera.getUpDirection(), screen->camera.fov, screen->camera.aspect, screen->camera.zfar);
 
+		renderItems.clear();
+
+		// Parts are culled through the bounds trees in the snapshot, subtrees outside of the view are skipped at once
+		// Parts added since the latest tick are not rendered until they are in a snapshot
+		snapshot.forEachPartFiltered(filter, [&] (const PartSnapshot& partSnapshot) {
+			Engine::Registry64::entity_type entity = static_cast<Engine::Registry64::entity_type>(partSnapshot.tag);
+			if (entity == 0)
+				return;
+
+			CachedEntity& cached = getCachedEntity(entity);
+			if (!cached.resolved)
+				resolveCachedEntity(registry, cached);
+
+			if (cached.mesh == nullptr || cached.mesh->id == -1)
+				return;
+
+			if (!cached.modelMatrixValid) {
+				cached.modelMatrix = partSnapshot.cframe.asMat4WithPreScale(partSnapshot.scale);
+				cached.modelMatrixValid = true;
+			}
+
+			addRenderItem(entity, *cached.mesh, cached.material != nullptr ? *cached.material : defaultMaterial, &partSnapshot, partSnapshot.cframe.getPosition());
+			renderItems.back().modelMatrix = cached.modelMatrix;
+		});
+
+		// Entities without a part are not in the trees
 		auto view = registry.view<Comp::Mesh>();
 		for (auto entity : view) {
-			EntityInfo info;
-			info.entity = entity;
-			
-			info.mesh = view.get<Comp::Mesh>(entity);
-			if (!info.mesh.valid())
+			if (registry.has<Comp::Collider>(entity))
 				continue;
 
-			if (info.mesh->id == -1)
+			Ref<Comp::Mesh> mesh = view.get<Comp::Mesh>(entity);
+			if (!mesh.valid() || mesh->id == -1)
 				continue;
-			
-			info.collider = registry.get<Comp::Collider>(entity);
-			if (info.collider.valid())
-				if (!filter(*info.collider->part))
-					continue;
-
-			info.transform = registry.getOr<Comp::Transform>(entity);
-			info.material = registry.getOr<Comp::Material>(entity);
-			
-			if (info.material.albedo.w < 1.0f) {
-				double distance = lengthSquared(Vec3(screen->camera.cframe.position - info.transform.getPosition()));
-				transparentEntities.insert(std::make_pair(distance, info));
-			} else {
-				Mat4f modelMatrix = info.transform.getModelMatrix();
-
-				if (info.collider.valid())
-					info.material.albedo += getAlbedoForPart(screen, info.collider->part);
-
-				Uniform uniform {
-					modelMatrix,
-					info.material.albedo,
-					info.material.metalness,
-					info.material.roughness,
-					info.material.ao
-				};
-				
-				manager->add(info.mesh->id, uniform);
-			}
+
+			Comp::Transform transform = registry.getOr<Comp::Transform>(entity);
+			addRenderItem(entity, *mesh, registry.getOr<Comp::Material>(entity), nullptr, transform.getPosition());
+			renderItems.back().modelMatrix = transform.getModelMatrix();
 		}
-		
-		Shaders::instanceShader.bind();
-		manager->submit();
-		
 
-		// Render transparent meshes
-		Shaders::basicShader.bind();
-		enableBlending();
-		for (auto iterator = transparentEntities.rbegin(); iterator != transparentEntities.rend(); ++iterator) {
-			EntityInfo info = iterator->second;
+		// Matrices and colors are computed on the workers, opaque instances end up grouped per mesh and transparents sorted back to front
+		renderListBuilder.build(renderItems, [&] (const RenderItem& item) {
+			Uniform uniform {
+				item.modelMatrix,
+				item.material.albedo,
+				item.material.metalness,
+				item.material.roughness,
+				item.material.ao
+			};
 
-			if (info.mesh->id == -1)
-				continue;
+			if (item.partSnapshot != nullptr)
+				uniform.albedo += getAlbedoForPart(screen, item.entity, selectedPartSnapshot, item.partSnapshot);
 
-			if (info.collider.valid())
-				info.material.albedo += getAlbedoForPart(screen, info.collider->part);
+			return uniform;
+		}, renderJobs, renderList);
 
-			Shaders::basicShader.updateMaterial(info.material);
-			Shaders::basicShader.updateModel(info.transform.getModelMatrix());
-			MeshRegistry::meshes[info.mesh->id]->render(info.mesh->mode);
-		}
+		Shaders::instanceShader.bind();
+		manager->submit(renderList);
 
-		// Hitbox drawing
-		if (screen->selectedEntity) {
-			Ref<Comp::Transform> transform = registry.get<Comp::Transform>(screen->selectedEntity);
-			if (transform.valid()) {
-				Ref<Comp::Hitbox> hitbox = registry.get<Comp::Hitbox>(screen->selectedEntity);
-
-				if (hitbox.valid()) {
-					Shape shape = hitbox->getShape();
-					DiagonalMat3 scale = transform->getScale();
-
-					if (!hitbox->isPartAttached())
-						scale = scale * hitbox->getScale();		
-					
-					VisualData data = MeshRegistry::getOrCreateMeshFor(shape.baseShape);
-
-					Shaders::debugShader.updateModel(transform->getCFrame().asMat4WithPreScale(scale));
-					MeshRegistry::meshes[data.id]->render();
-				}
-			}
+		// Render transparent meshes
+		Shaders::basicShader.bind();
+		enableBlending();
+		for (const auto& draw : renderList.transparents) {
+			const RenderItem& item = renderItems[draw.item];
+
+			Comp::Material material = item.material;
+			material.albedo = draw.uniform.albedo;
+			Shaders::basicShader.updateMaterial(material);
+			Shaders::basicShader.updateModel(draw.uniform.modelMatrix);
+			MeshRegistry::meshes[draw.mesh]->render(item.mode);
 		}
 
 		// Hitbox drawing
-		for (auto entity : screen->selectionContext.selection) {
-			Ref<Comp::Transform> transform = registry.get<Comp::Transform>(entity);
-			if (transform.valid()) {
-				Ref<Comp::Hitbox> hitbox = registry.get<Comp::Hitbox>(entity);
-
-				if (hitbox.valid()) {
-					Shape shape = hitbox->getShape();
-
-					if (!hitbox->isPartAttached())
-						shape = shape.scaled(transform->getScale());
+		if (screen->selectedEntity)
+			renderHitbox(snapshot, registry, screen->selectedEntity);
 
-					VisualData data = MeshRegistry::getOrCreateMeshFor(shape.baseShape);
-
-					Shaders::debugShader.updateModel(transform->getCFrame().asMat4WithPreScale(shape.scale));
-					MeshRegistry::meshes[data.id]->render();
-				}
-			}
-		}
-	});
+		for (auto entity : screen->selectionContext.selection)
+			renderHitbox(snapshot, registry, entity);
+	}
 
 	endScene();
 }
 
 void ModelLayer::onClose(Engine::Registry64& registry) {
-
+	renderJobs = nullptr;
+	entityCache.clear();
 }
 
 };
\ No newline at end of file
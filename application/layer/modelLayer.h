@@ -1,7 +1,13 @@
 #pragma once
 
 #include "../graphics/batch/instanceBatchManager.h"
+#include "../graphics/batch/renderList.h"
 #include "../engine/layer/layer.h"
+#include "../engine/ecs/registry.h"
+#include "ecs/components.h"
+
+class JobSystem;
+struct PartSnapshot;
 
 namespace P3D::Application {
 
@@ -17,7 +23,48 @@ public:
 		float ao = 1.0f;
 	};
 
+	// A visible mesh of the frame, as collected for the render list
+	struct RenderItem {
+		Engine::Registry64::entity_type entity = 0;
+		int mesh = -1;
+		int mode = 0;
+		float depth = 0.0f;
+		bool transparent = false;
+		Comp::Material material;
+		// nullptr for entities without a part
+		const PartSnapshot* partSnapshot = nullptr;
+		Mat4f modelMatrix = Mat4f::IDENTITY();
+	};
+
 	Graphics::InstanceBatchManager<Uniform>* manager = nullptr;
+
+	// Render prep, the render list is built from the items on the workers of renderJobs, not owned
+	JobSystem* renderJobs = nullptr;
+	std::vector<RenderItem> renderItems;
+	Graphics::RenderListBuilder<Uniform> renderListBuilder;
+	Graphics::RenderList<Uniform> renderList;
+
+	// The render data of an entity with a part, kept between frames so a frame only looks up the entities that changed
+	struct CachedEntity {
+		Engine::Registry64::entity_type entity = 0;
+		// false until mesh and material are looked up, nullptr if the entity has none
+		bool resolved = false;
+		const Comp::Mesh* mesh = nullptr;
+		const Comp::Material* material = nullptr;
+		// false until the matrix is first set, a part that doesn't move would otherwise never get its matrix
+		bool modelMatrixValid = false;
+		Mat4f modelMatrix = Mat4f::IDENTITY();
+	};
+
+	// Indexed by entity index, the cached components stay valid while the generations of the Mesh, Material and Transform pools don't change
+	std::vector<CachedEntity> entityCache;
+	std::size_t cachedGenerations[3] {};
+
+	// Sequence number of the snapshot whose changes were last applied to the cached model matrices
+	std::size_t appliedSnapshotSequence = 0;
+
+	CachedEntity& getCachedEntity(Engine::Registry64::entity_type entity);
+	static void resolveCachedEntity(Engine::Registry64& registry, CachedEntity& cached);
 	
 public:
 	ModelLayer() : Layer() {}
@@ -14,7 +14,6 @@
 #include "../engine/input/mouse.h"
 #include "../graphics/debug/visualDebug.h"
 #include "../physics/geometry/shape.h"
-#include "../physics/misc/filters/rayIntersectsBoundsFilter.h"
 
 namespace P3D::Application {
 
@@ -55,16 +54,25 @@ double intersect(const Ray& ray, const Shape& shape, const GlobalCFrame& cframe)
 }
 
 void intersectEntities(Screen& screen, const Ray& ray) {
-	RayIntersectBoundsFilter filter(ray);
 	Engine::Registry64::entity_type closestIntersectedEntity = 0;
 	double closestIntersectDistance = std::numeric_limits<double>::max();
-	
+
+	// Parts are found through the bounds trees of the world
+	RaycastHit hit;
+	screen.world->syncReadOnlyOperation([&] () {
+		hit = screen.world->raycast(ray);
+	});
+	if (hit.hit() && static_cast<ExtendedPart*>(hit.part)->entity) {
+		closestIntersectDistance = hit.distance;
+		closestIntersectedEntity = static_cast<ExtendedPart*>(hit.part)->entity;
+	}
+
+	// Only hitboxes without a part are left to check one by one
 	auto view = screen.registry.view<Comp::Hitbox>();
 	for (auto entity : view) {
 		Ref<Comp::Hitbox> hitbox = view.get<Comp::Hitbox>(entity);
 		if (hitbox->isPartAttached())
-			if (!filter(*hitbox->getPart()))
-				continue;
+			continue;
 
 		Ref<Comp::Transform> transform = screen.registry.get<Comp::Transform>(entity);
 		if (transform.invalid())
@@ -90,4 +90,8 @@ void PlayerWorld::onPartRemoved(ExtendedPart* part) {
 	screen.registry.get<Comp::Transform>(part->entity)->cframe = Comp::Transform::ScaledCFrame { part->getCFrame(), part->hitbox.scale };
 }
 
+std::uint64_t PlayerWorld::getSnapshotTag(const Part& part) const {
+	return static_cast<const ExtendedPart&>(part).entity;
+}
+
 };
\ No newline at end of file
@@ -18,6 +18,9 @@ public:
 
 	void onPartAdded(ExtendedPart* part) override;
 	void onPartRemoved(ExtendedPart* part) override;
+
+	// The entity of the part, so the renderer can find it from a snapshot
+	std::uint64_t getSnapshotTag(const Part& part) const override;
 };
 
 };
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include "batchSimulation.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+
+#include "../util/cmdParser.h"
+#include "../util/terminalColor.h"
+
+static void printUsage() {
+	setColor(TerminalColor::WHITE);
+	std::cout << "Usage: batchRunner [options] <world files...>\n"
+		"  --ticks <n>          ticks to run per world (default 1000)\n"
+		"  --deltaT <seconds>   length of a tick (default 0.01)\n"
+		"  --threads <n>        narrowphase worker threads per world (default 0)\n"
+		"  --parallel <n>       worlds simulated at the same time (default: hardware threads)\n"
+		"  --checkpoint <n>     write a checkpoint and breakdown row every n ticks (default: only after the last tick)\n"
+		"  --out <directory>    existing directory for checkpoints and breakdowns (default .)\n"
+		"  --partdata <format>  'application' for worlds saved by the application, 'native' for plain physics worlds\n"
+		"  -validate            check the validity of every world at each checkpoint\n";
+}
+
+static std::size_t parseCount(const Util::ParsedArgs& args, const char* option, std::size_t defaultValue) {
+	std::string value = args.getOptional(option);
+	return value.empty() ? defaultValue : static_cast<std::size_t>(std::stoull(value));
+}
+
+static void printResult(const BatchResult& result) {
+	if(result.succeeded) {
+		setColor(TerminalColor::GREEN);
+		std::cout << result.worldFile << ": " << result.partCount << " parts, " << result.ticksRun << " ticks in " << result.simulateMS << "ms";
+		setColor(TerminalColor::YELLOW);
+		std::cout << " (load " << result.loadMS << "ms";
+		// --ticks 0 only loads the world
+		if(result.ticksRun != 0) std::cout << ", " << result.simulateMS / result.ticksRun << "ms/tick";
+		std::cout << ")\n";
+	} else {
+		setColor(TerminalColor::RED);
+		std::cout << result.worldFile << ": failed after " << result.ticksRun << " ticks: " << result.error << "\n";
+	}
+	setColor(TerminalColor::WHITE);
+	std::cout.flush();
+}
+
+int main(int argc, const char** args) {
+	Util::ParsedArgs pa(argc, args);
+
+	if(pa.argCount() == 0) {
+		printUsage();
+		return 1;
+	}
+
+	BatchSettings settings;
+	settings.tickCount = parseCount(pa, "ticks", settings.tickCount);
+	settings.threadsPerWorld = parseCount(pa, "threads", settings.threadsPerWorld);
+	settings.checkpointInterval = parseCount(pa, "checkpoint", settings.checkpointInterval);
+	settings.validate = pa.hasFlag("validate");
+	if(!pa.getOptional("deltaT").empty()) settings.deltaT = std::stod(pa.getOptional("deltaT"));
+	if(!pa.getOptional("out").empty()) settings.outputDirectory = pa.getOptional("out");
+
+	std::string partData = pa.getOptional("partdata");
+	if(partData == "native") {
+		settings.partDataFormat = PartDataFormat::NATIVE;
+	} else if(partData.empty() || partData == "application") {
+		settings.partDataFormat = PartDataFormat::APPLICATION;
+	} else {
+		printUsage();
+		return 1;
+	}
+
+	std::vector<std::string> worldFiles(pa.begin(), pa.end());
+
+	std::size_t hardwareThreads = std::thread::hardware_concurrency();
+	std::size_t parallelWorlds = parseCount(pa, "parallel", hardwareThreads != 0 ? hardwareThreads : 1);
+	if(parallelWorlds == 0) parallelWorlds = 1;
+	if(parallelWorlds > worldFiles.size()) parallelWorlds = worldFiles.size();
+
+	// physicsMeasure is shared by all worlds, a breakdown of it is only meaningful while one world ticks at a time
+	settings.recordPhysicsMeasure = parallelWorlds == 1;
+
+	std::vector<BatchResult> results(worldFiles.size());
+	std::atomic<std::size_t> nextWorld{0};
+	std::mutex printLock;
+
+	auto worker = [&]() {
+		while(true) {
+			std::size_t index = nextWorld.fetch_add(1);
+			if(index >= worldFiles.size()) return;
+
+			results[index] = runBatchSimulation(worldFiles[index], settings);
+
+			std::lock_guard<std::mutex> lg(printLock);
+			printResult(results[index]);
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for(std::size_t i = 1; i < parallelWorlds; i++) {
+		workers.emplace_back(worker);
+	}
+	worker();
+	for(std::thread& t : workers) {
+		t.join();
+	}
+
+	std::size_t failed = 0;
+	for(const BatchResult& result : results) {
+		if(!result.succeeded) failed++;
+	}
+	if(failed != 0) {
+		setColor(TerminalColor::RED);
+		std::cout << failed << "/" << results.size() << " worlds failed\n";
+		setColor(TerminalColor::WHITE);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,232 @@
+#include "batchSimulation.h"
+
+#include <fstream>
+#include <chrono>
+#include <memory>
+#include <exception>
+
+#include "../physics/part.h"
+#include "../physics/world.h"
+#include "../physics/misc/serialization.h"
+#include "../physics/misc/mappedWorldFormat.h"
+#include "../physics/misc/physicsProfiler.h"
+#include "../physics/threading/physicsDriver.h"
+#include "../util/mappedFile.h"
+#include "../application/io/materialFormat.h"
+
+static const char* tickPhaseLabels[]{
+	"Broadphase",
+	"Narrowphase",
+	"Response",
+	"Constraints",
+	"Integrate",
+	"Refit"
+};
+
+/*
+	Part that keeps the external data it was loaded with as raw bytes
+	The runner does not need materials or names, it only has to write them back unchanged into checkpoints
+*/
+class BatchPart : public Part {
+public:
+	std::string externalData;
+
+	BatchPart(Part&& part, std::string&& externalData) : Part(std::move(part)), externalData(std::move(externalData)) {}
+};
+
+class BatchDeserializer : public DeSerializationSessionPrototype {
+	PartDataFormat format;
+
+protected:
+	virtual Part* deserializePartExternalData(Part&& part, std::istream& istream) override {
+		std::string externalData;
+		if(format == PartDataFormat::APPLICATION) {
+			externalData.resize(P3D::Application::MaterialFormat::SIZE);
+			istream.read(&externalData[0], P3D::Application::MaterialFormat::SIZE);
+			// the name of the part, including its terminating null character
+			while(true) {
+				int c = istream.get();
+				if(c == std::char_traits<char>::eof()) throw "Unexpected end of file in part data";
+				externalData.push_back(static_cast<char>(c));
+				if(c == '\0') break;
+			}
+		}
+		return new BatchPart(std::move(part), std::move(externalData));
+	}
+
+public:
+	BatchDeserializer(PartDataFormat format) : format(format) {}
+};
+
+class BatchSerializer : public SerializationSessionPrototype {
+protected:
+	virtual void serializePartExternalData(const Part& part, std::ostream& ostream) override {
+		const std::string& externalData = static_cast<const BatchPart&>(part).externalData;
+		ostream.write(externalData.data(), externalData.size());
+	}
+};
+
+std::string getWorldName(const std::string& path) {
+	std::size_t nameStart = path.find_last_of("/\\");
+	nameStart = (nameStart == std::string::npos) ? 0 : nameStart + 1;
+	std::size_t extensionStart = path.find_last_of('.');
+	if(extensionStart == std::string::npos || extensionStart < nameStart) extensionStart = path.size();
+	return path.substr(nameStart, extensionStart - nameStart);
+}
+
+static std::string getOutputPath(const BatchSettings& settings, const std::string& worldName, const std::string& suffix) {
+	return settings.outputDirectory + "/" + worldName + suffix;
+}
+
+static void writeCheckpoint(const World<BatchPart>& world, const std::string& path, bool mapped) {
+	std::ofstream file(path, std::ios::binary);
+	if(!file.is_open()) throw "Could not open checkpoint file for writing";
+
+	BatchSerializer serializer;
+	if(mapped) {
+		serializer.serializeWorldMapped(world, file);
+	} else {
+		serializer.serializeWorld(world, file);
+	}
+}
+
+/*
+	Sums the statistics of the ticks since the last checkpoint, the rows of the breakdown are the averages of these
+*/
+struct IntervalStatistics {
+	std::size_t tickCount = 0;
+	std::chrono::nanoseconds wallTime{0};
+	std::chrono::nanoseconds processTimes[static_cast<std::size_t>(PhysicsProcess::COUNT)]{};
+	long long intersections[static_cast<std::size_t>(IntersectionResult::COUNT)]{};
+
+	void addTick(std::chrono::nanoseconds tickTime, bool includePhysicsMeasure) {
+		tickCount++;
+		wallTime += tickTime;
+		if(includePhysicsMeasure) {
+			for(std::size_t i = 0; i < static_cast<std::size_t>(PhysicsProcess::COUNT); i++) {
+				processTimes[i] += physicsMeasure.history.front()[i];
+			}
+			for(std::size_t i = 0; i < static_cast<std::size_t>(IntersectionResult::COUNT); i++) {
+				intersections[i] += intersectionStatistics.history.front()[i];
+			}
+		}
+	}
+};
+
+static double toMS(std::chrono::nanoseconds time) {
+	return time.count() / 1000000.0;
+}
+
+static void writeBreakdownHeader(std::ostream& ostream, bool includePhysicsMeasure) {
+	ostream << "tick,ticks,wall ms/tick";
+	for(const char* label : tickPhaseLabels) {
+		ostream << ',' << label << " ms/tick";
+	}
+	if(includePhysicsMeasure) {
+		for(std::size_t i = 0; i < static_cast<std::size_t>(PhysicsProcess::COUNT); i++) {
+			ostream << ',' << physicsMeasure.labels[i] << " ms/tick";
+		}
+		for(std::size_t i = 0; i < static_cast<std::size_t>(IntersectionResult::COUNT); i++) {
+			ostream << ',' << intersectionStatistics.labels[i] << "/tick";
+		}
+	}
+	ostream << '\n';
+}
+
+static void writeBreakdownRow(std::ostream& ostream, std::size_t tick, const IntervalStatistics& stats, const PhysicsDriver::PhaseTimes& phaseTimes, bool includePhysicsMeasure) {
+	double ticks = static_cast<double>(stats.tickCount);
+	ostream << tick << ',' << stats.tickCount << ',' << toMS(stats.wallTime) / ticks;
+	for(std::size_t i = 0; i < static_cast<std::size_t>(TickPhase::COUNT); i++) {
+		ostream << ',' << toMS(phaseTimes[i]);
+	}
+	if(includePhysicsMeasure) {
+		for(std::size_t i = 0; i < static_cast<std::size_t>(PhysicsProcess::COUNT); i++) {
+			ostream << ',' << toMS(stats.processTimes[i]) / ticks;
+		}
+		for(std::size_t i = 0; i < static_cast<std::size_t>(IntersectionResult::COUNT); i++) {
+			ostream << ',' << stats.intersections[i] / ticks;
+		}
+	}
+	ostream << '\n';
+	ostream.flush();
+}
+
+static void simulate(World<BatchPart>& world, const std::string& worldFile, const BatchSettings& settings, BatchResult& result) {
+	using namespace std::chrono;
+	std::string worldName = getWorldName(worldFile);
+
+	high_resolution_clock::time_point loadStart = high_resolution_clock::now();
+	std::shared_ptr<Util::MappedFile> mapping = std::make_shared<Util::MappedFile>(worldFile);
+	bool isMapped = MappedWorldFormat::isMappedWorldFile(mapping->getData(), mapping->getSize());
+	if(isMapped) {
+		// the polyhedra point into the mapping, their shape classes keep it alive
+		BatchDeserializer deserializer(settings.partDataFormat);
+		deserializer.deserializeWorldMapped(world, mapping->getData(), mapping->getSize(), mapping);
+	} else {
+		mapping.reset();
+
+		std::ifstream file(worldFile, std::ios::binary);
+		if(!file.is_open()) throw "Could not open world file";
+
+		BatchDeserializer deserializer(settings.partDataFormat);
+		deserializer.deserializeWorld(world, file);
+		// reading with the wrong PartDataFormat misaligns everything after the first part
+		if(!file || file.peek() != std::char_traits<char>::eof()) throw "World file was not read completely, check the part data format";
+	}
+	result.loadMS = toMS(high_resolution_clock::now() - loadStart);
+	result.partCount = world.getPartCount();
+
+	if(settings.validate && !world.isValid()) throw "World is invalid after loading";
+
+	std::ofstream breakdown(getOutputPath(settings, worldName, ".breakdown.csv"));
+	if(!breakdown.is_open()) throw "Could not open breakdown file for writing";
+	writeBreakdownHeader(breakdown, settings.recordPhysicsMeasure);
+
+	PhysicsDriver driver(world, 1, settings.threadsPerWorld);
+	IntervalStatistics interval;
+
+	for(std::size_t tick = 1; tick <= settings.tickCount; tick++) {
+		high_resolution_clock::time_point tickStart = high_resolution_clock::now();
+		driver.runTick();
+		nanoseconds tickTime = high_resolution_clock::now() - tickStart;
+
+		interval.addTick(tickTime, settings.recordPhysicsMeasure);
+		result.simulateMS += toMS(tickTime);
+		result.ticksRun = tick;
+
+		bool isCheckpoint = (settings.checkpointInterval != 0 && tick % settings.checkpointInterval == 0) || tick == settings.tickCount;
+		if(isCheckpoint) {
+			if(settings.validate && !world.isValid()) throw "World became invalid";
+
+			PhysicsDriver::PhaseTimes phaseTimes;
+			driver.getAveragePhaseTimes(phaseTimes);
+			writeBreakdownRow(breakdown, tick, interval, phaseTimes, settings.recordPhysicsMeasure);
+			driver.resetTimings();
+			interval = IntervalStatistics();
+
+			writeCheckpoint(world, getOutputPath(settings, worldName, ".tick" + std::to_string(tick) + ".world"), isMapped);
+		}
+	}
+}
+
+BatchResult runBatchSimulation(const std::string& worldFile, const BatchSettings& settings) {
+	BatchResult result;
+	result.worldFile = worldFile;
+
+	// the narrowphase workers of the driver follow the ticking thread
+	std::unique_ptr<PhysicsStatisticsDisabler> noStatistics;
+	if(!settings.recordPhysicsMeasure) noStatistics.reset(new PhysicsStatisticsDisabler());
+
+	World<BatchPart> world(settings.deltaT);
+	try {
+		simulate(world, worldFile, settings, result);
+		result.succeeded = true;
+	} catch(const char* error) {
+		result.error = error;
+	} catch(const std::exception& error) {
+		result.error = error.what();
+	}
+	// the world does not own its parts, they have to be deleted explicitly
+	world.clear();
+	return result;
+}
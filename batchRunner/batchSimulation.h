@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+/*
+	How the part data that follows the physical data of every part in a .world file should be treated
+	NATIVE: plain physics worlds, as written by SerializationSessionPrototype
+	APPLICATION: worlds saved by the application, every part also carries its material and name
+*/
+enum class PartDataFormat {
+	NATIVE,
+	APPLICATION
+};
+
+struct BatchSettings {
+	std::size_t tickCount = 1000;
+	double deltaT = 1.0 / 100.0;
+	// narrowphase workers per world, 0 runs everything on the thread ticking the world
+	std::size_t threadsPerWorld = 0;
+	// a checkpoint is written every checkpointInterval ticks and after the last tick, 0 only writes the last one
+	std::size_t checkpointInterval = 0;
+	std::string outputDirectory = ".";
+	PartDataFormat partDataFormat = PartDataFormat::APPLICATION;
+	// physicsMeasure is global, it can only be used while a single world is ticking at a time
+	bool recordPhysicsMeasure = true;
+	bool validate = false;
+};
+
+struct BatchResult {
+	std::string worldFile;
+	bool succeeded = false;
+	std::string error;
+	std::size_t partCount = 0;
+	std::size_t ticksRun = 0;
+	double loadMS = 0.0;
+	double simulateMS = 0.0;
+};
+
+/*
+	Loads worldFile, ticks it settings.tickCount times and writes its checkpoints and breakdown into settings.outputDirectory
+
+	Both the stream format and the mapped format of mappedWorldFormat.h are read, mapped files are loaded without copying their polyhedra
+	Checkpoints are written as <name>.tick<N>.world in the same format and part data format as the input, so they can be loaded again
+	The breakdown is written to <name>.breakdown.csv, one row per checkpoint interval with the average time per tick of every
+	TickPhase, and of every PhysicsProcess if settings.recordPhysicsMeasure is set
+
+	Every call uses its own world and PhysicsDriver, so different worlds may be simulated concurrently on different threads
+	as long as recordPhysicsMeasure is off for all of them
+*/
+BatchResult runBatchSimulation(const std::string& worldFile, const BatchSettings& settings);
+
+// file name of path without directories and extension
+std::string getWorldName(const std::string& path);
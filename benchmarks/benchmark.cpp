@@ -1,13 +1,28 @@
 #include "benchmark.h"
 
+#include <algorithm>
 #include <chrono>
 #include <vector>
 #include <iostream>
+#include <fstream>
 #include <string>
 #include <sstream>
+#include <cstdio>
+#include <cstdlib>
 
 #include "../util/terminalColor.h"
 #include "../util/parseCPUIDArgs.h"
+#include "worldBenchmark.h"
+#include "perfCounters.h"
+#include "benchmarkStatistics.h"
+
+#ifdef _WIN32
+#include <process.h>
+#define NULL_DEVICE "NUL"
+#else
+#include <unistd.h>
+#define NULL_DEVICE "/dev/null"
+#endif
 
 std::vector<Benchmark*>* knownBenchmarks = nullptr;
 
@@ -57,14 +72,32 @@ static void runBenchmark(Benchmark* bench) {
 	setColor(TerminalColor::YELLOW);
 	std::cout << '(' << (createFinish - createStart).count() / 1000000.0 << "ms)";
 	std::cout.flush();
+	PerfCounters& counters = PerfCounters::local();
+	PerfCounterValues countersBefore = counters.read();
 	auto runStart = std::chrono::high_resolution_clock::now();
 	bench->run();
 	auto runFinish = std::chrono::high_resolution_clock::now();
+	PerfCounterValues runCounters = counters.read() - countersBefore;
 	double deltaTimeMS = (runFinish - runStart).count() / 1000000.0;
 	setColor(TerminalColor::GREEN);
-	std::cout << "  (" << deltaTimeMS << "ms)\n";
+	std::cout << "  (" << deltaTimeMS << "ms)";
+	BenchmarkWork work = bench->getWork();
+	if(work.unit != nullptr && deltaTimeMS > 0.0) {
+		setColor(TerminalColor::MAGENTA);
+		std::cout << "  (" << formatCount(work.amount / deltaTimeMS * 1000.0) << ' ' << work.unit << "/s)";
+	}
+	std::cout << "\n";
 	std::cout.flush();
 	bench->printResults(deltaTimeMS);
+
+	if(counters.isAnyAvailable()) {
+		setColor(TerminalColor::WHITE);
+		std::cout << "\n";
+		setColor(TerminalColor::MAGENTA);
+		std::cout << "[Hardware Counters]\n";
+		const char* label = "Run";
+		printPerfCounterTable(&label, &runCounters, 1);
+	}
 }
 
 static void runBenchmarks(const std::vector<std::string>& benchmarks) {
@@ -76,6 +109,14 @@ static void runBenchmarks(const std::vector<std::string>& benchmarks) {
 	std::cout << " [RUNTIME]\n";
 	setColor(TerminalColor::WHITE);
 
+	// counted on this thread, which runs every benchmark
+	PerfCounters& counters = PerfCounters::local();
+	if(!counters.getUnavailableReason().empty()) {
+		setColor(TerminalColor::YELLOW);
+		std::cout << (counters.isAnyAvailable() ? "Some counters are unavailable, " : "Hardware counters are unavailable, ") << counters.getUnavailableReason() << "\n";
+		setColor(TerminalColor::WHITE);
+	}
+
 	for(const std::string& c : benchmarks) {
 		Benchmark* b = getBenchFor(c);
 		if(b != nullptr) {
@@ -84,11 +125,285 @@ static void runBenchmarks(const std::vector<std::string>& benchmarks) {
 	}
 }
 
+/*
+	With any of these set the benchmarks are run as repetitions, each in its own process started from this executable
+	A new process starts every repetition from the state the benchmark was constructed in, as init() and run() change it
+*/
+struct StatisticsSettings {
+	std::size_t repetitions = 10;
+	std::size_t warmup = 1;
+	std::vector<int> partCounts;
+	std::vector<int> threadCounts;
+	std::string jsonPath;
+	std::string csvPath;
+	std::string baselinePath;
+	double thresholdPercent = 5.0;
+};
+
+static std::vector<int> parseIntList(const std::string& list) {
+	std::vector<int> result;
+	for(const std::string& item : split(list + ",", ',')) {
+		if(!item.empty()) result.push_back(std::stoi(item));
+	}
+	return result;
+}
+
+// the child process of a repetition, writes the sample to the sampleFile, returns the exit code
+static int runOnce(const Util::ParsedArgs& pa) {
+	Benchmark* bench = (pa.argCount() == 1) ? getBenchFor(pa[0]) : nullptr;
+	if(bench == nullptr) return 1;
+	std::string parts = pa.getOptional("parts");
+	if(!parts.empty()) bench->parameters.parts = std::stoi(parts);
+	std::string threads = pa.getOptional("threads");
+	if(!threads.empty()) bench->parameters.threads = std::stoi(threads);
+
+	PerfCounters& counters = PerfCounters::local();
+	auto initStart = std::chrono::high_resolution_clock::now();
+	bench->init();
+	auto initFinish = std::chrono::high_resolution_clock::now();
+	PerfCounterValues countersBefore = counters.read();
+	auto runStart = std::chrono::high_resolution_clock::now();
+	bench->run();
+	auto runFinish = std::chrono::high_resolution_clock::now();
+	PerfCounterValues runCounters = counters.read() - countersBefore;
+	BenchmarkWork work = bench->getWork();
+
+	std::ofstream sampleFile(pa.getOptional("sampleFile"));
+	sampleFile.precision(9);
+	sampleFile << std::chrono::duration<double, std::milli>(initFinish - initStart).count() << ' ' << std::chrono::duration<double, std::milli>(runFinish - runStart).count();
+	for(std::int64_t count : runCounters.values) sampleFile << ' ' << count;
+	// the units are single words, - for none
+	sampleFile << ' ' << work.amount << ' ' << (work.unit != nullptr ? work.unit : "-");
+	sampleFile << '\n';
+	return sampleFile.good() ? 0 : 1;
+}
+
+static std::string quote(const std::string& text) {
+	return '"' + text + '"';
+}
+
+// a repetition writes its sample to this file in the working directory, named after this process so concurrent runs do not share it
+static std::string getSampleFileName() {
+#ifdef _WIN32
+	int pid = _getpid();
+#else
+	int pid = static_cast<int>(getpid());
+#endif
+	return "benchmarkSample" + std::to_string(pid) + ".tmp";
+}
+
+static bool runRepetition(const std::string& command, const std::string& sampleFileName, BenchmarkSample& sample) {
+	std::remove(sampleFileName.c_str());
+	if(std::system(command.c_str()) != 0) return false;
+	std::ifstream sampleFile(sampleFileName);
+	sampleFile >> sample.initMillis >> sample.runMillis;
+	for(std::int64_t& count : sample.counters.values) sampleFile >> count;
+	sampleFile >> sample.workAmount >> sample.workUnit;
+	if(sample.workUnit == "-") sample.workUnit.clear();
+	bool valid = !sampleFile.fail();
+	sampleFile.close();
+	std::remove(sampleFileName.c_str());
+	return valid;
+}
+
+static std::string formatMillis(double millis) {
+	std::stringstream ss;
+	ss.precision(millis < 10.0 ? 4 : 2);
+	ss << std::fixed << millis << "ms";
+	return ss.str();
+}
+
+static void printSummary(const BenchmarkSummary& summary, const std::vector<BenchmarkBaseline>& baseline, const StatisticsSettings& settings, std::size_t& regressionCount) {
+	setColor(TerminalColor::GREEN);
+	std::cout << formatMillis(summary.median) << " +- " << formatMillis(summary.mad);
+	if(!summary.workUnit.empty()) {
+		setColor(TerminalColor::MAGENTA);
+		std::cout << "  " << formatCount(summary.throughput) << ' ' << summary.workUnit << "/s";
+	}
+	setColor(TerminalColor::YELLOW);
+	std::cout << "  p10 " << formatMillis(summary.p10) << "  p90 " << formatMillis(summary.p90) << "  min " << formatMillis(summary.min) << "  max " << formatMillis(summary.max);
+
+	if(!settings.baselinePath.empty()) {
+		const BenchmarkBaseline* previous = nullptr;
+		for(const BenchmarkBaseline& b : baseline) {
+			if(b.name == summary.name) previous = &b;
+		}
+		std::cout << "  ";
+		if(previous == nullptr) {
+			setColor(TerminalColor::WHITE);
+			std::cout << "(not in baseline)";
+		} else {
+			std::stringstream change;
+			change.precision(1);
+			change << std::fixed << std::showpos << ((summary.median - previous->median) / previous->median * 100.0) << "%";
+			switch(compareToBaseline(summary, *previous, settings.thresholdPercent)) {
+				case BenchmarkChange::SAME:
+					setColor(TerminalColor::WHITE);
+					std::cout << change.str() << " within noise";
+					break;
+				case BenchmarkChange::FASTER:
+					setColor(TerminalColor::GREEN);
+					std::cout << change.str() << " faster";
+					break;
+				case BenchmarkChange::SLOWER:
+					setColor(TerminalColor::RED);
+					std::cout << change.str() << " REGRESSION";
+					regressionCount++;
+					break;
+			}
+		}
+	}
+	std::cout << '\n';
+	setColor(TerminalColor::WHITE);
+}
+
+// returns the exit code, 1 if any benchmark failed or regressed against the baseline
+static int runStatistics(const std::vector<std::string>& benchmarks, const StatisticsSettings& settings, const std::string& executable, const std::string& forwardedFlags) {
+	std::vector<BenchmarkBaseline> baseline;
+	if(!settings.baselinePath.empty()) {
+		std::ifstream baselineFile(settings.baselinePath);
+		try {
+			if(!baselineFile.is_open()) throw "Could not open the benchmark baseline";
+			baseline = readBenchmarkBaseline(baselineFile);
+		} catch(const char* error) {
+			setColor(TerminalColor::RED);
+			std::cout << error << ' ' << settings.baselinePath << "\n";
+			setColor(TerminalColor::WHITE);
+			return 1;
+		}
+	}
+
+	setColor(TerminalColor::WHITE);
+	std::cout << settings.repetitions << " repetitions after " << settings.warmup << " warmup, median +- median absolute deviation\n";
+
+	std::string sampleFileName = getSampleFileName();
+	std::vector<BenchmarkSummary> summaries;
+	std::size_t failureCount = 0;
+	std::size_t regressionCount = 0;
+	for(const std::string& c : benchmarks) {
+		Benchmark* b = getBenchFor(c);
+		if(b == nullptr) {
+			setColor(TerminalColor::RED);
+			std::cout << "Unknown benchmark " << c << "\n";
+			failureCount++;
+			continue;
+		}
+
+		// the sweeps only apply to the benchmarks that take the parameter
+		std::vector<int> partCounts = (b->takesParts() && !settings.partCounts.empty()) ? settings.partCounts : std::vector<int>{-1};
+		std::vector<int> threadCounts = (b->takesThreads() && !settings.threadCounts.empty()) ? settings.threadCounts : std::vector<int>{-1};
+		for(int parts : partCounts) {
+			for(int threads : threadCounts) {
+				std::string name = b->name;
+				std::string parameterArgs;
+				if(parts != -1) {
+					name += "/parts:" + std::to_string(parts);
+					parameterArgs += " --parts " + std::to_string(parts);
+				}
+				if(threads != -1) {
+					name += "/threads:" + std::to_string(threads);
+					parameterArgs += " --threads " + std::to_string(threads);
+				}
+				std::string command = quote(executable) + forwardedFlags + " -runOnce --sampleFile " + quote(sampleFileName) + parameterArgs + " " + quote(b->name) + " > " NULL_DEVICE;
+#ifdef _WIN32
+				// cmd strips the outer quotes of the whole command
+				command = quote(command);
+#endif
+
+				setColor(TerminalColor::CYAN);
+				std::cout << name << ": ";
+				std::cout.flush();
+
+				std::vector<BenchmarkSample> samples;
+				bool failed = false;
+				for(std::size_t i = 0; i < settings.warmup + settings.repetitions && !failed; i++) {
+					BenchmarkSample sample;
+					failed = !runRepetition(command, sampleFileName, sample);
+					if(i >= settings.warmup) samples.push_back(sample);
+				}
+				if(failed) {
+					setColor(TerminalColor::RED);
+					std::cout << "failed\n";
+					setColor(TerminalColor::WHITE);
+					failureCount++;
+					continue;
+				}
+
+				summaries.push_back(summarizeBenchmark(name, settings.warmup, samples));
+				printSummary(summaries.back(), baseline, settings, regressionCount);
+			}
+		}
+	}
+
+	std::vector<const char*> names;
+	std::vector<PerfCounterValues> counters;
+	bool anyCounters = false;
+	for(const BenchmarkSummary& summary : summaries) {
+		names.push_back(summary.name.c_str());
+		counters.push_back(summary.counters);
+		for(std::int64_t count : summary.counters.values) anyCounters = anyCounters || count >= 0;
+	}
+	if(anyCounters) {
+		std::cout << "\n";
+		setColor(TerminalColor::MAGENTA);
+		std::cout << "[Hardware Counters] median of a run\n";
+		printPerfCounterTable(names.data(), counters.data(), counters.size());
+	}
+
+	if(!settings.jsonPath.empty()) {
+		std::ofstream json(settings.jsonPath);
+		writeBenchmarkJSON(json, summaries);
+	}
+	if(!settings.csvPath.empty()) {
+		std::ofstream csv(settings.csvPath);
+		writeBenchmarkCSV(csv, summaries);
+	}
+
+	if(!settings.baselinePath.empty()) {
+		setColor(regressionCount == 0 ? TerminalColor::GREEN : TerminalColor::RED);
+		std::cout << regressionCount << " regressions beyond " << settings.thresholdPercent << "% and the noise\n";
+		setColor(TerminalColor::WHITE);
+	}
+	return (failureCount == 0 && regressionCount == 0) ? 0 : 1;
+}
+
 int main(int argc, const char** args) {
 	Util::ParsedArgs pa(argc, args);
 	std::cout << Util::printAndParseCPUIDArgs(pa).c_str() << "\n";
+	if(pa.hasFlag("runOnce")) return runOnce(pa);
+
+	// the repetitions disable the same technologies
+	std::string forwardedFlags;
+	for(int techI = 0; techI < Util::CPUIDCheck::TECHNOLOGY_COUNT; techI++) {
+		if(pa.hasFlag(Util::CPUIDCheck::NAMES[techI])) forwardedFlags += std::string(" -") + Util::CPUIDCheck::NAMES[techI];
+	}
+
+	StatisticsSettings statistics;
+	bool useStatistics = false;
+	std::string repetitions = pa.getOptional("repetitions");
+	if(!repetitions.empty()) statistics.repetitions = std::max(1, std::stoi(repetitions));
+	std::string warmup = pa.getOptional("warmup");
+	if(!warmup.empty()) statistics.warmup = std::max(0, std::stoi(warmup));
+	statistics.partCounts = parseIntList(pa.getOptional("parts"));
+	statistics.threadCounts = parseIntList(pa.getOptional("threads"));
+	statistics.jsonPath = pa.getOptional("json");
+	statistics.csvPath = pa.getOptional("csv");
+	statistics.baselinePath = pa.getOptional("compare");
+	std::string threshold = pa.getOptional("threshold");
+	if(!threshold.empty()) statistics.thresholdPercent = std::stod(threshold);
+	for(const char* option : {"repetitions", "warmup", "parts", "threads", "json", "csv", "compare"}) {
+		if(!pa.getOptional(option).empty()) useStatistics = true;
+	}
+
+	worldBenchmarkTrace.tracePath = pa.getOptional("trace");
+	std::string traceSeconds = pa.getOptional("traceSeconds");
+	if(!traceSeconds.empty()) worldBenchmarkTrace.traceSeconds = std::stod(traceSeconds);
+	std::string spikeMillis = pa.getOptional("traceSpikeMs");
+	if(!spikeMillis.empty()) worldBenchmarkTrace.spikeMillis = std::stod(spikeMillis);
+	worldBenchmarkPerfPhases = pa.hasFlag("perfPhases");
 
 	if(pa.argCount() >= 1) {
+		if(useStatistics) return runStatistics(pa.args(), statistics, args[0], forwardedFlags);
 		runBenchmarks(pa.args());
 	} else {
 		setColor(TerminalColor::WHITE);
@@ -112,6 +427,7 @@ int main(int argc, const char** args) {
 
 		std::vector<std::string> commands = split(cmd, ';');
 
+		if(useStatistics) return runStatistics(commands, statistics, args[0], forwardedFlags);
 		runBenchmarks(commands);
 	}
 	return 0;
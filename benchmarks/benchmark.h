@@ -1,12 +1,38 @@
 #pragma once
 
 
+/*
+	Values a benchmark can be run with, set by the runner before init(), -1 where the benchmark picks its own
+*/
+struct BenchmarkParameters {
+	int parts = -1;
+	// including the thread that runs the benchmark
+	int threads = -1;
+};
+
+/*
+	How much a run processed, for benchmarks that scale with their input, the runners report it per second of the run
+*/
+struct BenchmarkWork {
+	double amount = 0.0;
+	// what is counted, such as "leaves" or "MB", nullptr for benchmarks that report no throughput
+	const char* unit = nullptr;
+};
+
 class Benchmark {
 public:
 	const char* name;
+	BenchmarkParameters parameters;
+
 	Benchmark(const char* name);
 	virtual ~Benchmark() {}
 	virtual void init() {}
 	virtual void run() = 0;
 	virtual void printResults(double timeTaken) {}
+	// read after run()
+	virtual BenchmarkWork getWork() const { return BenchmarkWork(); }
+
+	// the parameters this benchmark uses, the runner only sweeps those
+	virtual bool takesParts() const { return false; }
+	virtual bool takesThreads() const { return false; }
 };
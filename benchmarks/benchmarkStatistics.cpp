@@ -0,0 +1,251 @@
+#include "benchmarkStatistics.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+
+// linear interpolation between the closest ranks, sorted must be sorted and not empty
+static double percentile(const std::vector<double>& sorted, double fraction) {
+	double rank = fraction * (sorted.size() - 1);
+	std::size_t lower = static_cast<std::size_t>(std::floor(rank));
+	std::size_t upper = std::min(lower + 1, sorted.size() - 1);
+	return sorted[lower] + (sorted[upper] - sorted[lower]) * (rank - lower);
+}
+
+static double median(std::vector<double> values) {
+	std::sort(values.begin(), values.end());
+	return percentile(values, 0.5);
+}
+
+BenchmarkSummary summarizeBenchmark(const std::string& name, std::size_t warmup, const std::vector<BenchmarkSample>& samples) {
+	BenchmarkSummary result;
+	result.name = name;
+	result.warmup = warmup;
+
+	std::vector<double> initTimes;
+	std::vector<double> throughputs;
+	for(const BenchmarkSample& sample : samples) {
+		result.samples.push_back(sample.runMillis);
+		initTimes.push_back(sample.initMillis);
+		throughputs.push_back((sample.runMillis > 0.0) ? sample.workAmount / sample.runMillis * 1000.0 : 0.0);
+	}
+
+	std::vector<double> sorted = result.samples;
+	std::sort(sorted.begin(), sorted.end());
+	result.median = percentile(sorted, 0.5);
+	result.min = sorted.front();
+	result.p10 = percentile(sorted, 0.1);
+	result.p90 = percentile(sorted, 0.9);
+	result.max = sorted.back();
+	result.initMedian = median(initTimes);
+	result.workUnit = samples.front().workUnit;
+	result.throughput = result.workUnit.empty() ? 0.0 : median(throughputs);
+
+	std::vector<double> deviations;
+	for(double sample : sorted) deviations.push_back(std::abs(sample - result.median));
+	result.mad = median(deviations);
+
+	for(std::size_t i = 0; i < static_cast<std::size_t>(PerfCounter::COUNT); i++) {
+		std::vector<double> counts;
+		for(const BenchmarkSample& sample : samples) {
+			if(sample.counters.values[i] < 0) break;
+			counts.push_back(static_cast<double>(sample.counters.values[i]));
+		}
+		result.counters.values[i] = (counts.size() == samples.size()) ? static_cast<std::int64_t>(median(counts)) : -1;
+	}
+	return result;
+}
+
+static void writeJSONString(std::ostream& output, const std::string& text) {
+	output << '"';
+	for(char c : text) {
+		if(c == '"' || c == '\\') output << '\\';
+		output << c;
+	}
+	output << '"';
+}
+
+void writeBenchmarkJSON(std::ostream& output, const std::vector<BenchmarkSummary>& summaries) {
+	std::streamsize oldPrecision = output.precision(9);
+	output << "{\"unit\":\"ms\",\"benchmarks\":[";
+	for(std::size_t i = 0; i < summaries.size(); i++) {
+		const BenchmarkSummary& summary = summaries[i];
+		output << (i == 0 ? "\n" : ",\n") << "{\"name\":";
+		writeJSONString(output, summary.name);
+		output << ",\"repetitions\":" << summary.samples.size() << ",\"warmup\":" << summary.warmup;
+		output << ",\"median\":" << summary.median << ",\"mad\":" << summary.mad;
+		output << ",\"min\":" << summary.min << ",\"p10\":" << summary.p10 << ",\"p90\":" << summary.p90 << ",\"max\":" << summary.max;
+		output << ",\"initMedian\":" << summary.initMedian;
+		if(!summary.workUnit.empty()) {
+			output << ",\"throughput\":" << summary.throughput << ",\"throughputUnit\":";
+			writeJSONString(output, summary.workUnit + "/s");
+		}
+		output << ",\"samples\":[";
+		for(std::size_t s = 0; s < summary.samples.size(); s++) {
+			output << (s == 0 ? "" : ",") << summary.samples[s];
+		}
+		output << "],\"counters\":{";
+		bool first = true;
+		for(std::size_t c = 0; c < static_cast<std::size_t>(PerfCounter::COUNT); c++) {
+			if(summary.counters.values[c] < 0) continue;
+			output << (first ? "" : ",");
+			writeJSONString(output, perfCounterLabels[c]);
+			output << ':' << summary.counters.values[c];
+			first = false;
+		}
+		output << "}}";
+	}
+	output << "\n]}\n";
+	output.precision(oldPrecision);
+}
+
+void writeBenchmarkCSV(std::ostream& output, const std::vector<BenchmarkSummary>& summaries) {
+	std::streamsize oldPrecision = output.precision(9);
+	output << "name,repetitions,warmup,median_ms,mad_ms,min_ms,p10_ms,p90_ms,max_ms,init_ms,throughput,throughput_unit";
+	for(const char* label : perfCounterLabels) output << ',' << label;
+	output << '\n';
+	for(const BenchmarkSummary& summary : summaries) {
+		output << summary.name << ',' << summary.samples.size() << ',' << summary.warmup << ',' << summary.median << ',' << summary.mad;
+		output << ',' << summary.min << ',' << summary.p10 << ',' << summary.p90 << ',' << summary.max << ',' << summary.initMedian;
+		// missing throughputs and counters are left empty
+		output << ',';
+		if(!summary.workUnit.empty()) {
+			output << summary.throughput << ',' << summary.workUnit << "/s";
+		} else {
+			output << ',';
+		}
+		for(std::int64_t count : summary.counters.values) {
+			output << ',';
+			if(count >= 0) output << count;
+		}
+		output << '\n';
+	}
+	output.precision(oldPrecision);
+}
+
+// just enough JSON to find the benchmarks in a file written by writeBenchmarkJSON, other values are skipped
+class BaselineReader {
+	std::istream& input;
+
+public:
+	BaselineReader(std::istream& input) : input(input) {}
+
+	char peek() {
+		input >> std::ws;
+		int c = input.peek();
+		if(c == std::char_traits<char>::eof()) throw "Unexpected end of the benchmark baseline";
+		return static_cast<char>(c);
+	}
+	void expect(char c) {
+		if(peek() != c) throw "Malformed benchmark baseline";
+		input.get();
+	}
+	// consumes the separator if the next value follows, or the closing character if the list ends
+	bool next(char close) {
+		if(peek() == ',') {
+			input.get();
+			return true;
+		}
+		expect(close);
+		return false;
+	}
+
+	std::string readString() {
+		expect('"');
+		std::string result;
+		for(int c = input.get(); c != '"'; c = input.get()) {
+			if(c == std::char_traits<char>::eof()) throw "Unexpected end of the benchmark baseline";
+			if(c == '\\') c = input.get();
+			result.push_back(static_cast<char>(c));
+		}
+		return result;
+	}
+	double readNumber() {
+		peek();
+		double result;
+		if(!(input >> result)) throw "Malformed number in the benchmark baseline";
+		return result;
+	}
+
+	void skipValue() {
+		char c = peek();
+		if(c == '"') {
+			readString();
+		} else if(c == '{') {
+			input.get();
+			if(peek() == '}') {
+				input.get();
+				return;
+			}
+			do {
+				readString();
+				expect(':');
+				skipValue();
+			} while(next('}'));
+		} else if(c == '[') {
+			input.get();
+			if(peek() == ']') {
+				input.get();
+				return;
+			}
+			do {
+				skipValue();
+			} while(next(']'));
+		} else if(c == 't' || c == 'f' || c == 'n') {
+			while(std::isalpha(input.peek())) input.get();
+		} else {
+			readNumber();
+		}
+	}
+
+	BenchmarkBaseline readBenchmark() {
+		BenchmarkBaseline result{"", 0.0, 0.0};
+		expect('{');
+		do {
+			std::string key = readString();
+			expect(':');
+			if(key == "name") {
+				result.name = readString();
+			} else if(key == "median") {
+				result.median = readNumber();
+			} else if(key == "mad") {
+				result.mad = readNumber();
+			} else {
+				skipValue();
+			}
+		} while(next('}'));
+		return result;
+	}
+};
+
+std::vector<BenchmarkBaseline> readBenchmarkBaseline(std::istream& input) {
+	BaselineReader reader(input);
+	std::vector<BenchmarkBaseline> result;
+	reader.expect('{');
+	do {
+		std::string key = reader.readString();
+		reader.expect(':');
+		if(key != "benchmarks") {
+			reader.skipValue();
+			continue;
+		}
+		reader.expect('[');
+		if(reader.peek() == ']') {
+			input.get();
+			continue;
+		}
+		do {
+			result.push_back(reader.readBenchmark());
+		} while(reader.next(']'));
+	} while(reader.next('}'));
+	return result;
+}
+
+BenchmarkChange compareToBaseline(const BenchmarkSummary& summary, const BenchmarkBaseline& baseline, double thresholdPercent) {
+	double difference = summary.median - baseline.median;
+	double noise = 3.0 * (summary.mad + baseline.mad);
+	if(std::abs(difference) <= baseline.median * thresholdPercent / 100.0 || std::abs(difference) <= noise) return BenchmarkChange::SAME;
+	return (difference > 0.0) ? BenchmarkChange::SLOWER : BenchmarkChange::FASTER;
+}
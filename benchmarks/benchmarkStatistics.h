@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "perfCounters.h"
+
+// one repetition of a benchmark
+struct BenchmarkSample {
+	double initMillis;
+	double runMillis;
+	PerfCounterValues counters;
+	// the work of the run, see BenchmarkWork, the unit is empty for benchmarks that report none
+	double workAmount = 0.0;
+	std::string workUnit;
+};
+
+/*
+	The spread of the run times of one benchmark over its repetitions, in milliseconds
+	mad is the median absolute deviation from the median, unlike the standard deviation a few runs that were interrupted
+	barely move it
+*/
+struct BenchmarkSummary {
+	std::string name;
+	std::size_t warmup;
+	// in the order they ran
+	std::vector<double> samples;
+	double median;
+	double mad;
+	double min;
+	double p10;
+	double p90;
+	double max;
+	double initMedian;
+	// the median of every counter, missing if it is missing in any sample
+	PerfCounterValues counters;
+	// the median of the work per second of every sample, in workUnit per second
+	double throughput;
+	std::string workUnit;
+};
+
+// samples must not be empty
+BenchmarkSummary summarizeBenchmark(const std::string& name, std::size_t warmup, const std::vector<BenchmarkSample>& samples);
+
+void writeBenchmarkJSON(std::ostream& output, const std::vector<BenchmarkSummary>& summaries);
+void writeBenchmarkCSV(std::ostream& output, const std::vector<BenchmarkSummary>& summaries);
+
+struct BenchmarkBaseline {
+	std::string name;
+	double median;
+	double mad;
+};
+
+// reads the benchmarks of a file written by writeBenchmarkJSON, throws if it is not such a file
+std::vector<BenchmarkBaseline> readBenchmarkBaseline(std::istream& input);
+
+enum class BenchmarkChange {
+	SAME,
+	FASTER,
+	SLOWER
+};
+
+/*
+	The medians have to differ by more than thresholdPercent of the baseline, and by more than 3 times the MADs of both
+	together, so a noisy benchmark needs a larger difference before it counts
+*/
+BenchmarkChange compareToBaseline(const BenchmarkSummary& summary, const BenchmarkBaseline& baseline, double thresholdPercent);
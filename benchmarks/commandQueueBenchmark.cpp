@@ -0,0 +1,102 @@
+#include "benchmark.h"
+
+#include "../physics/synchonizedWorld.h"
+#include "../physics/part.h"
+#include "../physics/geometry/shapeCreation.h"
+#include "../physics/math/linalg/commonMatrices.h"
+#include "../physics/externalforces/gravityForce.h"
+#include "../util/log.h"
+
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+#define PRODUCER_COUNT 4
+#define OPERATIONS_PER_PRODUCER 100000
+
+// World<Part> cannot be instantiated, as its Part and T overloads would collide
+class QueueBenchPart : public Part {
+public:
+	using Part::Part;
+};
+
+/*
+	Producers hammer asyncModification while another thread ticks the world as fast as it can
+	Measures throughput of all operations and the latency between submitting an operation and it being executed
+*/
+class CommandQueueBenchmark : public Benchmark {
+	SynchronizedWorld<QueueBenchPart> world;
+	std::vector<std::vector<double>> latencies;
+	std::size_t ticksDone = 0;
+
+public:
+	CommandQueueBenchmark() : Benchmark("commandQueue"), world(0.005) {}
+
+	void init() override {
+		world.addExternalForce(new DirectionalGravity(Vec3(0, -10, 0)));
+		world.addTerrainPart(new QueueBenchPart(boxShape(40.0, 1.0, 40.0), GlobalCFrame(0.0, 0.0, 0.0), {1.0, 0.5, 0.3}));
+		for(int i = 0; i < 20; i++) {
+			world.addPart(new QueueBenchPart(boxShape(1.0, 1.0, 1.0), GlobalCFrame(i * 2.0 - 19.0, 1.0, 0.0), {1.0, 0.5, 0.3}));
+		}
+		latencies.clear();
+		latencies.resize(PRODUCER_COUNT);
+		ticksDone = 0;
+	}
+
+	void run() override {
+		typedef std::chrono::high_resolution_clock Clock;
+		std::atomic<bool> producersDone{false};
+		std::atomic<std::size_t> counter{0};
+
+		std::thread ticker([this, &producersDone]() {
+			while(!producersDone.load(std::memory_order_acquire)) {
+				world.tick();
+				ticksDone++;
+			}
+			// one more tick to flush everything still in the queue
+			world.tick();
+			ticksDone++;
+		});
+
+		std::vector<std::thread> producers;
+		for(int p = 0; p < PRODUCER_COUNT; p++) {
+			producers.emplace_back([this, p, &counter]() {
+				std::vector<double>& lats = latencies[p];
+				lats.resize(OPERATIONS_PER_PRODUCER);
+				double* latsData = lats.data();
+				for(int i = 0; i < OPERATIONS_PER_PRODUCER; i++) {
+					Clock::time_point submitted = Clock::now();
+					world.asyncModification([&counter, submitted, latsData, i]() {
+						counter.fetch_add(1, std::memory_order_relaxed);
+						latsData[i] = std::chrono::duration<double, std::micro>(Clock::now() - submitted).count();
+					});
+				}
+			});
+		}
+		for(std::thread& t : producers) t.join();
+		producersDone.store(true, std::memory_order_release);
+		ticker.join();
+
+		if(counter.load() != PRODUCER_COUNT * OPERATIONS_PER_PRODUCER) {
+			Log::error("Not all operations executed! %d/%d", int(counter.load()), PRODUCER_COUNT * OPERATIONS_PER_PRODUCER);
+		}
+	}
+
+	void printResults(double timeTaken) override {
+		std::vector<double> allLatencies;
+		for(const std::vector<double>& lats : latencies) {
+			allLatencies.insert(allLatencies.end(), lats.begin(), lats.end());
+		}
+		std::sort(allLatencies.begin(), allLatencies.end());
+
+		double total = 0.0;
+		for(double l : allLatencies) total += l;
+
+		std::size_t count = allLatencies.size();
+		Log::print("%d operations from %d producers, %d ticks\n", int(count), PRODUCER_COUNT, int(ticksDone));
+		Log::print("Throughput: %.0f operations/s\n", count / (timeTaken / 1000.0));
+		Log::print("Latency avg: %.2fus  p50: %.2fus  p99: %.2fus  max: %.2fus\n", total / count, allLatencies[count / 2], allLatencies[count * 99 / 100], allLatencies[count - 1]);
+	}
+} commandQueueBenchmark;
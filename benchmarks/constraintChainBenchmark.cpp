@@ -0,0 +1,66 @@
+#include "benchmark.h"
+
+#include "../physics/world.h"
+#include "../physics/part.h"
+#include "../physics/geometry/shapeCreation.h"
+#include "../physics/constraints/constraintGroup.h"
+#include "../physics/constraints/ballConstraint.h"
+#include "../util/log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#define CHAIN_DEFAULT_LENGTH 100
+// the constraints solved in a run, short chains are solved this many times over so they still take measurable time
+#define CHAIN_CONSTRAINTS_PER_RUN 10000
+
+/*
+	ConstraintGroup::apply on a chain of links joined by ball constraints, --parts sets the number of constraints
+	The links start slightly out of line, so every solve has errors to correct. The group is solved as one dense system,
+	the constraints per second show how quickly that falls behind for long chains.
+*/
+class ConstraintChainBenchmark : public Benchmark {
+	WorldPrototype world;
+	std::size_t length = 0;
+	std::size_t passes = 1;
+
+public:
+	ConstraintChainBenchmark() : Benchmark("constraintChain"), world(0.005) {}
+
+	void init() override {
+		length = (parameters.parts > 0) ? parameters.parts : CHAIN_DEFAULT_LENGTH;
+		passes = std::max<std::size_t>(1, CHAIN_CONSTRAINTS_PER_RUN / length);
+
+		std::vector<Part*> links;
+		for(std::size_t i = 0; i <= length; i++) {
+			links.push_back(new Part(boxShape(1.8, 0.4, 0.4), GlobalCFrame(i * 2.0, std::sin(i * 0.7) * 0.05, 0.0), {1.0, 0.5, 0.3}));
+		}
+		// added in a random order, the tree grows too deep for its iterators when a long line of parts comes in one by one
+		std::vector<Part*> additionOrder(links);
+		std::shuffle(additionOrder.begin(), additionOrder.end(), std::mt19937(static_cast<unsigned>(length)));
+		for(Part* link : additionOrder) {
+			world.addPart(link);
+		}
+
+		ConstraintGroup chain;
+		for(std::size_t i = 0; i < length; i++) {
+			chain.add(links[i], links[i + 1], new BallConstraint(Vec3(1.0, 0.0, 0.0), Vec3(-1.0, 0.0, 0.0)));
+		}
+		world.constraints.push_back(std::move(chain));
+	}
+
+	void run() override {
+		for(std::size_t pass = 0; pass < passes; pass++) {
+			world.constraints[0].apply();
+		}
+	}
+
+	bool takesParts() const override { return true; }
+	BenchmarkWork getWork() const override { return BenchmarkWork{static_cast<double>(length * passes), "constraints"}; }
+
+	void printResults(double timeTaken) override {
+		Log::print("%d constraints, %d passes, %.3fms per apply\n", int(length), int(passes), timeTaken / passes);
+	}
+} constraintChainBenchmark;
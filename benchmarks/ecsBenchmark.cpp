@@ -6,10 +6,10 @@ using namespace P3D::Engine;
 
 class ECSGetFromRegistryBenchmark : public Benchmark {
 public:
-	ECSGetFromRegistryBenchmark() : Benchmark("ecsGetFromRegistryBenchmark") {}
+	ECSGetFromRegistryBenchmark(const char* name, int amount) : Benchmark(name), amount(amount) {}
 
 	Registry64 registry;
-	std::vector<int> v { 1, 2, 3, 4, 5, 6 };
+	int amount;
 	int errors = 0;
 	
 	struct A : public RefCountable {
@@ -19,7 +19,6 @@ public:
 	};
 
 	void init() override {
-		int amount = 1000000;
 		for (int i = 0; i < amount; i++) {
 			auto id = registry.create();
 			registry.add<A>(id, i);
@@ -41,19 +40,22 @@ public:
 		Log::error("Amount of errors: %d\n", errors);
 	}
 
-} ecsGetFromRegistryBenchmark;
+};
+
+ECSGetFromRegistryBenchmark ecsGetFromRegistryBenchmark100k("ecsGetFromRegistryBenchmark100k", 100000);
+ECSGetFromRegistryBenchmark ecsGetFromRegistryBenchmark("ecsGetFromRegistryBenchmark", 1000000);
 
 class ECSGetFromViewConjunctionBenchmark : public Benchmark {
 public:
-	ECSGetFromViewConjunctionBenchmark() : Benchmark("ecsGetFromViewConjunctionBenchmark") {}
+	ECSGetFromViewConjunctionBenchmark(const char* name, int amount) : Benchmark(name), amount(amount) {}
 
 	Registry64 registry;
+	int amount;
 	int errors = 0;
 
 	struct A : public RefCountable { int i; A(int i) : i(i) {} };
 
 	void init() override {
-		int amount = 1000000;
 		for (int i = 0; i < amount; i++) {
 			auto id = registry.create();
 			registry.add<A>(id, i);
@@ -75,7 +77,86 @@ public:
 		Log::error("Amount of errors: %d\n", errors);
 	}
 
-} ecsGetFromViewConjunctionBenchmark;
+};
+
+ECSGetFromViewConjunctionBenchmark ecsGetFromViewConjunctionBenchmark100k("ecsGetFromViewConjunctionBenchmark100k", 100000);
+ECSGetFromViewConjunctionBenchmark ecsGetFromViewConjunctionBenchmark("ecsGetFromViewConjunctionBenchmark", 1000000);
+
+/*
+	A view over two components where the second is on every fourth entity, like the hitboxes and transforms the picker walks
+*/
+class ECSGetFromMultiViewBenchmark : public Benchmark {
+public:
+	ECSGetFromMultiViewBenchmark(const char* name, int amount) : Benchmark(name), amount(amount) {}
+
+	Registry64 registry;
+	int amount;
+	long long sum = 0;
+
+	struct A : public RefCountable { int i; A(int i) : i(i) {} };
+	struct B : public RefCountable { int i; B(int i) : i(i) {} };
+
+	void init() override {
+		for (int i = 0; i < amount; i++) {
+			auto id = registry.create();
+			registry.add<A>(id, i);
+			if (i % 4 == 0)
+				registry.add<B>(id, i);
+		}
+	}
+
+	void run() override {
+		auto view = registry.view<A, B>();
+		for (auto entity : view)
+			sum += view.get<A>(entity)->i - view.get<B>(entity)->i + 1;
+	}
+
+	void printResults(double timeTaken) override {
+		Log::error("Entities visited: %lld\n", sum);
+	}
+
+};
+
+ECSGetFromMultiViewBenchmark ecsGetFromMultiViewBenchmark100k("ecsGetFromMultiViewBenchmark100k", 100000);
+ECSGetFromMultiViewBenchmark ecsGetFromMultiViewBenchmark("ecsGetFromMultiViewBenchmark", 1000000);
+
+class ECSEachBenchmark : public Benchmark {
+public:
+	ECSEachBenchmark(const char* name, int amount) : Benchmark(name), amount(amount) {}
+
+	Registry64 registry;
+	int amount;
+	long long sum = 0;
+
+	struct A : public RefCountable { int i; A(int i) : i(i) {} };
+	struct B : public RefCountable { int i; B(int i) : i(i) {} };
+
+	void init() override {
+		for (int i = 0; i < amount; i++) {
+			auto id = registry.create();
+			registry.add<A>(id, i);
+			if (i % 4 == 0)
+				registry.add<B>(id, i);
+		}
+	}
+
+	void run() override {
+		registry.each<A>([this] (Registry64::entity_type entity, A& a) {
+			sum += a.i;
+		});
+		registry.each<A, B>([this] (Registry64::entity_type entity, A& a, B& b) {
+			sum += a.i - b.i + 1;
+		});
+	}
+
+	void printResults(double timeTaken) override {
+		Log::error("Sum: %lld\n", sum);
+	}
+
+};
+
+ECSEachBenchmark ecsEachBenchmark100k("ecsEachBenchmark100k", 100000);
+ECSEachBenchmark ecsEachBenchmark("ecsEachBenchmark", 1000000);
 
 /*class ECSGetFromViewDisjunctionBenchmark : public Benchmark {
 public:
@@ -109,4 +190,4 @@ public:
 		Log::error("Amount of errors: %d\n", errors);
 	}
 	
-} ecsGetFromViewDisjunctionBenchmark;*/
\ No newline at end of file
+} ecsGetFromViewDisjunctionBenchmark;*/
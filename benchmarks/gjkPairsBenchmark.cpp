@@ -0,0 +1,90 @@
+#include "benchmark.h"
+
+#include "../physics/geometry/shape.h"
+#include "../physics/geometry/shapeCreation.h"
+#include "../physics/geometry/intersection.h"
+#include "../physics/misc/shapeLibrary.h"
+#include "../util/log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#define GJK_DEFAULT_TRANSFORMS 1000
+// the intersections computed for every pair of shapes in a run
+#define GJK_INTERSECTIONS_PER_PAIR 20000
+
+/*
+	GJK and EPA on their own, for every pair of the shape classes, at random relative transforms
+	The shapes are about a meter wide and the transforms within a meter and a half of each other, so a part of them intersects.
+	--parts sets the number of transforms, which are all tried for every pair.
+*/
+class GJKPairsBenchmark : public Benchmark {
+	struct ShapeClassPair {
+		std::size_t first;
+		std::size_t second;
+		double time;
+		std::size_t intersections;
+	};
+
+	const char* shapeNames[4]{"box", "sphere", "cylinder", "polyhedron"};
+	std::vector<Shape> shapes;
+	std::vector<CFrame> transforms;
+	std::vector<ShapeClassPair> pairs;
+	std::size_t passes = 1;
+
+public:
+	GJKPairsBenchmark() : Benchmark("gjkPairs") {}
+
+	void init() override {
+		shapes.push_back(boxShape(1.0, 1.0, 1.0));
+		shapes.push_back(sphereShape(0.5));
+		shapes.push_back(cylinderShape(0.5, 1.0));
+		shapes.push_back(polyhedronShape(Library::icosahedron).scaled(0.5, 0.5, 0.5));
+
+		std::size_t count = (parameters.parts > 0) ? parameters.parts : GJK_DEFAULT_TRANSFORMS;
+		passes = std::max<std::size_t>(1, GJK_INTERSECTIONS_PER_PAIR / count);
+
+		std::mt19937 random(count);
+		std::uniform_real_distribution<double> coordinate(-1.5, 1.5);
+		std::uniform_real_distribution<double> angle(0.0, 6.283185307);
+		for(std::size_t i = 0; i < count; i++) {
+			transforms.push_back(CFrame(coordinate(random), coordinate(random), coordinate(random), Rotation::fromEulerAngles(angle(random), angle(random), angle(random))));
+		}
+
+		for(std::size_t first = 0; first < shapes.size(); first++) {
+			for(std::size_t second = first; second < shapes.size(); second++) {
+				pairs.push_back(ShapeClassPair{first, second, 0.0, 0});
+			}
+		}
+	}
+
+	void run() override {
+		typedef std::chrono::high_resolution_clock Clock;
+
+		for(ShapeClassPair& pair : pairs) {
+			const Shape& first = shapes[pair.first];
+			const Shape& second = shapes[pair.second];
+			pair.intersections = 0;
+			Clock::time_point start = Clock::now();
+			for(std::size_t pass = 0; pass < passes; pass++) {
+				for(const CFrame& transform : transforms) {
+					if(intersectsTransformed(first, second, transform)) pair.intersections++;
+				}
+			}
+			pair.time = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		}
+	}
+
+	bool takesParts() const override { return true; }
+	BenchmarkWork getWork() const override { return BenchmarkWork{static_cast<double>(pairs.size() * transforms.size() * passes), "pairs"}; }
+
+	void printResults(double timeTaken) override {
+		std::size_t tests = transforms.size() * passes;
+		Log::print("%d transforms, %d passes\n", int(transforms.size()), int(passes));
+		for(const ShapeClassPair& pair : pairs) {
+			Log::print("%10s-%-10s  %8.3fus per pair  %10.0f pairs/s  %3.0f%% intersect\n", shapeNames[pair.first], shapeNames[pair.second], pair.time * 1000.0 / tests, tests / pair.time * 1000.0, 100.0 * pair.intersections / tests);
+		}
+	}
+} gjkPairsBenchmark;
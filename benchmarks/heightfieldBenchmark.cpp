@@ -0,0 +1,109 @@
+#include "benchmark.h"
+
+#include "../physics/world.h"
+#include "../physics/part.h"
+#include "../physics/geometry/shapeCreation.h"
+#include "../physics/geometry/heightfieldShapeClass.h"
+#include "../physics/externalforces/gravityForce.h"
+#include "../util/log.h"
+
+#include <cmath>
+#include <chrono>
+#include <vector>
+
+#define TERRAIN_CELLS 256
+#define TERRAIN_TICKS 200
+
+/*
+	Compares a heightfield with the same terrain built as a tiling of terrain boxes, one box per cell
+	Cubes are dropped on rolling hills, both worlds are ticked for the same number of ticks. The memory of the terrain is
+	the height samples for the heightfield, and at least one Part per cell for the tiling.
+*/
+class HeightfieldBenchmark : public Benchmark {
+	WorldPrototype heightfieldWorld;
+	WorldPrototype tiledWorld;
+	std::vector<float> heights;
+	std::size_t heightfieldBytes = 0;
+	std::size_t tiledBytes = 0;
+	double heightfieldTime = 0.0;
+	double tiledTime = 0.0;
+
+	static float hillHeight(int column, int row) {
+		return float(2.0 * std::sin(column * 0.1) * std::cos(row * 0.07) + 0.5 * std::sin(column * 0.37 + row * 0.23));
+	}
+
+	void addCubes(WorldPrototype& world) {
+		world.addExternalForce(new DirectionalGravity(Vec3(0, -10, 0)));
+		for(int x = 0; x < 20; x++) {
+			for(int z = 0; z < 20; z++) {
+				// dropped from just above the terrain, so they are in contact for most of the ticks
+				int column = TERRAIN_CELLS / 2 - 60 + x * 6;
+				int row = TERRAIN_CELLS / 2 - 60 + z * 6;
+				GlobalCFrame position(column - TERRAIN_CELLS / 2.0, hillHeight(column, row) + 1.2, row - TERRAIN_CELLS / 2.0);
+				world.addPart(new Part(boxShape(1.0, 1.0, 1.0), position, {1.0, 0.5, 0.3}));
+			}
+		}
+	}
+
+public:
+	HeightfieldBenchmark() : Benchmark("heightfield"), heightfieldWorld(0.005), tiledWorld(0.005) {}
+
+	void init() override {
+		int samplesPerSide = TERRAIN_CELLS + 1;
+		heights.resize(samplesPerSide * samplesPerSide);
+		float lowest = INFINITY;
+		float highest = -INFINITY;
+		for(int row = 0; row < samplesPerSide; row++) {
+			for(int column = 0; column < samplesPerSide; column++) {
+				float height = hillHeight(column, row);
+				heights[row * samplesPerSide + column] = height;
+				lowest = std::min(lowest, height);
+				highest = std::max(highest, height);
+			}
+		}
+
+		// the heightfield shape is centered between the lowest and highest sample
+		Shape heightfield = heightfieldShape(heights.data(), samplesPerSide, samplesPerSide, 1.0);
+		heightfieldWorld.addTerrainPart(new Part(heightfield, GlobalCFrame(0.0, (lowest + highest) / 2, 0.0), {1.0, 0.5, 0.3}));
+		heightfieldBytes = static_cast<const HeightfieldShapeClass*>(heightfield.baseShape)->getHeights().size() * sizeof(std::uint16_t);
+
+		// every cell becomes a box column from the lowest point of the terrain up to the average height of its corners
+		double offset = TERRAIN_CELLS / 2.0;
+		for(int row = 0; row < TERRAIN_CELLS; row++) {
+			for(int column = 0; column < TERRAIN_CELLS; column++) {
+				double average = (hillHeight(column, row) + hillHeight(column + 1, row) + hillHeight(column, row + 1) + hillHeight(column + 1, row + 1)) / 4;
+				double height = average - lowest + 0.1;
+				GlobalCFrame center(column + 0.5 - offset, lowest + height / 2 - 0.1, row + 0.5 - offset);
+				tiledWorld.addTerrainPart(new Part(boxShape(1.0, height, 1.0), center, {1.0, 0.5, 0.3}));
+			}
+		}
+		tiledBytes = std::size_t(TERRAIN_CELLS) * TERRAIN_CELLS * sizeof(Part);
+
+		addCubes(heightfieldWorld);
+		addCubes(tiledWorld);
+	}
+
+	void run() override {
+		typedef std::chrono::high_resolution_clock Clock;
+
+		Clock::time_point start = Clock::now();
+		for(int i = 0; i < TERRAIN_TICKS; i++) {
+			heightfieldWorld.tick();
+		}
+		heightfieldTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+		start = Clock::now();
+		for(int i = 0; i < TERRAIN_TICKS; i++) {
+			tiledWorld.tick();
+		}
+		tiledTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	void printResults(double timeTaken) override {
+		double squareKilometers = double(TERRAIN_CELLS) * TERRAIN_CELLS / 1000000.0;
+		Log::print("%dx%d cells of 1m, %d cubes, %d ticks\n", TERRAIN_CELLS, TERRAIN_CELLS, 400, TERRAIN_TICKS);
+		Log::print("heightfield: %.3fms per tick, %.2fMB per km2\n", heightfieldTime / TERRAIN_TICKS, heightfieldBytes / squareKilometers / 1000000.0);
+		Log::print("box tiling:  %.3fms per tick, at least %.2fMB per km2\n", tiledTime / TERRAIN_TICKS, tiledBytes / squareKilometers / 1000000.0);
+		Log::print("speedup: %.1fx  memory: %.1fx less\n", tiledTime / heightfieldTime, double(tiledBytes) / heightfieldBytes);
+	}
+} heightfieldBenchmark;
@@ -6,6 +6,9 @@
 #include "../physics/math/linalg/commonMatrices.h"
 #include "../physics/math/linalg/trigonometry.h"
 
+#include <algorithm>
+#include <cmath>
+
 class ManyCubesBenchmark : public WorldBenchmark {
 public:
 	ManyCubesBenchmark() : WorldBenchmark("manyCubes", 10000) {}
@@ -13,25 +16,27 @@ public:
 	void init() {
 		createFloor(50, 50, 10);
 
-		int minX = -5;
-		int maxX = 5;
-		int minY = -5;
-		int maxY = 5;
-		int minZ = -5;
-		int maxZ = 5;
+		// a cube of cubes, 10 to a side unless a part count is given
+		int side = (parameters.parts > 0) ? std::max(1, static_cast<int>(std::round(std::cbrt(parameters.parts)))) : 10;
+		double start = -side / 2.0;
 
 		GlobalCFrame ref(0, 15, 0, Rotation::fromEulerAngles(3.1415 / 4, 3.1415 / 4, 0.0));
 
 		//Part* newCube = new Part(boxShape(1.0, 1.0, 1.0), ref.localToGlobal(CFrame(0,0,0)), {1.0, 0.2, 0.5});
 		//world.addPart(newCube);
 
-		for(double x = minX; x < maxX; x += 1.01) {
-			for(double y = minY; y < maxY; y += 1.01) {
-				for(double z = minZ; z < maxZ; z += 1.01) {
+		double x = start;
+		for(int ix = 0; ix < side; ix++, x += 1.01) {
+			double y = start;
+			for(int iy = 0; iy < side; iy++, y += 1.01) {
+				double z = start;
+				for(int iz = 0; iz < side; iz++, z += 1.01) {
 					Part* newCube = new Part(polyhedronShape(Library::createBox(1.0, 1.0, 1.0)), ref.localToGlobal(CFrame(x, y, z)), {1.0, 0.2, 0.5});
 					world.addPart(newCube);
 				}
 			}
 		}
 	}
+
+	bool takesParts() const override { return true; }
 } manyCubesBench;
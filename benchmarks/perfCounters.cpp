@@ -0,0 +1,257 @@
+#include "perfCounters.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "../util/terminalColor.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+const char* const perfCounterLabels[static_cast<std::size_t>(PerfCounter::COUNT)]{
+	"Cycles",
+	"Instructions",
+	"Cache Misses",
+	"Branch Misses",
+	"L1D Loads",
+	"L1D Misses",
+	"LLC Loads",
+	"LLC Misses",
+	"Page Faults",
+	"Ctx Switches"
+};
+
+PerfCounterValues::PerfCounterValues() : values{} {}
+
+PerfCounterValues PerfCounterValues::operator-(const PerfCounterValues& other) const {
+	PerfCounterValues result;
+	for(std::size_t i = 0; i < static_cast<std::size_t>(PerfCounter::COUNT); i++) {
+		if(values[i] < 0 || other.values[i] < 0) {
+			result.values[i] = -1;
+		} else {
+			// scaled counters are estimates, which may go back a little
+			result.values[i] = (values[i] > other.values[i]) ? values[i] - other.values[i] : 0;
+		}
+	}
+	return result;
+}
+
+PerfCounterValues& PerfCounterValues::operator+=(const PerfCounterValues& other) {
+	for(std::size_t i = 0; i < static_cast<std::size_t>(PerfCounter::COUNT); i++) {
+		values[i] = (values[i] < 0 || other.values[i] < 0) ? -1 : values[i] + other.values[i];
+	}
+	return *this;
+}
+
+#ifdef __linux__
+struct CounterConfig {
+	std::uint32_t type;
+	std::uint64_t config;
+};
+
+static constexpr std::uint64_t cacheConfig(std::uint64_t cache, std::uint64_t result) {
+	return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (result << 16);
+}
+
+static const CounterConfig counterConfigs[static_cast<std::size_t>(PerfCounter::COUNT)]{
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+	{PERF_TYPE_HW_CACHE, cacheConfig(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_ACCESS)},
+	{PERF_TYPE_HW_CACHE, cacheConfig(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+	{PERF_TYPE_HW_CACHE, cacheConfig(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_RESULT_ACCESS)},
+	{PERF_TYPE_HW_CACHE, cacheConfig(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+	{PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+	{PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES}
+};
+
+static int openCounter(const CounterConfig& counter) {
+	perf_event_attr attr;
+	std::memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = counter.type;
+	attr.config = counter.config;
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	// threads started later, such as the workers of a JobSystem, are counted along with this one
+	attr.inherit = 1;
+	// a perf_event_paranoid of 2, the default of most distributions, only allows counting user space
+	// software counters such as context switches are counted in the kernel, and are allowed for the own thread
+	if(counter.type != PERF_TYPE_SOFTWARE) {
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+	}
+	return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+static const char* describeOpenError(int error) {
+	switch(error) {
+		case ENOENT:
+		case EOPNOTSUPP:
+			return "not supported by this machine";
+		case EACCES:
+		case EPERM:
+			return "not permitted, see /proc/sys/kernel/perf_event_paranoid";
+		case ENOSYS:
+			return "perf_event_open is not available";
+		default:
+			return std::strerror(error);
+	}
+}
+#endif
+
+PerfCounters::PerfCounters() {
+	for(std::size_t i = 0; i < static_cast<std::size_t>(PerfCounter::COUNT); i++) {
+#ifdef __linux__
+		files[i] = openCounter(counterConfigs[i]);
+		if(files[i] == -1 && unavailableReason.empty()) unavailableReason = std::string(perfCounterLabels[i]) + ": " + describeOpenError(errno);
+#else
+		files[i] = -1;
+		if(unavailableReason.empty()) unavailableReason = "counters are only read on Linux";
+#endif
+	}
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+	for(int file : files) {
+		if(file != -1) close(file);
+	}
+#endif
+}
+
+bool PerfCounters::isAnyAvailable() const {
+	for(int file : files) {
+		if(file != -1) return true;
+	}
+	return false;
+}
+
+PerfCounterValues PerfCounters::read() const {
+	PerfCounterValues result;
+	for(std::size_t i = 0; i < static_cast<std::size_t>(PerfCounter::COUNT); i++) {
+		result.values[i] = -1;
+#ifdef __linux__
+		if(files[i] == -1) continue;
+		struct {
+			std::uint64_t value;
+			std::uint64_t timeEnabled;
+			std::uint64_t timeRunning;
+		} reading;
+		if(::read(files[i], &reading, sizeof(reading)) != static_cast<ssize_t>(sizeof(reading))) continue;
+		if(reading.timeRunning != 0 && reading.timeRunning < reading.timeEnabled) {
+			result.values[i] = static_cast<std::int64_t>(reading.value * (static_cast<double>(reading.timeEnabled) / reading.timeRunning));
+		} else {
+			result.values[i] = static_cast<std::int64_t>(reading.value);
+		}
+#endif
+	}
+	return result;
+}
+
+PerfCounters& PerfCounters::local() {
+	static thread_local PerfCounters counters;
+	return counters;
+}
+
+static const std::size_t ROW_LABEL_LENGTH = 16;
+static const std::size_t COLUMN_LENGTH = 14;
+
+static void printColumn(const std::string& text, std::size_t length) {
+	for(std::size_t i = text.size(); i < length; i++) {
+		std::cout << ' ';
+	}
+	std::cout << text;
+}
+
+std::string formatCount(double count) {
+	const char* suffixes[]{"", "K", "M", "G", "T"};
+	std::size_t suffix = 0;
+	while(count >= 10000.0 && suffix < 4) {
+		count /= 1000.0;
+		suffix++;
+	}
+	std::stringstream ss;
+	ss.precision(suffix == 0 && count < 100.0 ? 2 : 1);
+	ss << std::fixed << count << suffixes[suffix];
+	return ss.str();
+}
+
+static std::string formatRatio(const PerfCounterValues& values, PerfCounter numerator, PerfCounter denominator, double factor, const char* unit) {
+	if(!values.has(numerator) || !values.has(denominator) || values[denominator] == 0) return "-";
+	std::stringstream ss;
+	ss.precision(2);
+	ss << std::fixed << (factor * values[numerator] / values[denominator]) << unit;
+	return ss.str();
+}
+
+void printPerfCounterTable(const char* const* rowLabels, const PerfCounterValues* rows, std::size_t rowCount, double divisor) {
+	std::vector<std::size_t> columns;
+	for(std::size_t i = 0; i < static_cast<std::size_t>(PerfCounter::COUNT); i++) {
+		for(std::size_t row = 0; row < rowCount; row++) {
+			if(rows[row].values[i] >= 0) {
+				columns.push_back(i);
+				break;
+			}
+		}
+	}
+
+	struct Ratio {
+		const char* label;
+		PerfCounter numerator;
+		PerfCounter denominator;
+		double factor;
+		const char* unit;
+	};
+	static const Ratio ratios[]{
+		{"IPC", PerfCounter::INSTRUCTIONS, PerfCounter::CYCLES, 1.0, ""},
+		{"L1D Miss", PerfCounter::L1D_LOAD_MISSES, PerfCounter::L1D_LOADS, 100.0, "%"},
+		{"LLC Miss", PerfCounter::LLC_LOAD_MISSES, PerfCounter::LLC_LOADS, 100.0, "%"},
+		{"Br Miss/KI", PerfCounter::BRANCH_MISSES, PerfCounter::INSTRUCTIONS, 1000.0, ""}
+	};
+	std::vector<const Ratio*> ratioColumns;
+	for(const Ratio& ratio : ratios) {
+		for(std::size_t row = 0; row < rowCount; row++) {
+			if(rows[row].has(ratio.numerator) && rows[row].has(ratio.denominator)) {
+				ratioColumns.push_back(&ratio);
+				break;
+			}
+		}
+	}
+
+	std::size_t labelLength = ROW_LABEL_LENGTH;
+	for(std::size_t row = 0; row < rowCount; row++) {
+		labelLength = std::max(labelLength, std::strlen(rowLabels[row]) + 2);
+	}
+
+	setColor(TerminalColor::WHITE);
+	printColumn("", labelLength);
+	for(std::size_t column : columns) printColumn(perfCounterLabels[column], COLUMN_LENGTH);
+	for(const Ratio* ratio : ratioColumns) printColumn(ratio->label, COLUMN_LENGTH);
+	std::cout << '\n';
+
+	for(std::size_t row = 0; row < rowCount; row++) {
+		setColor(TerminalColor::CYAN);
+		std::string label = rowLabels[row] + std::string(":");
+		std::cout << label;
+		for(std::size_t i = label.size(); i < labelLength; i++) std::cout << ' ';
+		setColor(TerminalColor::GREEN);
+		for(std::size_t column : columns) {
+			std::int64_t value = rows[row].values[column];
+			printColumn(value < 0 ? std::string("-") : formatCount(value / divisor), COLUMN_LENGTH);
+		}
+		setColor(TerminalColor::YELLOW);
+		for(const Ratio* ratio : ratioColumns) {
+			printColumn(formatRatio(rows[row], ratio->numerator, ratio->denominator, ratio->factor, ratio->unit), COLUMN_LENGTH);
+		}
+		std::cout << '\n';
+	}
+	setColor(TerminalColor::WHITE);
+}
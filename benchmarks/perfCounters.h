@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+enum class PerfCounter {
+	CYCLES,
+	INSTRUCTIONS,
+	CACHE_MISSES,
+	BRANCH_MISSES,
+	L1D_LOADS,
+	L1D_LOAD_MISSES,
+	LLC_LOADS,
+	LLC_LOAD_MISSES,
+	PAGE_FAULTS,
+	CONTEXT_SWITCHES,
+	COUNT
+};
+
+extern const char* const perfCounterLabels[static_cast<std::size_t>(PerfCounter::COUNT)];
+
+struct PerfCounterValues {
+	// -1 for counters that are not available
+	std::int64_t values[static_cast<std::size_t>(PerfCounter::COUNT)];
+
+	// all zero, to add to
+	PerfCounterValues();
+
+	bool has(PerfCounter counter) const { return values[static_cast<std::size_t>(counter)] >= 0; }
+	std::int64_t operator[](PerfCounter counter) const { return values[static_cast<std::size_t>(counter)]; }
+
+	// counters missing from either side stay missing
+	PerfCounterValues operator-(const PerfCounterValues& other) const;
+	PerfCounterValues& operator+=(const PerfCounterValues& other);
+};
+
+/*
+	Hardware counters of the thread that constructs this and of the threads it starts afterwards, read with perf_event_open on Linux
+	Threads that were already running when the counters were opened are not counted, so JobSystems must be started after them
+	Every counter is opened on its own, so counters the machine or the kernel does not offer are simply missing. Containers and
+	virtual machines often offer none of the hardware counters, the page faults and context switches are software counters
+	that are nearly always there. On other platforms no counter is available.
+
+	The counters run from construction on, the difference of two reads is what happened in between. When the hardware has fewer
+	counters than are opened the kernel takes turns, the values are then scaled up to the time the counter was not running.
+*/
+class PerfCounters {
+	int files[static_cast<std::size_t>(PerfCounter::COUNT)];
+	// why the first missing counter could not be opened
+	std::string unavailableReason;
+
+public:
+	PerfCounters();
+	~PerfCounters();
+
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	bool isAvailable(PerfCounter counter) const { return files[static_cast<std::size_t>(counter)] != -1; }
+	bool isAnyAvailable() const;
+	// empty if every counter is available
+	const std::string& getUnavailableReason() const { return unavailableReason; }
+
+	PerfCounterValues read() const;
+
+	// the counters of the calling thread, opened on first use
+	static PerfCounters& local();
+};
+
+// with a K, M or G suffix, so large counts fit in a column
+std::string formatCount(double count);
+
+/*
+	Prints a row for every value with a column for every counter that any row has, divided by divisor
+	Instructions per cycle and the miss rates follow the counts, they tell whether the time goes to computing or to waiting on memory
+*/
+void printPerfCounterTable(const char* const* rowLabels, const PerfCounterValues* rows, std::size_t rowCount, double divisor = 1.0);
@@ -0,0 +1,56 @@
+#include "benchmark.h"
+
+#include "../physics/misc/threadProfiling.h"
+#include "../util/log.h"
+
+#include <chrono>
+
+#define PROFILED_ITERATIONS 10000000
+
+enum class BenchmarkZone {
+	OUTER,
+	INNER,
+	COUNT
+};
+static const char* benchmarkZoneLabels[]{"Outer", "Inner"};
+
+/*
+	Enters and exits nested zones as fast as possible, the time per zone is the overhead the profiler adds to every zone
+	Every zone reads the clock twice, what that costs on its own is printed along with it, as it depends on the machine more than
+	anything the profiler does. On virtual machines reading the time stamp counter can take 20 ns.
+*/
+class ProfilerZoneBenchmark : public Benchmark {
+	ZoneProfiler<BenchmarkZone> profiler;
+	ThreadTally<long long, BenchmarkZone> tally;
+	double clockReadNanoseconds = 0.0;
+
+public:
+	ProfilerZoneBenchmark() : Benchmark("profilerZones"), profiler(benchmarkZoneLabels, 10), tally(benchmarkZoneLabels, 10) {}
+
+	void init() override {
+		// the clock is calibrated on first use, which would otherwise be timed along with the zones
+		profilerTickNanoseconds();
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for(int i = 0; i < PROFILED_ITERATIONS; i++) {
+			profilerTicks();
+		}
+		std::chrono::duration<double, std::nano> clockTime = std::chrono::steady_clock::now() - start;
+		clockReadNanoseconds = clockTime.count() / PROFILED_ITERATIONS;
+	}
+
+	void run() override {
+		for(int i = 0; i < PROFILED_ITERATIONS; i++) {
+			ProfileZone outer(profiler.getZoneID(BenchmarkZone::OUTER));
+			ProfileZone inner(profiler.getZoneID(BenchmarkZone::INNER));
+			tally.addToTally(BenchmarkZone::INNER, 1);
+		}
+		profiler.endTick();
+		tally.nextTally();
+	}
+
+	void printResults(double timeTaken) override {
+		double zoneNanoseconds = timeTaken * 1000000.0 / (2.0 * PROFILED_ITERATIONS);
+		Log::print("%.2f ns per zone, %.2f ns of which reading the clock twice, counted %lld\n", zoneNanoseconds, 2.0 * clockReadNanoseconds, tally.history.front()[static_cast<size_t>(BenchmarkZone::INNER)]);
+	}
+} profilerZoneBenchmark;
@@ -0,0 +1,85 @@
+#include "benchmark.h"
+
+#include "../physics/world.h"
+#include "../physics/part.h"
+#include "../physics/geometry/shapeCreation.h"
+#include "../physics/threading/jobSystem.h"
+#include "../util/log.h"
+
+#include <cmath>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#define RAYCAST_PARTS 10000
+#define RAYCAST_RAYS 100000
+
+/*
+	Casts a tick worth of sensor rays into a scattered world, as single raycasts, as a serial batch and as a parallel batch
+	The rays come in fans of 16 from 6250 agents, like the sensors of AI agents
+*/
+class RaycastBenchmark : public Benchmark {
+	WorldPrototype world;
+	// started in init, after the perf counters are opened, so its workers are counted
+	std::unique_ptr<JobSystem> jobs;
+	std::vector<Ray> rays;
+	std::vector<RaycastHit> hits;
+	double singleTime = 0.0;
+	double batchTime = 0.0;
+	double parallelTime = 0.0;
+	int hitCount = 0;
+
+public:
+	RaycastBenchmark() : Benchmark("raycast"), world(0.005) {}
+
+	void init() override {
+		jobs.reset(new JobSystem());
+		for(int i = 0; i < RAYCAST_PARTS; i++) {
+			GlobalCFrame cframe(std::sin(i * 1.3) * 200.0, std::cos(i * 0.7) * 10.0, std::sin(i * 0.37) * 200.0, Rotation::fromEulerAngles(0.3 * i, 0.1 * i, 0.0));
+			world.addTerrainPart(new Part(boxShape(1.0 + i % 3, 1.0, 1.0 + i % 5), cframe, {1.0, 0.5, 0.3}));
+		}
+		world.optimizeLayers();
+
+		for(int agent = 0; agent < RAYCAST_RAYS / 16; agent++) {
+			Position eye(std::cos(agent * 0.9) * 190.0, 0.0, std::sin(agent * 0.41) * 190.0);
+			double heading = agent * 0.77;
+			for(int ray = 0; ray < 16; ray++) {
+				double angle = heading + (ray - 8) * 0.03;
+				rays.push_back(Ray{eye, Vec3(std::cos(angle) * 50.0, (ray % 4 - 1.5) * 0.5, std::sin(angle) * 50.0)});
+			}
+		}
+		hits.resize(rays.size());
+	}
+
+	void run() override {
+		typedef std::chrono::high_resolution_clock Clock;
+
+		Clock::time_point start = Clock::now();
+		for(std::size_t i = 0; i < rays.size(); i++) {
+			hits[i] = world.raycast(rays[i], ALL_LAYERS, 1.0);
+		}
+		singleTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+		start = Clock::now();
+		world.raycastBatch(rays.data(), rays.size(), hits.data(), ALL_LAYERS, 1.0);
+		batchTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+		world.jobSystem = jobs.get();
+		start = Clock::now();
+		world.raycastBatch(rays.data(), rays.size(), hits.data(), ALL_LAYERS, 1.0);
+		parallelTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		world.jobSystem = nullptr;
+
+		hitCount = 0;
+		for(const RaycastHit& hit : hits) {
+			if(hit.hit()) hitCount++;
+		}
+	}
+
+	void printResults(double timeTaken) override {
+		Log::print("%d parts, %d rays of 50m, %d hit\n", RAYCAST_PARTS, RAYCAST_RAYS, hitCount);
+		Log::print("single raycasts: %.3fms\n", singleTime);
+		Log::print("batch:           %.3fms\n", batchTime);
+		Log::print("parallel batch:  %.3fms on %d workers\n", parallelTime, int(jobs->getWorkerCount()) + 1);
+	}
+} raycastBenchmark;
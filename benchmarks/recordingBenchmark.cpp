@@ -0,0 +1,76 @@
+#include "benchmark.h"
+
+#include "../physics/world.h"
+#include "../physics/part.h"
+#include "../physics/geometry/shapeCreation.h"
+#include "../physics/externalforces/gravityForce.h"
+#include "../physics/misc/recording.h"
+#include "../util/log.h"
+
+#include <sstream>
+#include <chrono>
+
+#define RECORDING_TICK_COUNT 2000
+
+/*
+	Ticks two identical worlds of falling cubes, one of them with a Recorder capturing every tick
+	The difference between their tick times is the overhead of recording on the ticking thread
+*/
+class RecordingBenchmark : public Benchmark {
+	WorldPrototype plainWorld;
+	WorldPrototype recordedWorld;
+	std::ostringstream recordingStream;
+	double plainTime = 0.0;
+	double recordedTime = 0.0;
+	Recorder::Statistics statistics;
+
+	static void fillWorld(WorldPrototype& world) {
+		world.addExternalForce(new DirectionalGravity(Vec3(0, -10, 0)));
+		world.addTerrainPart(new Part(boxShape(60.0, 1.0, 60.0), GlobalCFrame(0.0, 0.0, 0.0), {1.0, 0.5, 0.3}));
+		for(int x = 0; x < 10; x++) {
+			for(int y = 0; y < 5; y++) {
+				for(int z = 0; z < 10; z++) {
+					world.addPart(new Part(boxShape(1.0, 1.0, 1.0), GlobalCFrame(x * 1.5 - 7.0, y * 1.5 + 2.0, z * 1.5 - 7.0), {1.0, 0.5, 0.3}));
+				}
+			}
+		}
+	}
+
+public:
+	RecordingBenchmark() : Benchmark("recording"), plainWorld(0.005), recordedWorld(0.005) {}
+
+	void init() override {
+		fillWorld(plainWorld);
+		fillWorld(recordedWorld);
+	}
+
+	void run() override {
+		typedef std::chrono::high_resolution_clock Clock;
+
+		Recorder recorder(recordingStream);
+		plainTime = 0.0;
+		recordedTime = 0.0;
+		for(int i = 0; i < RECORDING_TICK_COUNT; i++) {
+			Clock::time_point start = Clock::now();
+			plainWorld.tick();
+			Clock::time_point middle = Clock::now();
+			recordedWorld.tick();
+			recorder.captureTick(recordedWorld);
+			Clock::time_point end = Clock::now();
+
+			plainTime += std::chrono::duration<double, std::milli>(middle - start).count();
+			recordedTime += std::chrono::duration<double, std::milli>(end - middle).count();
+		}
+		recorder.flush();
+		statistics = recorder.getStatistics();
+	}
+
+	void printResults(double timeTaken) override {
+		Log::print("%d ticks, %d keyframes, %d bytes recorded (%.1f bytes/tick)\n", int(statistics.recordedTicks), int(statistics.keyframes), int(statistics.bytesWritten), double(statistics.bytesWritten) / statistics.recordedTicks);
+		Log::print("Tick without recording: %.4fms  with recording: %.4fms  overhead: %.2f%%\n", plainTime / RECORDING_TICK_COUNT, recordedTime / RECORDING_TICK_COUNT, (recordedTime - plainTime) / plainTime * 100.0);
+		double captureTime = std::chrono::duration<double, std::milli>(statistics.captureTime).count();
+		double encodeTime = std::chrono::duration<double, std::milli>(statistics.encodeTime).count();
+		// with fewer cores than busy threads the recorder thread runs during either world's ticks, captureTick is what the ticking thread pays itself
+		Log::print("captureTick: %.4fms/tick (%.2f%%)  encoding on the recorder thread: %.4fms/tick (%.2f%%)\n", captureTime / RECORDING_TICK_COUNT, captureTime / plainTime * 100.0, encodeTime / RECORDING_TICK_COUNT, encodeTime / plainTime * 100.0);
+	}
+} recordingBenchmark;
@@ -0,0 +1,72 @@
+#include "benchmark.h"
+
+#include "../physics/world.h"
+#include "../physics/part.h"
+#include "../physics/geometry/shapeCreation.h"
+#include "../physics/misc/serialization.h"
+#include "../util/log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#define SERIALIZATION_DEFAULT_PARTS 10000
+// the parts round tripped in a run, small worlds are round tripped this many times over so they still take measurable time
+#define SERIALIZATION_PARTS_PER_RUN 100000
+
+/*
+	serializeWorld followed by deserializeWorld into a new world, --parts sets the number of parts of the world
+	A quarter of the parts carry a second part, so the physicals are not all alike. Reports the megabytes of the
+	serialized world that go through a round trip per second.
+*/
+class SerializationBenchmark : public Benchmark {
+	WorldPrototype world;
+	std::size_t passes = 1;
+	std::size_t serializedSize = 0;
+
+public:
+	SerializationBenchmark() : Benchmark("serializationRoundTrip"), world(0.005) {}
+
+	void init() override {
+		std::size_t count = (parameters.parts > 0) ? parameters.parts : SERIALIZATION_DEFAULT_PARTS;
+		passes = std::max<std::size_t>(1, SERIALIZATION_PARTS_PER_RUN / count);
+
+		// added in a random order, the tree grows too deep for its iterators when the parts of a large grid come in row by row
+		std::vector<std::size_t> order(count);
+		for(std::size_t i = 0; i < count; i++) order[i] = i;
+		std::shuffle(order.begin(), order.end(), std::mt19937(count));
+
+		std::size_t side = static_cast<std::size_t>(std::ceil(std::sqrt(count)));
+		for(std::size_t i = 0; i < count; i++) {
+			GlobalCFrame cframe((order[i] % side) * 3.0, 1.0, (order[i] / side) * 3.0);
+			Shape shape = (i % 3 == 0) ? boxShape(1.0, 1.0, 1.0) : (i % 3 == 1) ? sphereShape(0.5) : cylinderShape(0.5, 1.0);
+			Part* part = new Part(shape, cframe, {1.0, 0.5, 0.3});
+			if(i % 4 == 0) {
+				part->attach(new Part(sphereShape(0.4), GlobalCFrame(), {1.0, 0.5, 0.3}), CFrame(0.0, 0.9, 0.0));
+			}
+			world.addPart(part);
+		}
+	}
+
+	void run() override {
+		for(std::size_t pass = 0; pass < passes; pass++) {
+			WorldPrototype copy(world.deltaT);
+			std::stringstream stream;
+			SerializationSessionPrototype serializer;
+			serializer.serializeWorld(world, stream);
+			serializedSize = static_cast<std::size_t>(stream.tellp());
+			DeSerializationSessionPrototype deserializer;
+			deserializer.deserializeWorld(copy, stream);
+			copy.clear();
+		}
+	}
+
+	bool takesParts() const override { return true; }
+	BenchmarkWork getWork() const override { return BenchmarkWork{serializedSize * passes / 1000000.0, "MB"}; }
+
+	void printResults(double timeTaken) override {
+		Log::print("%d parts, %d bytes serialized, %d passes, %.3fms per round trip\n", int(world.getPartCount()), int(serializedSize), int(passes), timeTaken / passes);
+	}
+} serializationBenchmark;
@@ -0,0 +1,129 @@
+#include "benchmark.h"
+
+#include "../physics/layer.h"
+#include "../physics/part.h"
+#include "../physics/colissionBuffer.h"
+#include "../physics/geometry/shapeCreation.h"
+#include "../util/log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#define TREE_DEFAULT_LEAVES 10000
+// the leaves processed by a run, small trees are processed this many times over so they still take measurable time
+#define TREE_LEAVES_PER_RUN 1000000
+
+/*
+	The bounds tree of a single layer on its own, without a world around it, at the size given with --parts
+	The leaves are boxes at random places, the space grows with the count so every box overlaps about as many others at every size.
+	Each benchmark reports leaves per second, a falling rate over the sizes is where the tree stops scaling as n log n.
+*/
+class TreeScalingBenchmark : public Benchmark {
+protected:
+	// declared before the layer, which clears the layer of the parts on destruction
+	std::vector<Part> parts;
+	ColissionLayer layer;
+	std::size_t passes = 1;
+
+	WorldLayer& leaves() { return layer.subLayers[ColissionLayer::FREE_PARTS_LAYER]; }
+
+	void addAllParts() {
+		for(Part& part : parts) {
+			leaves().addPart(&part);
+		}
+	}
+
+public:
+	TreeScalingBenchmark(const char* name) : Benchmark(name) {}
+
+	void init() override {
+		std::size_t count = (parameters.parts > 0) ? parameters.parts : TREE_DEFAULT_LEAVES;
+		passes = std::max<std::size_t>(1, TREE_LEAVES_PER_RUN / count);
+
+		std::mt19937 random(count);
+		std::uniform_real_distribution<double> size(1.0, 2.0);
+		std::uniform_real_distribution<double> angle(0.0, 6.283185307);
+		// a box for every 8 cubic meters
+		std::uniform_real_distribution<double> coordinate(0.0, std::cbrt(count * 8.0));
+		parts.reserve(count);
+		for(std::size_t i = 0; i < count; i++) {
+			GlobalCFrame cframe(coordinate(random), coordinate(random), coordinate(random), Rotation::fromEulerAngles(angle(random), angle(random), angle(random)));
+			parts.emplace_back(boxShape(size(random), size(random), size(random)), cframe, PartProperties{1.0, 0.5, 0.3});
+		}
+	}
+
+	bool takesParts() const override { return true; }
+	BenchmarkWork getWork() const override { return BenchmarkWork{static_cast<double>(parts.size() * passes), "leaves"}; }
+
+	void printResults(double timeTaken) override {
+		Log::print("%d leaves, %d passes, %.1fns per leaf, longest branch %d\n", int(parts.size()), int(passes), timeTaken * 1000000.0 / (parts.size() * passes), int(leaves().tree.rootNode.getLengthOfLongestBranch()));
+	}
+};
+
+// inserts every part into an empty tree, and refits and improves it once as the world does before its first tick
+class TreeBuildBenchmark : public TreeScalingBenchmark {
+public:
+	TreeBuildBenchmark() : TreeScalingBenchmark("treeBuild") {}
+
+	void run() override {
+		for(std::size_t pass = 0; pass < passes; pass++) {
+			leaves().tree.clear();
+			addAllParts();
+			leaves().refresh();
+		}
+	}
+} treeBuildBenchmark;
+
+// moves every part a little and refreshes the layer, the tree work of a tick
+class TreeRefitBenchmark : public TreeScalingBenchmark {
+public:
+	TreeRefitBenchmark() : TreeScalingBenchmark("treeRefit") {}
+
+	void init() override {
+		TreeScalingBenchmark::init();
+		addAllParts();
+		leaves().refresh();
+	}
+
+	void run() override {
+		for(std::size_t pass = 0; pass < passes; pass++) {
+			// back and forth, so the parts stay where they were placed
+			Vec3 offset((pass % 2 == 0) ? 0.05 : -0.05, 0.0, 0.0);
+			for(Part& part : parts) {
+				GlobalCFrame cframe = part.getCFrame();
+				cframe.position += offset;
+				part.setCFrame(cframe);
+			}
+			leaves().refresh();
+		}
+	}
+} treeRefitBenchmark;
+
+// the colission candidates among the parts of the layer, the broadphase and pretests of a tick
+class TreeSelfColissionBenchmark : public TreeScalingBenchmark {
+	ColissionBuffer buffer;
+
+public:
+	TreeSelfColissionBenchmark() : TreeScalingBenchmark("treeSelfColission") {}
+
+	void init() override {
+		TreeScalingBenchmark::init();
+		addAllParts();
+		leaves().refresh();
+	}
+
+	void run() override {
+		for(std::size_t pass = 0; pass < passes; pass++) {
+			buffer.clear();
+			layer.getInternalColissions(buffer);
+		}
+	}
+
+	void printResults(double timeTaken) override {
+		TreeScalingBenchmark::printResults(timeTaken);
+		std::size_t pairs = buffer.freePartColissions.size();
+		Log::print("%d candidate pairs, %.2f per leaf, %.0f pairs/s\n", int(pairs), double(pairs) / parts.size(), pairs * passes / timeTaken * 1000.0);
+	}
+} treeSelfColissionBenchmark;
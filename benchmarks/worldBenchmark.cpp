@@ -14,6 +14,39 @@
 #include "../physics/misc/shapeLibrary.h"
 #include "../physics/misc/filters/outOfBoundsFilter.h"
 #include "../physics/misc/physicsProfiler.h"
+#include "../physics/misc/tickTrace.h"
+#include "../physics/threading/jobSystem.h"
+
+#include <memory>
+
+WorldBenchmarkTraceSettings worldBenchmarkTrace;
+bool worldBenchmarkPerfPhases = false;
+
+static const char* tickPhaseLabels[]{
+	"Broadphase",
+	"Narrowphase",
+	"Response",
+	"Constraints",
+	"Integrate",
+	"Refit"
+};
+
+// adds what the counters of the ticking thread and its workers counted during every phase to the totals of that phase
+class PhaseCounterListener : public TickPhaseListener {
+	PerfCounters& counters = PerfCounters::local();
+	PerfCounterValues* totals;
+	PerfCounterValues phaseStart;
+
+public:
+	PhaseCounterListener(PerfCounterValues* totals) : totals(totals) {}
+
+	virtual void beginPhase(TickPhase) override {
+		phaseStart = counters.read();
+	}
+	virtual void endPhase(TickPhase phase) override {
+		totals[static_cast<std::size_t>(phase)] += counters.read() - phaseStart;
+	}
+};
 
 WorldBenchmark::WorldBenchmark(const char* name, int tickCount) : Benchmark(name), world(0.005), tickCount(tickCount) {
 	world.addExternalForce(new DirectionalGravity(Vec3(0, -10, 0)));
@@ -21,6 +54,22 @@ WorldBenchmark::WorldBenchmark(const char* name, int tickCount) : Benchmark(name
 
 void WorldBenchmark::run() {
 	world.isValid();
+	physicsMeasure.resetTotal();
+
+	bool tracing = !worldBenchmarkTrace.tracePath.empty() || worldBenchmarkTrace.spikeMillis > 0.0;
+	TickTraceRecorder trace(worldBenchmarkTrace.traceSeconds);
+	if(tracing) {
+		trace.setSpikeTrigger(worldBenchmarkTrace.spikeMillis, worldBenchmarkTrace.tracePath + name + ".spike");
+		trace.start();
+	}
+	std::unique_ptr<JobSystem> jobs;
+	if(parameters.threads > 1) {
+		jobs.reset(new JobSystem(parameters.threads - 1));
+		world.jobSystem = jobs.get();
+	}
+	peakTickMemory = TickMemoryUsage();
+	PhaseCounterListener phaseCounterListener(phaseCounters);
+	if(worldBenchmarkPerfPhases && PerfCounters::local().isAnyAvailable()) world.phaseListener = &phaseCounterListener;
 	Part& partToTrack = *world.physicals[0]->getMainPart();
 	for (int i = 0; i < tickCount; i++) {
 		if (i % (tickCount / 8) == 0) {
@@ -36,17 +85,31 @@ void WorldBenchmark::run() {
 			Log::print("%d/%d parts out of bounds!\n", partsOutOfBounds, world.getPartCount());
 		}
 
-		physicsMeasure.mark(PhysicsProcess::OTHER);
-
-		world.tick();
-
-		physicsMeasure.end();
+		if(tracing) trace.beginTick();
+		{
+			PhysicsZone tickZone(PhysicsProcess::OTHER);
+			world.tick();
+		}
 
-		GJKCollidesIterationStatistics.nextTally();
-		GJKNoCollidesIterationStatistics.nextTally();
-		EPAIterationStatistics.nextTally();
+		endPhysicsStatisticsTick();
+		if(tracing) trace.endTick();
+		if(world.lastTickMemory.getPeak() > peakTickMemory.getPeak()) peakTickMemory = world.lastTickMemory;
 	}
+	world.phaseListener = nullptr;
+	world.jobSystem = nullptr;
 	world.isValid();
+
+	if(tracing) {
+		trace.stop();
+		if(!worldBenchmarkTrace.tracePath.empty()) {
+			std::string path = worldBenchmarkTrace.tracePath + name + ".json";
+			if(trace.write(path)) {
+				Log::print("Wrote the trace of the last %.1f seconds to %s\n", worldBenchmarkTrace.traceSeconds, path.c_str());
+			} else {
+				Log::error("Could not write trace %s", path.c_str());
+			}
+		}
+	}
 }
 
 static const std::size_t LABEL_LENGTH = 23;
@@ -145,6 +208,33 @@ void printBreakdown(const T* values, const char** labels, std::size_t N, std::st
 
 }
 
+// the zones below parent, depth first, with their time and count per tick
+static void printZoneTree(const ProfileTree& tree, int parent, std::size_t depth, double tickCount) {
+	for(int node = 0; node < static_cast<int>(tree.nodes.size()); node++) {
+		const ProfileTree::Node& zone = tree.nodes[node];
+		if(zone.parent != parent) continue;
+
+		setColor(getColor(zone.zone));
+		printToLength(std::string(depth * 2, ' ') + physicsMeasure.labels[zone.zone] + std::string(":"), LABEL_LENGTH);
+
+		std::stringstream ss;
+		ss.precision(5);
+		ss << std::fixed;
+		ss << (zone.time.count() / 1000000.0 / tickCount) << "ms";
+		setColor(getColor(zone.zone));
+		printToLength(ss.str(), COUNT_LENGTH);
+
+		std::stringstream ss2;
+		ss2.precision(1);
+		ss2 << std::fixed;
+		ss2 << (zone.count / tickCount) << "x";
+		setColor(getColor(zone.zone));
+		std::cout << ss2.str() << '\n';
+
+		printZoneTree(tree, node, depth + 1, tickCount);
+	}
+}
+
 void WorldBenchmark::printResults(double timeTakenMillis) {
 	double tickTime = (timeTakenMillis) / tickCount;
 	Log::print("%d ticks at %f ticks per second\n", tickCount, 1000 / tickTime);
@@ -163,12 +253,42 @@ void WorldBenchmark::printResults(double timeTakenMillis) {
 	std::cout << "[Physics Profiler]\n";
 	printBreakdown(millis, physicsMeasure.labels, physicsMeasure.size(), "ms");
 
+	setColor(TerminalColor::WHITE);
+	std::cout << "\n";
+	setColor(TerminalColor::MAGENTA);
+	std::cout << "[Physics Zones] per tick, summed over all threads\n";
+	std::size_t profiledTicks = physicsMeasure.getTotalTickCount();
+	if(profiledTicks != 0) printZoneTree(physicsMeasure.getTotal(), -1, 0, static_cast<double>(profiledTicks));
+
 	setColor(TerminalColor::WHITE);
 	std::cout << "\n";
 	setColor(TerminalColor::MAGENTA);
 	std::cout << "[Intersection Statistics]\n";
 	printBreakdown(intersectionStatistics.history.avg().values, intersectionStatistics.labels, intersectionStatistics.size(), "");
 	setColor(TerminalColor::WHITE);
+
+	if(worldBenchmarkPerfPhases && PerfCounters::local().isAnyAvailable()) {
+		std::cout << "\n";
+		setColor(TerminalColor::MAGENTA);
+		std::cout << "[Hardware Counters] per tick\n";
+		printPerfCounterTable(tickPhaseLabels, phaseCounters, static_cast<std::size_t>(TickPhase::COUNT), tickCount);
+	}
+
+	MemoryUsage memory = world.getMemoryUsage();
+	std::size_t memoryBytes[MemoryUsage::NUMBER_OF_CATEGORIES];
+	memory.getValues(memoryBytes);
+	std::size_t memoryKiB[MemoryUsage::NUMBER_OF_CATEGORIES];
+	for(std::size_t i = 0; i < MemoryUsage::NUMBER_OF_CATEGORIES; i++) {
+		memoryKiB[i] = (memoryBytes[i] + 1023) / 1024;
+	}
+
+	std::cout << "\n";
+	setColor(TerminalColor::MAGENTA);
+	std::cout << "[World Memory] " << (memory.getTotal() + 1023) / 1024 << "KiB\n";
+	printBreakdown(memoryKiB, MemoryUsage::labels, MemoryUsage::NUMBER_OF_CATEGORIES, "KiB");
+	setColor(TerminalColor::WHITE);
+	Log::print("Peak scratch per tick: %.1fKiB, colissions %.1fKiB, narrowphase %.1fKiB, constraints %.1fKiB\n",
+		peakTickMemory.getPeak() / 1024.0, peakTickMemory.colissions / 1024.0, peakTickMemory.narrowphaseScratch / 1024.0, peakTickMemory.constraintScratch / 1024.0);
 }
 
 
@@ -1,13 +1,35 @@
 #pragma once
 
 #include "benchmark.h"
+#include "perfCounters.h"
 #include "../physics/world.h"
 
+#include <string>
+
+/*
+	Chrome trace capture of the world benchmarks, set from the command line of the benchmarks
+	With a tracePath, the last traceSeconds of every world benchmark are written to tracePath followed by its name and .json
+	With a spikeMillis, ticks that take longer write tracePath followed by the name, .spike, the number of the spike and .json
+*/
+struct WorldBenchmarkTraceSettings {
+	std::string tracePath;
+	double traceSeconds = 5.0;
+	double spikeMillis = 0.0;
+};
+extern WorldBenchmarkTraceSettings worldBenchmarkTrace;
+
+// reads the counters of the benchmark thread around every TickPhase, a few microseconds per phase
+extern bool worldBenchmarkPerfPhases;
+
 static const PartProperties basicProperties{1.0, 0.7, 0.5};
 class WorldBenchmark : public Benchmark {
 protected:
 	WorldPrototype world;
 	int tickCount;
+	// summed over all ticks, only filled with worldBenchmarkPerfPhases
+	PerfCounterValues phaseCounters[static_cast<std::size_t>(TickPhase::COUNT)];
+	// the tick with the most scratch memory
+	TickMemoryUsage peakTickMemory;
 
 public:
 	WorldBenchmark(const char* name, int tickCount);
@@ -15,5 +37,8 @@ public:
 	virtual void run() override;
 	virtual void printResults(double timeTaken) override;
 
+	// with more than one thread the narrowphase is spread over a JobSystem, which is started as part of run()
+	virtual bool takesThreads() const override { return true; }
+
 	void createFloor(double w, double h, double wallHeight);
 };
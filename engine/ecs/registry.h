@@ -1,12 +1,17 @@
 #pragma once
 
-#include <set>
+#include <new>
 #include <queue>
+#include <tuple>
+#include <memory>
 #include <vector>
+#include <string>
 #include <cstdint>
+#include <utility>
 #include <type_traits>
 #include <unordered_map>
 #include <typeinfo>
+#include <stdexcept>
 #include "../util/typetraits.h"
 #include "../util/iteratorUtils.h"
 #include "../util/intrusivePointer.h"
@@ -22,6 +27,7 @@ struct registry_traits<Type, std::enable_if_t<std::is_enum_v<Type>>> : registry_
 
 /**
  * entity = 8 parent bits, 8 self bits
+ * self = 8 index bits, there is no room for a version so destroyed ids are reused as they are
  */
 template<>
 struct registry_traits<std::uint16_t> {
@@ -31,10 +37,13 @@ struct registry_traits<std::uint16_t> {
 
 	static constexpr entity_type entity_mask = 0xFF;
 	static constexpr std::size_t parent_shift = 8u;
+	static constexpr std::size_t index_bits = 8u;
 };
 
 /**
  * entity = 16 parent bits, 16 self bits
+ * self = 16 index bits, a version would cut the 65535 entities this registry holds down to a few thousand, so like Registry16
+ * destroyed ids are reused as they are
  */
 template<>
 struct registry_traits<std::uint32_t> {
@@ -44,10 +53,12 @@ struct registry_traits<std::uint32_t> {
 
 	static constexpr entity_type entity_mask = 0xFFFF;
 	static constexpr std::size_t parent_shift = 16u;
+	static constexpr std::size_t index_bits = 16u;
 };
 
 /**
  * entity = 32 parent bits, 32 self bits
+ * self = 8 version bits, 24 index bits
  */
 template<>
 struct registry_traits<std::uint64_t> {
@@ -57,6 +68,7 @@ struct registry_traits<std::uint64_t> {
 
 	static constexpr entity_type entity_mask = 0xFFFFFFFF;
 	static constexpr std::size_t parent_shift = 32u;
+	static constexpr std::size_t index_bits = 24u;
 };
 	
 template<typename Entity>
@@ -85,23 +97,262 @@ public:
 	using component_type = typename traits_type::component_type;
 	using representation_type = typename traits_type::representation_type;
 
+	// Number of entity indices per page of a sparse index
+	static constexpr std::size_t sparse_page_size = 1024u;
+	// Number of components per page of a component pool
+	static constexpr std::size_t component_page_size = 1024u;
+
 
 	//-------------------------------------------------------------------------------------//
-	// Member types                                                                        //
+	// Sparse sets                                                                         //
 	//-------------------------------------------------------------------------------------//
 
-private:
-	struct entity_compare { bool operator() (const representation_type& left, const representation_type& right) const noexcept { return self(left) < self(right); } };
+public:
+	/**
+	 * A set of entities stored contiguously in packed, with a paged sparse index from the index of an entity to its position in packed
+	 * Value is either an entity or an entity merged with its parent, the self bits of a value are the entity it belongs to
+	 * Erasing moves the last value into the hole, so the order of packed is the order of insertion until something is erased
+	 */
+	template<typename Value>
+	class sparse_set {
+	public:
+		static constexpr std::uint32_t null_position = 0xFFFFFFFF;
+
+	protected:
+		std::vector<Value> packed;
+		std::vector<std::unique_ptr<std::uint32_t[]>> sparse;
+
+		std::uint32_t& sparse_slot(const entity_type& entity) {
+			std::size_t index = index_of(entity);
+			std::size_t page = index / sparse_page_size;
+
+			if (page >= sparse.size())
+				sparse.resize(page + 1);
+
+			if (!sparse[page]) {
+				sparse[page] = std::make_unique<std::uint32_t[]>(sparse_page_size);
+				std::fill(sparse[page].get(), sparse[page].get() + sparse_page_size, null_position);
+			}
+
+			return sparse[page][index % sparse_page_size];
+		}
+
+	public:
+		/**
+		 * Returns the position of the given entity in packed, null_position if the set does not contain it
+		 */
+		[[nodiscard]] std::uint32_t position(const entity_type& entity) const noexcept {
+			std::size_t index = index_of(entity);
+			std::size_t page = index / sparse_page_size;
+			if (page >= sparse.size() || !sparse[page])
+				return null_position;
+
+			std::uint32_t position = sparse[page][index % sparse_page_size];
+			if (position == null_position || self(packed[position]) != entity)
+				return null_position;
+
+			return position;
+		}
+
+		[[nodiscard]] bool contains(const entity_type& entity) const noexcept {
+			return position(entity) != null_position;
+		}
+
+		[[nodiscard]] std::size_t size() const noexcept {
+			return packed.size();
+		}
+
+		void insert(const Value& value) {
+			sparse_slot(self(value)) = static_cast<std::uint32_t>(packed.size());
+			packed.push_back(value);
+		}
+
+		/**
+		 * Removes the value at the given position by moving the last value into its place
+		 */
+		void erase_at(std::uint32_t position) noexcept {
+			std::uint32_t last = static_cast<std::uint32_t>(packed.size() - 1);
+
+			sparse_slot(self(packed[position])) = null_position;
+			if (position != last) {
+				packed[position] = packed[last];
+				sparse_slot(self(packed[position])) = position;
+			}
+
+			packed.pop_back();
+		}
+
+		Value& at(std::uint32_t position) noexcept {
+			return packed[position];
+		}
+
+		auto begin() noexcept {
+			return packed.begin();
+		}
+
+		auto end() noexcept {
+			return packed.end();
+		}
+	};
+
+	/**
+	 * The type erased part of a component pool, its packed entities are the entities that have the component
+	 */
+	class basic_pool : public sparse_set<entity_type> {
+	public:
+		/**
+		 * Increased whenever an entity gains or loses a component of this pool, replacing a component in place leaves it as is
+		 */
+		std::size_t generation = 0;
+
+		virtual ~basic_pool() = default;
+
+		/**
+		 * Removes the component of the given entity, returns whether it had one
+		 */
+		virtual bool remove(const entity_type& entity) noexcept = 0;
+
+		/**
+		 * Returns the component of the given entity, nullptr if it has none
+		 */
+		virtual RefCountable* get_erased(const entity_type& entity) noexcept = 0;
+	};
+
+	/**
+	 * The components of one type, stored in pages of component_page_size that never move
+	 * A component keeps its slot until it is removed, so Refs to it stay valid while components of other entities are added and removed
+	 * slots maps every position in packed to the slot of its component, the slots of removed components are reused by later components
+	 * A component that is still referenced when it is removed is destroyed with the pool instead, its slot is not reused
+	 */
+	template<typename Component>
+	class component_pool : public basic_pool {
+		static_assert(std::is_base_of_v<RefCountable, Component>);
+
+	private:
+		std::vector<Component*> pages;
+		std::vector<std::uint32_t> slots;
+		std::vector<std::uint32_t> free_slots;
+		std::vector<std::uint32_t> retired_slots;
+		std::uint32_t slot_count = 0;
+
+		Component* storage(std::uint32_t slot) const noexcept {
+			return pages[slot / component_page_size] + slot % component_page_size;
+		}
+
+		std::uint32_t allocate_slot() {
+			if (!free_slots.empty()) {
+				std::uint32_t slot = free_slots.back();
+				free_slots.pop_back();
+
+				return slot;
+			}
+
+			if (slot_count / component_page_size >= pages.size())
+				pages.push_back(static_cast<Component*>(::operator new(sizeof(Component) * component_page_size, std::align_val_t(alignof(Component)))));
+
+			return slot_count++;
+		}
+
+	public:
+		component_pool() = default;
+		component_pool(const component_pool&) = delete;
+		component_pool& operator=(const component_pool&) = delete;
+
+		~component_pool() override {
+			for (std::uint32_t slot : slots)
+				storage(slot)->~Component();
+
+			for (std::uint32_t slot : retired_slots)
+				storage(slot)->~Component();
+
+			for (Component* page : pages)
+				::operator delete(page, std::align_val_t(alignof(Component)));
+		}
+
+		/**
+		 * Constructs a component for the given entity, an existing component of the entity is replaced in place
+		 * The reference count is that of the Refs to the slot, not that of the component the arguments may have been copied from
+		 */
+		template<typename... Args>
+		Component* emplace(const entity_type& entity, Args&&... args) {
+			std::uint32_t position = this->position(entity);
+			if (position != basic_pool::null_position) {
+				Component* component = storage(slots[position]);
+				std::size_t count = component->count;
+				component->~Component();
+
+				component = new (component) Component(std::forward<Args>(args)...);
+				component->count = count;
+
+				return component;
+			}
+
+			std::uint32_t slot = allocate_slot();
+			Component* component = new (storage(slot)) Component(std::forward<Args>(args)...);
+			component->count = 0;
+			this->insert(entity);
+			slots.push_back(slot);
+			basic_pool::generation++;
+
+			return component;
+		}
+
+		Component* get(const entity_type& entity) noexcept {
+			std::uint32_t position = this->position(entity);
+			if (position == basic_pool::null_position)
+				return nullptr;
+
+			return storage(slots[position]);
+		}
+
+		/**
+		 * Returns the component at the given position, which belongs to the entity at the same position in packed
+		 */
+		Component& component_at(std::uint32_t position) noexcept {
+			return *storage(slots[position]);
+		}
+
+		bool remove(const entity_type& entity) noexcept override {
+			std::uint32_t position = this->position(entity);
+			if (position == basic_pool::null_position)
+				return false;
+
+			std::uint32_t slot = slots[position];
+			Component* component = storage(slot);
+			if (component->count == 0) {
+				component->~Component();
+				free_slots.push_back(slot);
+			} else {
+				retired_slots.push_back(slot);
+			}
+
+			// packed moves its last entity into the hole, its slot has to follow it
+			slots[position] = slots.back();
+			slots.pop_back();
+			this->erase_at(position);
+			basic_pool::generation++;
+
+			return true;
+		}
+
+		RefCountable* get_erased(const entity_type& entity) noexcept override {
+			return get(entity);
+		}
+	};
+
+
+	//-------------------------------------------------------------------------------------//
+	// Member types                                                                        //
+	//-------------------------------------------------------------------------------------//
 
 public:
-	using entity_set = std::set<representation_type, entity_compare>;
+	using entity_set = sparse_set<representation_type>;
 	using entity_queue = std::queue<entity_type>;
-	using entity_map = std::unordered_map<entity_type, Ref<RefCountable>>;
 	using type_map = std::unordered_map<component_type, std::string>;
-	using component_vector = std::vector<entity_map*>;
+	using component_vector = std::vector<std::unique_ptr<basic_pool>>;
 
 	using component_vector_iterator = decltype(std::declval<component_vector>().begin());
-	using component_map_iterator = decltype(std::declval<entity_map>().begin());
+	using component_set_iterator = decltype(std::declval<basic_pool>().begin());
 	using entity_set_iterator = decltype(std::declval<entity_set>().begin());
 
 	// Null entity
@@ -117,10 +368,17 @@ private:
 	component_vector components;
 	type_map type_mapping;
 
+	// Destroyed entities with their version already increased
 	entity_queue id_queue;
 	entity_type id_counter = null_entity;
 
-	constexpr entity_type nextID() noexcept {
+	/**
+	 * Returns a new index with version 0, throws once every index is in use, as the next one would wrap into the version bits
+	 */
+	entity_type nextID() {
+		if (static_cast<std::size_t>(id_counter) >= index_mask)
+			throw std::length_error("Registry ran out of entity indices");
+
 		return ++id_counter;
 	}
 
@@ -151,6 +409,9 @@ public:
 	};
 
 private:
+	static constexpr std::size_t index_mask = (std::size_t(1) << traits_type::index_bits) - 1;
+	static constexpr std::size_t version_mask = std::size_t(traits_type::entity_mask) >> traits_type::index_bits;
+
 	static constexpr entity_type self(const representation_type& entity) noexcept {
 		return static_cast<entity_type>(entity & traits_type::entity_mask);
 	}
@@ -163,22 +424,44 @@ private:
 		return (static_cast<representation_type>(parent) << traits_type::parent_shift) | static_cast<representation_type>(entity);
 	}
 
+	static constexpr std::size_t index_of(const entity_type& entity) noexcept {
+		return static_cast<std::size_t>(entity) & index_mask;
+	}
 
-	//-------------------------------------------------------------------------------------//
-	// View iterators                                                                      //
-	//-------------------------------------------------------------------------------------//
+	/**
+	 * Returns the id the index of the given entity gets when it is reused, the same index with the next version
+	 */
+	static constexpr entity_type next_version(const entity_type& entity) noexcept {
+		std::size_t version = ((static_cast<std::size_t>(entity) >> traits_type::index_bits) + 1) & version_mask;
+		return static_cast<entity_type>((version << traits_type::index_bits) | index_of(entity));
+	}
 
-public:
-	struct component_iterator : component_map_iterator {
-	public:
-		component_iterator() = default;
+	/**
+	 * Returns the pool of the given component, creating it if it does not exist yet
+	 */
+	template<typename Component>
+	component_pool<Component>* assure() {
+		component_type index = getComponentIndex<Component>();
+		if (index >= components.size())
+			components.resize(index + 1);
 
-		explicit component_iterator(component_map_iterator&& iterator) : component_map_iterator(std::move(iterator)) {}
+		if (!components[index])
+			components[index] = std::make_unique<component_pool<Component>>();
 
-		auto& operator*() const {
-			return component_map_iterator::operator*().first;
-		}
-	};
+		return static_cast<component_pool<Component>*>(components[index].get());
+	}
+
+	/**
+	 * Returns the pool of the given component, nullptr if the component has never been added
+	 */
+	template<typename Component>
+	component_pool<Component>* pool() noexcept {
+		component_type index = getComponentIndex<Component>();
+		if (index >= components.size())
+			return nullptr;
+
+		return static_cast<component_pool<Component>*>(components[index].get());
+	}
 
 	
 	//-------------------------------------------------------------------------------------//
@@ -194,12 +477,7 @@ public:
 	struct conjunction {
 		template<typename Component>
 		static Ref<Component> get(Registry<Entity>* registry, const entity_type& entity) {
-			component_type index = registry->getComponentIndex<Component>();
-			entity_map* map = registry->components[index];
-
-			auto component_iterator = map->find(entity);
-
-			return intrusive_cast<Component>(component_iterator->second);
+			return Ref<Component>(registry->template pool<Component>()->get(entity));
 		}
 	};
 
@@ -265,38 +543,18 @@ public:
 private:
 	template<typename... Components>
 	std::enable_if_t<sizeof...(Components) == 0> init() {}
-	
-	template<typename... Components>
-	std::enable_if_t<sizeof...(Components) == 0> extract_smallest_component(component_type& smallest_component, std::size_t& smallest_size, std::vector<component_type>& other_components) {}
-
-	template<typename Component, typename... Components>
-	void extract_smallest_component(component_type& smallest_component, std::size_t& smallest_size, std::vector<component_type>& other_components) noexcept {
-		component_type current_component = getComponentIndex<Component>();
-		const std::size_t current_size = this->components[current_component]->size();
-
-		if (current_size < smallest_size) {
-			other_components.push_back(smallest_component);
-			smallest_component = current_component;
-			smallest_size = current_size;
-		} else
-			other_components.push_back(current_component);
-
-		extract_smallest_component<Components...>(smallest_component, smallest_size, other_components);
-	}
-
-	template<typename... Components>
-	std::enable_if_t<sizeof...(Components) == 0> insert_entities(entity_set& entities) {}
 
-	template<typename Component, typename... Components>
-	void insert_entities(entity_set& entities) noexcept {
-		std::size_t component = getComponentIndex<Component>();
-
-		component_iterator first(this->components[component]->begin());
-		component_iterator last(this->components[component]->end());
-
-		entities.insert(first, last);
-
-		insert_entities<Components...>(entities);
+	/**
+	 * Returns the pool with the fewest entities among the given pools
+	 */
+	template<std::size_t Size>
+	static basic_pool* smallest_pool(basic_pool* const (&pools)[Size]) noexcept {
+		basic_pool* smallest = pools[0];
+		for (basic_pool* pool : pools)
+			if (pool->size() < smallest->size())
+				smallest = pool;
+
+		return smallest;
 	}
 	
 	template<typename ViewType, typename Iterator, typename Filter>
@@ -371,33 +629,31 @@ public:
 	}
 	
 	/**
-	 * Initializes the component vector to create an order in the components
+	 * Creates the pools of the given components up front
 	 */
 	template<typename Component, typename... Components>
 	void init() {
-		component_type index = getComponentIndex<Component>();
-		components.push_back(new entity_map());
+		assure<Component>();
 		init<Components...>();
 	}
 	
 	/**
 	 * Creates a new entity with an empty parent and adds it to the registry
+	 * Ids of destroyed entities are reused with a new version, so an old id does not refer to the new entity
+	 * Throws std::length_error when all 2^index_bits - 1 ids are taken by live entities
 	 */
-	[[nodiscard]] entity_type create(const entity_type& parent = null_entity) noexcept {
-		representation_type id;
+	[[nodiscard]] entity_type create(const entity_type& parent = null_entity) {
+		entity_type id;
 		if (id_queue.empty()) {
-			id = merge(parent, nextID());
+			id = nextID();
 		} else {
-			entity_type lastID = id_queue.front();
-
-			id = merge(parent, lastID);
-
+			id = id_queue.front();
 			id_queue.pop();
 		}
 
-		entities.insert(id);
+		entities.insert(merge(parent, id));
 
-		return static_cast<entity_type>(id);
+		return id;
 	}
 
 	/**
@@ -407,65 +663,42 @@ public:
 		if (entity == null_entity)
 			return;
 
-		auto entities_iterator = entities.find(static_cast<representation_type>(entity));
-		if (entities_iterator != entities.end()) {
-			entities.erase(entities_iterator);
-			id_queue.push(entity);
-
-			for (auto map : components) {
-				auto component_iterator = map->find(entity);
-				if (component_iterator != map->end()) {
-					delete component_iterator->second.get(); // TODO fix
-					map->erase(component_iterator);
-				}
-			}
-		}
+		std::uint32_t position = entities.position(entity);
+		if (position == entity_set::null_position)
+			return;
+
+		entities.erase_at(position);
+		id_queue.push(next_version(entity));
+
+		for (auto& pool : components)
+			if (pool)
+				pool->remove(entity);
 	}
 
 	/**
 	 * Instantiates a component using the given type and arguments and adds it to the given entity
+	 * References to other components of the same type stay valid, an existing component of the entity is replaced
 	 */
 	template<typename Component, typename... Args>
 	Ref<Component> add(const entity_type& entity, Args&&... args) noexcept {
-		auto entities_iterator = entities.find(static_cast<representation_type>(entity));
-		if (entities_iterator == entities.end())
+		if (!entities.contains(entity))
 			return Ref<Component>();
 
-		Ref<Component> component = make_intrusive(new Component(std::forward<Args>(args)...));
-		component_type index = getComponentIndex<Component>();
-
-		while (index >= components.size())
-			components.push_back(new entity_map());
-
-		entity_map* map = components[index];
-		auto result = map->insert(std::make_pair(entity, intrusive_cast<RefCountable>(component)));
-
-		if (!result.second)
-			result.first->second = intrusive_cast<RefCountable>(component);
-
-		return component;
+		return Ref<Component>(assure<Component>()->emplace(entity, std::forward<Args>(args)...));
 	}
 
 	/**
 	 * Removes the component with the given component id from the given entity, returns whether the erasure was successful
+	 * Components of other entities stay in place, so references to them stay valid
 	 */
 	bool remove(const entity_type& entity, const component_type& index) noexcept {
-		if (index >= components.size())
+		if (index >= components.size() || !components[index])
 			return false;
 		
-		auto entities_iterator = entities.find(static_cast<representation_type>(entity));
-		if (entities_iterator == entities.end())
+		if (!entities.contains(entity))
 			return false;
 
-		entity_map* map = components[index];
-		auto component_iterator = map->find(entity);
-		if (component_iterator == map->end())
-			return false;
-
-		map->erase(component_iterator);
-		// Todo check if really destroyed
-		
-		return true;
+		return components[index]->remove(entity);
 	}
 
 
@@ -488,20 +721,11 @@ public:
 	 */
 	template<typename Component>
 	[[nodiscard]] Ref<Component> get(const entity_type& entity) noexcept {
-		auto entities_iterator = entities.find(static_cast<representation_type>(entity));
-		if (entities_iterator == entities.end())
-			return Ref<Component>();
-
-		component_type index = getComponentIndex<Component>();
-		if (index >= components.size())
-			return Ref<Component>();
-
-		entity_map* map = components[index];
-		auto component_iterator = map->find(entity);
-		if (component_iterator == map->end())
+		component_pool<Component>* components = pool<Component>();
+		if (components == nullptr)
 			return Ref<Component>();
 
-		return intrusive_cast<Component>(component_iterator->second);
+		return Ref<Component>(components->get(entity));
 	}
 
 	/**
@@ -509,25 +733,15 @@ public:
 	 */
 	template<typename Component, typename... Args>
 	[[nodiscard]] Ref<Component> getOrAdd(const entity_type& entity, Args&&... args) {
-		auto entities_iterator = entities.find(static_cast<representation_type>(entity));
-		if (entities_iterator == entities.end())
+		if (!entities.contains(entity))
 			return Ref<Component>();
 
-		component_type index = getComponentIndex<Component>();
-		while (index >= components.size())
-			components.push_back(new entity_map());
-
-		entity_map* map = components[index];
-		auto component_iterator = map->find(entity);
-		if (component_iterator == map->end()) {
-			Ref<Component> component = make_intrusive(new Component(std::forward<Args>(args)...));
-
-			map->insert(std::make_pair(entity, intrusive_cast<RefCountable>(component)));
-
-			return component;
-		}
+		component_pool<Component>* components = assure<Component>();
+		Component* component = components->get(entity);
+		if (component == nullptr)
+			component = components->emplace(entity, std::forward<Args>(args)...);
 
-		return intrusive_cast<Component>(component_iterator->second);
+		return Ref<Component>(component);
 	}
 
 	/**
@@ -547,27 +761,31 @@ public:
 	 */
 	template<typename Component>
 	[[nodiscard]] bool has(const entity_type& entity) noexcept {
-		auto entities_iterator = entities.find(static_cast<representation_type>(entity));
-		if (entities_iterator == entities.end())
+		component_pool<Component>* components = pool<Component>();
+		if (components == nullptr)
 			return false;
 
-		component_type index = getComponentIndex<Component>();
-		if (index >= components.size())
-			return false;
+		return components->contains(entity);
+	}
 
-		entity_map* map = components[index];
-		auto component_iterator = map->find(entity);
-		if (component_iterator == map->end())
-			return false;
+	/**
+	 * Returns a number that changes whenever an entity gains or loses a component of the given type
+	 * Components are replaced in place, so pointers to components that were cached while it stayed the same are still valid and current
+	 */
+	template<typename Component>
+	[[nodiscard]] std::size_t getComponentGeneration() noexcept {
+		component_pool<Component>* components = pool<Component>();
+		if (components == nullptr)
+			return 0;
 
-		return true;
+		return components->generation;
 	}
 
 	/**
 	 * Returns whether the registry contains the given entity
 	 */
 	[[nodiscard]] bool contains(const entity_type& entity) noexcept {
-		return entities.find(static_cast<representation_type>(entity)) != entities.end();
+		return entities.contains(entity);
 	}
 
 
@@ -586,9 +804,9 @@ public:
 	 * Returns the parent of the given entity
 	 */
 	[[nodiscard]] constexpr entity_type getParent(const entity_type& entity) {
-		entity_set_iterator iterator = entities.find(static_cast<representation_type>(entity));
-		if (iterator != entities.end())
-			return parent(*iterator);
+		std::uint32_t position = entities.position(entity);
+		if (position != entity_set::null_position)
+			return parent(entities.at(position));
 
 		return null_entity;
 	}
@@ -607,25 +825,25 @@ public:
 		return entity;
 	}
 
+	/**
+	 * Returns the index of the given entity, live entities have distinct indices below 2^index_bits, a reused id keeps its index
+	 */
+	[[nodiscard]] static constexpr std::size_t getIndex(const entity_type& entity) noexcept {
+		return index_of(entity);
+	}
+
 	/**
 	 * Sets the parent of the given entity to the given parent, returns true if successful, returns false if the entity does not exist.
 	 */
 	bool setParent(const entity_type& entity, const entity_type& parent) noexcept {
-		auto entity_iterator = entities.find(static_cast<representation_type>(entity));
-		if (entity_iterator == entities.end())
+		std::uint32_t position = entities.position(entity);
+		if (position == entity_set::null_position)
 			return false;
 
-		if (parent != null_entity) {
-			auto parent_iterator = entities.find(parent);
-			if (parent_iterator == entities.end())
-				return false;
-		}
+		if (parent != null_entity && !entities.contains(parent))
+			return false;
 
-		representation_type newEntity = merge(parent, entity);
-		auto hint_iterator = entity_iterator;
-		++hint_iterator;
-		entities.erase(entity_iterator);
-		entities.insert(hint_iterator, newEntity);
+		entities.at(position) = merge(parent, entity);
 
 		return true;
 	}
@@ -665,39 +883,35 @@ public:
 	
 	/**
 	 * Returns an iterator which iterates over all entities having all the given components
+	 * The packed entities of the smallest pool are walked, and only checked against the other pools
 	 */
 private:
 	template<typename Component, typename... Components>
 	[[nodiscard]] auto view(type<conjunction<Component, Components...>>) noexcept {
 		static_assert(unique_types<Component, Components...>);
 
-		std::vector<component_type> other_components;
-		other_components.reserve(sizeof...(Components));
-
-		component_type smallest_component = getComponentIndex<Component>();
-		std::size_t smallest_size = this->components[smallest_component]->size();
+		basic_pool* const pools[] { assure<Component>(), assure<Components>()... };
+		basic_pool* smallest = smallest_pool(pools);
 
-		extract_smallest_component<Components...>(smallest_component, smallest_size, other_components);
+		std::vector<basic_pool*> other_pools;
+		other_pools.reserve(sizeof...(Components));
+		for (basic_pool* pool : pools)
+			if (pool != smallest)
+				other_pools.push_back(pool);
 
-		entity_map* map = this->components[smallest_component];
-		component_map_iterator first(map->begin());
-		component_map_iterator last(map->end());
-
-		auto filter = [this, other_components] (const component_map_iterator& iterator) {
-			for (component_type component : other_components) {
-				auto component_iterator = this->components[component]->find(iterator->first);
-				if (component_iterator == this->components[component]->end())
+		auto filter = [other_pools] (const component_set_iterator& iterator) {
+			for (basic_pool* pool : other_pools)
+				if (!pool->contains(*iterator))
 					return false;
-			}
 
 			return true;
 		};
 
-		auto transform = [] (const component_map_iterator& iterator) {
-			return iterator->first;
+		auto transform = [] (const component_set_iterator& iterator) {
+			return *iterator;
 		};
 
-		return filter_transform_view<conjunction<Component, Components...>>(first, last, filter, transform);
+		return filter_transform_view<conjunction<Component, Components...>>(smallest->begin(), smallest->end(), filter, transform);
 	}
 
 	/**
@@ -725,14 +939,14 @@ public:
 		component_vector_iterator last = components.end();
 
 		auto filter = [entity] (const component_vector_iterator& iterator) {
-			entity_map* map = *iterator;
+			basic_pool* pool = iterator->get();
 
-			return map->find(entity) != map->end();
+			return pool != nullptr && pool->contains(entity);
 		};
 
 		auto transform = [first, entity] (const component_vector_iterator& iterator) {
-			entity_map* map = *iterator;
-			auto p =  std::make_pair(std::distance(first, iterator), map->at(entity));
+			basic_pool* pool = iterator->get();
+			auto p = std::make_pair(std::distance(first, iterator), Ref<RefCountable>(pool->get_erased(entity)));
 			return p;
 		};
 
@@ -786,6 +1000,36 @@ public:
 			return view(type<conjunction<Type...>>{});
 		
 	}
+
+	/**
+	 * Calls func(entity, Component&, Components&...) for all entities having all the given components
+	 * With a single component the pool is walked in the order it is stored in, without any lookup
+	 * func must not add or remove components of the given types
+	 */
+	template<typename Component, typename... Components, typename Func>
+	void each(const Func& func) {
+		static_assert(unique_types<Component, Components...>);
+
+		component_pool<Component>* first = assure<Component>();
+		if constexpr (sizeof...(Components) == 0) {
+			for (std::uint32_t position = 0; position < first->size(); position++)
+				func(static_cast<entity_type>(first->at(position)), first->component_at(position));
+		} else {
+			std::tuple<component_pool<Components>*...> other_pools { assure<Components>()... };
+			basic_pool* const pools[] { first, std::get<component_pool<Components>*>(other_pools)... };
+			basic_pool* smallest = smallest_pool(pools);
+
+			for (entity_type entity : *smallest) {
+				std::uint32_t position = first->position(entity);
+				if (position == basic_pool::null_position)
+					continue;
+
+				std::tuple<Components*...> others { std::get<component_pool<Components>*>(other_pools)->get(entity)... };
+				if (((std::get<Components*>(others) != nullptr) && ...))
+					func(entity, first->component_at(position), *std::get<Components*>(others)...);
+			}
+		}
+	}
 };
 
 typedef Registry<std::uint16_t> Registry16;
@@ -2,10 +2,16 @@
 
 #include "import.h"
 
-#include <fstream>
+#include <charconv>
+#include <cstring>
+#include <iterator>
+#include <memory>
 
 #include "../util/stringUtil.h"
+#include "../util/fileUtils.h"
+#include "../util/mappedFile.h"
 #include "../physics/physical.h"
+#include "../physics/threading/jobSystem.h"
 #include "../graphics/visualShape.h"
 
 namespace P3D {
@@ -110,28 +116,19 @@ T Import::read(std::istream& input) {
 
 /*
 	OBJImport
+
+	Files are parsed straight from memory. Text files are split into chunks at line boundaries, which are parsed in parallel
+	into vertex and face streams of their own. Face indices in OBJ files count from the start of the file, so merging the chunks
+	is only a matter of writing their streams into the final mesh at the offset of the chunk.
 */
 
+// text files are split into chunks of about this size, files of a single chunk are parsed on the calling thread
+#define OBJ_CHUNK_SIZE (1 << 20)
+
 struct Vertex {
 	int position = -1;
 	int normal = -1;
 	int uv = -1;
-
-	inline Vertex(const std::string& line) {
-		std::vector<std::string> tokens = Util::split(line, '/');
-		size_t length = tokens.size();
-
-		// Positions
-		position = std::stoi(tokens[0]) - 1;
-
-		// Uvs
-		if (length > 1) 
-			uv = tokens[1].size() > 0 ? std::stoi(tokens[1]) - 1 : -1;
-
-		// Normals
-		if (length > 2)
-			normal = tokens[2].size() > 0 ? std::stoi(tokens[2]) - 1 : -1;
-	}
 };
 
 struct Flags {
@@ -167,124 +164,399 @@ struct Face {
 	}
 };
 
-Graphics::VisualShape reorder(const std::vector<Vec3f>& positions, const std::vector<Vec3f>& normals, const std::vector<Vec2f>& uvs, const std::vector<Face>& faces, const Flags& flags) {
-	
-	// Positions
-	Vec3f* positionArray = new Vec3f[positions.size()];
-	for (int i = 0; i < positions.size(); i++) 
-		positionArray[i] = positions[i];
-	
+struct OBJChunk {
+	const char* begin;
+	const char* end;
+
+	std::vector<Vec3f> positions;
+	std::vector<Vec3f> normals;
+	std::vector<Vec2f> uvs;
+	std::vector<Face> faces;
+
+	// offsets of the streams of this chunk in the whole file
+	std::size_t firstPosition = 0;
+	std::size_t firstNormal = 0;
+	std::size_t firstUV = 0;
+	std::size_t firstFace = 0;
+
+	// chunks may be processed on a worker, so errors are stored instead of thrown
+	const char* error = nullptr;
+
+	OBJChunk(const char* begin, const char* end) : begin(begin), end(end) {}
+};
+
+static inline bool isSpace(char c) {
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline const char* skipSpaces(const char* cur, const char* end) {
+	while (cur != end && isSpace(*cur))
+		cur++;
+
+	return cur;
+}
+
+// returns the end of the parsed number, or nullptr if there is no number at cur
+template<typename T>
+static inline const char* parseNumber(const char* cur, const char* end, T& result) {
+	cur = skipSpaces(cur, end);
+	if (cur != end && *cur == '+')
+		cur++;
+
+	std::from_chars_result parsed = std::from_chars(cur, end, result);
+	return parsed.ec == std::errc() ? parsed.ptr : nullptr;
+}
+
+// parses a face vertex of the form position[/[uv][/normal]], the indices in the file start at 1
+static const char* parseVertex(const char* cur, const char* end, Vertex& vertex) {
+	cur = parseNumber(cur, end, vertex.position);
+	if (cur == nullptr)
+		return nullptr;
+	vertex.position--;
+
+	// Uvs
+	if (cur == end || *cur != '/')
+		return cur;
+	cur++;
+	if (cur != end && *cur != '/') {
+		cur = parseNumber(cur, end, vertex.uv);
+		if (cur == nullptr)
+			return nullptr;
+		vertex.uv--;
+	}
+
+	// Normals
+	if (cur == end || *cur != '/')
+		return cur;
+	cur++;
+	if (cur != end && !isSpace(*cur)) {
+		cur = parseNumber(cur, end, vertex.normal);
+		if (cur == nullptr)
+			return nullptr;
+		vertex.normal--;
+	}
+
+	return cur;
+}
+
+// parses a line without its line ending
+static void parseLine(const char* cur, const char* end, OBJChunk& chunk) {
+	cur = skipSpaces(cur, end);
+	const char* keyword = cur;
+	while (cur != end && !isSpace(*cur))
+		cur++;
+	std::size_t keywordLength = cur - keyword;
+
+	if (keywordLength == 1 && keyword[0] == 'v') {
+		Vec3f vertex;
+		if (!(cur = parseNumber(cur, end, vertex.x)) || !(cur = parseNumber(cur, end, vertex.y)) || !(cur = parseNumber(cur, end, vertex.z)))
+			chunk.error = "Invalid vertex in OBJ file";
+		else
+			chunk.positions.push_back(vertex);
+	} else if (keywordLength == 1 && keyword[0] == 'f') {
+		// polygons are split into a fan of triangles around their first vertex
+		Vertex first;
+		Vertex previous;
+		if (!(cur = parseVertex(cur, end, first)) || !(cur = parseVertex(cur, end, previous))) {
+			chunk.error = "Invalid face in OBJ file";
+			return;
+		}
+
+		std::size_t triangleCount = 0;
+		while ((cur = skipSpaces(cur, end)) != end) {
+			Vertex current;
+			if (!(cur = parseVertex(cur, end, current))) {
+				chunk.error = "Invalid face in OBJ file";
+				return;
+			}
+			chunk.faces.emplace_back(first, previous, current);
+			previous = current;
+			triangleCount++;
+		}
+
+		if (triangleCount == 0)
+			chunk.error = "Face with less than 3 vertices in OBJ file";
+	} else if (keywordLength == 2 && keyword[0] == 'v' && keyword[1] == 't') {
+		Vec2f uv;
+		if (!(cur = parseNumber(cur, end, uv.x)) || !(cur = parseNumber(cur, end, uv.y)))
+			chunk.error = "Invalid uv in OBJ file";
+		else
+			chunk.uvs.push_back(uv);
+	} else if (keywordLength == 2 && keyword[0] == 'v' && keyword[1] == 'n') {
+		Vec3f normal;
+		if (!(cur = parseNumber(cur, end, normal.x)) || !(cur = parseNumber(cur, end, normal.y)) || !(cur = parseNumber(cur, end, normal.z)))
+			chunk.error = "Invalid normal in OBJ file";
+		else
+			chunk.normals.push_back(normal);
+	}
+}
+
+static void parseChunk(OBJChunk& chunk) {
+	const char* cur = chunk.begin;
+	while (cur != chunk.end && chunk.error == nullptr) {
+		const char* lineEnd = static_cast<const char*>(std::memchr(cur, '\n', chunk.end - cur));
+		if (lineEnd == nullptr)
+			lineEnd = chunk.end;
+
+		parseLine(cur, lineEnd, chunk);
+
+		cur = lineEnd == chunk.end ? lineEnd : lineEnd + 1;
+	}
+}
+
+// splits the text into chunks of whole lines
+static std::vector<OBJChunk> splitChunks(const char* begin, const char* end) {
+	std::vector<OBJChunk> chunks;
+	const char* chunkBegin = begin;
+	while (chunkBegin != end) {
+		const char* chunkEnd = end;
+		if (static_cast<std::size_t>(end - chunkBegin) > OBJ_CHUNK_SIZE) {
+			const char* lineEnd = static_cast<const char*>(std::memchr(chunkBegin + OBJ_CHUNK_SIZE, '\n', end - chunkBegin - OBJ_CHUNK_SIZE));
+			if (lineEnd != nullptr)
+				chunkEnd = lineEnd + 1;
+		}
+
+		chunks.emplace_back(chunkBegin, chunkEnd);
+		chunkBegin = chunkEnd;
+	}
+
+	return chunks;
+}
+
+// runs func on every chunk, in parallel if a jobSystem is given
+template<typename Func>
+static void forEachChunk(JobSystem* jobSystem, std::vector<OBJChunk>& chunks, const Func& func) {
+	if (jobSystem == nullptr) {
+		for (OBJChunk& chunk : chunks)
+			func(chunk);
+
+		return;
+	}
+
+	jobSystem->parallelFor(chunks.size(), 1, [&chunks, &func](std::size_t begin, std::size_t end) {
+		for (std::size_t i = begin; i < end; i++)
+			func(chunks[i]);
+	});
+}
+
+static void throwChunkErrors(const std::vector<OBJChunk>& chunks) {
+	for (const OBJChunk& chunk : chunks) {
+		if (chunk.error != nullptr)
+			throw chunk.error;
+	}
+}
+
+static bool isValidIndex(int index, std::size_t count, bool optional) {
+	if (index == -1)
+		return optional;
+
+	return index >= 0 && static_cast<std::size_t>(index) < count;
+}
+
+Graphics::VisualShape buildShape(std::vector<OBJChunk>& chunks, JobSystem* jobSystem) {
+	std::size_t positionCount = 0;
+	std::size_t normalCount = 0;
+	std::size_t uvCount = 0;
+	std::size_t faceCount = 0;
+	for (OBJChunk& chunk : chunks) {
+		chunk.firstPosition = positionCount;
+		chunk.firstNormal = normalCount;
+		chunk.firstUV = uvCount;
+		chunk.firstFace = faceCount;
+		positionCount += chunk.positions.size();
+		normalCount += chunk.normals.size();
+		uvCount += chunk.uvs.size();
+		faceCount += chunk.faces.size();
+	}
+	Flags flags = { normalCount != 0, uvCount != 0 };
+
+	// Positions and triangles go straight into the mesh, normals and uvs are looked up through the faces
+	EditableMesh mesh(static_cast<int>(positionCount), static_cast<int>(faceCount));
+	std::vector<Vec3f> normals(normalCount);
+	std::vector<Vec2f> uvs(uvCount);
+	forEachChunk(jobSystem, chunks, [&](OBJChunk& chunk) {
+		for (std::size_t i = 0; i < chunk.positions.size(); i++)
+			mesh.setVertex(static_cast<int>(chunk.firstPosition + i), chunk.positions[i]);
+
+		std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + chunk.firstNormal);
+		std::copy(chunk.uvs.begin(), chunk.uvs.end(), uvs.begin() + chunk.firstUV);
+
+		for (std::size_t i = 0; i < chunk.faces.size(); i++) {
+			const Face& face = chunk.faces[i];
+			for (int j = 0; j < 3; j++) {
+				if (!isValidIndex(face[j].position, positionCount, false) || !isValidIndex(face[j].normal, normalCount, true) || !isValidIndex(face[j].uv, uvCount, true)) {
+					chunk.error = "Face index out of range in OBJ file";
+					return;
+				}
+			}
+
+			mesh.setTriangle(static_cast<int>(chunk.firstFace + i), face.v1.position, face.v2.position, face.v3.position);
+		}
+	});
+	throwChunkErrors(chunks);
+
 	// Normals
 	Vec3f* normalArray = nullptr;
-	if (flags.normals) 
-		normalArray = new Vec3f[positions.size()];
+	if (flags.normals)
+		normalArray = new Vec3f[positionCount];
 
 	// UVs
 	Vec2f* uvArray = nullptr;
 	Vec3f* tangentArray = nullptr;
 	Vec3f* bitangentArray = nullptr;
 	if (flags.uvs) {
-		uvArray = new Vec2f[positions.size()];
-		tangentArray = new Vec3f[positions.size()];
-		bitangentArray = new Vec3f[positions.size()];
+		uvArray = new Vec2f[positionCount];
+		tangentArray = new Vec3f[positionCount];
+		bitangentArray = new Vec3f[positionCount];
 	}
-	// Triangles
-	Triangle* triangleArray = new Triangle[faces.size()];
-	for (int i = 0; i < faces.size(); i++) {
-		const Face& face = faces[i];
-
-		// Save triangle
-		triangleArray[i] = { face.v1.position, face.v2.position, face.v3.position };
-
-		// Calculate (bi)tangents
-		Vec3f tangent;
-		Vec3f bitangent;
-		if (flags.uvs) {
-			Vec3f edge1 = positions[face.v2.position] - positions[face.v1.position];
-			Vec3f edge2 = positions[face.v3.position] - positions[face.v1.position];
-			Vec2f dUV1 = uvs[face.v2.uv] - uvs[face.v1.uv];
-			Vec2f dUV2 = uvs[face.v3.uv] - uvs[face.v1.uv];
-
-			float f = 1.0f / (dUV1.x * dUV2.y - dUV2.x * dUV1.y);
 
-			tangent.x = f * (dUV2.y * edge1.x - dUV1.y * edge2.x);
-			tangent.y = f * (dUV2.y * edge1.y - dUV1.y * edge2.y);
-			tangent.z = f * (dUV2.y * edge1.z - dUV1.y * edge2.z);
-			tangent = normalize(tangent);
-
-			bitangent.x = f * (-dUV2.x * edge1.x + dUV1.x * edge2.x);
-			bitangent.y = f * (-dUV2.x * edge1.y + dUV1.x * edge2.y);
-			bitangent.z = f * (-dUV2.x * edge1.z + dUV1.x * edge2.z);
-			bitangent = normalize(bitangent);
+	// Vertices shared by several faces get the attributes of the last face, so this is done in file order
+	if (flags.normals || flags.uvs) {
+		for (const OBJChunk& chunk : chunks) {
+			for (const Face& face : chunk.faces) {
+				// Calculate (bi)tangents
+				Vec3f tangent;
+				Vec3f bitangent;
+				if (flags.uvs && face.v1.uv != -1 && face.v2.uv != -1 && face.v3.uv != -1) {
+					Vec3f edge1 = mesh.getVertex(face.v2.position) - mesh.getVertex(face.v1.position);
+					Vec3f edge2 = mesh.getVertex(face.v3.position) - mesh.getVertex(face.v1.position);
+					Vec2f dUV1 = uvs[face.v2.uv] - uvs[face.v1.uv];
+					Vec2f dUV2 = uvs[face.v3.uv] - uvs[face.v1.uv];
+
+					float f = 1.0f / (dUV1.x * dUV2.y - dUV2.x * dUV1.y);
+
+					tangent.x = f * (dUV2.y * edge1.x - dUV1.y * edge2.x);
+					tangent.y = f * (dUV2.y * edge1.y - dUV1.y * edge2.y);
+					tangent.z = f * (dUV2.y * edge1.z - dUV1.y * edge2.z);
+					tangent = normalize(tangent);
+
+					bitangent.x = f * (-dUV2.x * edge1.x + dUV1.x * edge2.x);
+					bitangent.y = f * (-dUV2.x * edge1.y + dUV1.x * edge2.y);
+					bitangent.z = f * (-dUV2.x * edge1.z + dUV1.x * edge2.z);
+					bitangent = normalize(bitangent);
+				}
+
+				for (int i = 0; i < 3; i++) {
+					const Vertex& vertex = face[i];
+
+					// Save normal
+					if (flags.normals && vertex.normal != -1)
+						normalArray[vertex.position] = normals[vertex.normal];
+
+					// Save uv
+					if (flags.uvs && vertex.uv != -1) {
+						Vec2f uv = Vec2f(uvs[vertex.uv].x, 1.0 - uvs[vertex.uv].y);
+						uvArray[vertex.position] = uv;
+						tangentArray[vertex.position] = tangent;
+						bitangentArray[vertex.position] = bitangent;
+					}
+				}
+			}
 		}
+	}
+
+	return Graphics::VisualShape(TriangleMesh(std::move(mesh)), SharedArrayPtr<const Vec3f>(normalArray), SharedArrayPtr<const Vec2f>(uvArray), SharedArrayPtr<const Vec3f>(tangentArray), SharedArrayPtr<const Vec3f>(bitangentArray));
+}
 
-		for (int i = 0; i < 3; i++) {
-			const Vertex& vertex = face[i];
+static JobSystem* importJobSystem = nullptr;
 
-			// Save normal
-			if (flags.normals && vertex.normal != -1) 
-				normalArray[vertex.position] = normals[vertex.normal];
+void OBJImport::setJobSystem(JobSystem* jobSystem) {
+	importJobSystem = jobSystem;
+}
 
-			// Save uv
-			if (flags.uvs && vertex.uv != -1) {
-				Vec2f uv = Vec2f(uvs[vertex.uv].x, 1.0 - uvs[vertex.uv].y);
-				uvArray[vertex.position] = uv;
-				tangentArray[vertex.position] = tangent;
-				bitangentArray[vertex.position] = bitangent;
-			}
-		}
+// the workers given to setJobSystem, or workers started on the first large import and kept for all later ones
+static JobSystem& getImportJobSystem() {
+	if (importJobSystem == nullptr) {
+		static JobSystem ownJobSystem;
+		return ownJobSystem;
 	}
 
-	return Graphics::VisualShape(positionArray, (int) positions.size(), triangleArray, (int) faces.size(), SharedArrayPtr<const Vec3f>(normalArray), SharedArrayPtr<const Vec2f>(uvArray), SharedArrayPtr<const Vec3f>(tangentArray), SharedArrayPtr<const Vec3f>(bitangentArray));
+	return *importJobSystem;
+}
+
+Graphics::VisualShape loadNonBinaryObj(const char* begin, const char* end) {
+	std::vector<OBJChunk> chunks = splitChunks(begin, end);
+
+	// using the workers only pays off for files of several chunks
+	JobSystem* jobSystem = chunks.size() > 1 ? &getImportJobSystem() : nullptr;
+
+	forEachChunk(jobSystem, chunks, parseChunk);
+	throwChunkErrors(chunks);
+
+	return buildShape(chunks, jobSystem);
+}
+
+// copies count values of T from cur and advances it past them
+template<typename T>
+static void readBinary(const char*& cur, const char* end, T* result, std::size_t count) {
+	std::size_t size = sizeof(T) * count;
+	if (static_cast<std::size_t>(end - cur) < size)
+		throw "Unexpected end of binary OBJ file";
+
+	std::memcpy(result, cur, size);
+	cur += size;
 }
 
-Graphics::VisualShape loadBinaryObj(std::istream& input) {
-	char flag = Import::read<char>(input);
-	int vertexCount = Import::read<int>(input);
-	int triangleCount = Import::read<int>(input);
+Graphics::VisualShape loadBinaryObj(const char* cur, const char* end) {
+	char flag;
+	int vertexCount;
+	int triangleCount;
+	readBinary(cur, end, &flag, 1);
+	readBinary(cur, end, &vertexCount, 1);
+	readBinary(cur, end, &triangleCount, 1);
+
+	if (vertexCount < 0 || triangleCount < 0)
+		throw "Negative vertex or triangle count in binary OBJ file";
 
 	char V = 0;
 	char VN = 1;
 	char VT = 2;
 	char VNT = 3;
 
-	Vec3f* vertices = new Vec3f[vertexCount];
-	for (int i = 0; i < vertexCount; i++) {
-		Vec3 vertex = Import::read<Vec3f>(input);
+	bool hasNormals = flag == VN || flag == VNT;
+	bool hasUVs = flag == VT || flag == VNT;
 
-		vertices[i] = vertex;
-	}
+	// the counts are checked against the size of the file before anything is allocated for them
+	std::size_t vertexSize = sizeof(Vec3f) + (hasNormals ? sizeof(Vec3f) : 0) + (hasUVs ? sizeof(Vec2f) : 0);
+	std::size_t size = vertexSize * static_cast<std::size_t>(vertexCount) + sizeof(Triangle) * static_cast<std::size_t>(triangleCount);
+	if (static_cast<std::size_t>(end - cur) < size)
+		throw "Unexpected end of binary OBJ file";
 
-	Vec3f* normals = nullptr;
-	if (flag == VN || flag == VNT) {
-		normals = new Vec3f[vertexCount];
+	std::unique_ptr<Vec3f[]> vertices(new Vec3f[vertexCount]);
+	readBinary(cur, end, vertices.get(), vertexCount);
 
-		for (int i = 0; i < vertexCount; i++) {
-			normals[i] = Import::read<Vec3f>(input);
-		}
+	std::unique_ptr<Vec3f[]> normals;
+	if (hasNormals) {
+		normals.reset(new Vec3f[vertexCount]);
+		readBinary(cur, end, normals.get(), vertexCount);
 	}
 
-	Vec2f* uvs = nullptr;
-	Vec3f* tangents = nullptr;
-	Vec3f* bitangents = nullptr;
-	if (flag == VT || flag == VNT) {
-		uvs = new Vec2f[vertexCount];
-		tangents = new Vec3f[vertexCount];
-		bitangents = new Vec3f[vertexCount];
-
-		for (int i = 0; i < vertexCount; i++) {
-			uvs[i] = Import::read<Vec2f>(input);
-		}
+	std::unique_ptr<Vec2f[]> uvs;
+	std::unique_ptr<Vec3f[]> tangents;
+	std::unique_ptr<Vec3f[]> bitangents;
+	if (hasUVs) {
+		uvs.reset(new Vec2f[vertexCount]);
+		tangents.reset(new Vec3f[vertexCount]);
+		bitangents.reset(new Vec3f[vertexCount]);
+		readBinary(cur, end, uvs.get(), vertexCount);
 	}
 
-	Triangle* triangles = new Triangle[triangleCount];
+	std::unique_ptr<Triangle[]> triangles(new Triangle[triangleCount]);
+	readBinary(cur, end, triangles.get(), triangleCount);
+
 	for (int i = 0; i < triangleCount; i++) {
-		Triangle triangle = Import::read<Triangle>(input);
+		const Triangle& triangle = triangles[i];
+		for (int j = 0; j < 3; j++) {
+			if (!isValidIndex(triangle[j], vertexCount, false))
+				throw "Triangle index out of range in binary OBJ file";
+		}
+	}
 
-		triangles[i] = triangle;
+	// Calculate (bi)tangents
+	if (hasUVs) {
+		for (int i = 0; i < triangleCount; i++) {
+			Triangle triangle = triangles[i];
 
-		// Calculate (bi)tangents
-		if (flag == VT || flag == VNT) {
 			Vec3f tangent;
 			Vec3f bitangent;
 
@@ -311,58 +583,20 @@ Graphics::VisualShape loadBinaryObj(std::istream& input) {
 		}
 	}
 
-	return Graphics::VisualShape(vertices, vertexCount, triangles, triangleCount, SharedArrayPtr<const Vec3f>(normals), SharedArrayPtr<const Vec2f>(uvs), SharedArrayPtr<const Vec3f>(tangents), SharedArrayPtr<const Vec3f>(bitangents));
-}
-
-Graphics::VisualShape loadNonBinaryObj(std::istream& input) {
-	std::vector<Vec3f> vertices;
-	std::vector<Vec3f> normals;
-	std::vector<Vec2f> uvs;
-	std::vector<Face> faces;
-	Flags flags = { false, false };
-
-	std::string line;
-	while (getline(input, line)) {
-		std::vector<std::string> tokens = Util::split(line, ' ');
-
-		if (tokens.size() == 0)
-			continue;
-
-		if (tokens[0] == "v") {
-			Vec3f vertex = Vec3f(stof(tokens[1]), stof(tokens[2]), stof(tokens[3]));
-			vertices.push_back(vertex);
-		} else if (tokens[0] == "f") {
-			Vertex v1(tokens[1]);
-			Vertex v2(tokens[2]);
-			Vertex v3(tokens[3]);
-
-			Face face = Face(v1, v2, v3);
-			faces.push_back(face);
-
-			if (tokens.size() > 4) {
-				Vertex v4 = tokens[4];
-				Face face = Face(v1, v3, v4);
-				faces.push_back(face);
-			}
-		} else if (tokens[0] == "vt") {
-			flags.uvs = true;
-			Vec2f uv = Vec2f(stof(tokens[1]), stof(tokens[2]));
-			uvs.push_back(uv);
-		} else if (tokens[0] == "vn") {
-			flags.normals = true;
-			Vec3f normal = Vec3f(stof(tokens[1]), stof(tokens[2]), stof(tokens[3]));
-			normals.push_back(normal);
-		}
-	}
-
-	return reorder(vertices, normals, uvs, faces, flags);
+	// the shape copies the vertices and triangles into its own layout and takes over the other arrays
+	return Graphics::VisualShape(vertices.get(), vertexCount, triangles.get(), triangleCount, SharedArrayPtr<const Vec3f>(normals.release()), SharedArrayPtr<const Vec2f>(uvs.release()), SharedArrayPtr<const Vec3f>(tangents.release()), SharedArrayPtr<const Vec3f>(bitangents.release()));
 }
 
 Graphics::VisualShape OBJImport::load(std::istream& file, bool binary) {
+	// the parsers work on memory, so the stream is read in one go
+	std::string content{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+	const char* begin = content.data();
+	const char* end = begin + content.size();
+
 	if (binary)
-		return loadBinaryObj(file);
+		return loadBinaryObj(begin, end);
 	else
-		return loadNonBinaryObj(file);
+		return loadNonBinaryObj(begin, end);
 }
 
 Graphics::VisualShape OBJImport::load(const std::string& file) {
@@ -378,30 +612,24 @@ Graphics::VisualShape OBJImport::load(const std::string& file) {
 }
 
 Graphics::VisualShape OBJImport::load(const std::string& file, bool binary) {
-	/*struct stat buffer;
-	if (stat(file.c_str(), &buffer) == -1) {
-		Log::subject(file.c_str());
+	if (!Util::doesFileExist(file)) {
 		Log::error("File not found: %s", file.c_str());
 
 		return Graphics::VisualShape();
-	}*/
+	}
 
-	std::ifstream input;
+	Util::MappedFile mappedFile(file);
+	const char* begin = mappedFile.getData();
+	const char* end = begin + mappedFile.getSize();
 
 	if (binary)
-		input.open(file, std::ios::binary);
+		return loadBinaryObj(begin, end);
 	else
-		input.open(file);
-
-	Graphics::VisualShape shape = load(input, binary);
-
-	input.close();
-
-	return shape;
+		return loadNonBinaryObj(begin, end);
 }
 
 /*
 	End of OBJImport
 */
 
-};
\ No newline at end of file
+};
@@ -2,6 +2,8 @@
 
 #include <istream>
 
+class JobSystem;
+
 namespace P3D::Graphics {
 struct VisualShape;
 };
@@ -30,6 +32,9 @@ namespace OBJImport {
 	Graphics::VisualShape load(std::istream& file, bool binary = false);
 	Graphics::VisualShape load(const std::string& file, bool binary);
 	Graphics::VisualShape load(const std::string& file);
+
+	// large text files are parsed on these workers, without them a JobSystem is started by the first large import and kept
+	void setJobSystem(JobSystem* jobSystem);
 };
 
 };
\ No newline at end of file
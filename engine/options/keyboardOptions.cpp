@@ -38,6 +38,7 @@ namespace KeyboardOptions {
 		Key tree    = Keyboard::KEY_UNKNOWN;
 		Key pies    = Keyboard::KEY_UNKNOWN;
 		Key frame   = Keyboard::KEY_UNKNOWN;
+		Key trace   = Keyboard::KEY_UNKNOWN;
 	};
 
 	namespace Edit {
@@ -97,6 +98,7 @@ namespace KeyboardOptions {
 		Debug::tree = loadKey(properties, "debug.tree");
 		Debug::pies = loadKey(properties, "debug.pies");
 		Debug::frame = loadKey(properties, "debug.frame");
+		Debug::trace = loadKey(properties, "debug.trace");
 
 		// Part
 		Part::anchor = loadKey(properties, "part.anchor");
@@ -144,6 +146,7 @@ namespace KeyboardOptions {
 		saveKey(properties, "debug.tree", Debug::tree);
 		saveKey(properties, "debug.pies", Debug::pies);
 		saveKey(properties, "debug.frame", Debug::frame);
+		saveKey(properties, "debug.trace", Debug::trace);
 
 		// Part
 		saveKey(properties, "part.anchor", Part::anchor);
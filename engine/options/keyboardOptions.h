@@ -41,6 +41,7 @@ namespace KeyboardOptions {
 		extern Key tree;
 		extern Key pies;
 		extern Key frame;
+		extern Key trace;
 	};
 
 	namespace Edit {
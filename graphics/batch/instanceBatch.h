@@ -45,18 +45,23 @@ public:
 	}
 
 	void submit() {
+		submit(uniformBuffer.data(), uniformBuffer.size());
+
+		clear();
+	}
+
+	// Draws count instances straight from uniforms, which must be contiguous
+	void submit(const Uniform* uniforms, std::size_t count) {
 		if (mesh < 0 || mesh >= MeshRegistry::meshes.size()) {
 			Log::error("Trying to sumbit a mesh that has not been registered in the mesh registry");
 			return;
 		}
 
-		if (uniformBuffer.empty())
+		if (count == 0)
 			return;
 		
-		MeshRegistry::meshes[mesh]->fillUniformBuffer((const void*) uniformBuffer.data(), uniformBuffer.size() * sizeof(Uniform), Renderer::STREAM_DRAW);
-		MeshRegistry::meshes[mesh]->renderInstanced(uniformBuffer.size());
-
-		clear();
+		MeshRegistry::meshes[mesh]->fillUniformBuffer((const void*) uniforms, count * sizeof(Uniform), Renderer::STREAM_DRAW);
+		MeshRegistry::meshes[mesh]->renderInstanced(count);
 	}
 
 	void clear() {
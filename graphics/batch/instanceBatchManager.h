@@ -3,6 +3,7 @@
 #include <unordered_map>
 #include "../util/log.h"
 #include "instanceBatch.h"
+#include "renderList.h"
 #include "../buffers/bufferLayout.h"
 
 namespace P3D::Graphics {
@@ -13,6 +14,14 @@ private:
 	BufferLayout uniformBufferLayout;
 	std::unordered_map<GLID, InstanceBatch<Uniform>*> batches;
 
+	InstanceBatch<Uniform>* getOrCreateBatch(GLID mesh) {
+		auto iterator = batches.find(mesh);
+		if (iterator == batches.end()) 
+			iterator = batches.insert(std::make_pair(mesh, new InstanceBatch<Uniform>(mesh, uniformBufferLayout))).first;
+
+		return iterator->second;
+	}
+
 public:
 	InstanceBatchManager(const BufferLayout& uniformBufferLayout) : uniformBufferLayout(uniformBufferLayout) {}
 
@@ -23,11 +32,19 @@ public:
 			return;
 		}
 
-		auto iterator = batches.find(mesh);
-		if (iterator == batches.end()) 
-			iterator = batches.insert(std::make_pair(mesh, new InstanceBatch<Uniform>(mesh, uniformBufferLayout))).first;
+		getOrCreateBatch(mesh)->add(std::forward<Args>(uniform)...);
+	}
+
+	// Draws the opaque instances of a render list, every mesh straight from its range of the list
+	void submit(const RenderList<Uniform>& renderList) {
+		for (const typename RenderList<Uniform>::MeshRange& range : renderList.meshRanges) {
+			if (range.mesh >= MeshRegistry::meshes.size()) {
+				Log::error("Trying to submit a mesh that has not been registered in the mesh registry");
+				continue;
+			}
 
-		iterator->second->add(std::forward<Args>(uniform)...);
+			getOrCreateBatch(range.mesh)->submit(renderList.instances.data() + range.first, range.count);
+		}
 	}
 
 	void submit(GLID mesh) {
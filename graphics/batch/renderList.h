@@ -0,0 +1,190 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+
+#include "../../physics/threading/jobSystem.h"
+
+namespace P3D::Graphics {
+
+/*
+	The draws of one frame, built on the CPU without any GL call
+
+	The opaque instances of every mesh are contiguous in instances, so each range can be uploaded as the uniform buffer of its mesh at once
+	Transparent draws are sorted back to front
+*/
+template<typename Uniform>
+struct RenderList {
+	struct MeshRange {
+		int mesh;
+		std::size_t first;
+		std::size_t count;
+	};
+
+	struct TransparentDraw {
+		int mesh;
+		float depth;
+		// index of the item the draw was made from
+		std::uint32_t item;
+		Uniform uniform;
+	};
+
+	std::vector<Uniform> instances;
+	std::vector<MeshRange> meshRanges;
+	std::vector<TransparentDraw> transparents;
+
+	void clear() {
+		instances.clear();
+		meshRanges.clear();
+		transparents.clear();
+	}
+};
+
+/*
+	Builds RenderLists from the visible items of a frame, spread over the workers of a JobSystem
+
+	Items need the fields
+		int mesh: index of the mesh in the MeshRegistry, at least 0
+		float depth: distance to the camera, or any value that grows with it, at least 0
+		bool transparent
+	Items are processed in chunks of CHUNK_SIZE: every chunk counts its instances per mesh, after which every chunk writes its
+	uniforms straight to their final place. The result does not depend on the number of workers.
+	The buffers are kept between frames, so one builder should be reused.
+*/
+template<typename Uniform>
+class RenderListBuilder {
+public:
+	static constexpr std::size_t CHUNK_SIZE = 512;
+
+private:
+	// chunkCounts[chunk * meshCount + mesh] is first the count of that chunk, then the offset it writes to
+	std::vector<std::size_t> chunkCounts;
+	std::vector<std::size_t> chunkTransparentOffsets;
+	std::vector<std::uint32_t> sortKeys;
+	std::vector<std::uint32_t> sortScratchKeys;
+	std::vector<std::uint32_t> sortOrder;
+	std::vector<std::uint32_t> sortScratchOrder;
+	std::vector<typename RenderList<Uniform>::TransparentDraw> unsortedTransparents;
+
+	template<typename Func>
+	static void forEachChunk(JobSystem* jobs, std::size_t chunkCount, const Func& func) {
+		if(jobs != nullptr) {
+			jobs->parallelFor(chunkCount, 1, [&func](std::size_t begin, std::size_t end) {
+				for(std::size_t chunk = begin; chunk < end; chunk++) func(chunk);
+			});
+		} else {
+			for(std::size_t chunk = 0; chunk < chunkCount; chunk++) func(chunk);
+		}
+	}
+
+	/*
+		Sorts unsortedTransparents back to front into result
+		A least significant digit radix sort on the bits of the depth, which order like the depths as the depths are not negative
+	*/
+	void sortTransparents(std::vector<typename RenderList<Uniform>::TransparentDraw>& result) {
+		std::size_t count = unsortedTransparents.size();
+		sortKeys.resize(count);
+		sortScratchKeys.resize(count);
+		sortOrder.resize(count);
+		sortScratchOrder.resize(count);
+		for(std::size_t i = 0; i < count; i++) {
+			std::uint32_t bits;
+			std::memcpy(&bits, &unsortedTransparents[i].depth, sizeof(bits));
+			// inverted, so the furthest draw comes first
+			sortKeys[i] = ~bits;
+			sortOrder[i] = static_cast<std::uint32_t>(i);
+		}
+
+		for(int shift = 0; shift < 32; shift += 8) {
+			std::size_t offsets[256]{};
+			for(std::size_t i = 0; i < count; i++) offsets[(sortKeys[i] >> shift) & 0xFF]++;
+			std::size_t total = 0;
+			for(std::size_t& offset : offsets) {
+				std::size_t digitCount = offset;
+				offset = total;
+				total += digitCount;
+			}
+			for(std::size_t i = 0; i < count; i++) {
+				std::size_t target = offsets[(sortKeys[i] >> shift) & 0xFF]++;
+				sortScratchKeys[target] = sortKeys[i];
+				sortScratchOrder[target] = sortOrder[i];
+			}
+			std::swap(sortKeys, sortScratchKeys);
+			std::swap(sortOrder, sortScratchOrder);
+		}
+
+		result.clear();
+		result.reserve(count);
+		for(std::uint32_t index : sortOrder) result.push_back(unsortedTransparents[index]);
+	}
+
+public:
+	/*
+		Fills result with the draws of items, makeUniform(const Item&) gives the uniform of an item and must be safe to call concurrently
+		jobs may be nullptr, then everything runs on this thread
+	*/
+	template<typename Item, typename MakeUniform>
+	void build(const std::vector<Item>& items, const MakeUniform& makeUniform, JobSystem* jobs, RenderList<Uniform>& result) {
+		result.clear();
+
+		std::size_t meshCount = 0;
+		for(const Item& item : items) meshCount = std::max(meshCount, static_cast<std::size_t>(item.mesh) + 1);
+		std::size_t chunkCount = (items.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+		chunkCounts.assign(chunkCount * meshCount, 0);
+		chunkTransparentOffsets.assign(chunkCount, 0);
+		forEachChunk(jobs, chunkCount, [&](std::size_t chunk) {
+			std::size_t* counts = chunkCounts.data() + chunk * meshCount;
+			std::size_t end = std::min(items.size(), (chunk + 1) * CHUNK_SIZE);
+			for(std::size_t i = chunk * CHUNK_SIZE; i < end; i++) {
+				if(items[i].transparent) {
+					chunkTransparentOffsets[chunk]++;
+				} else {
+					counts[items[i].mesh]++;
+				}
+			}
+		});
+
+		// meshes in order, and within a mesh the chunks in order, so instances keep the order of items
+		std::size_t instanceCount = 0;
+		for(std::size_t mesh = 0; mesh < meshCount; mesh++) {
+			std::size_t first = instanceCount;
+			for(std::size_t chunk = 0; chunk < chunkCount; chunk++) {
+				std::size_t& count = chunkCounts[chunk * meshCount + mesh];
+				std::size_t instancesOfChunk = count;
+				count = instanceCount;
+				instanceCount += instancesOfChunk;
+			}
+			if(instanceCount != first) result.meshRanges.push_back(typename RenderList<Uniform>::MeshRange{static_cast<int>(mesh), first, instanceCount - first});
+		}
+		std::size_t transparentCount = 0;
+		for(std::size_t& offset : chunkTransparentOffsets) {
+			std::size_t transparentsOfChunk = offset;
+			offset = transparentCount;
+			transparentCount += transparentsOfChunk;
+		}
+
+		result.instances.resize(instanceCount);
+		unsortedTransparents.resize(transparentCount);
+		forEachChunk(jobs, chunkCount, [&](std::size_t chunk) {
+			std::size_t* offsets = chunkCounts.data() + chunk * meshCount;
+			std::size_t transparentOffset = chunkTransparentOffsets[chunk];
+			std::size_t end = std::min(items.size(), (chunk + 1) * CHUNK_SIZE);
+			for(std::size_t i = chunk * CHUNK_SIZE; i < end; i++) {
+				const Item& item = items[i];
+				if(item.transparent) {
+					unsortedTransparents[transparentOffset++] = typename RenderList<Uniform>::TransparentDraw{item.mesh, item.depth, static_cast<std::uint32_t>(i), makeUniform(item)};
+				} else {
+					result.instances[offsets[item.mesh]++] = makeUniform(item);
+				}
+			}
+		});
+
+		sortTransparents(result.transparents);
+	}
+};
+
+};
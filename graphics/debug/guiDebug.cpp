@@ -58,17 +58,12 @@ namespace AppDebug {
 ThreePhaseBuffer<ColoredVector> vecBuf(256);
 ThreePhaseBuffer<ColoredPoint> pointBuf(256);
 
+// entries drained from the physics log at the end of a tick
+std::vector<::Debug::LogEntry> drainedLog;
+
 namespace Logging {
 using namespace Debug;
 
-void logVector(Position origin, Vec3 vec, VectorType type) {
-	vecBuf.add(ColoredVector(origin, vec, type));
-}
-
-void logPoint(Position point, PointType type) {
-	pointBuf.add(ColoredPoint(point, type));
-}
-
 void logCFrame(CFrame frame, CFrameType type) {
 	switch (type) {
 		case OBJECT_CFRAME: {
@@ -105,6 +100,16 @@ void logTickStart() {
 }
 
 void logTickEnd() {
+	// everything the physics threads logged during the tick, taken from their ring buffers
+	drainedLog.clear();
+	::Debug::drainLog(drainedLog);
+	for (const ::Debug::LogEntry& entry : drainedLog) {
+		if (entry.isPoint)
+			pointBuf.add(ColoredPoint(entry.origin, static_cast<::Debug::PointType>(entry.type)));
+		else
+			vecBuf.add(ColoredVector(entry.origin, entry.vector, static_cast<::Debug::VectorType>(entry.type)));
+	}
+
 	vecBuf.pushWriteBuffer();
 	pointBuf.pushWriteBuffer();
 }
@@ -119,8 +124,7 @@ void logFrameEnd() {
 
 void setupDebugHooks() {
 	Log::info("Set up debug hooks!");
-	Debug::setVectorLogAction(Logging::logVector);
-	Debug::setPointLogAction(Logging::logPoint);
+	Debug::setLogEnabled(true);
 	Debug::setCFrameLogAction(Logging::logCFrame);
 	Debug::setShapeLogAction(Logging::logShape);
 }
@@ -10,6 +10,7 @@
 #include "font.h"
 #include "../physics/math/constants.h"
 #include "../physics/datastructures/boundsTree.h"
+#include "../physics/misc/threadProfiling.h"
 
 namespace P3D::Graphics {
 
@@ -201,6 +202,45 @@ void renderTreeStructure(const BoundsTree<Part>& tree, const Vec3f& treeColor, V
 
 #pragma endregion
 
+#pragma region ProfileTree
+
+//! ProfileTree
+
+static void recursiveRenderProfileTree(const ProfileTree& tree, int parent, int depth, const char* const* labels, Vec2f origin, double tickCount, int& line) {
+	for (int node = 0; node < static_cast<int>(tree.nodes.size()); node++) {
+		const ProfileTree::Node& zone = tree.nodes[node];
+		if (zone.parent != parent)
+			continue;
+
+		Vec2f linePosition = origin + Vec2f(0, -line * 0.035f);
+		Vec4f color = join(pieColors[zone.zone], 1.0f);
+
+		std::stringstream time;
+		time.precision(4);
+		time << zone.time.count() / 1000000.0 / tickCount << "ms";
+
+		std::stringstream count;
+		count.precision(4);
+		count << zone.count / tickCount << "x";
+
+		Path::text(GUI::font, labels[zone.zone], 0.0006, linePosition + Vec2f(depth * 0.03f, 0), color);
+		Path::text(GUI::font, time.str(), 0.0006, linePosition + Vec2f(0.40f, 0), color);
+		Path::text(GUI::font, count.str(), 0.0006, linePosition + Vec2f(0.60f, 0), color);
+		line++;
+
+		recursiveRenderProfileTree(tree, node, depth + 1, labels, origin, tickCount, line);
+	}
+}
+
+void renderProfileTree(const ProfileTree& tree, const char* title, const char* const* labels, Vec2f origin, double tickCount) {
+	Path::text(GUI::font, title, 0.001, origin, COLOR::WHITE);
+
+	int line = 1;
+	recursiveRenderProfileTree(tree, -1, 0, labels, origin - Vec2f(0, 0.015f), tickCount, line);
+}
+
+#pragma endregion
+
 #pragma region SlidingDataChart
 
 //! SlidingDataChart
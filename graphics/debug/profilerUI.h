@@ -11,6 +11,7 @@ template<typename T>
 struct BoundsTree;
 class Part;
 struct TreeNode;
+class ProfileTree;
 
 namespace P3D::Graphics {
 
@@ -99,4 +100,7 @@ struct SlidingChart : public Component {
 
 void renderTreeStructure(const BoundsTree<Part>& tree, const Color3& treeColor, Vec2f origin, float allottedWidth, const void* selectedObject);
 
+// the zones of a ProfileTree as indented lines with their time and count per tick, labels are indexed by the zones of the nodes
+void renderProfileTree(const ProfileTree& tree, const char* title, const char* const* labels, Vec2f origin, double tickCount = 1.0);
+
 };
\ No newline at end of file
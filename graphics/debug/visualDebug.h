@@ -60,7 +60,7 @@ void addDebugField(Vec2 dimension, Graphics::Font* font, const char* varName, T
 }
 
 template<typename EnumType>
-PieChart toPieChart(BreakdownAverageProfiler<EnumType>& profiler, const char* title, Vec2f piePosition, float pieSize) {
+PieChart toPieChart(HistoricTally<std::chrono::nanoseconds, EnumType>& profiler, const char* title, Vec2f piePosition, float pieSize) {
 	auto results = profiler.history.avg();
 	auto averageTotalTime = results.sum();
 
@@ -11,5 +11,6 @@ struct BallConstraint : public Constraint {
 
 	virtual int maxNumberOfParameters() const override;
 	virtual ConstraintMatrixPack getMatrices(const PhysicalInfo& physA, const PhysicalInfo& physB, double* matrixBuf, double* errorBuf) const override;
+	virtual Constraint* clone() const override { return new BallConstraint(*this); }
 };
 
@@ -38,7 +38,7 @@ void ConstraintGroup::add(Part* first, Part* second, Constraint* constraint) {
 	this->constraints.push_back(PhysicalConstraint(first->parent, second->parent, constraint));
 }
 
-void ConstraintGroup::apply() const {
+std::size_t ConstraintGroup::apply() const {
 	std::size_t maxNumberOfParameters = 0;
 	ConstraintMatrixPack* constraintMatrices = new ConstraintMatrixPack[constraints.size()];
 
@@ -160,4 +160,12 @@ void ConstraintGroup::apply() const {
 		}
 		assert(curParameterIndex == numberOfParams);
 	}
+
+	delete[] constraintMatrices;
+	delete[] matrixBuffer;
+	delete[] errorBuffer;
+
+	return sizeof(ConstraintMatrixPack) * constraints.size()
+		+ sizeof(double) * (std::size_t(24) + NUMBER_OF_ERROR_DERIVATIVES) * maxNumberOfParameters
+		+ sizeof(double) * numberOfParams * numberOfParams;
 }
@@ -26,5 +26,6 @@ struct ConstraintGroup {
 	void add(Physical* first, Physical* second, Constraint* constraint);
 	void add(Part* first, Part* second, Constraint* constraint);
 	
-	void apply() const;
+	// returns the bytes of scratch memory it allocated while solving
+	std::size_t apply() const;
 };
@@ -13,4 +13,5 @@ struct HingeConstraint : public Constraint {
 
 	virtual int maxNumberOfParameters() const override;
 	virtual ConstraintMatrixPack getMatrices(const PhysicalInfo& physA, const PhysicalInfo& physB, double* matrixBuf, double* errorBuf) const override;
+	virtual Constraint* clone() const override { return new HingeConstraint(*this); }
 };
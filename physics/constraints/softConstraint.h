@@ -80,4 +80,6 @@ public:
 struct Constraint {
 	virtual int maxNumberOfParameters() const = 0;
 	virtual ConstraintMatrixPack getMatrices(const PhysicalInfo& physA, const PhysicalInfo& physB, double* matrixBuf, double* errorBuf) const = 0;
+	// returns a new copy of this constraint
+	virtual Constraint* clone() const = 0;
 };
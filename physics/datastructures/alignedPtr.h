@@ -8,26 +8,42 @@
 template<typename T>
 class UniqueAlignedPointer {
 	T* data;
+	// false for memory that is owned elsewhere, see borrow()
+	bool ownsData;
 
 public:
-	UniqueAlignedPointer() : data(nullptr) {}
+	UniqueAlignedPointer() : data(nullptr), ownsData(true) {}
 	UniqueAlignedPointer(std::size_t size, std::size_t align = alignof(T)) : 
-		data(static_cast<T*>(aligned_malloc(sizeof(T)* size, align))) {}
+		data(static_cast<T*>(aligned_malloc(sizeof(T)* size, align))), ownsData(true) {}
 	~UniqueAlignedPointer() {
-		aligned_free(static_cast<void*>(data));
+		if(ownsData) aligned_free(static_cast<void*>(data));
 	}
 
+	/*
+		Wraps memory that is owned by something else, such as a memory mapped file, it is not freed by this pointer
+		The memory must outlive this pointer and every pointer it is moved into
+	*/
+	static UniqueAlignedPointer borrow(T* externalData) {
+		UniqueAlignedPointer result;
+		result.data = externalData;
+		result.ownsData = false;
+		return result;
+	}
+	inline bool isBorrowed() const { return !ownsData; }
+
 	inline T* get() const { return data; }
 	operator T*() const { return data; }
 
 	UniqueAlignedPointer(const UniqueAlignedPointer& other) = delete;
 	UniqueAlignedPointer& operator=(const UniqueAlignedPointer& other) = delete;
 
-	UniqueAlignedPointer(UniqueAlignedPointer&& other) noexcept : data(other.data) {
+	UniqueAlignedPointer(UniqueAlignedPointer&& other) noexcept : data(other.data), ownsData(other.ownsData) {
 		other.data = nullptr;
+		other.ownsData = true;
 	}
 	UniqueAlignedPointer& operator=(UniqueAlignedPointer&& other) noexcept {
 		std::swap(this->data, other.data);
+		std::swap(this->ownsData, other.ownsData);
 
 		return *this;
 	}
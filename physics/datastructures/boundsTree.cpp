@@ -52,6 +52,7 @@ TreeNode TreeNode::withEmptySubNodes() {
 TreeNode::TreeNode(const TreeNode& original) :
 	nodeCount(original.nodeCount),
 	isGroupHead(original.isGroupHead),
+	proxyIndex(original.proxyIndex),
 	bounds(original.bounds) {
 
 	if(original.isLeafNode()) {
@@ -68,6 +69,7 @@ TreeNode& TreeNode::operator=(const TreeNode& original) {
 
 	this->nodeCount = original.nodeCount;
 	this->isGroupHead = original.isGroupHead;
+	this->proxyIndex = original.proxyIndex;
 	this->bounds = original.bounds;
 
 	if(original.isLeafNode()) {
@@ -242,6 +244,17 @@ size_t TreeNode::getLengthOfLongestBranch() const {
 	return best + 1;
 }
 
+size_t TreeNode::getSubNodeMemory() const {
+	if(this->isLeafNode() || this->subTrees == nullptr) return 0;
+
+	// every array of sub nodes is allocated with room for MAX_BRANCHES
+	size_t total = sizeof(TreeNode) * MAX_BRANCHES;
+	for(const TreeNode& subNode : *this) {
+		total += subNode.getSubNodeMemory();
+	}
+	return total;
+}
+
 inline static void transferObject(TreeNode& from, TreeNode& to, size_t index){
 	to.addOutside(std::move(from.subTrees[index]));
 	new(&from.subTrees[index]) TreeNode(std::move(from.subTrees[--from.nodeCount]));
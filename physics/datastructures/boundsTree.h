@@ -7,6 +7,7 @@
 #include "../math/fix.h"
 #include "../math/bounds.h"
 
+#include <cstdint>
 #include <utility>
 #include <new>
 #include <assert.h>
@@ -14,7 +15,7 @@
 
 #define MAX_BRANCHES 4
 #define MAX_HEIGHT 64
-#define LEAF_NODE_SIGNIFIER 0x7FFFFFFF
+#define LEAF_NODE_SIGNIFIER 0x7FFF
 
 struct TreeNode {
 	Bounds bounds;
@@ -22,12 +23,18 @@ struct TreeNode {
 		TreeNode* subTrees;
 		void* object;
 	};
-	int nodeCount;
+	// 16 bits, so proxyIndex fits in what used to be padding and a node stays 64 bytes
+	std::int16_t nodeCount;
 	/* means that the nodes within this node belong to a specific group, if true, the tree will not separate the elements below this one. 
 	New elements will not be added to this group unless specifically specified
 	If false, then no subnodes are allowed to be exchanged with the rest of the tree. This node must be viewed as a black box. 
 	*/
 	bool isGroupHead = false;
+	/*
+		Only used by leaf nodes, the index of object in an array that the owner of the tree keeps in tree order, such as the ColissionProxies of a WorldLayer
+		Lets a walk over the tree find the data of an object without dereferencing object
+	*/
+	std::uint32_t proxyIndex = 0;
 
 	inline bool isLeafNode() const { return nodeCount == LEAF_NODE_SIGNIFIER; }
 
@@ -42,7 +49,7 @@ struct TreeNode {
 	explicit TreeNode(const TreeNode& original);
 	TreeNode& operator=(const TreeNode& original);
 
-	inline TreeNode(TreeNode&& other) noexcept : nodeCount(other.nodeCount), subTrees(other.subTrees), bounds(other.bounds), isGroupHead(other.isGroupHead) {
+	inline TreeNode(TreeNode&& other) noexcept : nodeCount(other.nodeCount), subTrees(other.subTrees), bounds(other.bounds), isGroupHead(other.isGroupHead), proxyIndex(other.proxyIndex) {
 		other.subTrees = nullptr;
 		other.nodeCount = LEAF_NODE_SIGNIFIER;
 	}
@@ -51,6 +58,7 @@ struct TreeNode {
 		std::swap(this->subTrees, other.subTrees);
 		std::swap(this->bounds, other.bounds);
 		std::swap(this->isGroupHead, other.isGroupHead);
+		std::swap(this->proxyIndex, other.proxyIndex);
 		return *this;
 	}
 	
@@ -78,6 +86,8 @@ struct TreeNode {
 
 	size_t getNumberOfObjectsInNode() const;
 	size_t getLengthOfLongestBranch() const;
+	// the bytes of the arrays of sub nodes below this node, not counting this node itself
+	size_t getSubNodeMemory() const;
 };
 
 long long computeCost(const Bounds& bounds);
@@ -299,6 +309,7 @@ struct BoundsTree {
 		std::swap(rootNode.object, other.rootNode.object);
 		std::swap(rootNode.isGroupHead, other.rootNode.isGroupHead);
 		std::swap(rootNode.nodeCount, other.rootNode.nodeCount);
+		std::swap(rootNode.proxyIndex, other.rootNode.proxyIndex);
 		return *this;
 	}
 
@@ -520,6 +531,11 @@ struct BoundsTree {
 		}
 	}
 
+	// the bytes of the sub node arrays of this tree, the root node itself is part of the tree object
+	inline size_t getNodeMemory() const {
+		return this->rootNode.getSubNodeMemory();
+	}
+
 	inline bool areInSameGroup(const Boundable* first, Bounds firstBounds, const Boundable* second, Bounds secondBounds) const {
 		TreeNode* firstGroup = *findGroupFor(first, firstBounds);
 		TreeNode* secondGroup = *findGroupFor(second, secondBounds);
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <assert.h>
+
+/*
+	A bounded lock-free queue for many producers and a single consumer
+
+	Every slot carries a sequence number which tells producers and the consumer whether the slot is free for position pos (sequence == pos),
+	or holds the value pushed at position pos (sequence == pos + 1). Producers claim positions with a CAS on enqueuePos.
+	Positions are handed out in increasing order, and the consumer pops them in that same order, so they can be used as tickets.
+
+	capacity must be a power of 2
+*/
+template<typename T>
+class BoundedMPSCQueue {
+	struct Slot {
+		std::atomic<std::size_t> sequence;
+		alignas(T) unsigned char value[sizeof(T)];
+
+		T* get() { return reinterpret_cast<T*>(value); }
+	};
+
+	Slot* slots;
+	std::size_t mask;
+
+	alignas(64) std::atomic<std::size_t> enqueuePos{0};
+	alignas(64) std::size_t dequeuePos = 0;
+
+public:
+	explicit BoundedMPSCQueue(std::size_t capacity) : slots(new Slot[capacity]), mask(capacity - 1) {
+		assert(capacity >= 2 && (capacity & (capacity - 1)) == 0);
+		for(std::size_t i = 0; i < capacity; i++) {
+			slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+	~BoundedMPSCQueue() {
+		while(tryPop([](T&) {}));
+		delete[] slots;
+	}
+
+	BoundedMPSCQueue(const BoundedMPSCQueue&) = delete;
+	BoundedMPSCQueue& operator=(const BoundedMPSCQueue&) = delete;
+
+	std::size_t capacity() const { return mask + 1; }
+
+	/*
+		Attempts to push a new value, returns false if the queue is full
+		position receives the position of the pushed value in the queue
+	*/
+	bool tryPush(T&& newValue, std::size_t& position) {
+		std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+		while(true) {
+			Slot& slot = slots[pos & mask];
+			std::size_t seq = slot.sequence.load(std::memory_order_acquire);
+			std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+			if(diff == 0) {
+				if(enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					new(slot.value) T(std::move(newValue));
+					slot.sequence.store(pos + 1, std::memory_order_release);
+					position = pos;
+					return true;
+				}
+			} else if(diff < 0) {
+				return false; // full
+			} else {
+				pos = enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/*
+		Only to be called from the consumer thread
+		Calls func(T&) on the oldest value if one is available, and removes it afterwards
+	*/
+	template<typename Func>
+	bool tryPop(const Func& func) {
+		Slot& slot = slots[dequeuePos & mask];
+		std::size_t seq = slot.sequence.load(std::memory_order_acquire);
+		if(seq != dequeuePos + 1) return false;
+
+		T* value = slot.get();
+		func(*value);
+		value->~T();
+		slot.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+		dequeuePos++;
+		return true;
+	}
+
+	/*
+		Only to be called from the consumer thread
+		Pops all values which were fully pushed at the moment they are reached, calls func(T&, std::size_t position) on each in order
+	*/
+	template<typename Func>
+	std::size_t drain(const Func& func) {
+		std::size_t count = 0;
+		while(tryPop([this, &func](T& value) { func(value, dequeuePos); })) {
+			count++;
+		}
+		return count;
+	}
+};
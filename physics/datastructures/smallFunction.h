@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+/*
+	A move-only type erased void() callable, which stores callables of up to InlineSize bytes inline
+	Larger callables, or those that cannot be moved without throwing, fall back to a heap allocation
+*/
+template<std::size_t InlineSize = 48>
+class SmallFunction {
+	struct Operations {
+		void(*invoke)(void* storage);
+		void(*moveTo)(void* from, void* to) noexcept;
+		void(*destroy)(void* storage) noexcept;
+	};
+
+	template<typename Func>
+	static constexpr bool fitsInline = sizeof(Func) <= InlineSize && alignof(Func) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible<Func>::value;
+
+	template<typename Func>
+	struct InlineOperations {
+		static void invoke(void* storage) { (*static_cast<Func*>(storage))(); }
+		static void moveTo(void* from, void* to) noexcept {
+			new(to) Func(std::move(*static_cast<Func*>(from)));
+			static_cast<Func*>(from)->~Func();
+		}
+		static void destroy(void* storage) noexcept { static_cast<Func*>(storage)->~Func(); }
+		static constexpr Operations operations{&invoke, &moveTo, &destroy};
+	};
+
+	template<typename Func>
+	struct HeapOperations {
+		static void invoke(void* storage) { (**static_cast<Func**>(storage))(); }
+		static void moveTo(void* from, void* to) noexcept {
+			*static_cast<Func**>(to) = *static_cast<Func**>(from);
+			*static_cast<Func**>(from) = nullptr;
+		}
+		static void destroy(void* storage) noexcept { delete *static_cast<Func**>(storage); }
+		static constexpr Operations operations{&invoke, &moveTo, &destroy};
+	};
+
+	alignas(std::max_align_t) unsigned char storage[InlineSize];
+	const Operations* operations = nullptr;
+
+public:
+	SmallFunction() noexcept = default;
+
+	template<typename Func, typename = std::enable_if_t<!std::is_same<std::decay_t<Func>, SmallFunction>::value>>
+	SmallFunction(Func&& func) {
+		typedef std::decay_t<Func> F;
+		if constexpr(fitsInline<F>) {
+			new(storage) F(std::forward<Func>(func));
+			operations = &InlineOperations<F>::operations;
+		} else {
+			*reinterpret_cast<F**>(storage) = new F(std::forward<Func>(func));
+			operations = &HeapOperations<F>::operations;
+		}
+	}
+
+	SmallFunction(SmallFunction&& other) noexcept : operations(other.operations) {
+		if(operations != nullptr) {
+			operations->moveTo(other.storage, storage);
+			other.operations = nullptr;
+		}
+	}
+	SmallFunction& operator=(SmallFunction&& other) noexcept {
+		if(this != &other) {
+			reset();
+			operations = other.operations;
+			if(operations != nullptr) {
+				operations->moveTo(other.storage, storage);
+				other.operations = nullptr;
+			}
+		}
+		return *this;
+	}
+	SmallFunction(const SmallFunction&) = delete;
+	SmallFunction& operator=(const SmallFunction&) = delete;
+
+	~SmallFunction() { reset(); }
+
+	void reset() noexcept {
+		if(operations != nullptr) {
+			operations->destroy(storage);
+			operations = nullptr;
+		}
+	}
+
+	void operator()() { operations->invoke(storage); }
+
+	explicit operator bool() const noexcept { return operations != nullptr; }
+
+	template<typename Func>
+	static constexpr bool isStoredInline() { return fitsInline<std::decay_t<Func>>; }
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/*
+	Lock-free triple buffer for one writer and one reader
+
+	The writer fills getWriteBuffer() and hands it over with publish(), the reader picks up the newest published buffer with update().
+	Neither side ever blocks the other, and the reader's buffer stays untouched until it calls update() again.
+	Buffers are recycled rather than cleared, so T can keep its allocations between rounds.
+*/
+template<typename T>
+class TripleBuffer {
+	static constexpr std::uint8_t INDEX_MASK = 0x3;
+	static constexpr std::uint8_t NEW_DATA = 0x4;
+
+	T buffers[3];
+
+	// index of the buffer in between writer and reader, NEW_DATA is set while the reader has not yet picked it up
+	std::atomic<std::uint8_t> middle{1};
+	std::uint8_t writeIndex = 0;
+	std::uint8_t readIndex = 2;
+
+public:
+	TripleBuffer() = default;
+	TripleBuffer(const TripleBuffer&) = delete;
+	TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+	// writer side
+	T& getWriteBuffer() { return buffers[writeIndex]; }
+
+	// writer side, makes the write buffer available to the reader and takes over the old middle buffer
+	void publish() {
+		std::uint8_t previousMiddle = middle.exchange(writeIndex | NEW_DATA, std::memory_order_acq_rel);
+		writeIndex = previousMiddle & INDEX_MASK;
+	}
+
+	// reader side, returns true if a newer buffer was published since the last call
+	bool update() {
+		if((middle.load(std::memory_order_relaxed) & NEW_DATA) == 0) return false;
+		std::uint8_t previousMiddle = middle.exchange(readIndex, std::memory_order_acq_rel);
+		readIndex = previousMiddle & INDEX_MASK;
+		return true;
+	}
+
+	// reader side
+	T& getReadBuffer() { return buffers[readIndex]; }
+	const T& getReadBuffer() const { return buffers[readIndex]; }
+};
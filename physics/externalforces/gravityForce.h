@@ -20,4 +20,7 @@ public:
 	virtual double getPotentialEnergyForObject(const WorldPrototype* world, const MotorizedPhysical& phys) const override {
 		return Vec3(Position() - phys.getCenterOfMass()) * gravity * phys.totalMass;
 	}
+	virtual ExternalForce* clone() const override {
+		return new DirectionalGravity(gravity);
+	}
 };
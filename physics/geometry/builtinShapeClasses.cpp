@@ -231,7 +231,11 @@ void CylinderClass::setScaleY(double newY, DiagonalMat3& scale) const {
 	scale[1] = newY;
 }
 
-PolyhedronShapeClass::PolyhedronShapeClass(Polyhedron&& poly) : poly(poly), ShapeClass(poly.getVolume(), poly.getCenterOfMass(), poly.getScalableInertiaAroundCenterOfMass(), CONVEX_POLYHEDRON_CLASS_ID) {}
+PolyhedronShapeClass::PolyhedronShapeClass(Polyhedron&& poly) : poly(std::move(poly)), ShapeClass(poly.getVolume(), poly.getCenterOfMass(), poly.getScalableInertiaAroundCenterOfMass(), CONVEX_POLYHEDRON_CLASS_ID) {}
+PolyhedronShapeClass::PolyhedronShapeClass(Polyhedron&& poly, std::shared_ptr<const void> borrowedMemory) : PolyhedronShapeClass(std::move(poly)) {
+	this->borrowedMemory = std::move(borrowedMemory);
+}
+PolyhedronShapeClass::PolyhedronShapeClass(Polyhedron&& poly, double volume, Vec3 centerOfMass, ScalableInertialMatrix inertia) : poly(std::move(poly)), ShapeClass(volume, centerOfMass, inertia, CONVEX_POLYHEDRON_CLASS_ID) {}
 
 bool PolyhedronShapeClass::containsPoint(Vec3 point) const {
 	return poly.containsPoint(point);
@@ -3,10 +3,14 @@
 #include "polyhedron.h"
 #include "shapeClass.h"
 
+#include <memory>
+
 #define CUBE_CLASS_ID 0
 #define SPHERE_CLASS_ID 1
 #define CYLINDER_CLASS_ID 2
 #define CONVEX_POLYHEDRON_CLASS_ID 10
+#define TRIANGLE_MESH_CLASS_ID 11
+#define HEIGHTFIELD_CLASS_ID 12
 
 
 class CubeClass : public ShapeClass {
@@ -19,6 +23,7 @@ public:
 	virtual double getScaledMaxRadiusSq(DiagonalMat3 scale) const;
 	virtual Vec3f furthestInDirection(const Vec3f& direction) const;
 	virtual Polyhedron asPolyhedron() const;
+	virtual std::size_t getObjectSize() const { return sizeof(CubeClass); }
 
 	static const CubeClass instance;
 };
@@ -34,6 +39,7 @@ public:
 	virtual double getScaledMaxRadius(DiagonalMat3 scale) const;
 	virtual Vec3f furthestInDirection(const Vec3f& direction) const;
 	virtual Polyhedron asPolyhedron() const;
+	virtual std::size_t getObjectSize() const { return sizeof(SphereClass); }
 	void setScaleX(double newX, DiagonalMat3& scale) const override;
 	void setScaleY(double newY, DiagonalMat3& scale) const override;
 	void setScaleZ(double newZ, DiagonalMat3& scale) const override;
@@ -51,6 +57,7 @@ public:
 	virtual double getScaledMaxRadiusSq(DiagonalMat3 scale) const;
 	virtual Vec3f furthestInDirection(const Vec3f& direction) const;
 	virtual Polyhedron asPolyhedron() const;
+	virtual std::size_t getObjectSize() const { return sizeof(CylinderClass); }
 	void setScaleX(double newX, DiagonalMat3& scale) const override;
 	void setScaleY(double newY, DiagonalMat3& scale) const override;
 
@@ -61,8 +68,16 @@ public:
 class PolyhedronShapeClass : public ShapeClass {
 protected:
 	Polyhedron poly;
+	// the memory poly borrows its blocks from, such as a mapped world file, it is released once no shape class uses it
+	std::shared_ptr<const void> borrowedMemory;
 public:
 	PolyhedronShapeClass(Polyhedron&& poly);
+	// for a poly whose blocks are borrowed from memory owned by borrowedMemory
+	PolyhedronShapeClass(Polyhedron&& poly, std::shared_ptr<const void> borrowedMemory);
+	// takes data that was already computed from poly, such as the data remembered by a ShapeClassCache
+	PolyhedronShapeClass(Polyhedron&& poly, double volume, Vec3 centerOfMass, ScalableInertialMatrix inertia);
+
+	const Polyhedron& getPolyhedron() const { return poly; }
 
 	virtual bool containsPoint(Vec3 point) const override;
 	virtual double getIntersectionDistance(Vec3 origin, Vec3 direction) const override;
@@ -71,6 +86,9 @@ public:
 	virtual double getScaledMaxRadiusSq(DiagonalMat3 scale) const override;
 	virtual Vec3f furthestInDirection(const Vec3f& direction) const override;
 	virtual Polyhedron asPolyhedron() const override;
+	// the subclasses add no members
+	virtual std::size_t getObjectSize() const override { return sizeof(PolyhedronShapeClass); }
+	virtual std::size_t getDataSize() const override { return poly.getDataSize(); }
 };
 
 class PolyhedronShapeClassAVX : public PolyhedronShapeClass {
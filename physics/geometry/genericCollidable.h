@@ -5,3 +5,16 @@
 struct GenericCollidable {
 	virtual Vec3f furthestInDirection(const Vec3f& direction) const = 0;
 };
+
+// a single triangle, such as one of the triangles of a TriangleMeshShapeClass
+struct TriangleCollidable : public GenericCollidable {
+	Vec3f vertices[3];
+
+	virtual Vec3f furthestInDirection(const Vec3f& direction) const override {
+		float d0 = vertices[0] * direction;
+		float d1 = vertices[1] * direction;
+		float d2 = vertices[2] * direction;
+		if(d0 >= d1 && d0 >= d2) return vertices[0];
+		return d1 >= d2 ? vertices[1] : vertices[2];
+	}
+};
@@ -18,7 +18,8 @@
 #include <stdexcept>
 
 
-inline static void incDebugTally(HistoricTally<long long, IterationTime>& tally, int iterTime) {
+inline static void incDebugTally(ThreadTally<long long, IterationTime>& tally, int iterTime) {
+	if(!physicsStatisticsEnabled) return;
 	if(iterTime >= GJK_MAX_ITER) {
 		tally.addToTally(IterationTime::LIMIT_REACHED, 1);
 	} else if(iterTime >= 15) {
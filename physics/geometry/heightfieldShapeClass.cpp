@@ -0,0 +1,168 @@
+#include "heightfieldShapeClass.h"
+
+#include "builtinShapeClasses.h"
+#include "polyhedron.h"
+#include "triangleMesh.h"
+
+static std::uint16_t highestSample(const std::vector<std::uint16_t>& heights) {
+	return heights.empty() ? 0 : *std::max_element(heights.begin(), heights.end());
+}
+
+// the mass properties of the -1..1 box
+HeightfieldShapeClass::HeightfieldShapeClass(std::vector<std::uint16_t>&& heights, int columnCount, int rowCount) :
+	ShapeClass(8, Vec3(0, 0, 0), ScalableInertialMatrix(Vec3(8.0 / 3.0, 8.0 / 3.0, 8.0 / 3.0), Vec3(0, 0, 0)), HEIGHTFIELD_CLASS_ID),
+	columnCount(columnCount),
+	rowCount(rowCount),
+	heights(std::move(heights)) {
+
+	if(columnCount < 2 || rowCount < 2) throw "A heightfield needs at least two columns and two rows";
+	if(this->heights.size() != static_cast<std::size_t>(columnCount) * rowCount) throw "The number of heights doesn't match the size of the heightfield";
+
+	top = toY(highestSample(this->heights));
+}
+
+bool HeightfieldShapeClass::containsPoint(Vec3 point) const {
+	if(std::abs(point.x) > 1.0 || std::abs(point.z) > 1.0 || point.y < -1.0 || point.y > top) return false;
+
+	float columnCoordinate = float(point.x + 1.0) * (columnCount - 1) / 2.0f;
+	float rowCoordinate = float(point.z + 1.0) * (rowCount - 1) / 2.0f;
+	int column = std::min(columnCount - 2, static_cast<int>(columnCoordinate));
+	int row = std::min(rowCount - 2, static_cast<int>(rowCoordinate));
+	float u = columnCoordinate - column;
+	float v = rowCoordinate - row;
+
+	// the cell is split along the diagonal from (column + 1, row) to (column, row + 1)
+	float h00 = toY(getHeight(column, row));
+	float h10 = toY(getHeight(column + 1, row));
+	float h01 = toY(getHeight(column, row + 1));
+	float h11 = toY(getHeight(column + 1, row + 1));
+	float surface;
+	if(u + v <= 1.0f) {
+		surface = h00 + u * (h10 - h00) + v * (h01 - h00);
+	} else {
+		surface = h11 + (1.0f - u) * (h01 - h11) + (1.0f - v) * (h10 - h11);
+	}
+	return point.y <= surface;
+}
+
+float HeightfieldShapeClass::rayDistanceInCell(int column, int row, Vec3f origin, Vec3f direction) const {
+	Vec3f v00 = getVertex(column, row);
+	Vec3f v10 = getVertex(column + 1, row);
+	Vec3f v01 = getVertex(column, row + 1);
+	Vec3f v11 = getVertex(column + 1, row + 1);
+	return std::min(rayTriangleIntersectionDistance(v00, v01, v10, origin, direction), rayTriangleIntersectionDistance(v10, v01, v11, origin, direction));
+}
+
+double HeightfieldShapeClass::getIntersectionDistance(Vec3 origin64, Vec3 direction64) const {
+	Vec3f origin(origin64);
+	Vec3f direction(direction64);
+
+	// clip the ray to the bounding box, so the walk starts and ends inside the grid
+	float enter = 0.0f;
+	float exit = INFINITY;
+	Vec3f boxMin(-1.0f, -1.0f, -1.0f);
+	Vec3f boxMax(1.0f, top, 1.0f);
+	for(int axis = 0; axis < 3; axis++) {
+		if(direction[axis] == 0.0f) {
+			if(origin[axis] < boxMin[axis] || origin[axis] > boxMax[axis]) return INFINITY;
+			continue;
+		}
+		float t1 = (boxMin[axis] - origin[axis]) / direction[axis];
+		float t2 = (boxMax[axis] - origin[axis]) / direction[axis];
+		enter = std::max(enter, std::min(t1, t2));
+		exit = std::min(exit, std::max(t1, t2));
+	}
+	if(enter > exit) return INFINITY;
+
+	// the ray in grid coordinates, where cell (column, row) spans column..column+1 and row..row+1
+	float columnsPerUnit = (columnCount - 1) / 2.0f;
+	float rowsPerUnit = (rowCount - 1) / 2.0f;
+	float startColumn = (origin.x + 1.0f) * columnsPerUnit;
+	float startRow = (origin.z + 1.0f) * rowsPerUnit;
+	float columnSpeed = direction.x * columnsPerUnit;
+	float rowSpeed = direction.z * rowsPerUnit;
+
+	int column = std::clamp(static_cast<int>(std::floor(startColumn + enter * columnSpeed)), 0, columnCount - 2);
+	int row = std::clamp(static_cast<int>(std::floor(startRow + enter * rowSpeed)), 0, rowCount - 2);
+
+	int columnStep = columnSpeed > 0.0f ? 1 : -1;
+	int rowStep = rowSpeed > 0.0f ? 1 : -1;
+	// the distance along the ray at which it crosses into the next column or row of cells
+	float nextColumnCrossing = columnSpeed == 0.0f ? INFINITY : ((columnSpeed > 0.0f ? column + 1 : column) - startColumn) / columnSpeed;
+	float nextRowCrossing = rowSpeed == 0.0f ? INFINITY : ((rowSpeed > 0.0f ? row + 1 : row) - startRow) / rowSpeed;
+	float columnCrossingInterval = columnSpeed == 0.0f ? INFINITY : std::abs(1.0f / columnSpeed);
+	float rowCrossingInterval = rowSpeed == 0.0f ? INFINITY : std::abs(1.0f / rowSpeed);
+
+	// the cells are visited in the order the ray passes over them, so the first hit is the closest one
+	while(true) {
+		float distance = rayDistanceInCell(column, row, origin, direction);
+		if(distance != INFINITY) return distance;
+
+		if(std::min(nextColumnCrossing, nextRowCrossing) >= exit) return INFINITY;
+		if(nextColumnCrossing < nextRowCrossing) {
+			column += columnStep;
+			nextColumnCrossing += columnCrossingInterval;
+			if(column < 0 || column > columnCount - 2) return INFINITY;
+		} else {
+			row += rowStep;
+			nextRowCrossing += rowCrossingInterval;
+			if(row < 0 || row > rowCount - 2) return INFINITY;
+		}
+	}
+}
+
+BoundingBox HeightfieldShapeClass::getBounds(const Rotation& rotation, const DiagonalMat3& scale) const {
+	Mat3 referenceFrame = rotation.asRotationMatrix() * scale;
+	BoundingBox result(Vec3(INFINITY, INFINITY, INFINITY), Vec3(-INFINITY, -INFINITY, -INFINITY));
+	for(int corner = 0; corner < 8; corner++) {
+		Vec3 boxCorner((corner & 1) ? 1.0 : -1.0, (corner & 2) ? top : -1.0, (corner & 4) ? 1.0 : -1.0);
+		Vec3 transformed = referenceFrame * boxCorner;
+		for(int axis = 0; axis < 3; axis++) {
+			result.min[axis] = std::min(result.min[axis], transformed[axis]);
+			result.max[axis] = std::max(result.max[axis], transformed[axis]);
+		}
+	}
+	return result;
+}
+
+double HeightfieldShapeClass::getScaledMaxRadiusSq(DiagonalMat3 scale) const {
+	double furthestY = std::max(1.0, double(std::abs(top)));
+	return scale[0] * scale[0] + furthestY * furthestY * scale[1] * scale[1] + scale[2] * scale[2];
+}
+
+Vec3f HeightfieldShapeClass::furthestInDirection(const Vec3f& direction) const {
+	// the bottom corners and every sample are the candidates, like the support of a Polyhedron this is a full scan
+	Vec3f best(direction.x >= 0.0f ? 1.0f : -1.0f, -1.0f, direction.z >= 0.0f ? 1.0f : -1.0f);
+	float bestDot = best * direction;
+	for(int row = 0; row < rowCount; row++) {
+		for(int column = 0; column < columnCount; column++) {
+			Vec3f vertex = getVertex(column, row);
+			float dot = vertex * direction;
+			if(dot > bestDot) {
+				best = vertex;
+				bestDot = dot;
+			}
+		}
+	}
+	return best;
+}
+
+Polyhedron HeightfieldShapeClass::asPolyhedron() const {
+	std::vector<Vec3f> vertices;
+	vertices.reserve(heights.size());
+	for(int row = 0; row < rowCount; row++) {
+		for(int column = 0; column < columnCount; column++) {
+			vertices.push_back(getVertex(column, row));
+		}
+	}
+	std::vector<Triangle> triangles;
+	triangles.reserve(std::size_t(columnCount - 1) * (rowCount - 1) * 2);
+	for(int row = 0; row < rowCount - 1; row++) {
+		for(int column = 0; column < columnCount - 1; column++) {
+			int corner = row * columnCount + column;
+			triangles.push_back(Triangle{{{corner, corner + columnCount, corner + 1}}});
+			triangles.push_back(Triangle{{{corner + 1, corner + columnCount, corner + columnCount + 1}}});
+		}
+	}
+	return Polyhedron(vertices.data(), triangles.data(), static_cast<int>(vertices.size()), static_cast<int>(triangles.size()));
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "shapeClass.h"
+
+// one cell triangle of a heightfield as a solid prism, the triangle extruded down to the bottom of the heightfield
+struct HeightfieldPrismCollidable : public TriangleCollidable {
+	float bottom;
+
+	virtual Vec3f furthestInDirection(const Vec3f& direction) const override {
+		Vec3f best = vertices[0];
+		float bestDot = vertices[0] * direction;
+		for(int i = 0; i < 3; i++) {
+			Vec3f below(vertices[i].x, bottom, vertices[i].z);
+			float topDot = vertices[i] * direction;
+			float belowDot = below * direction;
+			if(topDot > bestDot) {
+				best = vertices[i];
+				bestDot = topDot;
+			}
+			if(belowDot > bestDot) {
+				best = below;
+				bestDot = belowDot;
+			}
+		}
+		return best;
+	}
+};
+
+/*
+	A grid of 16 bit height samples, for large static terrain
+
+	Sample (column, row) is at x = -1 + 2 * column / (columnCount - 1), z = -1 + 2 * row / (rowCount - 1) and
+	y = -1 + 2 * height / MAX_SAMPLE. Every cell between four samples is split into two triangles, the heightfield is
+	solid from its surface down to y = -1. Colissions are computed against the prisms below the triangles of the cells
+	that overlap the other shape, which are found directly from the grid. Rays walk the grid cell by cell.
+
+	The mass properties are those of the bounding box, which only keeps parts with this shape valid. Such parts should
+	be terrain, not free parts.
+*/
+class HeightfieldShapeClass : public ShapeClass {
+	int columnCount;
+	int rowCount;
+	std::vector<std::uint16_t> heights;
+	// the highest sample, in the -1..1 space of the class
+	float top;
+
+	float toY(std::uint16_t height) const { return -1.0f + height * (2.0f / MAX_SAMPLE); }
+	float toX(int column) const { return -1.0f + column * (2.0f / (columnCount - 1)); }
+	float toZ(int row) const { return -1.0f + row * (2.0f / (rowCount - 1)); }
+	float rayDistanceInCell(int column, int row, Vec3f origin, Vec3f direction) const;
+
+public:
+	static constexpr std::uint16_t MAX_SAMPLE = 65535;
+
+	// heights holds columnCount * rowCount samples row by row, there must be at least two columns and two rows
+	HeightfieldShapeClass(std::vector<std::uint16_t>&& heights, int columnCount, int rowCount);
+
+	int getColumnCount() const { return columnCount; }
+	int getRowCount() const { return rowCount; }
+	const std::vector<std::uint16_t>& getHeights() const { return heights; }
+	std::uint16_t getHeight(int column, int row) const { return heights[row * columnCount + column]; }
+	Vec3f getVertex(int column, int row) const { return Vec3f(toX(column), toY(getHeight(column, row)), toZ(row)); }
+
+	// the convex pieces forEachCollidableIn passes
+	typedef HeightfieldPrismCollidable Piece;
+
+	/*
+		Calls func(const Piece&) for the prisms of the cells that may intersect bounds, bounds is in the -1..1 space of the class
+		The cells come straight from the grid, triangles that lie below bounds or on the other side of the diagonal of their cell are skipped
+	*/
+	template<typename Func>
+	void forEachCollidableIn(const BoundingBoxTemplate<float>& bounds, const Func& func) const {
+		if(bounds.min.y > top || bounds.max.y < -1.0f) return;
+
+		float columnsPerUnit = (columnCount - 1) / 2.0f;
+		float rowsPerUnit = (rowCount - 1) / 2.0f;
+		int firstColumn = std::max(0, static_cast<int>(std::floor((bounds.min.x + 1.0f) * columnsPerUnit)));
+		int lastColumn = std::min(columnCount - 2, static_cast<int>(std::floor((bounds.max.x + 1.0f) * columnsPerUnit)));
+		int firstRow = std::max(0, static_cast<int>(std::floor((bounds.min.z + 1.0f) * rowsPerUnit)));
+		int lastRow = std::min(rowCount - 2, static_cast<int>(std::floor((bounds.max.z + 1.0f) * rowsPerUnit)));
+
+		float lowestHeight = (bounds.min.y + 1.0f) * (MAX_SAMPLE / 2.0f);
+		// the corner of bounds nearest to and furthest from the origin of the grid, in grid coordinates
+		float nearCorner = (bounds.min.x + 1.0f) * columnsPerUnit + (bounds.min.z + 1.0f) * rowsPerUnit;
+		float farCorner = (bounds.max.x + 1.0f) * columnsPerUnit + (bounds.max.z + 1.0f) * rowsPerUnit;
+
+		HeightfieldPrismCollidable prism;
+		prism.bottom = -1.0f;
+		for(int row = firstRow; row <= lastRow; row++) {
+			for(int column = firstColumn; column <= lastColumn; column++) {
+				std::uint16_t h00 = getHeight(column, row);
+				std::uint16_t h10 = getHeight(column + 1, row);
+				std::uint16_t h01 = getHeight(column, row + 1);
+				std::uint16_t h11 = getHeight(column + 1, row + 1);
+
+				Vec3f v00(toX(column), toY(h00), toZ(row));
+				Vec3f v10(toX(column + 1), toY(h10), toZ(row));
+				Vec3f v01(toX(column), toY(h01), toZ(row + 1));
+
+				// the cell is split along its diagonal column + row = constant, bounds may only reach one side of it
+				float diagonal = float(column + row + 1);
+				if(nearCorner <= diagonal && std::max(std::max(h00, h10), h01) >= lowestHeight) {
+					prism.vertices[0] = v00; prism.vertices[1] = v01; prism.vertices[2] = v10;
+					func(prism);
+				}
+				if(farCorner >= diagonal && std::max(std::max(h10, h01), h11) >= lowestHeight) {
+					prism.vertices[0] = v10; prism.vertices[1] = v01; prism.vertices[2] = Vec3f(toX(column + 1), toY(h11), toZ(row + 1));
+					func(prism);
+				}
+			}
+		}
+	}
+
+	virtual bool containsPoint(Vec3 point) const override;
+	// the distance to the surface, the grid is walked along the ray so only the cells the ray passes over are tested
+	virtual double getIntersectionDistance(Vec3 origin, Vec3 direction) const override;
+	virtual BoundingBox getBounds(const Rotation& rotation, const DiagonalMat3& scale) const override;
+	virtual double getScaledMaxRadiusSq(DiagonalMat3 scale) const override;
+	virtual Vec3f furthestInDirection(const Vec3f& direction) const override;
+	// only the surface, without the sides and bottom
+	virtual Polyhedron asPolyhedron() const override;
+	virtual std::size_t getObjectSize() const override { return sizeof(HeightfieldShapeClass); }
+	virtual std::size_t getDataSize() const override { return heights.capacity() * sizeof(std::uint16_t); }
+};
@@ -10,26 +10,143 @@
 
 #include "../misc/validityHelper.h"
 #include "shapeClass.h"
+#include "builtinShapeClasses.h"
+#include "triangleMeshShapeClass.h"
+#include "heightfieldShapeClass.h"
 
 #include "../catchable_assert.h"
 
 #include <algorithm>
+#include <vector>
 
+// the furthest point of scaled in direction, for a ShapeClass or piece scaled by scale
+static Vec3f furthestOfScaled(const GenericCollidable& scaled, const DiagonalMat3f& scale, const Vec3f& direction) {
+	return scale * scaled.furthestInDirection(scale * direction);
+}
+
+/*
+	Intersects the convex shape first with the convex pieces of a non convex ShapeClass that are near it, the deepest intersection is the result
+	Like intersectsTransformed, relativeTransform is pieces relative to first and the result is local to first
+
+	The overlap of first and a piece along the normal of the piece is a cheap upper bound of the depth of their intersection.
+	Pieces that don't overlap along it are skipped, the others run GJK and EPA from the largest bound down, until no piece
+	that is left can be deeper than the deepest intersection found so far.
+*/
+template<typename PiecewiseClass>
+static std::optional<Intersection> intersectsPieces(const Shape& first, const Shape& pieces, const CFrame& relativeTransform) {
+	typedef typename PiecewiseClass::Piece Piece;
+	struct Candidate {
+		Piece piece;
+		float maxDepth;
+	};
+	// one per thread, so intersections can be computed in parallel
+	thread_local std::vector<Candidate> candidates;
+
+	const PiecewiseClass& piecewiseClass = static_cast<const PiecewiseClass&>(*pieces.baseShape);
+
+	CFrame firstInPieces = ~relativeTransform;
+	BoundingBox firstBounds = first.getBounds(firstInPieces.getRotation());
+	DiagonalMat3 inverseScale = ~pieces.scale;
+	Vec3f queryMin(inverseScale * (firstBounds.min + firstInPieces.getPosition()));
+	Vec3f queryMax(inverseScale * (firstBounds.max + firstInPieces.getPosition()));
+	BoundingBoxTemplate<float> queryBounds(queryMin, queryMax);
+
+	DiagonalMat3f firstScale(first.scale);
+	DiagonalMat3f piecesScale(pieces.scale);
+	Vec3f firstPosition(firstInPieces.getPosition());
+
+	candidates.clear();
+	piecewiseClass.forEachCollidableIn(queryBounds, [&](const Piece& piece) {
+		Vec3f v0 = piecesScale * piece.vertices[0];
+		Vec3f normal = (piecesScale * piece.vertices[1] - v0) % (piecesScale * piece.vertices[2] - v0);
+		float normalLength = length(normal);
+		if(normalLength == 0.0f) {
+			candidates.push_back(Candidate{piece, INFINITY});
+			return;
+		}
+		normal = normal / normalLength;
+
+		// projections on the normal, in the scaled space of the pieces
+		Vec3f normalInFirst(relativeTransform.localToRelative(Vec3(normal)));
+		float firstOffset = normal * firstPosition;
+		float firstMax = firstOffset + normalInFirst * furthestOfScaled(*first.baseShape, firstScale, normalInFirst);
+		float firstMin = firstOffset + normalInFirst * furthestOfScaled(*first.baseShape, firstScale, -normalInFirst);
+		float pieceMax = normal * furthestOfScaled(piece, piecesScale, normal);
+		float pieceMin = normal * furthestOfScaled(piece, piecesScale, -normal);
+
+		float overlap = std::min(pieceMax - firstMin, firstMax - pieceMin);
+		if(overlap >= 0.0f) {
+			candidates.push_back(Candidate{piece, overlap});
+		}
+	});
+
+	std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+		return a.maxDepth > b.maxDepth;
+	});
+
+	std::optional<Intersection> deepest;
+	double deepestLength = -1.0;
+	for(const Candidate& candidate : candidates) {
+		if(deepestLength >= candidate.maxDepth) break;
+		std::optional<Intersection> result = intersectsTransformed(*first.baseShape, candidate.piece, relativeTransform, first.scale, pieces.scale);
+		if(result) {
+			double resultLength = length(result->exitVector);
+			if(resultLength > deepestLength) {
+				deepestLength = resultLength;
+				deepest = result;
+			}
+		}
+	}
+	return deepest;
+}
+
+static bool isPiecewise(const Shape& shape) {
+	int id = shape.baseShape->intersectionClassID;
+	return id == TRIANGLE_MESH_CLASS_ID || id == HEIGHTFIELD_CLASS_ID;
+}
+
+static std::optional<Intersection> intersectsPiecewise(const Shape& convex, const Shape& piecewise, const CFrame& relativeTransform) {
+	if(piecewise.baseShape->intersectionClassID == TRIANGLE_MESH_CLASS_ID) {
+		return intersectsPieces<TriangleMeshShapeClass>(convex, piecewise, relativeTransform);
+	} else {
+		return intersectsPieces<HeightfieldShapeClass>(convex, piecewise, relativeTransform);
+	}
+}
+
+// triangle meshes and heightfields are made of convex pieces, two such shapes never collide
 std::optional<Intersection> intersectsTransformed(const Shape& first, const Shape& second, const CFrame& relativeTransform) {
+	bool firstIsPiecewise = isPiecewise(first);
+	bool secondIsPiecewise = isPiecewise(second);
+	if(firstIsPiecewise && secondIsPiecewise) {
+		return std::optional<Intersection>();
+	} else if(secondIsPiecewise) {
+		return intersectsPiecewise(first, second, relativeTransform);
+	} else if(firstIsPiecewise) {
+		CFrame secondToFirst = ~relativeTransform;
+		std::optional<Intersection> result = intersectsPiecewise(second, first, secondToFirst);
+		if(!result) return result;
+		// the exit vector of first relative to second becomes the exit vector of second relative to first
+		return Intersection(relativeTransform.localToGlobal(result->intersection), -relativeTransform.localToRelative(result->exitVector));
+	}
 	return intersectsTransformed(*first.baseShape, *second.baseShape, relativeTransform, first.scale, second.scale);
 }
 
 
-ComputationBuffers buffers(1000, 2000);
+// one per thread, so intersections can be computed in parallel
+thread_local ComputationBuffers buffers(1000, 2000);
 
 std::optional<Intersection> intersectsTransformed(const GenericCollidable& first, const GenericCollidable& second, const CFrame& relativeTransform, const DiagonalMat3& scaleFirst, const DiagonalMat3& scaleSecond) {
 	ColissionPair info{first, second, relativeTransform, scaleFirst, scaleSecond};
-	physicsMeasure.mark(PhysicsProcess::GJK_COL);
-	std::optional collides = runGJKTransformed(info, -relativeTransform.position);
+	std::optional<Tetrahedron> collides;
+	{
+		PhysicsZone gjkZone(PhysicsProcess::GJK_COL);
+		collides = runGJKTransformed(info, -relativeTransform.position);
+		if(!collides) gjkZone.setProcess(PhysicsProcess::GJK_NO_COL);
+	}
 
 	if(collides) {
 		Tetrahedron& result = collides.value();
-		physicsMeasure.mark(PhysicsProcess::EPA);
+		PhysicsZone epaZone(PhysicsProcess::EPA);
 		Vec3f intersection;
 		Vec3f exitVector;
 
@@ -64,7 +181,6 @@ std::optional<Intersection> intersectsTransformed(const GenericCollidable& first
 			return std::optional<Intersection>(Intersection(intersection, exitVector));
 		}
 	} else {
-		physicsMeasure.mark(PhysicsProcess::OTHER, PhysicsProcess::GJK_NO_COL);
 		return std::optional<Intersection>();
 	}
 }
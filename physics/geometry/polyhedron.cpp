@@ -20,6 +20,10 @@ Polyhedron::Polyhedron(const Vec3f* vertices, const Triangle* triangles, int ver
 	TriangleMesh(vertexCount, triangleCount, vertices, triangles) {
 	assert(isValid(*this));
 }
+Polyhedron::Polyhedron(UniqueAlignedPointer<float>&& vertices, UniqueAlignedPointer<int>&& triangles, int vertexCount, int triangleCount) :
+	TriangleMesh(std::move(vertices), std::move(triangles), vertexCount, triangleCount) {
+	assert(isValid(*this));
+}
 Polyhedron::Polyhedron(const TriangleMesh& mesh) : 
 	TriangleMesh(mesh) {
 	assert(isValid(*this));
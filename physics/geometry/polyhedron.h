@@ -16,6 +16,11 @@ public:
 	explicit Polyhedron(const MeshPrototype& mesh);
 	explicit Polyhedron(MeshPrototype&& mesh) noexcept;
 	Polyhedron(const Vec3f* vertices, const Triangle* triangles, int vertexCount, int triangleCount);
+	/*
+		Adopts buffers that are already in the padded parallel layout of MeshPrototype, including the padding
+		The buffers are not modified, so they may be borrowed from a memory mapped file
+	*/
+	Polyhedron(UniqueAlignedPointer<float>&& vertices, UniqueAlignedPointer<int>&& triangles, int vertexCount, int triangleCount);
 
 	Polyhedron translated(Vec3f offset) const;
 	Polyhedron rotated(Rotationf rotation) const;
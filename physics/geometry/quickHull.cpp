@@ -0,0 +1,339 @@
+#include "quickHull.h"
+
+#include <cmath>
+#include <cfloat>
+#include <queue>
+#include <utility>
+
+#include "../threading/jobSystem.h"
+
+double QuickHull::distanceAbove(const Face& face, int point) const {
+	return face.normal * points[point] - face.offset;
+}
+
+int QuickHull::createFace(int a, int b, int c) {
+	Face face;
+	face.vertices[0] = a;
+	face.vertices[1] = b;
+	face.vertices[2] = c;
+	face.neighbors[0] = face.neighbors[1] = face.neighbors[2] = -1;
+	Vec3 normal = (points[b] - points[a]) % (points[c] - points[a]);
+	double length = std::sqrt(lengthSquared(normal));
+	// a degenerate face has no points above it, it disappears once the points around it are added
+	face.normal = length > 0.0 ? normal / length : Vec3(0.0, 0.0, 0.0);
+	face.offset = face.normal * points[a];
+	face.furthestPoint = -1;
+	face.furthestDistance = 0.0;
+	face.alive = true;
+	face.visible = false;
+
+	faces.push_back(std::move(face));
+	return static_cast<int>(faces.size() - 1);
+}
+
+// adds the point to the conflict list of the first candidate it is above, points that are above none of them are inside the hull
+void QuickHull::assignConflict(int point, const int* candidateFaces, int candidateCount) {
+	for(int i = 0; i < candidateCount; i++) {
+		Face& face = faces[candidateFaces[i]];
+		double distance = distanceAbove(face, point);
+		if(distance > tolerance) {
+			face.conflicts.push_back(point);
+			if(distance > face.furthestDistance) {
+				face.furthestDistance = distance;
+				face.furthestPoint = point;
+			}
+			return;
+		}
+	}
+}
+
+void QuickHull::createInitialTetrahedron() {
+	int pointCount = static_cast<int>(points.size());
+
+	// the two most distant of the extreme points along the axes
+	int extremes[6]{0, 0, 0, 0, 0, 0};
+	for(int i = 1; i < pointCount; i++) {
+		for(int axis = 0; axis < 3; axis++) {
+			if(points[i][axis] < points[extremes[axis * 2]][axis]) extremes[axis * 2] = i;
+			if(points[i][axis] > points[extremes[axis * 2 + 1]][axis]) extremes[axis * 2 + 1] = i;
+		}
+	}
+	int v0 = extremes[0];
+	int v1 = extremes[1];
+	double bestDistance = -1.0;
+	for(int i = 0; i < 6; i++) {
+		for(int j = i + 1; j < 6; j++) {
+			double distance = lengthSquared(points[extremes[i]] - points[extremes[j]]);
+			if(distance > bestDistance) {
+				bestDistance = distance;
+				v0 = extremes[i];
+				v1 = extremes[j];
+			}
+		}
+	}
+	if(std::sqrt(bestDistance) <= tolerance) throw "Can't build a convex hull of coinciding points!";
+
+	// the point furthest from the line v0-v1
+	Vec3 lineDirection = points[v1] - points[v0];
+	int v2 = -1;
+	bestDistance = 0.0;
+	for(int i = 0; i < pointCount; i++) {
+		double distance = lengthSquared((points[i] - points[v0]) % lineDirection);
+		if(distance > bestDistance) {
+			bestDistance = distance;
+			v2 = i;
+		}
+	}
+	if(v2 == -1 || std::sqrt(bestDistance) / std::sqrt(lengthSquared(lineDirection)) <= tolerance) throw "Can't build a convex hull of points on a line!";
+
+	// the point furthest from the plane v0-v1-v2
+	Vec3 planeNormal = normalize(lineDirection % (points[v2] - points[v0]));
+	int v3 = -1;
+	bestDistance = 0.0;
+	for(int i = 0; i < pointCount; i++) {
+		double distance = std::abs((points[i] - points[v0]) * planeNormal);
+		if(distance > bestDistance) {
+			bestDistance = distance;
+			v3 = i;
+		}
+	}
+	if(v3 == -1 || bestDistance <= tolerance) throw "Can't build a convex hull of points in a plane!";
+
+	// v3 must be below the face v0-v1-v2
+	if((points[v3] - points[v0]) * planeNormal > 0) std::swap(v1, v2);
+
+	int tetrahedron[4]{
+		createFace(v0, v1, v2),
+		createFace(v0, v3, v1),
+		createFace(v1, v3, v2),
+		createFace(v2, v3, v0)
+	};
+
+	// link the faces through their shared edges, which run in opposite directions
+	for(int a : tetrahedron) {
+		for(int edgeA = 0; edgeA < 3; edgeA++) {
+			int from = faces[a].vertices[edgeA];
+			int to = faces[a].vertices[(edgeA + 1) % 3];
+			for(int b : tetrahedron) {
+				for(int edgeB = 0; edgeB < 3; edgeB++) {
+					if(faces[b].vertices[edgeB] == to && faces[b].vertices[(edgeB + 1) % 3] == from) {
+						faces[a].neighbors[edgeA] = b;
+					}
+				}
+			}
+		}
+	}
+
+	addedVertexCount = 4;
+	for(int i = 0; i < pointCount; i++) {
+		if(i != v0 && i != v1 && i != v2 && i != v3) {
+			assignConflict(i, tetrahedron, 4);
+		}
+	}
+}
+
+/*
+	Marks the faces that can see the eye point as visible and collects the edges around them in horizon
+	This is a depth first search that starts every face at the edge after the one it was entered through, the same as the
+	recursive version, but with an explicit stack so large visible regions can't overflow the call stack
+*/
+void QuickHull::findHorizon(int eyePoint, int startFace) {
+	visibleFaces.clear();
+	horizon.clear();
+	searchStack.clear();
+
+	faces[startFace].visible = true;
+	visibleFaces.push_back(startFace);
+	searchStack.push_back(SearchFrame{startFace, 0, 0});
+
+	while(!searchStack.empty()) {
+		SearchFrame& frame = searchStack.back();
+		if(frame.step == 3) {
+			searchStack.pop_back();
+			continue;
+		}
+		int face = frame.face;
+		int edge = (frame.firstEdge + frame.step) % 3;
+		frame.step++;
+
+		int neighbor = faces[face].neighbors[edge];
+		if(faces[neighbor].visible) continue;
+
+		if(distanceAbove(faces[neighbor], eyePoint) > tolerance) {
+			faces[neighbor].visible = true;
+			visibleFaces.push_back(neighbor);
+			int edgeInNeighbor = 0;
+			while(faces[neighbor].neighbors[edgeInNeighbor] != face) edgeInNeighbor++;
+			searchStack.push_back(SearchFrame{neighbor, (edgeInNeighbor + 1) % 3, 0});
+		} else {
+			horizon.push_back(HorizonEdge{face, edge});
+		}
+	}
+}
+
+void QuickHull::addPoint(int eyePoint, int visibleFace) {
+	findHorizon(eyePoint, visibleFace);
+
+	// a cone of new faces from the horizon to the eye point
+	newFaces.clear();
+	newFaceStartingAt.clear();
+	for(const HorizonEdge& horizonEdge : horizon) {
+		int from = faces[horizonEdge.face].vertices[horizonEdge.edge];
+		int to = faces[horizonEdge.face].vertices[(horizonEdge.edge + 1) % 3];
+		int outside = faces[horizonEdge.face].neighbors[horizonEdge.edge];
+
+		int newFace = createFace(from, to, eyePoint);
+		faces[newFace].neighbors[0] = outside;
+		for(int& neighborOfOutside : faces[outside].neighbors) {
+			if(neighborOfOutside == horizonEdge.face) neighborOfOutside = newFace;
+		}
+		newFaces.push_back(newFace);
+		newFaceStartingAt[from] = newFace;
+	}
+	for(int newFace : newFaces) {
+		int next = newFaceStartingAt.at(faces[newFace].vertices[1]);
+		faces[newFace].neighbors[1] = next;
+		faces[next].neighbors[2] = newFace;
+	}
+
+	// the points above the removed faces are either above the new faces or inside the hull now
+	for(int face : visibleFaces) {
+		std::vector<int> conflicts = std::move(faces[face].conflicts);
+		for(int point : conflicts) {
+			if(point != eyePoint) {
+				assignConflict(point, newFaces.data(), static_cast<int>(newFaces.size()));
+			}
+		}
+		faces[face].conflicts = std::vector<int>();
+		faces[face].alive = false;
+	}
+
+	addedVertexCount++;
+}
+
+void QuickHull::build(const Vec3f* inputPoints, int pointCount, int maxVertexCount) {
+	if(pointCount < 4) throw "A convex hull needs at least 4 points!";
+
+	points.clear();
+	points.reserve(pointCount);
+	faces.clear();
+	Vec3 maxCoordinates(0.0, 0.0, 0.0);
+	for(int i = 0; i < pointCount; i++) {
+		Vec3 point(inputPoints[i]);
+		points.push_back(point);
+		for(int axis = 0; axis < 3; axis++) {
+			maxCoordinates[axis] = std::max(maxCoordinates[axis], std::abs(point[axis]));
+		}
+	}
+	// the points only have float precision
+	tolerance = 3 * FLT_EPSILON * (maxCoordinates.x + maxCoordinates.y + maxCoordinates.z);
+
+	createInitialTetrahedron();
+
+	// faces with conflicts, furthest conflict first. Entries of faces that were removed since are skipped
+	typedef std::pair<double, int> QueueEntry;
+	std::priority_queue<QueueEntry> queue;
+	for(int i = 0; i < static_cast<int>(faces.size()); i++) {
+		if(!faces[i].conflicts.empty()) queue.push(QueueEntry(faces[i].furthestDistance, i));
+	}
+
+	while(!queue.empty()) {
+		if(maxVertexCount != 0 && addedVertexCount >= maxVertexCount) break;
+
+		int face = queue.top().second;
+		queue.pop();
+		if(!faces[face].alive) continue;
+
+		std::size_t firstNewFace = faces.size();
+		addPoint(faces[face].furthestPoint, face);
+		for(std::size_t i = firstNewFace; i < faces.size(); i++) {
+			if(!faces[i].conflicts.empty()) queue.push(QueueEntry(faces[i].furthestDistance, static_cast<int>(i)));
+		}
+	}
+}
+
+// gathers the alive faces and the vertices they use, faceIndices maps the faces to their triangle or -1
+void QuickHull::collectResult(std::vector<Vec3f>& vertices, std::vector<Triangle>& triangles, std::vector<int>& faceIndices) const {
+	std::vector<int> vertexIndices(points.size(), -1);
+	faceIndices.assign(faces.size(), -1);
+	for(std::size_t i = 0; i < faces.size(); i++) {
+		const Face& face = faces[i];
+		if(!face.alive) continue;
+
+		Triangle triangle;
+		for(int corner = 0; corner < 3; corner++) {
+			int& vertexIndex = vertexIndices[face.vertices[corner]];
+			if(vertexIndex == -1) {
+				vertexIndex = static_cast<int>(vertices.size());
+				vertices.push_back(Vec3f(points[face.vertices[corner]]));
+			}
+			triangle[corner] = vertexIndex;
+		}
+		faceIndices[i] = static_cast<int>(triangles.size());
+		triangles.push_back(triangle);
+	}
+}
+
+int QuickHull::getTriangleCount() const {
+	int count = 0;
+	for(const Face& face : faces) {
+		if(face.alive) count++;
+	}
+	return count;
+}
+
+Polyhedron QuickHull::toPolyhedron() const {
+	std::vector<Vec3f> vertices;
+	std::vector<Triangle> triangles;
+	std::vector<int> faceIndices;
+	collectResult(vertices, triangles, faceIndices);
+	return Polyhedron(vertices.data(), triangles.data(), static_cast<int>(vertices.size()), static_cast<int>(triangles.size()));
+}
+
+IndexedShape QuickHull::toIndexedShape(TriangleNeighbors* neighborBuf) const {
+	std::vector<Vec3f> vertices;
+	std::vector<Triangle> triangles;
+	std::vector<int> faceIndices;
+	collectResult(vertices, triangles, faceIndices);
+
+	for(std::size_t i = 0; i < faces.size(); i++) {
+		if(faceIndices[i] == -1) continue;
+
+		// TriangleNeighbors are indexed by the opposite vertex, the edge opposite vertex k starts at vertex k + 1
+		TriangleNeighbors& neighbors = neighborBuf[faceIndices[i]];
+		for(int k = 0; k < 3; k++) {
+			neighbors.neighbors[k] = faceIndices[faces[i].neighbors[(k + 1) % 3]];
+		}
+	}
+
+	return IndexedShape(Polyhedron(vertices.data(), triangles.data(), static_cast<int>(vertices.size()), static_cast<int>(triangles.size())), neighborBuf);
+}
+
+Polyhedron convexHull(const Vec3f* points, int pointCount, int maxVertexCount) {
+	QuickHull hull;
+	hull.build(points, pointCount, maxVertexCount);
+	return hull.toPolyhedron();
+}
+
+std::vector<Polyhedron> convexHulls(const std::vector<std::vector<Vec3f>>& pointClouds, JobSystem& jobSystem, int maxVertexCount) {
+	std::vector<Polyhedron> results(pointClouds.size());
+	// the hulls may be built on workers, so errors are stored instead of thrown
+	std::vector<const char*> errors(pointClouds.size(), nullptr);
+
+	jobSystem.parallelFor(pointClouds.size(), 1, [&pointClouds, &results, &errors, maxVertexCount](std::size_t begin, std::size_t end) {
+		QuickHull hull;
+		for(std::size_t i = begin; i < end; i++) {
+			try {
+				hull.build(pointClouds[i].data(), static_cast<int>(pointClouds[i].size()), maxVertexCount);
+				results[i] = hull.toPolyhedron();
+			} catch(const char* error) {
+				errors[i] = error;
+			}
+		}
+	});
+
+	for(const char* error : errors) {
+		if(error != nullptr) throw error;
+	}
+	return results;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+
+#include "polyhedron.h"
+#include "indexedShape.h"
+
+class JobSystem;
+
+/*
+	Builds the convex hull of a point cloud with Quickhull
+
+	Starts from a tetrahedron of extreme points, every face keeps a conflict list of the points above it.
+	The point furthest from the hull is always added first, so a hull that is stopped at maxVertexCount is the hull of the most significant points.
+	Points that are closer to the hull than a tolerance relative to the size of the point cloud count as inside.
+
+	A QuickHull can be reused for several builds, it keeps its buffers.
+*/
+class QuickHull {
+	struct Face {
+		int vertices[3];
+		// neighbors[i] is the face across the edge from vertices[i] to vertices[(i + 1) % 3]
+		int neighbors[3];
+		Vec3 normal;
+		double offset;
+		std::vector<int> conflicts;
+		int furthestPoint;
+		double furthestDistance;
+		bool alive;
+		bool visible;
+	};
+	struct HorizonEdge {
+		int face;
+		int edge;
+	};
+	struct SearchFrame {
+		int face;
+		int firstEdge;
+		int step;
+	};
+
+	std::vector<Vec3> points;
+	std::vector<Face> faces;
+	double tolerance;
+	int addedVertexCount;
+
+	// scratch buffers of addPoint
+	std::vector<int> visibleFaces;
+	std::vector<HorizonEdge> horizon;
+	std::vector<SearchFrame> searchStack;
+	std::vector<int> newFaces;
+	std::unordered_map<int, int> newFaceStartingAt;
+
+	double distanceAbove(const Face& face, int point) const;
+	int createFace(int a, int b, int c);
+	void assignConflict(int point, const int* candidateFaces, int candidateCount);
+	void createInitialTetrahedron();
+	void findHorizon(int eyePoint, int startFace);
+	void addPoint(int eyePoint, int visibleFace);
+
+	void collectResult(std::vector<Vec3f>& vertices, std::vector<Triangle>& triangles, std::vector<int>& faceIndices) const;
+
+public:
+	/*
+		Builds the hull of the given points, throws if there are less than 4 points or they are all in one plane
+		A maxVertexCount of 0 doesn't limit the hull, otherwise the hull has at most max(maxVertexCount, 4) vertices
+	*/
+	void build(const Vec3f* points, int pointCount, int maxVertexCount = 0);
+
+	int getTriangleCount() const;
+
+	Polyhedron toPolyhedron() const;
+	// neighborBuf must be able to hold getTriangleCount() elements
+	IndexedShape toIndexedShape(TriangleNeighbors* neighborBuf) const;
+};
+
+Polyhedron convexHull(const Vec3f* points, int pointCount, int maxVertexCount = 0);
+
+/*
+	Builds the convex hulls of many point clouds in parallel on the jobSystem
+	If any of the hulls can't be built, the error of the first one is thrown after all builds are done
+*/
+std::vector<Polyhedron> convexHulls(const std::vector<std::vector<Vec3f>>& pointClouds, JobSystem& jobSystem, int maxVertexCount = 0);
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 #include "../math/linalg/vec.h"
 #include "../math/linalg/mat.h"
 #include "../math/rotation.h"
@@ -43,4 +45,8 @@ public:
 	virtual void setScaleX(double newX, DiagonalMat3& scale) const;
 	virtual void setScaleY(double newY, DiagonalMat3& scale) const;
 	virtual void setScaleZ(double newZ, DiagonalMat3& scale) const;
+
+	// for memory accounting, the size of the object of the class itself, and of the data it owns beyond that such as its vertices
+	virtual std::size_t getObjectSize() const = 0;
+	virtual std::size_t getDataSize() const { return 0; }
 };
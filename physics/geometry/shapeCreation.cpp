@@ -3,8 +3,13 @@
 #include "shapeClass.h"
 #include "polyhedron.h"
 #include "builtinShapeClasses.h"
+#include "triangleMeshShapeClass.h"
+#include "heightfieldShapeClass.h"
 
-#include "../../util/cpuid.h"
+#include "../misc/shapeClassCache.h"
+
+#include <algorithm>
+#include <cmath>
 
 Shape sphereShape(double radius) {
 	return Shape(&SphereClass::instance, radius * 2, radius * 2, radius * 2);
@@ -23,19 +28,39 @@ Shape polyhedronShape(const Polyhedron& poly) {
 	Vec3 center = bounds.getCenter();
 	DiagonalMat3 scale{2 / bounds.getWidth(), 2 / bounds.getHeight(), 2 / bounds.getDepth()};
 
-	PolyhedronShapeClass* shapeClass;
-
-	if(Util::CPUIDCheck::hasTechnology(Util::CPUIDCheck::AVX | Util::CPUIDCheck::AVX2 | Util::CPUIDCheck::FMA)) {
-		shapeClass = new PolyhedronShapeClassAVX(poly.translatedAndScaled(-center, scale));
-	} else if(Util::CPUIDCheck::hasTechnology(Util::CPUIDCheck::SSE | Util::CPUIDCheck::SSE2)) {
-		if(Util::CPUIDCheck::hasTechnology(Util::CPUIDCheck::SSE4_1)) {
-			shapeClass = new PolyhedronShapeClassSSE4(poly.translatedAndScaled(-center, scale));
-		} else {
-			shapeClass = new PolyhedronShapeClassSSE(poly.translatedAndScaled(-center, scale));
-		}
-	} else {
-		shapeClass = new PolyhedronShapeClassFallback(poly.translatedAndScaled(-center, scale));
-	}
+	// identical polyhedra share their ShapeClass
+	const PolyhedronShapeClass* shapeClass = ShapeClassCache::instance.getPolyhedronClass(poly.translatedAndScaled(-center, scale));
 
 	return Shape(shapeClass, bounds.getWidth(), bounds.getHeight(), bounds.getDepth());
 }
+
+Shape triangleMeshShape(const TriangleMesh& mesh) {
+	BoundingBox bounds = mesh.getBounds();
+	Vec3 center = bounds.getCenter();
+	// a flat mesh such as a plane of terrain keeps a size of 2 along its flat axis
+	double width = bounds.getWidth() > 0 ? bounds.getWidth() : 2.0;
+	double height = bounds.getHeight() > 0 ? bounds.getHeight() : 2.0;
+	double depth = bounds.getDepth() > 0 ? bounds.getDepth() : 2.0;
+	DiagonalMat3 scale{2 / width, 2 / height, 2 / depth};
+
+	return Shape(new TriangleMeshShapeClass(mesh.translatedAndScaled(-center, scale)), width, height, depth);
+}
+
+Shape heightfieldShape(std::vector<std::uint16_t>&& heights, int columnCount, int rowCount, double width, double height, double depth) {
+	return Shape(new HeightfieldShapeClass(std::move(heights), columnCount, rowCount), width, height, depth);
+}
+
+Shape heightfieldShape(const float* heights, int columnCount, int rowCount, double cellSize) {
+	std::size_t sampleCount = static_cast<std::size_t>(columnCount) * rowCount;
+	float lowest = *std::min_element(heights, heights + sampleCount);
+	float highest = *std::max_element(heights, heights + sampleCount);
+	// a flat field is put at the bottom of a box that is one cell high
+	double height = highest > lowest ? highest - lowest : cellSize;
+
+	std::vector<std::uint16_t> quantizedHeights(sampleCount);
+	for(std::size_t i = 0; i < sampleCount; i++) {
+		double fraction = (heights[i] - lowest) / height;
+		quantizedHeights[i] = static_cast<std::uint16_t>(std::lround(fraction * HeightfieldShapeClass::MAX_SAMPLE));
+	}
+	return heightfieldShape(std::move(quantizedHeights), columnCount, rowCount, (columnCount - 1) * cellSize, height, (rowCount - 1) * cellSize);
+}
@@ -2,9 +2,19 @@
 
 #include "shape.h"
 
+#include <cstdint>
+#include <vector>
+
 class Polyhedron;
+class TriangleMesh;
 
 Shape sphereShape(double radius);
 Shape cylinderShape(double radius, double height);
 Shape boxShape(double width, double height, double depth);
 Shape polyhedronShape(const Polyhedron& poly);
+// a static, non convex shape for terrain, see TriangleMeshShapeClass
+Shape triangleMeshShape(const TriangleMesh& mesh);
+// a static heightfield for terrain, see HeightfieldShapeClass. The heights span the height of the shape, from 0 at the bottom to HeightfieldShapeClass::MAX_SAMPLE at the top
+Shape heightfieldShape(std::vector<std::uint16_t>&& heights, int columnCount, int rowCount, double width, double height, double depth);
+// quantizes heights to 16 bits between the lowest and the highest sample, the samples are cellSize apart along x and z
+Shape heightfieldShape(const float* heights, int columnCount, int rowCount, double cellSize);
@@ -0,0 +1,165 @@
+#include "triangleBVH.h"
+
+#include <algorithm>
+#include <cmath>
+
+typedef BoundingBoxTemplate<float> BoundingBoxf;
+
+static BoundingBoxf emptyBounds() {
+	return BoundingBoxf(Vec3f(INFINITY, INFINITY, INFINITY), Vec3f(-INFINITY, -INFINITY, -INFINITY));
+}
+
+static void expand(BoundingBoxf& bounds, const Vec3f& point) {
+	for(int axis = 0; axis < 3; axis++) {
+		bounds.min[axis] = std::min(bounds.min[axis], point[axis]);
+		bounds.max[axis] = std::max(bounds.max[axis], point[axis]);
+	}
+}
+
+static void expand(BoundingBoxf& bounds, const BoundingBoxf& other) {
+	expand(bounds, other.min);
+	expand(bounds, other.max);
+}
+
+TriangleBVH::TriangleBVH(const MeshPrototype& mesh, std::vector<Triangle>& orderedTriangles) {
+	int triangleCount = mesh.triangleCount;
+	if(triangleCount > static_cast<int>(INDEX_MASK)) throw "Too many triangles for a TriangleBVH";
+
+	orderedTriangles.clear();
+	if(triangleCount == 0) return;
+
+	std::vector<BoundingBoxf> triangleBounds(triangleCount);
+	std::vector<Vec3f> centers(triangleCount);
+	std::vector<int> order(triangleCount);
+	BoundingBoxf meshBounds = emptyBounds();
+	for(int i = 0; i < triangleCount; i++) {
+		Triangle triangle = mesh.getTriangle(i);
+		BoundingBoxf bounds = emptyBounds();
+		for(int corner = 0; corner < 3; corner++) {
+			expand(bounds, mesh.getVertex(triangle.indexes[corner]));
+		}
+		triangleBounds[i] = bounds;
+		centers[i] = bounds.getCenter();
+		order[i] = i;
+		expand(meshBounds, bounds);
+	}
+
+	origin = meshBounds.min;
+	for(int axis = 0; axis < 3; axis++) {
+		float extent = meshBounds.max[axis] - meshBounds.min[axis];
+		// a flat mesh quantizes everything on that axis to 0
+		quantizeFactor[axis] = extent > 0.0f ? 65535.0f / extent : 0.0f;
+		dequantizeFactor[axis] = extent / 65535.0f;
+	}
+
+	// a full binary tree with leaves of at least one triangle
+	nodes.reserve(2 * (triangleCount / TRIANGLES_PER_LEAF + 1));
+	build(centers.data(), triangleBounds.data(), order.data(), 0, triangleCount);
+
+	orderedTriangles.reserve(triangleCount);
+	for(int i : order) {
+		orderedTriangles.push_back(mesh.getTriangle(i));
+	}
+}
+
+std::uint32_t TriangleBVH::build(const Vec3f* centers, const BoundingBoxf* triangleBounds, int* order, int first, int count) {
+	std::uint32_t nodeIndex = static_cast<std::uint32_t>(nodes.size());
+	nodes.emplace_back();
+
+	BoundingBoxf bounds = emptyBounds();
+	BoundingBoxf centerBounds = emptyBounds();
+	for(int i = first; i < first + count; i++) {
+		expand(bounds, triangleBounds[order[i]]);
+		expand(centerBounds, centers[order[i]]);
+	}
+	quantizeDown(bounds.min, nodes[nodeIndex].min);
+	quantizeUp(bounds.max, nodes[nodeIndex].max);
+
+	if(count <= TRIANGLES_PER_LEAF) {
+		nodes[nodeIndex].index = LEAF_FLAG | static_cast<std::uint32_t>(count) << COUNT_SHIFT | static_cast<std::uint32_t>(first);
+		return nodeIndex;
+	}
+
+	Vec3f centerExtent = centerBounds.max - centerBounds.min;
+	int axis = 0;
+	if(centerExtent.y > centerExtent[axis]) axis = 1;
+	if(centerExtent.z > centerExtent[axis]) axis = 2;
+
+	// splitting at the median keeps the tree balanced, so its depth is logarithmic in the triangle count
+	int half = count / 2;
+	std::nth_element(order + first, order + first + half, order + first + count, [centers, axis](int a, int b) {
+		return centers[a][axis] < centers[b][axis];
+	});
+
+	build(centers, triangleBounds, order, first, half);
+	std::uint32_t secondChild = build(centers, triangleBounds, order, first + half, count - half);
+	nodes[nodeIndex].index = secondChild;
+	return nodeIndex;
+}
+
+void TriangleBVH::quantizeDown(const Vec3f& point, std::uint16_t* result) const {
+	for(int axis = 0; axis < 3; axis++) {
+		float value = std::floor((point[axis] - origin[axis]) * quantizeFactor[axis]);
+		result[axis] = static_cast<std::uint16_t>(std::clamp(value, 0.0f, 65535.0f));
+	}
+}
+
+void TriangleBVH::quantizeUp(const Vec3f& point, std::uint16_t* result) const {
+	for(int axis = 0; axis < 3; axis++) {
+		float value = std::ceil((point[axis] - origin[axis]) * quantizeFactor[axis]);
+		result[axis] = static_cast<std::uint16_t>(std::clamp(value, 0.0f, 65535.0f));
+	}
+}
+
+BoundingBoxf TriangleBVH::getNodeBounds(const Node& node) const {
+	BoundingBoxf result;
+	for(int axis = 0; axis < 3; axis++) {
+		result.min[axis] = origin[axis] + node.min[axis] * dequantizeFactor[axis];
+		result.max[axis] = origin[axis] + node.max[axis] * dequantizeFactor[axis];
+	}
+	return result;
+}
+
+// slab test, returns the distance at which the ray enters bounds, or INFINITY if it misses
+static float rayEntryDistance(const BoundingBoxf& bounds, const Vec3f& rayOrigin, const Vec3f& inverseDirection, float maxDistance) {
+	float near = 0.0f;
+	float far = maxDistance;
+	for(int axis = 0; axis < 3; axis++) {
+		float t1 = (bounds.min[axis] - rayOrigin[axis]) * inverseDirection[axis];
+		float t2 = (bounds.max[axis] - rayOrigin[axis]) * inverseDirection[axis];
+		// rays parallel to the slab give NaN when they start on its border, those count as inside
+		if(std::isnan(t1) || std::isnan(t2)) continue;
+		near = std::max(near, std::min(t1, t2));
+		far = std::min(far, std::max(t1, t2));
+	}
+	return near <= far ? near : INFINITY;
+}
+
+float TriangleBVH::getIntersectionDistance(const MeshPrototype& mesh, Vec3f rayOrigin, Vec3f direction) const {
+	if(nodes.empty()) return INFINITY;
+
+	Vec3f inverseDirection(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+	float best = INFINITY;
+
+	std::uint32_t stack[MAX_DEPTH + 1];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while(stackSize > 0) {
+		const Node& node = nodes[stack[--stackSize]];
+		if(rayEntryDistance(getNodeBounds(node), rayOrigin, inverseDirection, best) == INFINITY) continue;
+
+		if(node.isLeaf()) {
+			int firstTriangle = node.getFirstTriangle();
+			for(int i = firstTriangle; i < firstTriangle + node.getTriangleCount(); i++) {
+				Triangle triangle = mesh.getTriangle(i);
+				float distance = rayTriangleIntersectionDistance(mesh.getVertex(triangle.firstIndex), mesh.getVertex(triangle.secondIndex), mesh.getVertex(triangle.thirdIndex), rayOrigin, direction);
+				best = std::min(best, distance);
+			}
+		} else {
+			std::uint32_t firstChild = static_cast<std::uint32_t>(&node - nodes.data()) + 1;
+			stack[stackSize++] = node.index;
+			stack[stackSize++] = firstChild;
+		}
+	}
+	return best;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../math/linalg/vec.h"
+#include "../math/boundingBox.h"
+#include "triangleMesh.h"
+
+/*
+	Bounding volume hierarchy over the triangles of a mesh
+
+	The boxes of the nodes are quantized to 16 bits per coordinate within the bounds of the whole mesh, rounded outward
+	so they always contain their triangles. A node takes 16 bytes, nodes are stored depth first so the first child of a
+	node directly follows it. A leaf references a range of consecutive triangles, building the tree decides the order
+	of the triangles so the mesh must use that order.
+*/
+class TriangleBVH {
+public:
+	struct Node {
+		std::uint16_t min[3];
+		std::uint16_t max[3];
+		/*
+			Leaves: LEAF_FLAG | count << COUNT_SHIFT | first triangle
+			Inner nodes: index of the second child
+		*/
+		std::uint32_t index;
+
+		bool isLeaf() const { return (index & LEAF_FLAG) != 0; }
+		int getFirstTriangle() const { return static_cast<int>(index & INDEX_MASK); }
+		int getTriangleCount() const { return static_cast<int>((index >> COUNT_SHIFT) & COUNT_MASK); }
+	};
+
+	static constexpr std::uint32_t LEAF_FLAG = 0x80000000;
+	static constexpr int COUNT_SHIFT = 27;
+	static constexpr std::uint32_t COUNT_MASK = 0xF;
+	static constexpr std::uint32_t INDEX_MASK = (1U << COUNT_SHIFT) - 1;
+	static constexpr int TRIANGLES_PER_LEAF = 4;
+	// enough for any tree over INDEX_MASK triangles, the build splits at the median
+	static constexpr int MAX_DEPTH = 32;
+
+private:
+	std::vector<Node> nodes;
+	Vec3f origin;
+	// per axis, multiplying an offset from origin by quantizeFactor gives the quantized coordinate
+	Vec3f quantizeFactor;
+	Vec3f dequantizeFactor;
+
+	std::uint32_t build(const Vec3f* centers, const BoundingBoxTemplate<float>* triangleBounds, int* order, int first, int count);
+	void quantizeDown(const Vec3f& point, std::uint16_t* result) const;
+	void quantizeUp(const Vec3f& point, std::uint16_t* result) const;
+	BoundingBoxTemplate<float> getNodeBounds(const Node& node) const;
+
+public:
+	TriangleBVH() = default;
+	/*
+		Builds the tree over the triangles of mesh
+		orderedTriangles receives the triangles of mesh in the order the leaves reference them
+	*/
+	TriangleBVH(const MeshPrototype& mesh, std::vector<Triangle>& orderedTriangles);
+
+	std::size_t getNodeCount() const { return nodes.size(); }
+	std::size_t getDataSize() const { return nodes.capacity() * sizeof(Node); }
+
+	/*
+		Calls func(int triangleIndex) for every triangle in a leaf whose box intersects bounds
+		Triangles that don't touch bounds may be reported too, the boxes are conservative
+	*/
+	template<typename Func>
+	void forEachTriangleIn(const BoundingBoxTemplate<float>& bounds, const Func& func) const {
+		if(nodes.empty()) return;
+		std::uint16_t queryMin[3];
+		std::uint16_t queryMax[3];
+		for(int axis = 0; axis < 3; axis++) {
+			float minOffset = (bounds.min[axis] - origin[axis]) * quantizeFactor[axis];
+			float maxOffset = (bounds.max[axis] - origin[axis]) * quantizeFactor[axis];
+			if(maxOffset < 0.0f || minOffset > 65535.0f) return;
+		}
+		quantizeDown(bounds.min, queryMin);
+		quantizeUp(bounds.max, queryMax);
+
+		std::uint32_t stack[MAX_DEPTH + 1];
+		int stackSize = 0;
+		std::uint32_t current = 0;
+		while(true) {
+			const Node& node = nodes[current];
+			bool overlaps =
+				node.min[0] <= queryMax[0] && node.max[0] >= queryMin[0] &&
+				node.min[1] <= queryMax[1] && node.max[1] >= queryMin[1] &&
+				node.min[2] <= queryMax[2] && node.max[2] >= queryMin[2];
+			if(overlaps) {
+				if(node.isLeaf()) {
+					int firstTriangle = node.getFirstTriangle();
+					int triangleCount = node.getTriangleCount();
+					for(int i = firstTriangle; i < firstTriangle + triangleCount; i++) {
+						func(i);
+					}
+				} else {
+					stack[stackSize++] = node.index;
+					current++;
+					continue;
+				}
+			}
+			if(stackSize == 0) break;
+			current = stack[--stackSize];
+		}
+	}
+
+	// the distance along direction to the closest triangle of mesh hit by the ray, INFINITY if none is hit
+	float getIntersectionDistance(const MeshPrototype& mesh, Vec3f rayOrigin, Vec3f direction) const;
+};
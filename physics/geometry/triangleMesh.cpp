@@ -11,7 +11,7 @@
 
 #pragma region bufManagement
 inline static size_t getOffset(size_t size) {
-	return (size + 7) & 0xFFFFFFFFFFFFFFF8;
+	return MeshPrototype::getPaddedSize(size);
 }
 inline static UniqueAlignedPointer<float> createParallelVecBuf(size_t size) {
 	return UniqueAlignedPointer<float>(getOffset(size) * 3, 32);
@@ -354,43 +354,45 @@ double TriangleMesh::getScaledMaxRadius(DiagonalMat3 scale) const {
 	return sqrt(getScaledMaxRadiusSq(scale));
 }
 
-float TriangleMesh::getIntersectionDistance(Vec3f origin, Vec3f direction) const {
+float rayTriangleIntersectionDistance(Vec3f v0, Vec3f v1, Vec3f v2, Vec3f origin, Vec3f direction) {
 	const float EPSILON = 0.0000001f;
-	float t = INFINITY;
-	for(Triangle triangle : iterTriangles()) {
-		Vec3f v0 = this->getVertex(triangle.firstIndex);
-		Vec3f v1 = this->getVertex(triangle.secondIndex);
-		Vec3f v2 = this->getVertex(triangle.thirdIndex);
 
-		Vec3f edge1, edge2, h, s, q;
-		float a, f, u, v;
+	Vec3f edge1, edge2, h, s, q;
+	float a, f, u, v;
 
-		edge1 = v1 - v0;
-		edge2 = v2 - v0;
+	edge1 = v1 - v0;
+	edge2 = v2 - v0;
 
-		h = direction % edge2;
-		a = edge1 * h;
+	h = direction % edge2;
+	a = edge1 * h;
 
-		if(a > -EPSILON && a < EPSILON) continue;
+	if(a > -EPSILON && a < EPSILON) return INFINITY;
 
-		f = 1.0f / a;
-		s = origin - v0;
-		u = f * (s * h);
+	f = 1.0f / a;
+	s = origin - v0;
+	u = f * (s * h);
 
-		if(u < 0.0 || u > 1.0) continue;
+	if(u < 0.0 || u > 1.0) return INFINITY;
 
-		q = s % edge1;
-		v = direction * f * q;
+	q = s % edge1;
+	v = direction * f * q;
 
-		if(v < 0.0f || u + v > 1.0f) continue;
+	if(v < 0.0f || u + v > 1.0f) return INFINITY;
 
-		float r = edge2 * f * q;
-		if(r > EPSILON) {
-			if(r < t) t = r;
-		} else {
-			//Log::debug("Line intersection but not a ray intersection");
-			continue;
-		}
+	float r = edge2 * f * q;
+	if(r > EPSILON) {
+		return r;
+	} else {
+		//Log::debug("Line intersection but not a ray intersection");
+		return INFINITY;
+	}
+}
+
+float TriangleMesh::getIntersectionDistance(Vec3f origin, Vec3f direction) const {
+	float t = INFINITY;
+	for(Triangle triangle : iterTriangles()) {
+		float r = rayTriangleIntersectionDistance(this->getVertex(triangle.firstIndex), this->getVertex(triangle.secondIndex), this->getVertex(triangle.thirdIndex), origin, direction);
+		if(r < t) t = r;
 	}
 
 	return t;
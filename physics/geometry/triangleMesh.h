@@ -75,6 +75,16 @@ public:
 
 	Vec3f getVertex(int index) const;
 	Triangle getTriangle(int index) const;
+
+	/*
+		The vertices and triangles are stored as three parallel blocks of x, y and z values, each getPaddedSize(count) long
+		The padding at the end of each block repeats the last element, so they can be processed 8 at a time
+	*/
+	static inline size_t getPaddedSize(size_t count) { return (count + 7) & ~size_t(7); }
+	const float* getVertexBuffer() const { return vertices.get(); }
+	const int* getTriangleBuffer() const { return triangles.get(); }
+	// the bytes of the vertex and triangle buffers, including their padding
+	size_t getDataSize() const { return (getPaddedSize(vertexCount) * sizeof(float) + getPaddedSize(triangleCount) * sizeof(int)) * 3; }
 };
 
 class EditableMesh : public MeshPrototype {
@@ -158,4 +168,6 @@ public:
 	float getIntersectionDistance(Vec3f origin, Vec3f direction) const;
 };
 
+// Möller–Trumbore, the distance along direction to the triangle v0 v1 v2, or INFINITY if the ray misses it
+float rayTriangleIntersectionDistance(Vec3f v0, Vec3f v1, Vec3f v2, Vec3f origin, Vec3f direction);
 TriangleMesh stripUnusedVertices(const Vec3f* vertices, const Triangle* triangles, int vertexCount, int triangleCount);
@@ -0,0 +1,41 @@
+#include "triangleMeshShapeClass.h"
+
+#include <vector>
+
+#include "builtinShapeClasses.h"
+#include "polyhedron.h"
+
+// the mass properties of the -1..1 box
+TriangleMeshShapeClass::TriangleMeshShapeClass(const TriangleMesh& normalizedMesh) :
+	ShapeClass(8, Vec3(0, 0, 0), ScalableInertialMatrix(Vec3(8.0 / 3.0, 8.0 / 3.0, 8.0 / 3.0), Vec3(0, 0, 0)), TRIANGLE_MESH_CLASS_ID) {
+
+	std::vector<Triangle> orderedTriangles;
+	bvh = TriangleBVH(normalizedMesh, orderedTriangles);
+
+	std::vector<Vec3f> vertices(normalizedMesh.vertexCount);
+	normalizedMesh.getVertices(vertices.data());
+	mesh = TriangleMesh(normalizedMesh.vertexCount, normalizedMesh.triangleCount, vertices.data(), orderedTriangles.data());
+}
+
+// an open mesh has no inside, so no point is contained in it
+bool TriangleMeshShapeClass::containsPoint(Vec3) const {
+	return false;
+}
+double TriangleMeshShapeClass::getIntersectionDistance(Vec3 origin, Vec3 direction) const {
+	return bvh.getIntersectionDistance(mesh, Vec3f(origin), Vec3f(direction));
+}
+BoundingBox TriangleMeshShapeClass::getBounds(const Rotation& rotation, const DiagonalMat3& scale) const {
+	return mesh.getBounds(Mat3f(rotation.asRotationMatrix() * scale));
+}
+double TriangleMeshShapeClass::getScaledMaxRadius(DiagonalMat3 scale) const {
+	return mesh.getScaledMaxRadius(scale);
+}
+double TriangleMeshShapeClass::getScaledMaxRadiusSq(DiagonalMat3 scale) const {
+	return mesh.getScaledMaxRadiusSq(scale);
+}
+Vec3f TriangleMeshShapeClass::furthestInDirection(const Vec3f& direction) const {
+	return mesh.furthestInDirection(direction);
+}
+Polyhedron TriangleMeshShapeClass::asPolyhedron() const {
+	return Polyhedron(mesh);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "shapeClass.h"
+#include "triangleMesh.h"
+#include "triangleBVH.h"
+
+/*
+	A non convex ShapeClass made of the triangles of a mesh, meant for static terrain such as a landscape or a level
+
+	Collisions with it are computed per triangle, the triangles near the other shape are found with a TriangleBVH so the
+	cost of a collision grows with the logarithm of the size of the mesh. Two triangle meshes never collide.
+	The mesh needs not be closed, so it has no inside: containsPoint is always false, and the mass properties are those of
+	the bounding box, which only keeps parts with this shape valid. Such parts should be terrain, not free parts.
+*/
+class TriangleMeshShapeClass : public ShapeClass {
+	TriangleMesh mesh;
+	TriangleBVH bvh;
+
+public:
+	// normalizedMesh must already be scaled to fit the -1..1 box of a ShapeClass, the order of its triangles is not kept
+	TriangleMeshShapeClass(const TriangleMesh& normalizedMesh);
+
+	const TriangleMesh& getMesh() const { return mesh; }
+	const TriangleBVH& getBVH() const { return bvh; }
+
+	// the convex pieces forEachCollidableIn passes
+	typedef TriangleCollidable Piece;
+
+	// calls func(const Piece&) for the triangles that may intersect bounds, bounds is in the -1..1 space of the class
+	template<typename Func>
+	void forEachCollidableIn(const BoundingBoxTemplate<float>& bounds, const Func& func) const {
+		bvh.forEachTriangleIn(bounds, [this, &func](int triangleIndex) {
+			Triangle triangle = mesh.getTriangle(triangleIndex);
+			TriangleCollidable collidable;
+			for(int corner = 0; corner < 3; corner++) {
+				collidable.vertices[corner] = mesh.getVertex(triangle.indexes[corner]);
+			}
+			func(collidable);
+		});
+	}
+
+	virtual bool containsPoint(Vec3 point) const override;
+	virtual double getIntersectionDistance(Vec3 origin, Vec3 direction) const override;
+	virtual BoundingBox getBounds(const Rotation& rotation, const DiagonalMat3& scale) const override;
+	virtual double getScaledMaxRadius(DiagonalMat3 scale) const override;
+	virtual double getScaledMaxRadiusSq(DiagonalMat3 scale) const override;
+	// the furthest point of the convex hull of the mesh
+	virtual Vec3f furthestInDirection(const Vec3f& direction) const override;
+	virtual Polyhedron asPolyhedron() const override;
+	virtual std::size_t getObjectSize() const override { return sizeof(TriangleMeshShapeClass); }
+	virtual std::size_t getDataSize() const override { return mesh.getDataSize() + bvh.getDataSize(); }
+};
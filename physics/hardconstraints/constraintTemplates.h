@@ -25,6 +25,10 @@ public:
 		return RelativeMotion(Motion(TranslationalMotion(), rotationMotion), CFrame(Rotation::rotZ(speedDerivatives.getConstantValue())));
 	}
 
+	virtual HardConstraint* clone() const override {
+		return new MotorConstraintTemplate(*this);
+	}
+
 	virtual ~MotorConstraintTemplate() override {}
 };
 
@@ -51,5 +55,9 @@ public:
 		return RelativeMotion(Motion(translationMotion, RotationalMotion()), CFrame(0.0, 0.0, speedDerivatives.getConstantValue()));
 	}
 
+	virtual HardConstraint* clone() const override {
+		return new PistonConstraintTemplate(*this);
+	}
+
 	virtual ~PistonConstraintTemplate() override {}
 };
@@ -16,6 +16,9 @@ public:
 	virtual RelativeMotion getRelativeMotion() const = 0;
 	
 	virtual CFrame getRelativeCFrame() const = 0;
+
+	// returns a new copy of this constraint, in its current state
+	virtual HardConstraint* clone() const = 0;
 	
 	virtual ~HardConstraint() {}
 };
@@ -1,6 +1,7 @@
 #include "layer.h"
 #include "world.h"
 
+#include "geometry/shapeClass.h"
 #include "misc/validityHelper.h"
 #include "misc/debug.h"
 #include "misc/physicsProfiler.h"
@@ -8,6 +9,21 @@
 #include <assert.h>
 
 
+ColissionProxy::ColissionProxy(const Part& part) :
+	cframe(part.getCFrame()),
+	scale(part.hitbox.scale),
+	maxRadius(part.maxRadius),
+	baseShape(part.hitbox.baseShape) {}
+
+Bounds ColissionProxy::getBounds() const {
+	BoundingBox boundsOfHitbox = this->baseShape->getBounds(this->cframe.getRotation(), this->scale);
+
+	assert(isVecValid(boundsOfHitbox.min));
+	assert(isVecValid(boundsOfHitbox.max));
+
+	return boundsOfHitbox + this->cframe.getPosition();
+}
+
 WorldLayer::WorldLayer(ColissionLayer* parent) : parent(parent) {}
 
 WorldLayer::~WorldLayer() {
@@ -18,7 +34,11 @@ WorldLayer::~WorldLayer() {
 
 WorldLayer::WorldLayer(WorldLayer&& other) noexcept :
 	tree(std::move(other.tree)),
-	parent(other.parent) {
+	parent(other.parent),
+	colissionProxies(std::move(other.colissionProxies)),
+	colissionProxiesOutdated(other.colissionProxiesOutdated) {
+
+	other.colissionProxiesOutdated = true;
 
 	for(Part& p : tree) {
 		assert(p.layer = &other);
@@ -28,6 +48,8 @@ WorldLayer::WorldLayer(WorldLayer&& other) noexcept :
 WorldLayer& WorldLayer::operator=(WorldLayer&& other) noexcept {
 	std::swap(tree, other.tree);
 	std::swap(parent, other.parent);
+	std::swap(colissionProxies, other.colissionProxies);
+	std::swap(colissionProxiesOutdated, other.colissionProxiesOutdated);
 
 	for(Part& p : tree) {
 		assert(p.layer = &other);
@@ -41,16 +63,42 @@ WorldLayer& WorldLayer::operator=(WorldLayer&& other) noexcept {
 }
 
 void WorldLayer::refresh() {
-	physicsMeasure.mark(PhysicsProcess::UPDATE_TREE_BOUNDS);
-	tree.recalculateBounds();
-	physicsMeasure.mark(PhysicsProcess::UPDATE_TREE_STRUCTURE);
+	{
+		PhysicsZone zone(PhysicsProcess::UPDATE_TREE_BOUNDS);
+		updateColissionProxies();
+	}
+	PhysicsZone zone(PhysicsProcess::UPDATE_TREE_STRUCTURE);
 	tree.improveStructure();
 }
 
+// the only place the broadphase reads Parts, the proxies are what the colission walks read instead
+static void refitNodeFromProxies(TreeNode& node, std::vector<ColissionProxy>& proxies) {
+	if(node.isLeafNode()) {
+		node.proxyIndex = static_cast<std::uint32_t>(proxies.size());
+		proxies.emplace_back(*static_cast<const Part*>(node.object));
+		node.bounds = proxies.back().getBounds();
+	} else {
+		for(TreeNode& subNode : node) {
+			refitNodeFromProxies(subNode, proxies);
+		}
+		node.recalculateBoundsFromSubBounds();
+	}
+}
+
+void WorldLayer::updateColissionProxies() {
+	colissionProxies.clear();
+	if(!tree.isEmpty()) {
+		refitNodeFromProxies(tree.rootNode, colissionProxies);
+	}
+	colissionProxiesOutdated = false;
+}
+
 void WorldLayer::addNode(TreeNode&& newNode) {
+	markColissionProxiesOutdated();
 	tree.add(std::move(newNode));
 }
 void WorldLayer::addPart(Part* newPart) {
+	markColissionProxiesOutdated();
 	tree.add(newPart, newPart->getBounds());
 }
 
@@ -65,6 +113,7 @@ static TreeNode createNodeFor(MotorizedPhysical* phys, bool makeGroupHead) {
 void WorldLayer::addIntoGroup(Part* newPart, Part* group) {
 	assert(newPart->layer == nullptr);
 	assert(group->layer == this);
+	markColissionProxiesOutdated();
 #ifndef NDEBUG
 	treeValidCheck(tree);
 #endif
@@ -85,37 +134,45 @@ void WorldLayer::addIntoGroup(Part* newPart, Part* group) {
 }
 
 void WorldLayer::moveOutOfGroup(Part* part) {
+	markColissionProxiesOutdated();
 	this->tree.moveOutOfGroup(part, part->getBounds());
 }
 
 void WorldLayer::removePart(Part* partToRemove) {
+	markColissionProxiesOutdated();
 	tree.remove(partToRemove, partToRemove->getBounds());
 	parent->world->onPartRemoved(partToRemove);
 }
 
 void WorldLayer::notifyPartBoundsUpdated(const Part* updatedPart, const Bounds& oldBounds) {
+	markColissionProxiesOutdated();
 	tree.updateObjectBounds(updatedPart, oldBounds);
 }
 void WorldLayer::notifyPartGroupBoundsUpdated(const Part* mainPart, const Bounds& oldMainPartBounds) {
+	markColissionProxiesOutdated();
 	tree.updateObjectGroupBounds(mainPart, oldMainPartBounds);
 }
 
 void WorldLayer::notifyPartStdMoved(Part* oldPartPtr, Part* newPartPtr) noexcept {
+	markColissionProxiesOutdated();
 	bool success = tree.findAndReplaceObject(oldPartPtr, newPartPtr, newPartPtr->getBounds());
 	assert(success);
 }
 
 void WorldLayer::mergeGroupsOf(Part* first, Part* second) {
+	markColissionProxiesOutdated();
 	this->tree.mergeGroupsOf(first, first->getBounds(), second, second->getBounds());
 }
 
 // TODO can be optimized, this only needs to move the single partToMove node
 void WorldLayer::moveIntoGroup(Part* partToMove, Part* group) {
+	markColissionProxiesOutdated();
 	this->tree.mergeGroupsOf(partToMove, partToMove->getBounds(), group, group->getBounds());
 }
 
 // TODO can be optimized, this only needs to move the single part nodes
 void WorldLayer::joinPartsIntoNewGroup(Part* p1, Part* p2) {
+	markColissionProxiesOutdated();
 	this->tree.mergeGroupsOf(p1, p1->getBounds(), p2, p2->getBounds());
 }
 
@@ -170,32 +227,31 @@ static bool boundsSphereEarlyEnd(const DiagonalMat3& scale, const Vec3& sphereCe
 	return std::abs(sphereCenter.x) > scale[0] + sphereRadius || std::abs(sphereCenter.y) > scale[1] + sphereRadius || std::abs(sphereCenter.z) > scale[2] + sphereRadius;
 }
 
-static bool runColissionPreTests(const Part& p1, const Part& p2) {
-	Vec3 offset = p1.getPosition() - p2.getPosition();
+static bool runColissionPreTests(const ColissionProxy& p1, const ColissionProxy& p2) {
+	Vec3 offset = p1.cframe.getPosition() - p2.cframe.getPosition();
 	if(isLongerThan(offset, p1.maxRadius + p2.maxRadius)) {
-		intersectionStatistics.addToTally(IntersectionResult::PART_DISTANCE_REJECT, 1);
+		if(physicsStatisticsEnabled) intersectionStatistics.addToTally(IntersectionResult::PART_DISTANCE_REJECT, 1);
 		return false;
 	}
-	if(boundsSphereEarlyEnd(p1.hitbox.scale, p1.getCFrame().globalToLocal(p2.getPosition()), p2.maxRadius)) {
-		intersectionStatistics.addToTally(IntersectionResult::PART_BOUNDS_REJECT, 1);
+	if(boundsSphereEarlyEnd(p1.scale, p1.cframe.globalToLocal(p2.cframe.getPosition()), p2.maxRadius)) {
+		if(physicsStatisticsEnabled) intersectionStatistics.addToTally(IntersectionResult::PART_BOUNDS_REJECT, 1);
 		return false;
 	}
-	if(boundsSphereEarlyEnd(p2.hitbox.scale, p2.getCFrame().globalToLocal(p1.getPosition()), p1.maxRadius)) {
-		intersectionStatistics.addToTally(IntersectionResult::PART_BOUNDS_REJECT, 1);
+	if(boundsSphereEarlyEnd(p2.scale, p2.cframe.globalToLocal(p1.cframe.getPosition()), p1.maxRadius)) {
+		if(physicsStatisticsEnabled) intersectionStatistics.addToTally(IntersectionResult::PART_BOUNDS_REJECT, 1);
 		return false;
 	}
 
 	return true;
 }
 
-static void recursiveFindColissionsBetween(std::vector<Colission>& colissions, const TreeNode& first, const TreeNode& second) {
+static void recursiveFindColissionsBetween(std::vector<Colission>& colissions, const TreeNode& first, const ColissionProxy* firstProxies, const TreeNode& second, const ColissionProxy* secondProxies) {
 	if(!intersects(first.bounds, second.bounds)) return;
 
 	if(first.isLeafNode() && second.isLeafNode()) {
-		Part* p1 = static_cast<Part*>(first.object);
-		Part* p2 = static_cast<Part*>(second.object);
-		if(runColissionPreTests(*p1, *p2)) {
-			colissions.push_back(Colission{p1, p2, Position(), Vec3()});
+		// the parts themselves are only pointed to by the candidates, never read here
+		if(runColissionPreTests(firstProxies[first.proxyIndex], secondProxies[second.proxyIndex])) {
+			colissions.push_back(Colission{static_cast<Part*>(first.object), static_cast<Part*>(second.object), Position(), Vec3()});
 		}
 	} else {
 		bool preferFirst = computeCost(first.bounds) <= computeCost(second.bounds);
@@ -203,38 +259,54 @@ static void recursiveFindColissionsBetween(std::vector<Colission>& colissions, c
 			// split first
 
 			for(const TreeNode& node : first) {
-				recursiveFindColissionsBetween(colissions, node, second);
+				recursiveFindColissionsBetween(colissions, node, firstProxies, second, secondProxies);
 			}
 		} else {
 			// split second
 
 			for(const TreeNode& node : second) {
-				recursiveFindColissionsBetween(colissions, first, node);
+				recursiveFindColissionsBetween(colissions, first, firstProxies, node, secondProxies);
 			}
 		}
 	}
 }
-static void recursiveFindColissionsInternal(std::vector<Colission>& colissions, const TreeNode& trunkNode) {
+static void recursiveFindColissionsInternal(std::vector<Colission>& colissions, const TreeNode& trunkNode, const ColissionProxy* proxies) {
 	// within the same node
 	if(trunkNode.isLeafNode() || trunkNode.isGroupHead)
 		return;
 
 	for(int i = 0; i < trunkNode.nodeCount; i++) {
 		const TreeNode& A = trunkNode[i];
-		recursiveFindColissionsInternal(colissions, A);
+		recursiveFindColissionsInternal(colissions, A, proxies);
 		for(int j = i + 1; j < trunkNode.nodeCount; j++) {
 			const TreeNode& B = trunkNode[j];
-			recursiveFindColissionsBetween(colissions, A, B);
+			recursiveFindColissionsBetween(colissions, A, proxies, B, proxies);
+		}
+	}
+}
+
+static void findColissionsBetween(std::vector<Colission>& colissions, const WorldLayer& first, const WorldLayer& second) {
+	assert(!first.colissionProxiesOutdated && !second.colissionProxiesOutdated);
+	if(first.tree.isEmpty() || second.tree.isEmpty()) return;
+	recursiveFindColissionsBetween(colissions, first.tree.rootNode, first.colissionProxies.data(), second.tree.rootNode, second.colissionProxies.data());
+}
+
+void ColissionLayer::updateColissionProxiesIfOutdated() {
+	for(WorldLayer& layer : subLayers) {
+		if(layer.colissionProxiesOutdated) {
+			layer.updateColissionProxies();
 		}
 	}
 }
 
 void ColissionLayer::getInternalColissions(ColissionBuffer& curColissions) const {
-	recursiveFindColissionsInternal(curColissions.freePartColissions, subLayers[0].tree.rootNode);
-	recursiveFindColissionsBetween(curColissions.freeTerrainColissions, subLayers[0].tree.rootNode, subLayers[1].tree.rootNode);
+	const WorldLayer& freeParts = subLayers[FREE_PARTS_LAYER];
+	assert(!freeParts.colissionProxiesOutdated);
+	recursiveFindColissionsInternal(curColissions.freePartColissions, freeParts.tree.rootNode, freeParts.colissionProxies.data());
+	findColissionsBetween(curColissions.freeTerrainColissions, freeParts, subLayers[TERRAIN_PARTS_LAYER]);
 }
 void getColissionsBetween(const ColissionLayer& a, const ColissionLayer& b, ColissionBuffer& curColissions) {
-	recursiveFindColissionsBetween(curColissions.freePartColissions, a.subLayers[0].tree.rootNode, b.subLayers[0].tree.rootNode);
-	recursiveFindColissionsBetween(curColissions.freeTerrainColissions, a.subLayers[0].tree.rootNode, b.subLayers[1].tree.rootNode);
-	recursiveFindColissionsBetween(curColissions.freeTerrainColissions, b.subLayers[0].tree.rootNode, a.subLayers[1].tree.rootNode);
+	findColissionsBetween(curColissions.freePartColissions, a.subLayers[ColissionLayer::FREE_PARTS_LAYER], b.subLayers[ColissionLayer::FREE_PARTS_LAYER]);
+	findColissionsBetween(curColissions.freeTerrainColissions, a.subLayers[ColissionLayer::FREE_PARTS_LAYER], b.subLayers[ColissionLayer::TERRAIN_PARTS_LAYER]);
+	findColissionsBetween(curColissions.freeTerrainColissions, b.subLayers[ColissionLayer::FREE_PARTS_LAYER], a.subLayers[ColissionLayer::TERRAIN_PARTS_LAYER]);
 }
@@ -8,12 +8,36 @@
 
 class WorldPrototype;
 class ColissionLayer;
+class ShapeClass;
+
+/*
+	A compact copy of the part data needed by the broadphase, the colission pretests and the refitting of the tree
+	These are stored contiguously in their WorldLayer, so these stages don't have to pull in the rest of each Part
+*/
+struct ColissionProxy {
+	GlobalCFrame cframe;
+	DiagonalMat3 scale;
+	double maxRadius;
+	const ShapeClass* baseShape;
+
+	ColissionProxy() = default;
+	explicit ColissionProxy(const Part& part);
+
+	Bounds getBounds() const;
+};
 
 class WorldLayer {
 public:
 	BoundsTree<Part> tree;
 	ColissionLayer* parent;
 
+	/*
+		Indexed by the proxyIndex of the leaf nodes of tree, laid out in tree order
+		Only valid while colissionProxiesOutdated is false, any modification of the layer invalidates them
+	*/
+	std::vector<ColissionProxy> colissionProxies;
+	bool colissionProxiesOutdated = true;
+
 	explicit WorldLayer(ColissionLayer* parent);
 
 	WorldLayer(WorldLayer&& other) noexcept;
@@ -24,6 +48,11 @@ public:
 	~WorldLayer();
 
 	void refresh();
+	/*
+		Rebuilds the colissionProxies from the parts in this layer, and refits the bounds of the tree around them
+	*/
+	void updateColissionProxies();
+	inline void markColissionProxiesOutdated() noexcept { colissionProxiesOutdated = true; }
 
 	void addNode(TreeNode&& newNode);
 	void addPart(Part* newPart);
@@ -31,6 +60,7 @@ public:
 	void addIntoGroup(Part* newPart, Part* group);
 	template<typename PartIterBegin, typename PartIterEnd>
 	void addAllToGroup(PartIterBegin begin, PartIterEnd end, Part* group) {
+		markColissionProxiesOutdated();
 		tree.addAllToExistingGroup(begin, end, group);
 	}
 	//void addIntoGroup(MotorizedPhysical* newPhys, Part* group);
@@ -50,6 +80,7 @@ public:
 
 	template<typename PartIterBegin, typename PartIterEnd>
 	void moveAllOutOfGroup(PartIterBegin begin, PartIterEnd end) {
+		markColissionProxiesOutdated();
 		tree.moveAllOutOfGroup(begin, end);
 	}
 	void optimize() {
@@ -82,6 +113,7 @@ public:
 	ColissionLayer& operator=(ColissionLayer&& other) noexcept;
 
 	void refresh();
+	void updateColissionProxiesIfOutdated();
 
 	void getInternalColissions(ColissionBuffer& curColissions) const;
 
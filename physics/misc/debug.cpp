@@ -11,20 +11,114 @@
 #include <fstream>
 #include <chrono>
 #include <sstream>
+#include <atomic>
+#include <mutex>
 
 namespace Debug {
-	void(*logVecAction)(Position, Vec3, VectorType) = [](Position, Vec3, VectorType) {};
-	void(*logPointAction)(Position, PointType) = [](Position, PointType) {};
+#if DEBUG_LOG_LEVEL > 0
+	/*
+		Ring buffer of the entries logged by one thread, written only by that thread and read only by the thread that drains the log
+		Rings of threads that have exited are handed to new threads once they have been drained
+	*/
+	struct LogRing {
+		static constexpr std::size_t CAPACITY = 4096;
+
+		LogEntry entries[CAPACITY];
+		alignas(64) std::atomic<std::size_t> head{0};
+		alignas(64) std::atomic<std::size_t> tail{0};
+		std::atomic<bool> owned{true};
+
+		void push(const LogEntry& entry) {
+			std::size_t h = head.load(std::memory_order_relaxed);
+			if(h - tail.load(std::memory_order_acquire) == CAPACITY) {
+				droppedLogCount.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			entries[h % CAPACITY] = entry;
+			head.store(h + 1, std::memory_order_release);
+		}
+
+		void drain(std::vector<LogEntry>& output) {
+			std::size_t t = tail.load(std::memory_order_relaxed);
+			std::size_t h = head.load(std::memory_order_acquire);
+			for(; t != h; t++) {
+				output.push_back(entries[t % CAPACITY]);
+			}
+			tail.store(h, std::memory_order_release);
+		}
+
+		static std::atomic<std::size_t> droppedLogCount;
+	};
+	std::atomic<std::size_t> LogRing::droppedLogCount{0};
+
+	// only locked when a thread logs for the first time, and while draining
+	static std::mutex ringsLock;
+	static std::vector<LogRing*> rings;
+
+	// gives the ring of the thread back when the thread exits
+	struct ThreadLogRing {
+		LogRing* ring = nullptr;
+
+		~ThreadLogRing() {
+			if(ring != nullptr) ring->owned.store(false, std::memory_order_release);
+		}
+
+		LogRing* get() {
+			if(ring != nullptr) return ring;
+			std::lock_guard<std::mutex> lg(ringsLock);
+			for(LogRing* free : rings) {
+				if(!free->owned.load(std::memory_order_acquire) && free->head.load(std::memory_order_relaxed) == free->tail.load(std::memory_order_relaxed)) {
+					free->owned.store(true, std::memory_order_relaxed);
+					ring = free;
+					return ring;
+				}
+			}
+			ring = new LogRing();
+			rings.push_back(ring);
+			return ring;
+		}
+	};
+	static thread_local ThreadLogRing threadRing;
+#endif
+
+	static std::atomic<bool> logEnabled{false};
+
 	void(*logCFrameAction)(CFrame, CFrameType) = [](CFrame, CFrameType) {};
 	void(*logShapeAction)(const Polyhedron&, const GlobalCFrame&) = [](const Polyhedron&, const GlobalCFrame&) {};
 	
-	void logVector(Position origin, Vec3 vec, VectorType type) { logVecAction(origin, vec, type); };
-	void logPoint(Position point, PointType type) { logPointAction(point, type); }
+#if DEBUG_LOG_LEVEL > 0
+	void logVector(Position origin, Vec3 vec, VectorType type) {
+		if(!logEnabled.load(std::memory_order_relaxed)) return;
+		threadRing.get()->push(LogEntry{origin, vec, false, type});
+	}
+	void logPoint(Position point, PointType type) {
+		if(!logEnabled.load(std::memory_order_relaxed)) return;
+		threadRing.get()->push(LogEntry{point, Vec3(0.0, 0.0, 0.0), true, type});
+	}
+#else
+	void logVector(Position, Vec3, VectorType) {}
+	void logPoint(Position, PointType) {}
+#endif
 	void logCFrame(CFrame frame, CFrameType type) { logCFrameAction(frame, type); };
 	void logShape(const Polyhedron& shape, const GlobalCFrame& location) { logShapeAction(shape, location); };
 
-	void setVectorLogAction(void(*logger)(Position origin, Vec3 vec, VectorType type)) { logVecAction = logger; };
-	void setPointLogAction(void(*logger)(Position point, PointType type)) { logPointAction = logger; }
+	void setLogEnabled(bool enabled) { logEnabled.store(enabled, std::memory_order_relaxed); }
+	bool isLogEnabled() { return logEnabled.load(std::memory_order_relaxed); }
+#if DEBUG_LOG_LEVEL > 0
+	void drainLog(std::vector<LogEntry>& output) {
+		std::lock_guard<std::mutex> lg(ringsLock);
+		for(LogRing* ring : rings) {
+			ring->drain(output);
+		}
+	}
+	std::size_t getDroppedLogCount() {
+		return LogRing::droppedLogCount.load(std::memory_order_relaxed);
+	}
+#else
+	void drainLog(std::vector<LogEntry>&) {}
+	std::size_t getDroppedLogCount() { return 0; }
+#endif
+
 	void setCFrameLogAction(void(*logger)(CFrame frame, CFrameType type)) { logCFrameAction = logger; };
 	void setShapeLogAction(void(*logger)(const Polyhedron& shape, const GlobalCFrame& location)) { logShapeAction = logger; }
 
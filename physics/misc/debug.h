@@ -5,6 +5,30 @@
 #include "../math/cframe.h"
 #include "../math/globalCFrame.h"
 
+#include <vector>
+
+/*
+	Compile time level of the vector and point logging of the physics
+	0: DEBUG_LOG_VECTOR and DEBUG_LOG_POINT compile to nothing, their arguments are not evaluated either
+	1: they record into a ring buffer of the logging thread, while logging is enabled at runtime with Debug::setLogEnabled
+	Builds with NDEBUG default to 0
+*/
+#ifndef DEBUG_LOG_LEVEL
+#ifdef NDEBUG
+#define DEBUG_LOG_LEVEL 0
+#else
+#define DEBUG_LOG_LEVEL 1
+#endif
+#endif
+
+#if DEBUG_LOG_LEVEL > 0
+#define DEBUG_LOG_VECTOR(ORIGIN, VECTOR, TYPE) Debug::logVector(ORIGIN, VECTOR, TYPE)
+#define DEBUG_LOG_POINT(POINT, TYPE) Debug::logPoint(POINT, TYPE)
+#else
+#define DEBUG_LOG_VECTOR(ORIGIN, VECTOR, TYPE) ((void) 0)
+#define DEBUG_LOG_POINT(POINT, TYPE) ((void) 0)
+#endif
+
 class Part;
 
 class Polyhedron;
@@ -34,13 +58,36 @@ namespace Debug {
 		INERTIAL_CFRAME
 	};
 
+	// a logged vector or point, points have no vector
+	struct LogEntry {
+		Position origin;
+		Vec3 vector;
+		bool isPoint;
+		int type;
+	};
+
+	/*
+		Every thread that logs gets a ring buffer of its own which only it writes to, so logging takes no lock
+		Entries logged while the ring of a thread is full are dropped
+		Ignored below DEBUG_LOG_LEVEL 1
+	*/
 	void logVector(Position origin, Vec3 vec, VectorType type);
 	void logPoint(Position point, PointType type);
+
 	void logCFrame(CFrame frame, CFrameType type);
 	void logShape(const Polyhedron& shape);
 
-	void setVectorLogAction(void(*logger)(Position origin, Vec3 vec, VectorType type));
-	void setPointLogAction(void(*logger)(Position point, PointType type));
+	// logging is disabled until this is called, so nothing is recorded if no one drains the log
+	void setLogEnabled(bool enabled);
+	bool isLogEnabled();
+	/*
+		Appends the entries logged since the last call to output, per thread in the order they were logged
+		Only one thread may drain the log
+	*/
+	void drainLog(std::vector<LogEntry>& output);
+	// number of entries dropped because a ring was full
+	std::size_t getDroppedLogCount();
+
 	void setCFrameLogAction(void(*logger)(CFrame frame, CFrameType type));
 	void setShapeLogAction(void(*logger)(const Polyhedron& shape, const GlobalCFrame& location));
 
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "../math/cframe.h"
+#include "../math/globalCFrame.h"
+#include "../motion.h"
+#include "../part.h"
+
+/*
+	Section based world format that can be used straight from a memory mapped file
+
+	The file starts with a FileHeader, followed by a SectionEntry for every Section. Every section starts at a multiple of
+	SECTION_ALIGNMENT. Bulk data is stored as flat tables of trivially copyable records, polyhedra are stored in the padded
+	parallel layout of MeshPrototype, so they are adopted by the loaded ShapeClasses without copying. Data that is only
+	known to a DynamicSerializerRegistry, such as constraints and external forces, is stored in the stream format of
+	serialization.cpp.
+
+	The version is split in two. A new major version changes sections or records that already exist, readers reject any
+	major version but their own. A new minor version only appends sections to the end of the table, readers ignore the
+	sections they don't know, so they read files of any minor version.
+	All values are stored in the byte order of the machine that wrote the file, the same as the stream format.
+*/
+namespace MappedWorldFormat {
+
+constexpr char MAGIC[8]{'P', '3', 'D', 'W', 'O', 'R', 'L', 'D'};
+constexpr std::uint16_t MAJOR_VERSION = 1;
+constexpr std::uint16_t MINOR_VERSION = 0;
+// also satisfies the 32 byte alignment the AVX paths need for mesh blocks
+constexpr std::size_t SECTION_ALIGNMENT = 64;
+constexpr std::uint32_t NO_PARENT = 0xFFFFFFFF;
+
+enum class Section : std::uint32_t {
+	// a single WorldRecord
+	WORLD,
+	// a bool per layer pair, in the order of the stream format
+	LAYER_COLISSIONS,
+	// a ShapeClassRecord per ShapeClass that is not known in advance, in the order of their IDs
+	SHAPE_CLASSES,
+	// vertex and triangle blocks referenced by ShapeClassRecords, each starts at a multiple of SECTION_ALIGNMENT
+	MESH_DATA,
+	// a PartRecord per part, first the terrain parts, then the parts of every physical in PhysicalRecord order
+	PARTS,
+	// a PhysicalRecord per physical, depth first with parents before their children, like the stream format
+	PHYSICALS,
+	// constraint groups, in the stream format
+	CONSTRAINTS,
+	// external forces, in the stream format
+	EXTERNAL_FORCES,
+	// variable length data referenced through BlobRanges
+	BLOB,
+	COUNT
+};
+
+struct FileHeader {
+	char magic[8];
+	// in place of the earlier 32 bit version, which reads as 1.0 on little endian machines
+	std::uint16_t majorVersion;
+	std::uint16_t minorVersion;
+	std::uint32_t sectionCount;
+	std::uint64_t fileSize;
+};
+
+struct SectionEntry {
+	std::uint64_t offset;
+	std::uint64_t size;
+};
+
+// range of bytes in the BLOB section
+struct BlobRange {
+	std::uint64_t offset;
+	std::uint64_t size;
+};
+
+struct WorldRecord {
+	std::uint64_t age;
+	std::uint32_t layerCount;
+	std::uint32_t terrainPartCount;
+	std::uint32_t partCount;
+	std::uint32_t physicalCount;
+};
+
+enum class ShapeClassKind : std::uint32_t {
+	// vertexCount and triangleCount describe a polyhedron in MESH_DATA, its vertex block immediately followed by its triangle block
+	POLYHEDRON,
+	// any other ShapeClass, stored in the BLOB section through dynamicShapeClassSerializer
+	STREAM
+};
+
+struct ShapeClassRecord {
+	ShapeClassKind kind;
+	std::uint32_t vertexCount;
+	std::uint32_t triangleCount;
+	std::uint32_t padding;
+	// range in MESH_DATA for POLYHEDRON, in BLOB for STREAM
+	std::uint64_t offset;
+	std::uint64_t size;
+};
+
+struct PartRecord {
+	// terrain parts only
+	GlobalCFrame cframe;
+	// attached parts only, relative to the main part of their rigid body
+	CFrame attachment;
+	double width;
+	double height;
+	double depth;
+	PartProperties properties;
+	std::uint32_t shapeClassID;
+	std::uint32_t layerID;
+	// written by serializePartExternalData
+	BlobRange externalData;
+};
+
+struct PhysicalRecord {
+	// motorized physicals only
+	Motion motionOfCenterOfMass;
+	// motorized physicals only, cframe of the main part
+	GlobalCFrame cframe;
+	// connected physicals only
+	CFrame attachOnChild;
+	CFrame attachOnParent;
+	BlobRange hardConstraint;
+
+	// NO_PARENT for motorized physicals
+	std::uint32_t parentIndex;
+	std::uint32_t childCount;
+	// index of the main part in PARTS, followed by the attached parts
+	std::uint32_t firstPart;
+	std::uint32_t partCount;
+};
+
+static_assert(sizeof(FileHeader) % 8 == 0 && sizeof(SectionEntry) % 8 == 0, "Header records must keep the tables after them aligned");
+static_assert(sizeof(ShapeClassRecord) % 8 == 0 && sizeof(PartRecord) % 8 == 0 && sizeof(PhysicalRecord) % 8 == 0, "Records must keep the records after them aligned");
+
+inline std::size_t alignToSection(std::size_t offset) {
+	return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+}
+
+// true if data starts with the header of a mapped world file, otherwise it should be read with the stream format
+bool isMappedWorldFile(const char* data, std::size_t size);
+
+};
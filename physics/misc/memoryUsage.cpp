@@ -0,0 +1,104 @@
+#include "memoryUsage.h"
+
+#include <unordered_set>
+#include <algorithm>
+
+#include "../world.h"
+#include "../layer.h"
+#include "../part.h"
+#include "../physical.h"
+#include "../geometry/shapeClass.h"
+
+const char* MemoryUsage::labels[NUMBER_OF_CATEGORIES]{
+	"Tree nodes",
+	"Colission proxies",
+	"Parts",
+	"Physicals",
+	"Shape classes",
+	"Shape data",
+	"Colission buffers",
+	"Bookkeeping"
+};
+
+void MemoryUsage::getValues(std::size_t* values) const {
+	values[0] = treeNodes;
+	values[1] = colissionProxies;
+	values[2] = parts;
+	values[3] = physicals;
+	values[4] = shapeClasses;
+	values[5] = shapeData;
+	values[6] = colissionBuffers;
+	values[7] = bookkeeping;
+}
+
+std::size_t MemoryUsage::getTotal() const {
+	std::size_t values[NUMBER_OF_CATEGORIES];
+	getValues(values);
+	std::size_t total = 0;
+	for(std::size_t v : values) total += v;
+	return total;
+}
+
+MemoryUsage& MemoryUsage::operator+=(const MemoryUsage& other) {
+	treeNodes += other.treeNodes;
+	colissionProxies += other.colissionProxies;
+	parts += other.parts;
+	physicals += other.physicals;
+	shapeClasses += other.shapeClasses;
+	shapeData += other.shapeData;
+	colissionBuffers += other.colissionBuffers;
+	bookkeeping += other.bookkeeping;
+	return *this;
+}
+
+std::size_t TickMemoryUsage::getPeak() const {
+	// the narrowphase results are freed before the constraints are solved
+	return colissions + std::max(narrowphaseScratch, constraintScratch);
+}
+
+template<typename T>
+static std::size_t capacityBytes(const std::vector<T>& list) {
+	return list.capacity() * sizeof(T);
+}
+
+// the memory a physical owns beyond the object itself, ConnectedPhysicals are stored inside the vector of their parent
+static std::size_t getOwnedPhysicalMemory(const Physical& phys) {
+	std::size_t total = capacityBytes(phys.rigidBody.parts) + capacityBytes(phys.childPhysicals);
+	for(const ConnectedPhysical& child : phys.childPhysicals) {
+		total += getOwnedPhysicalMemory(child);
+	}
+	return total;
+}
+
+MemoryUsage WorldPrototype::getMemoryUsage() const {
+	MemoryUsage result;
+
+	std::unordered_set<const ShapeClass*> seenShapeClasses;
+	for(const ColissionLayer& layer : layers) {
+		for(const WorldLayer& subLayer : layer.subLayers) {
+			result.treeNodes += subLayer.tree.getNodeMemory();
+			result.colissionProxies += capacityBytes(subLayer.colissionProxies);
+		}
+	}
+	for(const Part& part : iterParts()) {
+		result.parts += sizeof(Part);
+		const ShapeClass* shapeClass = part.hitbox.baseShape;
+		if(seenShapeClasses.insert(shapeClass).second) {
+			result.shapeClasses += shapeClass->getObjectSize();
+			result.shapeData += shapeClass->getDataSize();
+		}
+	}
+	for(const MotorizedPhysical* phys : physicals) {
+		result.physicals += sizeof(MotorizedPhysical) + getOwnedPhysicalMemory(*phys);
+	}
+
+	result.colissionBuffers = capacityBytes(curColissions.freePartColissions) + capacityBytes(curColissions.freeTerrainColissions);
+
+	result.bookkeeping = sizeof(WorldPrototype) + capacityBytes(layers) + capacityBytes(physicals) + capacityBytes(externalForces)
+		+ capacityBytes(springLinks) + capacityBytes(colissionMask) + capacityBytes(constraints);
+	for(const ConstraintGroup& group : constraints) {
+		result.bookkeeping += capacityBytes(group.constraints);
+	}
+
+	return result;
+}
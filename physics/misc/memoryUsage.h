@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+
+/*
+	Bytes a world holds, per subsystem, as computed by WorldPrototype::getMemoryUsage()
+
+	Counts the memory the world and its parts reserved, including unused vector capacity, but not the overhead of the allocator
+	Parts are counted as sizeof(Part), the world can't see the size of subclasses of Part
+	Shape classes shared by several parts or worlds are counted once per world
+*/
+struct MemoryUsage {
+	// the sub node arrays of the bounds trees of all layers
+	std::size_t treeNodes = 0;
+	// the ColissionProxies of all layers
+	std::size_t colissionProxies = 0;
+	std::size_t parts = 0;
+	// MotorizedPhysicals, their ConnectedPhysicals and the attachments of their rigid bodies
+	std::size_t physicals = 0;
+	// the objects of the shape classes used by the parts
+	std::size_t shapeClasses = 0;
+	// the vertices, triangles and acceleration structures owned by those shape classes
+	std::size_t shapeData = 0;
+	// the reserved capacity of the ColissionBuffer of the world
+	std::size_t colissionBuffers = 0;
+	// the constraint groups and the lists of the world, such as physicals, forces and links
+	std::size_t bookkeeping = 0;
+
+	static constexpr std::size_t NUMBER_OF_CATEGORIES = 8;
+	static const char* labels[NUMBER_OF_CATEGORIES];
+
+	// the categories in the order of labels
+	void getValues(std::size_t* values) const;
+	std::size_t getTotal() const;
+
+	MemoryUsage& operator+=(const MemoryUsage& other);
+};
+
+/*
+	The scratch memory used during one tick, which is freed again or reused by the next tick
+	Filled by WorldPrototype::tick() into lastTickMemory, it only adds up sizes the tick already knows, so it is always on
+*/
+struct TickMemoryUsage {
+	// the colission pairs found by the broadphase, alive for the whole tick
+	std::size_t colissions = 0;
+	// the largest results buffer of the parallel narrowphase, zero for the serial one
+	std::size_t narrowphaseScratch = 0;
+	// the largest scratch of a single ConstraintGroup, its matrices and the system it solves
+	std::size_t constraintScratch = 0;
+
+	// the most of the above that is alive at the same time
+	std::size_t getPeak() const;
+};
@@ -5,6 +5,7 @@ const char * physicsLabels[]{
 	"GJK No Col",
 	"EPA",
 	"Collision",
+	"Narrowphase",
 	"Externals",
 	"Col. Handling",
 	"Constraints",
@@ -13,6 +14,7 @@ const char * physicsLabels[]{
 	"Wait for lock",
 	"Updates",
 	"Queue",
+	"Snapshot",
 	"Other"
 };
 
@@ -43,11 +45,21 @@ const char* iterationLabels[]{
 	"MAX",
 };
 
-BreakdownAverageProfiler<PhysicsProcess> physicsMeasure(physicsLabels, 100);
-HistoricTally<long long, IntersectionResult> intersectionStatistics(intersectionLabels, 1);
+ZoneProfiler<PhysicsProcess> physicsMeasure(physicsLabels, 100);
+
+thread_local bool physicsStatisticsEnabled = true;
+ThreadTally<long long, IntersectionResult> intersectionStatistics(intersectionLabels, 1);
 CircularBuffer<int> gjkCollideIterStats(1);
 CircularBuffer<int> gjkNoCollideIterStats(1);
 
-HistoricTally<long long, IterationTime> GJKCollidesIterationStatistics(iterationLabels, 1);
-HistoricTally<long long, IterationTime> GJKNoCollidesIterationStatistics(iterationLabels, 1);
-HistoricTally<long long, IterationTime> EPAIterationStatistics(iterationLabels, 1);
+ThreadTally<long long, IterationTime> GJKCollidesIterationStatistics(iterationLabels, 1);
+ThreadTally<long long, IterationTime> GJKNoCollidesIterationStatistics(iterationLabels, 1);
+ThreadTally<long long, IterationTime> EPAIterationStatistics(iterationLabels, 1);
+
+void endPhysicsStatisticsTick() {
+	physicsMeasure.endTick();
+
+	GJKCollidesIterationStatistics.nextTally();
+	GJKNoCollidesIterationStatistics.nextTally();
+	EPAIterationStatistics.nextTally();
+}
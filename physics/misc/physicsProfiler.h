@@ -1,12 +1,14 @@
 #pragma once
 
 #include "profiling.h"
+#include "threadProfiling.h"
 
 enum class PhysicsProcess {
 	GJK_COL,
 	GJK_NO_COL,
 	EPA,
 	COLISSION_OTHER,
+	NARROWPHASE,
 	EXTERNALS,
 	COLISSION_HANDLING,
 	CONSTRAINTS,
@@ -15,6 +17,7 @@ enum class PhysicsProcess {
 	WAIT_FOR_LOCK,
 	UPDATING,
 	QUEUE,
+	SNAPSHOT,
 	OTHER,
 	COUNT
 };
@@ -35,10 +38,40 @@ enum class IterationTime {
 	COUNT = 17
 };
 
-extern BreakdownAverageProfiler<PhysicsProcess> physicsMeasure;
-extern HistoricTally<long long, IntersectionResult> intersectionStatistics;
+extern ZoneProfiler<PhysicsProcess> physicsMeasure;
+extern ThreadTally<long long, IntersectionResult> intersectionStatistics;
 extern CircularBuffer<int> gjkCollideIterStats;
 extern CircularBuffer<int> gjkNoCollideIterStats;
-extern HistoricTally<long long, IterationTime> GJKCollidesIterationStatistics;
-extern HistoricTally<long long, IterationTime> GJKNoCollidesIterationStatistics;
-extern HistoricTally<long long, IterationTime> EPAIterationStatistics;
+extern ThreadTally<long long, IterationTime> GJKCollidesIterationStatistics;
+extern ThreadTally<long long, IterationTime> GJKNoCollidesIterationStatistics;
+extern ThreadTally<long long, IterationTime> EPAIterationStatistics;
+
+/*
+	physicsMeasure and the statistics are recorded per thread, so the parts of a tick that run in parallel can record too
+	They are merged over all threads, so they are only meaningful while a single world ticks at a time.
+	Threads that tick worlds of their own disable them for their thread for as long as a PhysicsStatisticsDisabler lives
+*/
+extern thread_local bool physicsStatisticsEnabled;
+
+class PhysicsStatisticsDisabler {
+	bool wasEnabled;
+public:
+	explicit PhysicsStatisticsDisabler(bool disable = true) : wasEnabled(physicsStatisticsEnabled) { if(disable) physicsStatisticsEnabled = false; }
+	~PhysicsStatisticsDisabler() { physicsStatisticsEnabled = wasEnabled; }
+	PhysicsStatisticsDisabler(const PhysicsStatisticsDisabler&) = delete;
+	PhysicsStatisticsDisabler& operator=(const PhysicsStatisticsDisabler&) = delete;
+};
+
+// times the enclosing block as process in physicsMeasure, unless physicsStatisticsEnabled is false on this thread
+class PhysicsZone {
+	ProfileZone zone;
+public:
+	explicit PhysicsZone(PhysicsProcess process) : zone(physicsStatisticsEnabled ? physicsMeasure.getZoneID(process) : ProfileZone::NONE) {}
+	void setProcess(PhysicsProcess process) { zone.setZone(physicsMeasure.getZoneID(process)); }
+};
+
+/*
+	Ends a tick of physicsMeasure and the iteration statistics, called by whoever ticks the world after every tick
+	intersectionStatistics starts its next tally in the middle of the tick, after the colissions are handled
+*/
+void endPhysicsStatisticsTick();
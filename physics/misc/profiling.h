@@ -40,7 +40,10 @@ public:
 		clearCurrentTally();
 	}
 
-	inline void addToTally(Category category, Unit amount) {
+	virtual ~HistoricTally() = default;
+
+	// virtual so tallies that collect from several threads are fed through the same calls
+	inline virtual void addToTally(Category category, Unit amount) {
 		currentTally[static_cast<size_t>(category)] += amount;
 	}
 
@@ -50,7 +53,7 @@ public:
 		}
 	}
 
-	inline void nextTally() {
+	inline virtual void nextTally() {
 		history.add(currentTally);
 		clearCurrentTally();
 	}
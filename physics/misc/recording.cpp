@@ -0,0 +1,576 @@
+#include "recording.h"
+
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <iterator>
+#include <algorithm>
+
+#include "../world.h"
+#include "../part.h"
+#include "../physical.h"
+#include "../math/linalg/quat.h"
+#include "../../util/serializeBasicTypes.h"
+
+// version 2 allows keyframes without the world, which older versions can't play
+#define RECORDING_VERSION_ID 2
+
+static const char RECORDING_MAGIC[8]{'P', '3', 'D', 'R', 'E', 'C', 'R', 'D'};
+
+enum class ChunkKind : std::uint8_t {
+	KEYFRAME,
+	DELTA
+};
+
+static const std::size_t MOTION_VALUES = 12;
+static const std::size_t CFRAME_VALUES = 7;
+static const std::size_t VALUES_PER_BLOCK = 16;
+static const int BIT_WIDTH_BITS = 7;
+
+#pragma region quantisation
+
+// nearbyint compiles to a single instruction where llround is a library call, the rounding of halves does not matter here
+static std::int64_t quantise(double value, double inverseStep) {
+	return static_cast<std::int64_t>(std::nearbyint(value * inverseStep));
+}
+
+static std::size_t getValueCount(std::size_t physicalCount, std::size_t partCount) {
+	return physicalCount * MOTION_VALUES + partCount * CFRAME_VALUES;
+}
+
+static void quantiseVec3(Vec3 v, double inverseStep, std::int64_t* out) {
+	out[0] = quantise(v.x, inverseStep);
+	out[1] = quantise(v.y, inverseStep);
+	out[2] = quantise(v.z, inverseStep);
+}
+
+static Vec3 dequantiseVec3(const std::int64_t* in, double step) {
+	return Vec3(in[0] * step, in[1] * step, in[2] * step);
+}
+
+/*
+	Writes the quantised motions, followed by the quantised cframes into values
+	previous is used to keep the sign of the rotation quaternions consistent between ticks, nullptr for keyframes
+*/
+static void quantiseState(const std::vector<Motion>& motions, const std::vector<GlobalCFrame>& cframes, const RecordingSettings& settings, const std::int64_t* previous, std::vector<std::int64_t>& values) {
+	values.resize(getValueCount(motions.size(), cframes.size()));
+	std::int64_t* out = values.data();
+	double inversePositionStep = 1.0 / settings.positionStep;
+	double inverseRotationStep = 1.0 / settings.rotationStep;
+	double inverseMotionStep = 1.0 / settings.motionStep;
+
+	for(const Motion& motion : motions) {
+		quantiseVec3(motion.getVelocity(), inverseMotionStep, out);
+		quantiseVec3(motion.getAcceleration(), inverseMotionStep, out + 3);
+		quantiseVec3(motion.getAngularVelocity(), inverseMotionStep, out + 6);
+		quantiseVec3(motion.getAngularAcceleration(), inverseMotionStep, out + 9);
+		out += MOTION_VALUES;
+	}
+
+	for(const GlobalCFrame& cframe : cframes) {
+		Position pos = cframe.getPosition();
+		out[0] = quantise(static_cast<double>(pos.x), inversePositionStep);
+		out[1] = quantise(static_cast<double>(pos.y), inversePositionStep);
+		out[2] = quantise(static_cast<double>(pos.z), inversePositionStep);
+
+		// q and -q are the same rotation, pick the one closest to the previous tick so the deltas stay small
+		Quaternion<double> q = cframe.getRotation().asRotationQuaternion();
+		bool flip;
+		if(previous != nullptr) {
+			const std::int64_t* prev = previous + (out - values.data()) + 3;
+			flip = q.w * prev[0] + q.i * prev[1] + q.j * prev[2] + q.k * prev[3] < 0.0;
+		} else {
+			flip = q.w < 0.0;
+		}
+		if(flip) q = -q;
+		out[3] = quantise(q.w, inverseRotationStep);
+		out[4] = quantise(q.i, inverseRotationStep);
+		out[5] = quantise(q.j, inverseRotationStep);
+		out[6] = quantise(q.k, inverseRotationStep);
+		out += CFRAME_VALUES;
+	}
+}
+
+static void dequantiseState(const std::vector<std::int64_t>& values, const RecordingSettings& settings, RecordedFrame& frame) {
+	const std::int64_t* in = values.data();
+
+	for(Motion& motion : frame.motions) {
+		motion = Motion(dequantiseVec3(in, settings.motionStep), dequantiseVec3(in + 6, settings.motionStep), dequantiseVec3(in + 3, settings.motionStep), dequantiseVec3(in + 9, settings.motionStep));
+		in += MOTION_VALUES;
+	}
+
+	for(GlobalCFrame& cframe : frame.cframes) {
+		Position pos(in[0] * settings.positionStep, in[1] * settings.positionStep, in[2] * settings.positionStep);
+		Quaternion<double> q(in[3] * settings.rotationStep, in[4] * settings.rotationStep, in[5] * settings.rotationStep, in[6] * settings.rotationStep);
+		cframe = GlobalCFrame(pos, Rotation::fromRotationQuaternion(normalize(q)));
+		in += CFRAME_VALUES;
+	}
+}
+
+#pragma endregion
+
+#pragma region bitPacking
+
+static std::uint64_t zigzag(std::int64_t value) {
+	return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+static std::int64_t unzigzag(std::uint64_t value) {
+	return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+static int getBitWidth(std::uint64_t value) {
+	int width = 0;
+	for(int shift = 32; shift != 0; shift /= 2) {
+		if(value >> shift) {
+			value >>= shift;
+			width += shift;
+		}
+	}
+	return width + static_cast<int>(value);
+}
+
+// writes into memory that was reserved beforehand, whole bytes are written out 4 at a time in little endian order
+class BitWriter {
+	char* out;
+	std::uint64_t buffer = 0;
+	int bufferedBits = 0;
+
+public:
+	BitWriter(char* out) : out(out) {}
+
+	// bits must be at most 32
+	void writeSmall(std::uint64_t value, int bits) {
+		buffer |= value << bufferedBits;
+		bufferedBits += bits;
+		if(bufferedBits >= 32) {
+			out[0] = static_cast<char>(buffer);
+			out[1] = static_cast<char>(buffer >> 8);
+			out[2] = static_cast<char>(buffer >> 16);
+			out[3] = static_cast<char>(buffer >> 24);
+			out += 4;
+			buffer >>= 32;
+			bufferedBits -= 32;
+		}
+	}
+
+	void write(std::uint64_t value, int bits) {
+		if(bits > 32) {
+			writeSmall(value & 0xFFFFFFFF, 32);
+			writeSmall(value >> 32, bits - 32);
+		} else {
+			writeSmall(value, bits);
+		}
+	}
+
+	// returns the end of the written bytes
+	char* finish() {
+		while(bufferedBits > 0) {
+			*out++ = static_cast<char>(buffer);
+			buffer >>= 8;
+			bufferedBits -= 8;
+		}
+		buffer = 0;
+		bufferedBits = 0;
+		return out;
+	}
+};
+
+class BitReader {
+	const unsigned char* cur;
+	const unsigned char* end;
+	std::uint64_t buffer = 0;
+	int bufferedBits = 0;
+
+public:
+	BitReader(const char* begin, const char* end) : cur(reinterpret_cast<const unsigned char*>(begin)), end(reinterpret_cast<const unsigned char*>(end)) {}
+
+	// bits must be at most 32
+	std::uint64_t readSmall(int bits) {
+		while(bufferedBits < bits) {
+			if(cur == end) throw SerializationException("Unexpected end of recorded tick");
+			buffer |= static_cast<std::uint64_t>(*cur++) << bufferedBits;
+			bufferedBits += 8;
+		}
+		std::uint64_t result = buffer & ((std::uint64_t(1) << bits) - 1);
+		buffer >>= bits;
+		bufferedBits -= bits;
+		return result;
+	}
+
+	std::uint64_t read(int bits) {
+		if(bits > 32) {
+			std::uint64_t low = readSmall(32);
+			return low | (readSmall(bits - 32) << 32);
+		} else {
+			return readSmall(bits);
+		}
+	}
+};
+
+// blocks of VALUES_PER_BLOCK zigzagged values, each block starts with the bit width all of its values are written with
+static void packValues(const std::int64_t* values, std::size_t count, std::string& out) {
+	// at most a bit width and 64 bits per value
+	std::size_t start = out.size();
+	out.resize(start + count * sizeof(std::uint64_t) + (count / VALUES_PER_BLOCK + 1) * sizeof(std::uint64_t));
+	BitWriter writer(&out[start]);
+	for(std::size_t blockStart = 0; blockStart < count; blockStart += VALUES_PER_BLOCK) {
+		std::size_t blockEnd = std::min(blockStart + VALUES_PER_BLOCK, count);
+		std::uint64_t combined = 0;
+		for(std::size_t i = blockStart; i < blockEnd; i++) {
+			combined |= zigzag(values[i]);
+		}
+		int width = getBitWidth(combined);
+		writer.write(width, BIT_WIDTH_BITS);
+		if(width == 0) continue;
+		for(std::size_t i = blockStart; i < blockEnd; i++) {
+			writer.write(zigzag(values[i]), width);
+		}
+	}
+	out.resize(writer.finish() - out.data());
+}
+
+static void unpackValues(const char* begin, const char* end, std::int64_t* values, std::size_t count) {
+	BitReader reader(begin, end);
+	for(std::size_t blockStart = 0; blockStart < count; blockStart += VALUES_PER_BLOCK) {
+		std::size_t blockEnd = std::min(blockStart + VALUES_PER_BLOCK, count);
+		int width = static_cast<int>(reader.read(BIT_WIDTH_BITS));
+		if(width > 64) throw SerializationException("Invalid bit width in recorded tick");
+		for(std::size_t i = blockStart; i < blockEnd; i++) {
+			values[i] = (width == 0) ? 0 : unzigzag(reader.read(width));
+		}
+	}
+}
+
+#pragma endregion
+
+#pragma region Recorder
+
+static void serializeWorldKeyframe(const WorldPrototype& world, std::ostream& ostream) {
+	SerializationSessionPrototype session;
+	session.serializeWorld(world, ostream);
+}
+
+Recorder::Recorder(std::ostream& ostream, const RecordingSettings& settings, KeyframeSerializer serializeKeyframe) :
+	ostream(ostream),
+	settings(settings),
+	serializeKeyframe(serializeKeyframe ? serializeKeyframe : KeyframeSerializer(serializeWorldKeyframe)),
+	pendingTicks(settings.maxPendingTicks),
+	freeTicks(settings.maxPendingTicks) {
+
+	ostream.write(RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+	::serialize<std::uint32_t>(RECORDING_VERSION_ID, ostream);
+	::serialize<std::uint32_t>(settings.keyframeInterval, ostream);
+	::serialize<double>(settings.positionStep, ostream);
+	::serialize<double>(settings.rotationStep, ostream);
+	::serialize<double>(settings.motionStep, ostream);
+
+	thread = std::thread([this]() { runRecorder(); });
+}
+
+Recorder::~Recorder() {
+	stopping.store(true);
+	{
+		std::lock_guard<std::mutex> lg(wakeLock);
+	}
+	wakeRecorder.notify_one();
+	thread.join();
+	ostream.flush();
+}
+
+Recorder::CapturedTick* Recorder::acquireCapture() {
+	CapturedTick* result = nullptr;
+	while(true) {
+		if(freeTicks.tryPop([&result](CapturedTick* tick) { result = tick; })) return result;
+		if(allTicks.size() < settings.maxPendingTicks) {
+			allTicks.push_back(std::make_unique<CapturedTick>());
+			return allTicks.back().get();
+		}
+		// the recorder thread is maxPendingTicks behind, wait for it rather than dropping ticks
+		wakeRecorder.notify_one();
+		std::this_thread::yield();
+	}
+}
+
+bool Recorder::structureChanged(std::size_t partHash) const {
+	return partHash != keyframePartHash || physicals != keyframePhysicals || partCounts != keyframePartCounts;
+}
+
+void Recorder::captureTick(const WorldPrototype& world) {
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	CapturedTick* capture = acquireCapture();
+	capture->tick = world.age;
+	capture->motions.clear();
+	capture->cframes.clear();
+	physicals.clear();
+	partCounts.clear();
+
+	std::size_t partHash = 0;
+	for(const MotorizedPhysical* phys : world.physicals) {
+		capture->motions.push_back(phys->motionOfCenterOfMass);
+		std::size_t partsBefore = capture->cframes.size();
+		phys->forEachPart([capture, &partHash](const Part& part) {
+			capture->cframes.push_back(part.getCFrame());
+			partHash = partHash * 31 + std::hash<const Part*>()(&part);
+		});
+		physicals.push_back(phys);
+		partCounts.push_back(static_cast<std::uint32_t>(capture->cframes.size() - partsBefore));
+	}
+
+	bool changed = ticksSinceKeyframe == 0 || structureChanged(partHash);
+	capture->isKeyframe = changed || ticksSinceKeyframe >= settings.keyframeInterval;
+	capture->hasWorld = changed || (capture->isKeyframe && ticksSinceWorld >= settings.worldInterval);
+	capture->worldData.clear();
+	if(capture->hasWorld) {
+		std::ostringstream worldData;
+		serializeKeyframe(world, worldData);
+		capture->worldData = worldData.str();
+		ticksSinceWorld = 0;
+	}
+	if(capture->isKeyframe) {
+		capture->partsPerPhysical = partCounts;
+
+		std::swap(keyframePhysicals, physicals);
+		std::swap(keyframePartCounts, partCounts);
+		keyframePartHash = partHash;
+		ticksSinceKeyframe = 0;
+	}
+	ticksSinceKeyframe++;
+	ticksSinceWorld++;
+
+	std::size_t inFlight = ticksInFlight.fetch_add(1) + 1;
+	std::size_t position;
+	// never fails, there are at most maxPendingTicks captures
+	pendingTicks.tryPush(std::move(capture), position);
+	// ticks are handed over in batches, waking the recorder for every tick costs the ticking thread more than capturing it
+	if(inFlight >= std::max<std::size_t>(settings.maxPendingTicks / 4, 1)) wakeRecorder.notify_one();
+
+	captureNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count());
+}
+
+void Recorder::writeTick(CapturedTick& tick) {
+	chunk.clear();
+	if(tick.isKeyframe) {
+		// 0 for keyframes without the world, a serialized world is never empty
+		std::uint64_t worldDataSize = tick.worldData.size();
+		std::uint32_t physicalCount = static_cast<std::uint32_t>(tick.partsPerPhysical.size());
+		chunk.append(reinterpret_cast<const char*>(&worldDataSize), sizeof(worldDataSize));
+		chunk.append(tick.worldData);
+		chunk.append(reinterpret_cast<const char*>(&physicalCount), sizeof(physicalCount));
+		chunk.append(reinterpret_cast<const char*>(tick.partsPerPhysical.data()), tick.partsPerPhysical.size() * sizeof(std::uint32_t));
+
+		quantiseState(tick.motions, tick.cframes, settings, nullptr, values);
+		packValues(values.data(), values.size(), chunk);
+		keyframes.fetch_add(1);
+	} else {
+		quantiseState(tick.motions, tick.cframes, settings, previousValues.data(), values);
+		// the layout is the same as that of the previous tick, otherwise this would have been a keyframe
+		for(std::size_t i = 0; i < values.size(); i++) {
+			previousValues[i] = values[i] - previousValues[i];
+		}
+		packValues(previousValues.data(), previousValues.size(), chunk);
+	}
+	std::swap(previousValues, values);
+
+	::serialize<std::uint8_t>(static_cast<std::uint8_t>(tick.isKeyframe ? ChunkKind::KEYFRAME : ChunkKind::DELTA), ostream);
+	::serialize<std::uint64_t>(tick.tick, ostream);
+	::serialize<std::uint64_t>(chunk.size(), ostream);
+	ostream.write(chunk.data(), chunk.size());
+
+	bytesWritten.fetch_add(sizeof(std::uint8_t) + 2 * sizeof(std::uint64_t) + chunk.size());
+	recordedTicks.fetch_add(1);
+}
+
+void Recorder::runRecorder() {
+	while(true) {
+		while(pendingTicks.tryPop([this](CapturedTick* tick) {
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+			writeTick(*tick);
+			encodeNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count());
+
+			std::size_t position;
+			freeTicks.tryPush(std::move(tick), position);
+		})) {
+			ticksInFlight.fetch_sub(1);
+			{
+				// taken so flush() can't miss the notification between checking ticksInFlight and waiting
+				std::lock_guard<std::mutex> lg(wakeLock);
+			}
+			tickWritten.notify_all();
+		}
+
+		// the destructor runs on the ticking thread, once it sets stopping no more ticks are captured
+		if(stopping.load() && ticksInFlight.load() == 0) return;
+
+		std::unique_lock<std::mutex> lock(wakeLock);
+		// the ticking thread does not take wakeLock, a wakeup that is missed is picked up by the timeout
+		wakeRecorder.wait_for(lock, std::chrono::milliseconds(5), [this]() { return stopping.load() || ticksInFlight.load() != 0; });
+	}
+}
+
+void Recorder::flush() {
+	wakeRecorder.notify_one();
+	std::unique_lock<std::mutex> lock(wakeLock);
+	tickWritten.wait(lock, [this]() { return ticksInFlight.load() == 0; });
+	lock.unlock();
+	ostream.flush();
+}
+
+Recorder::Statistics Recorder::getStatistics() const {
+	Statistics result;
+	result.recordedTicks = recordedTicks.load();
+	result.keyframes = keyframes.load();
+	result.bytesWritten = bytesWritten.load();
+	result.captureTime = std::chrono::nanoseconds(captureNanos.load());
+	result.encodeTime = std::chrono::nanoseconds(encodeNanos.load());
+	return result;
+}
+
+#pragma endregion
+
+#pragma region Replay
+
+Replay::Replay(std::istream& istream) : data(std::istreambuf_iterator<char>(istream), std::istreambuf_iterator<char>()) {
+	Util::MemoryInputStream stream(data.data(), data.data() + data.size());
+
+	char magic[sizeof(RECORDING_MAGIC)];
+	stream.read(magic, sizeof(magic));
+	if(!stream || std::memcmp(magic, RECORDING_MAGIC, sizeof(magic)) != 0) throw SerializationException("Not a recording");
+
+	std::uint32_t version = ::deserialize<std::uint32_t>(stream);
+	if(version > RECORDING_VERSION_ID) {
+		throw SerializationException("This recording is newer than this version of the engine! Current " + std::to_string(RECORDING_VERSION_ID) + " version of recording: " + std::to_string(version));
+	}
+	settings.keyframeInterval = ::deserialize<std::uint32_t>(stream);
+	settings.positionStep = ::deserialize<double>(stream);
+	settings.rotationStep = ::deserialize<double>(stream);
+	settings.motionStep = ::deserialize<double>(stream);
+	if(!stream) throw SerializationException("Recording header is truncated");
+
+	std::size_t offset = sizeof(RECORDING_MAGIC) + 2 * sizeof(std::uint32_t) + 3 * sizeof(double);
+	const std::size_t chunkHeaderSize = sizeof(std::uint8_t) + 2 * sizeof(std::uint64_t);
+	while(data.size() - offset >= chunkHeaderSize) {
+		Chunk chunk;
+		std::uint8_t kind = static_cast<std::uint8_t>(data[offset]);
+		std::uint64_t size;
+		std::memcpy(&chunk.tick, data.data() + offset + sizeof(std::uint8_t), sizeof(std::uint64_t));
+		std::memcpy(&size, data.data() + offset + sizeof(std::uint8_t) + sizeof(std::uint64_t), sizeof(std::uint64_t));
+		offset += chunkHeaderSize;
+
+		// a recording that was cut off while being written still plays up to its last complete tick
+		if(size > data.size() - offset) break;
+		if(kind > static_cast<std::uint8_t>(ChunkKind::DELTA)) throw SerializationException("Unknown chunk kind in recording");
+		if(!chunks.empty() && chunk.tick <= chunks.back().tick) throw SerializationException("Recorded ticks are not in order");
+
+		chunk.isKeyframe = kind == static_cast<std::uint8_t>(ChunkKind::KEYFRAME);
+		chunk.offset = offset;
+		chunk.size = static_cast<std::size_t>(size);
+		chunk.worldChunk = chunks.empty() ? 0 : chunks.back().worldChunk;
+		if(chunk.isKeyframe) {
+			std::uint64_t worldDataSize;
+			if(chunk.size < sizeof(worldDataSize)) throw SerializationException("Keyframe is truncated");
+			std::memcpy(&worldDataSize, data.data() + offset, sizeof(worldDataSize));
+			if(worldDataSize != 0) chunk.worldChunk = chunks.size();
+			else if(chunks.empty()) throw SerializationException("Recording does not start with the world");
+			keyframeChunks.push_back(chunks.size());
+		}
+		chunks.push_back(chunk);
+		offset += chunk.size;
+	}
+
+	if(chunks.empty() || !chunks.front().isKeyframe) throw SerializationException("Recording does not start with a keyframe");
+
+	decodeValues(0);
+	updateFrame();
+}
+
+void Replay::decodeValues(std::size_t chunkIndex) {
+	const Chunk& chunk = chunks[chunkIndex];
+	const char* cur = data.data() + chunk.offset;
+	const char* end = cur + chunk.size;
+
+	if(chunk.isKeyframe) {
+		std::uint64_t worldDataSize;
+		std::uint32_t physicalCount;
+		if(static_cast<std::size_t>(end - cur) < sizeof(worldDataSize)) throw SerializationException("Keyframe is truncated");
+		std::memcpy(&worldDataSize, cur, sizeof(worldDataSize));
+		cur += sizeof(worldDataSize);
+		if(static_cast<std::uint64_t>(end - cur) < worldDataSize + sizeof(physicalCount)) throw SerializationException("Keyframe is truncated");
+		cur += worldDataSize;
+		std::memcpy(&physicalCount, cur, sizeof(physicalCount));
+		cur += sizeof(physicalCount);
+		if(static_cast<std::size_t>(end - cur) / sizeof(std::uint32_t) < physicalCount) throw SerializationException("Keyframe is truncated");
+
+		frame.partsPerPhysical.resize(physicalCount);
+		std::memcpy(frame.partsPerPhysical.data(), cur, physicalCount * sizeof(std::uint32_t));
+		cur += physicalCount * sizeof(std::uint32_t);
+
+		std::size_t partCount = 0;
+		for(std::uint32_t count : frame.partsPerPhysical) {
+			partCount += count;
+		}
+		frame.motions.resize(physicalCount);
+		frame.cframes.resize(partCount);
+
+		values.resize(getValueCount(physicalCount, partCount));
+		unpackValues(cur, end, values.data(), values.size());
+	} else {
+		deltas.resize(values.size());
+		unpackValues(cur, end, deltas.data(), deltas.size());
+		for(std::size_t i = 0; i < values.size(); i++) {
+			values[i] += deltas[i];
+		}
+	}
+	currentChunk = chunkIndex;
+}
+
+void Replay::updateFrame() {
+	frame.tick = chunks[currentChunk].tick;
+	dequantiseState(values, settings, frame);
+}
+
+const RecordedFrame& Replay::seek(std::uint64_t tick) {
+	auto found = std::lower_bound(chunks.begin(), chunks.end(), tick, [](const Chunk& chunk, std::uint64_t tick) {
+		return chunk.tick < tick;
+	});
+	if(found == chunks.end() || found->tick != tick) throw SerializationException("Tick " + std::to_string(tick) + " was not recorded");
+	std::size_t target = found - chunks.begin();
+
+	// the keyframe at or before target
+	std::size_t keyframe = *(std::upper_bound(keyframeChunks.begin(), keyframeChunks.end(), target) - 1);
+
+	// continue from the current tick if no keyframe lies in between, otherwise start over at the keyframe
+	std::size_t first = (target >= currentChunk && keyframe <= currentChunk) ? currentChunk + 1 : keyframe;
+	if(first > target) return frame;
+	for(std::size_t i = first; i <= target; i++) {
+		decodeValues(i);
+	}
+	updateFrame();
+	return frame;
+}
+
+bool Replay::stepForward() {
+	if(currentChunk + 1 >= chunks.size()) return false;
+	decodeValues(currentChunk + 1);
+	updateFrame();
+	return true;
+}
+
+void Replay::getKeyframeWorldData(const char*& begin, const char*& end) const {
+	const Chunk& chunk = chunks[chunks[currentChunk].worldChunk];
+	std::uint64_t worldDataSize;
+	std::memcpy(&worldDataSize, data.data() + chunk.offset, sizeof(worldDataSize));
+	begin = data.data() + chunk.offset + sizeof(worldDataSize);
+	end = begin + worldDataSize;
+}
+
+void Replay::loadKeyframeWorld(DeSerializationSessionPrototype& deserializer, WorldPrototype& world) const {
+	const char* begin;
+	const char* end;
+	getKeyframeWorldData(begin, end);
+	Util::MemoryInputStream stream(begin, end);
+	deserializer.deserializeWorld(world, stream);
+}
+
+#pragma endregion
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../math/globalCFrame.h"
+#include "../motion.h"
+#include "../datastructures/mpscQueue.h"
+#include "serialization.h"
+#include "../../util/memoryStream.h"
+
+class WorldPrototype;
+class MotorizedPhysical;
+
+/*
+	Recording of a simulation, tick by tick
+
+	A recording is a header followed by chunks. Every keyframeInterval ticks, and whenever parts or physicals were added, removed,
+	attached or detached, a keyframe is written with the state of every motorized physical. The other ticks only store the change
+	of that state since the previous tick.
+	Keyframes written because the parts or physicals changed also hold a full serializeWorld of the world, as do keyframes once
+	worldInterval ticks passed since the last one that did. The other keyframes only restart the deltas, so seeking stays cheap
+	without serializing the world on the ticking thread every keyframeInterval ticks.
+
+	The recorded state of a tick is the motionOfCenterOfMass of every MotorizedPhysical in world.physicals, and the cframe of every part
+	of each of them in forEachPart order. Positions, rotation quaternions and motions are quantised to the steps in RecordingSettings,
+	the differences between consecutive ticks are zigzag encoded and bit packed in blocks of 16 values that share a bit width.
+	Quantisation is relative to the previously quantised value, so errors do not accumulate between keyframes.
+*/
+struct RecordingSettings {
+	// ticks between keyframes, seeking decodes at most this many ticks
+	std::uint32_t keyframeInterval = 100;
+	// ticks after which a keyframe serializes the world even if its parts and physicals did not change, not stored in the recording
+	std::uint32_t worldInterval = 1000;
+	double positionStep = 1.0 / (1 << 20);
+	// step of the components of the rotation quaternion
+	double rotationStep = 1.0 / (1 << 20);
+	// step of the velocities and accelerations of motionOfCenterOfMass
+	double motionStep = 1.0 / (1 << 16);
+	// ticks that may be waiting for the recorder thread before captureTick blocks, must be a power of 2
+	std::size_t maxPendingTicks = 64;
+};
+
+/*
+	Records a world to a stream, the encoding and writing happens on a background thread
+
+	captureTick must be called at the tick boundary, for example from PhysicsDriver::onTickEnd, while no other thread modifies the world.
+	It only copies the state of the world, or serializes it for keyframes that hold the world, the rest of the work is left to the
+	recorder thread.
+*/
+class Recorder {
+public:
+	// serializes the world of a keyframe, must use a new serialization session for every call
+	typedef std::function<void(const WorldPrototype&, std::ostream&)> KeyframeSerializer;
+
+	struct Statistics {
+		std::size_t recordedTicks;
+		std::size_t keyframes;
+		std::size_t bytesWritten;
+		// spent in captureTick, on the ticking thread
+		std::chrono::nanoseconds captureTime;
+		// spent encoding and writing, on the recorder thread
+		std::chrono::nanoseconds encodeTime;
+	};
+
+private:
+	struct CapturedTick {
+		std::uint64_t tick;
+		bool isKeyframe;
+		// keyframes only, worldData is empty for keyframes without the world
+		bool hasWorld;
+		std::string worldData;
+		std::vector<std::uint32_t> partsPerPhysical;
+
+		std::vector<Motion> motions;
+		std::vector<GlobalCFrame> cframes;
+	};
+
+	std::ostream& ostream;
+	RecordingSettings settings;
+	KeyframeSerializer serializeKeyframe;
+
+	// ticking thread -> recorder thread, and the used captures back
+	BoundedMPSCQueue<CapturedTick*> pendingTicks;
+	BoundedMPSCQueue<CapturedTick*> freeTicks;
+	std::vector<std::unique_ptr<CapturedTick>> allTicks;
+
+	std::thread thread;
+	std::atomic<bool> stopping{false};
+	std::atomic<std::size_t> ticksInFlight{0};
+	std::mutex wakeLock;
+	std::condition_variable wakeRecorder;
+	std::condition_variable tickWritten;
+
+	// ticking thread state, a keyframe is forced when the physicals or their parts differ from those of the last keyframe
+	std::uint32_t ticksSinceKeyframe = 0;
+	std::uint32_t ticksSinceWorld = 0;
+	std::vector<const MotorizedPhysical*> physicals;
+	std::vector<std::uint32_t> partCounts;
+	std::vector<const MotorizedPhysical*> keyframePhysicals;
+	std::vector<std::uint32_t> keyframePartCounts;
+	std::size_t keyframePartHash = 0;
+
+	// recorder thread state
+	std::vector<std::int64_t> previousValues;
+	std::vector<std::int64_t> values;
+	std::string chunk;
+
+	std::atomic<std::size_t> recordedTicks{0};
+	std::atomic<std::size_t> keyframes{0};
+	std::atomic<std::size_t> bytesWritten{0};
+	std::atomic<std::int64_t> captureNanos{0};
+	std::atomic<std::int64_t> encodeNanos{0};
+
+	CapturedTick* acquireCapture();
+	bool structureChanged(std::size_t partHash) const;
+	void runRecorder();
+	void writeTick(CapturedTick& tick);
+
+public:
+	Recorder(std::ostream& ostream, const RecordingSettings& settings = RecordingSettings(), KeyframeSerializer serializeKeyframe = KeyframeSerializer());
+	// writes all captured ticks before returning
+	~Recorder();
+
+	Recorder(const Recorder&) = delete;
+	Recorder& operator=(const Recorder&) = delete;
+
+	// ticking thread, records the current state of world as tick world.age
+	void captureTick(const WorldPrototype& world);
+
+	// blocks until every captured tick has been written to the stream
+	void flush();
+
+	// safe to call from any thread
+	Statistics getStatistics() const;
+};
+
+/*
+	The decoded state of a single recorded tick
+	motions has an entry per motorized physical, cframes has partsPerPhysical[i] consecutive entries for the parts of physical i
+	This is the same order as world.physicals and forEachPart of a world loaded with Replay::loadKeyframeWorld
+*/
+struct RecordedFrame {
+	std::uint64_t tick = 0;
+	std::vector<std::uint32_t> partsPerPhysical;
+	std::vector<Motion> motions;
+	std::vector<GlobalCFrame> cframes;
+};
+
+/*
+	Plays back a recording written by Recorder, any tick can be seeked to by decoding from the keyframe before it
+	Throws SerializationException for recordings that are damaged or were written by a newer version
+*/
+class Replay {
+	struct Chunk {
+		std::uint64_t tick;
+		bool isKeyframe;
+		std::size_t offset;
+		std::size_t size;
+		// index of the last keyframe that holds the world, at or before this chunk
+		std::size_t worldChunk;
+	};
+
+	std::string data;
+	RecordingSettings settings;
+	std::vector<Chunk> chunks;
+	// indices into chunks
+	std::vector<std::size_t> keyframeChunks;
+
+	RecordedFrame frame;
+	std::size_t currentChunk = 0;
+	std::vector<std::int64_t> values;
+	std::vector<std::int64_t> deltas;
+
+	// decodes the quantised values of a chunk into values, deltas are applied to the values of the chunk before it
+	void decodeValues(std::size_t chunkIndex);
+	// converts values into frame
+	void updateFrame();
+	// the serialized world of the keyframe the current frame was decoded from
+	void getKeyframeWorldData(const char*& begin, const char*& end) const;
+
+public:
+	// reads the whole recording from istream and positions the replay on its first tick
+	explicit Replay(std::istream& istream);
+
+	std::uint64_t getFirstTick() const { return chunks.front().tick; }
+	std::uint64_t getLastTick() const { return chunks.back().tick; }
+	const RecordingSettings& getSettings() const { return settings; }
+
+	// decodes the given tick, throws if it was not recorded
+	const RecordedFrame& seek(std::uint64_t tick);
+	// decodes the tick after the current one, returns false if the current tick is the last one
+	bool stepForward();
+	const RecordedFrame& getFrame() const { return frame; }
+
+	/*
+		tick of the last keyframe that holds the world, at or before the current frame
+		The parts and physicals of that world are those of the current frame, in the same order
+	*/
+	std::uint64_t getKeyframeTick() const { return chunks[chunks[currentChunk].worldChunk].tick; }
+	// loads the world as it was at getKeyframeTick() into world, which should be empty
+	void loadKeyframeWorld(DeSerializationSessionPrototype& deserializer, WorldPrototype& world) const;
+	template<typename ExtendedPartType>
+	void loadKeyframeWorld(DeSerializationSession<ExtendedPartType>& deserializer, World<ExtendedPartType>& world) const {
+		const char* begin;
+		const char* end;
+		getKeyframeWorldData(begin, end);
+		Util::MemoryInputStream stream(begin, end);
+		deserializer.deserializeWorld(world, stream);
+	}
+};
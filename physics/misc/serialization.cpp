@@ -2,6 +2,8 @@
 
 #include "../geometry/polyhedron.h"
 #include "../geometry/builtinShapeClasses.h"
+#include "../geometry/triangleMeshShapeClass.h"
+#include "../geometry/heightfieldShapeClass.h"
 #include "../geometry/shape.h"
 #include "../geometry/shapeClass.h"
 #include "../part.h"
@@ -12,10 +14,16 @@
 #include "../hardconstraints/sinusoidalPistonConstraint.h"
 #include "../externalforces/gravityForce.h"
 
+#include "mappedWorldFormat.h"
+#include "../../util/memoryStream.h"
+
 #include <map>
 #include <set>
 #include <limits.h>
 #include <string>
+#include <cstring>
+#include <cstdint>
+#include <sstream>
 #include <iostream>
 
 
@@ -38,20 +46,17 @@ Polyhedron deserializePolyhedron(std::istream& istream) {
 	uint32_t vertexCount = ::deserialize<uint32_t>(istream);
 	uint32_t triangleCount = ::deserialize<uint32_t>(istream);
 
-	Vec3f* vertices = new Vec3f[vertexCount];
-	Triangle* triangles = new Triangle[triangleCount];
+	// read straight into the final buffers, the Polyhedron takes them over
+	EditableMesh mesh(vertexCount, triangleCount);
 
 	for(uint32_t i = 0; i < vertexCount; i++) {
-		vertices[i] = ::deserialize<Vec3f>(istream);
+		mesh.setVertex(i, ::deserialize<Vec3f>(istream));
 	}
 	for(uint32_t i = 0; i < triangleCount; i++) {
-		triangles[i] = ::deserialize<Triangle>(istream);
+		mesh.setTriangle(i, ::deserialize<Triangle>(istream));
 	}
 
-	Polyhedron result(vertices, triangles, vertexCount, triangleCount);
-	delete[] vertices;
-	delete[] triangles;
-	return result;
+	return Polyhedron(std::move(mesh));
 }
 
 void ShapeSerializer::include(const Shape& shape) {
@@ -143,6 +148,32 @@ PolyhedronShapeClass* deserializePolyhedronShapeClass(std::istream& istream) {
 	return result;
 }
 
+void serializeTriangleMeshShapeClass(const TriangleMeshShapeClass& meshClass, std::ostream& ostream) {
+	::serializePolyhedron(meshClass.asPolyhedron(), ostream);
+}
+TriangleMeshShapeClass* deserializeTriangleMeshShapeClass(std::istream& istream) {
+	Polyhedron mesh = ::deserializePolyhedron(istream);
+	return new TriangleMeshShapeClass(mesh);
+}
+
+void serializeHeightfieldShapeClass(const HeightfieldShapeClass& heightfield, std::ostream& ostream) {
+	::serialize<int>(heightfield.getColumnCount(), ostream);
+	::serialize<int>(heightfield.getRowCount(), ostream);
+	const std::vector<std::uint16_t>& heights = heightfield.getHeights();
+	// the samples are written as one block, a large heightfield has millions of them
+	::serialize(reinterpret_cast<const char*>(heights.data()), heights.size() * sizeof(std::uint16_t), ostream);
+}
+HeightfieldShapeClass* deserializeHeightfieldShapeClass(std::istream& istream) {
+	int columnCount = ::deserialize<int>(istream);
+	int rowCount = ::deserialize<int>(istream);
+	if(columnCount < 2 || rowCount < 2) {
+		throw SerializationException("Invalid heightfield size " + std::to_string(columnCount) + "x" + std::to_string(rowCount));
+	}
+	std::vector<std::uint16_t> heights(static_cast<std::size_t>(columnCount) * rowCount);
+	::deserialize(reinterpret_cast<char*>(heights.data()), heights.size() * sizeof(std::uint16_t), istream);
+	return new HeightfieldShapeClass(std::move(heights), columnCount, rowCount);
+}
+
 void serializeDirectionalGravity(const DirectionalGravity& gravity, std::ostream& ostream) {
 	::serialize<Vec3>(gravity.gravity, ostream);
 }
@@ -354,7 +385,7 @@ void SerializationSessionPrototype::serializeWorldLayer(const WorldLayer& layer,
 	}
 }
 
-void SerializationSessionPrototype::serializeWorld(const WorldPrototype& world, std::ostream& ostream) {
+void SerializationSessionPrototype::collectWorldInformation(const WorldPrototype& world) {
 	for(const MotorizedPhysical* p : world.physicals) {
 		collectMotorizedPhysicalInformation(*p);
 	}
@@ -367,6 +398,27 @@ void SerializationSessionPrototype::serializeWorld(const WorldPrototype& world,
 			}
 		}
 	}
+}
+
+void SerializationSessionPrototype::serializeConstraints(const WorldPrototype& world, std::ostream& ostream) {
+	::serialize<std::uint32_t>(static_cast<std::uint32_t>(world.constraints.size()), ostream);
+	for(const ConstraintGroup& cg : world.constraints) {
+		::serialize<std::uint32_t>(static_cast<std::uint32_t>(cg.constraints.size()), ostream);
+		for(const PhysicalConstraint& c : cg.constraints) {
+			this->serializeConstraintInContext(c, ostream);
+		}
+	}
+}
+
+static void serializeExternalForces(const WorldPrototype& world, std::ostream& ostream) {
+	::serialize<uint32_t>(world.externalForces.size(), ostream);
+	for(ExternalForce* force : world.externalForces) {
+		dynamicExternalForceSerializer.serialize(*force, ostream);
+	}
+}
+
+void SerializationSessionPrototype::serializeWorld(const WorldPrototype& world, std::ostream& ostream) {
+	collectWorldInformation(world);
 
 	serializeCollectedHeaderInformation(ostream);
 	
@@ -391,24 +443,38 @@ void SerializationSessionPrototype::serializeWorld(const WorldPrototype& world,
 		serializeMotorizedPhysicalInContext(*p, ostream);
 	}
 
-	::serialize<std::uint32_t>(static_cast<std::uint32_t>(world.constraints.size()), ostream);
-	for(const ConstraintGroup& cg : world.constraints) {
-		::serialize<std::uint32_t>(static_cast<std::uint32_t>(cg.constraints.size()), ostream);
-		for(const PhysicalConstraint& c : cg.constraints) {
-			this->serializeConstraintInContext(c, ostream);
-		}
-	}
-	::serialize<uint32_t>(world.externalForces.size(), ostream);
-	for(ExternalForce* force : world.externalForces) {
-		dynamicExternalForceSerializer.serialize(*force, ostream);
-	}
+	serializeConstraints(world, ostream);
+	serializeExternalForces(world, ostream);
 }
 
 void DeSerializationSessionPrototype::deserializeWorldLayer(WorldLayer& layer, std::istream& istream) {
 	uint32_t extraPartsInLayer = ::deserialize<uint32_t>(istream);
 	for(uint32_t i = 0; i < extraPartsInLayer; i++) {
 		GlobalCFrame cf = ::deserialize<GlobalCFrame>(istream);
-		layer.tree.add(deserializePartData(cf, &layer, istream));
+		layer.addPart(deserializePartData(cf, &layer, istream));
+	}
+	layer.parent->world->objectCount += extraPartsInLayer;
+}
+
+void DeSerializationSessionPrototype::deserializeConstraints(WorldPrototype& world, std::istream& istream) {
+	std::uint32_t constraintCount = ::deserialize<std::uint32_t>(istream);
+	world.constraints.reserve(constraintCount);
+	for(std::uint32_t cg = 0; cg < constraintCount; cg++) {
+		ConstraintGroup group;
+		std::uint32_t numberOfConstraintsInGroup = ::deserialize<std::uint32_t>(istream);
+		for(std::uint32_t c = 0; c < numberOfConstraintsInGroup; c++) {
+			group.constraints.push_back(this->deserializeConstraintInContext(istream));
+		}
+		world.constraints.push_back(std::move(group));
+	}
+}
+
+static void deserializeExternalForces(WorldPrototype& world, std::istream& istream) {
+	uint32_t forceCount = ::deserialize<uint32_t>(istream);
+	world.externalForces.reserve(forceCount);
+	for(uint32_t i = 0; i < forceCount; i++) {
+		ExternalForce* force = dynamicExternalForceSerializer.deserialize(istream);
+		world.externalForces.push_back(force);
 	}
 }
 
@@ -439,22 +505,8 @@ void DeSerializationSessionPrototype::deserializeWorld(WorldPrototype& world, st
 		world.addPhysicalWithExistingLayers(deserializeMotorizedPhysicalWithContext(world.layers, istream));
 	}
 
-	std::uint32_t constraintCount = ::deserialize<std::uint32_t>(istream);
-	world.constraints.reserve(constraintCount);
-	for(std::uint32_t cg = 0; cg < constraintCount; cg++) {
-		ConstraintGroup group;
-		std::uint32_t numberOfConstraintsInGroup = ::deserialize<std::uint32_t>(istream);
-		for(std::uint32_t c = 0; c < numberOfConstraintsInGroup; c++) {
-			group.constraints.push_back(this->deserializeConstraintInContext(istream));
-		}
-		world.constraints.push_back(std::move(group));
-	}
-	uint32_t forceCount = ::deserialize<uint32_t>(istream);
-	world.externalForces.reserve(forceCount);
-	for(uint32_t i = 0; i < forceCount; i++) {
-		ExternalForce* force = dynamicExternalForceSerializer.deserialize(istream);
-		world.externalForces.push_back(force);
-	}
+	deserializeConstraints(world, istream);
+	deserializeExternalForces(world, istream);
 }
 
 void SerializationSessionPrototype::serializeParts(const Part* const parts[], size_t partCount, std::ostream& ostream) {
@@ -508,6 +560,386 @@ DeSerializationSessionPrototype::DeSerializationSessionPrototype(const std::vect
 
 #pragma endregion
 
+#pragma region mappedWorld
+
+bool MappedWorldFormat::isMappedWorldFile(const char* data, std::size_t size) {
+	return size >= sizeof(FileHeader) && std::memcmp(data, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+template<typename T>
+static void appendRecord(std::string& section, const T& record) {
+	section.append(reinterpret_cast<const char*>(&record), sizeof(T));
+}
+
+static MappedWorldFormat::BlobRange appendBlob(std::string& blob, const std::string& data) {
+	MappedWorldFormat::BlobRange range{blob.size(), data.size()};
+	blob.append(data);
+	return range;
+}
+
+void SerializationSessionPrototype::serializeWorldMapped(const WorldPrototype& world, std::ostream& ostream) {
+	using namespace MappedWorldFormat;
+
+	collectWorldInformation(world);
+
+	std::string sections[static_cast<std::size_t>(Section::COUNT)];
+	std::string& layerColissions = sections[static_cast<std::size_t>(Section::LAYER_COLISSIONS)];
+	std::string& shapeClasses = sections[static_cast<std::size_t>(Section::SHAPE_CLASSES)];
+	std::string& meshData = sections[static_cast<std::size_t>(Section::MESH_DATA)];
+	std::string& parts = sections[static_cast<std::size_t>(Section::PARTS)];
+	std::string& physicals = sections[static_cast<std::size_t>(Section::PHYSICALS)];
+	std::string& blob = sections[static_cast<std::size_t>(Section::BLOB)];
+
+	std::ostringstream streamBuffer;
+	auto takeStreamBuffer = [&streamBuffer]() {
+		std::string result = streamBuffer.str();
+		streamBuffer.str(std::string());
+		return result;
+	};
+
+	this->shapeSerializer.sharedShapeClassSerializer.collectRegistry([&](const ShapeClass* sc) {
+		ShapeClassRecord record{};
+		const PolyhedronShapeClass* polyClass = dynamic_cast<const PolyhedronShapeClass*>(sc);
+		if(polyClass != nullptr) {
+			Polyhedron poly = polyClass->asPolyhedron();
+			std::size_t vertexBlockSize = MeshPrototype::getPaddedSize(poly.vertexCount) * 3 * sizeof(float);
+			std::size_t triangleBlockSize = MeshPrototype::getPaddedSize(poly.triangleCount) * 3 * sizeof(int);
+
+			record.kind = ShapeClassKind::POLYHEDRON;
+			record.vertexCount = poly.vertexCount;
+			record.triangleCount = poly.triangleCount;
+			record.offset = meshData.size();
+			record.size = vertexBlockSize + triangleBlockSize;
+			meshData.append(reinterpret_cast<const char*>(poly.getVertexBuffer()), vertexBlockSize);
+			meshData.append(reinterpret_cast<const char*>(poly.getTriangleBuffer()), triangleBlockSize);
+			meshData.resize(alignToSection(meshData.size()), '\0');
+		} else {
+			dynamicShapeClassSerializer.serialize(*sc, streamBuffer);
+			BlobRange range = appendBlob(blob, takeStreamBuffer());
+
+			record.kind = ShapeClassKind::STREAM;
+			record.offset = range.offset;
+			record.size = range.size;
+		}
+		appendRecord(shapeClasses, record);
+	});
+
+	std::uint32_t partCount = 0;
+	auto writePart = [&](const Part& part, const GlobalCFrame& cframe, const CFrame& attachment) {
+		PartRecord record{};
+		record.cframe = cframe;
+		record.attachment = attachment;
+		record.width = part.hitbox.getWidth();
+		record.height = part.hitbox.getHeight();
+		record.depth = part.hitbox.getDepth();
+		record.properties = part.properties;
+		record.shapeClassID = this->shapeSerializer.sharedShapeClassSerializer.getIDFor(part.hitbox.baseShape);
+		record.layerID = part.getLayerID();
+		this->serializePartExternalData(part, streamBuffer);
+		record.externalData = appendBlob(blob, takeStreamBuffer());
+		appendRecord(parts, record);
+		partCount++;
+	};
+
+	WorldRecord worldRecord{};
+	worldRecord.age = world.age;
+	worldRecord.layerCount = static_cast<std::uint32_t>(world.getLayerCount());
+
+	for(int i = 0; i < world.getLayerCount(); i++) {
+		for(int j = 0; j <= i; j++) {
+			layerColissions.push_back(world.doLayersCollide(i, j) ? 1 : 0);
+		}
+	}
+
+	for(const ColissionLayer& layer : world.layers) {
+		for(const Part& p : layer.subLayers[ColissionLayer::TERRAIN_PARTS_LAYER].tree) {
+			if(p.parent == nullptr) {
+				writePart(p, p.getCFrame(), CFrame());
+			}
+		}
+	}
+	worldRecord.terrainPartCount = partCount;
+
+	// depth first, so the indices match those of physicalIndexMap in the stream format
+	struct PendingPhysical {
+		const Physical* phys;
+		std::uint32_t parentIndex;
+	};
+	std::vector<PendingPhysical> stack;
+	for(const MotorizedPhysical* motorPhys : world.physicals) {
+		stack.push_back(PendingPhysical{motorPhys, NO_PARENT});
+		while(!stack.empty()) {
+			PendingPhysical current = stack.back();
+			stack.pop_back();
+			const Physical& phys = *current.phys;
+			std::uint32_t index = currentPhysicalIndex++;
+			physicalIndexMap.emplace(&phys, index);
+
+			PhysicalRecord record{};
+			record.parentIndex = current.parentIndex;
+			record.childCount = static_cast<std::uint32_t>(phys.childPhysicals.size());
+			if(current.parentIndex == NO_PARENT) {
+				record.motionOfCenterOfMass = static_cast<const MotorizedPhysical&>(phys).motionOfCenterOfMass;
+				record.cframe = phys.rigidBody.mainPart->getCFrame();
+			} else {
+				const HardPhysicalConnection& connection = static_cast<const ConnectedPhysical&>(phys).connectionToParent;
+				record.attachOnChild = connection.attachOnChild;
+				record.attachOnParent = connection.attachOnParent;
+				dynamicHardConstraintSerializer.serialize(*connection.constraintWithParent, streamBuffer);
+				record.hardConstraint = appendBlob(blob, takeStreamBuffer());
+			}
+
+			record.firstPart = partCount;
+			writePart(*phys.rigidBody.mainPart, GlobalCFrame(), CFrame());
+			for(const AttachedPart& atPart : phys.rigidBody.parts) {
+				writePart(*atPart.part, GlobalCFrame(), atPart.attachment);
+			}
+			record.partCount = partCount - record.firstPart;
+			appendRecord(physicals, record);
+
+			// reversed, so the first child is the next one to be written
+			for(std::size_t i = phys.childPhysicals.size(); i > 0; i--) {
+				stack.push_back(PendingPhysical{&phys.childPhysicals[i - 1], index});
+			}
+		}
+	}
+	worldRecord.partCount = partCount;
+	worldRecord.physicalCount = static_cast<std::uint32_t>(physicals.size() / sizeof(PhysicalRecord));
+	appendRecord(sections[static_cast<std::size_t>(Section::WORLD)], worldRecord);
+
+	serializeConstraints(world, streamBuffer);
+	sections[static_cast<std::size_t>(Section::CONSTRAINTS)] = takeStreamBuffer();
+	serializeExternalForces(world, streamBuffer);
+	sections[static_cast<std::size_t>(Section::EXTERNAL_FORCES)] = takeStreamBuffer();
+
+	// lay out the sections
+	FileHeader header;
+	std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.majorVersion = MAJOR_VERSION;
+	header.minorVersion = MINOR_VERSION;
+	header.sectionCount = static_cast<std::uint32_t>(Section::COUNT);
+
+	SectionEntry entries[static_cast<std::size_t>(Section::COUNT)];
+	std::size_t offset = alignToSection(sizeof(FileHeader) + sizeof(entries));
+	for(std::size_t i = 0; i < static_cast<std::size_t>(Section::COUNT); i++) {
+		entries[i].offset = offset;
+		entries[i].size = sections[i].size();
+		offset = alignToSection(offset + sections[i].size());
+	}
+	header.fileSize = offset;
+
+	ostream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	ostream.write(reinterpret_cast<const char*>(entries), sizeof(entries));
+	std::size_t written = sizeof(header) + sizeof(entries);
+	const char padding[SECTION_ALIGNMENT]{};
+	for(std::size_t i = 0; i < static_cast<std::size_t>(Section::COUNT); i++) {
+		ostream.write(padding, entries[i].offset - written);
+		ostream.write(sections[i].data(), sections[i].size());
+		written = entries[i].offset + sections[i].size();
+	}
+	ostream.write(padding, header.fileSize - written);
+}
+
+/*
+	Bounds checked view of the sections of a mapped world file
+*/
+class MappedWorldView {
+	char* data;
+	const MappedWorldFormat::SectionEntry* entries;
+
+public:
+	MappedWorldView(char* data, size_t size) : data(data) {
+		using namespace MappedWorldFormat;
+
+		if(!isMappedWorldFile(data, size)) throw SerializationException("Not a mapped world file");
+		if(reinterpret_cast<std::uintptr_t>(data) % SECTION_ALIGNMENT != 0) throw SerializationException("Mapped world data is not aligned to " + std::to_string(SECTION_ALIGNMENT) + " bytes");
+
+		const FileHeader* header = reinterpret_cast<const FileHeader*>(data);
+		// any minor version can be read, the sections it added are past the ones read here
+		if(header->majorVersion != MAJOR_VERSION) {
+			throw SerializationException("This mapped world file has an incompatible major version! Current " + std::to_string(MAJOR_VERSION) + " version of file: " + std::to_string(header->majorVersion));
+		}
+		if(header->fileSize > size) throw SerializationException("Mapped world file is truncated");
+		if(header->sectionCount < static_cast<std::uint32_t>(Section::COUNT) || sizeof(FileHeader) + header->sectionCount * sizeof(SectionEntry) > header->fileSize) {
+			throw SerializationException("Mapped world file has an invalid section table");
+		}
+		entries = reinterpret_cast<const SectionEntry*>(data + sizeof(FileHeader));
+		for(std::uint32_t i = 0; i < static_cast<std::uint32_t>(Section::COUNT); i++) {
+			if(entries[i].offset % SECTION_ALIGNMENT != 0 || entries[i].offset > header->fileSize || entries[i].size > header->fileSize - entries[i].offset) {
+				throw SerializationException("Section " + std::to_string(i) + " of mapped world file is out of bounds");
+			}
+		}
+	}
+
+	char* getSection(MappedWorldFormat::Section section) const {
+		return data + entries[static_cast<std::size_t>(section)].offset;
+	}
+	std::size_t getSectionSize(MappedWorldFormat::Section section) const {
+		return static_cast<std::size_t>(entries[static_cast<std::size_t>(section)].size);
+	}
+	template<typename T>
+	const T* getTable(MappedWorldFormat::Section section, std::size_t count) const {
+		if(getSectionSize(section) / sizeof(T) < count) throw SerializationException("Section " + std::to_string(static_cast<std::size_t>(section)) + " of mapped world file is too small");
+		return reinterpret_cast<const T*>(getSection(section));
+	}
+	char* getRange(MappedWorldFormat::Section section, std::uint64_t offset, std::uint64_t size) const {
+		std::size_t sectionSize = getSectionSize(section);
+		if(offset > sectionSize || size > sectionSize - offset) throw SerializationException("Range in section " + std::to_string(static_cast<std::size_t>(section)) + " of mapped world file is out of bounds");
+		return getSection(section) + offset;
+	}
+	void setStreamRange(Util::MemoryInputStream& stream, MappedWorldFormat::Section section, const MappedWorldFormat::BlobRange& range) const {
+		const char* begin = getRange(section, range.offset, range.size);
+		stream.setRange(begin, begin + range.size);
+	}
+};
+
+// copies a block of a mapped world file into memory owned by the polyhedron
+template<typename T>
+static UniqueAlignedPointer<T> copyMeshBlock(const char* block, std::size_t blockSize) {
+	UniqueAlignedPointer<T> result(blockSize / sizeof(T), 32);
+	std::memcpy(result.get(), block, blockSize);
+	return result;
+}
+
+void DeSerializationSessionPrototype::deserializeWorldMapped(WorldPrototype& world, char* data, size_t size, std::shared_ptr<const void> owner) {
+	using namespace MappedWorldFormat;
+
+	MappedWorldView view(data, size);
+	Util::MemoryInputStream stream;
+
+	const WorldRecord& worldRecord = *view.getTable<WorldRecord>(Section::WORLD, 1);
+
+	std::size_t shapeClassCount = view.getSectionSize(Section::SHAPE_CLASSES) / sizeof(ShapeClassRecord);
+	const ShapeClassRecord* shapeClassRecords = view.getTable<ShapeClassRecord>(Section::SHAPE_CLASSES, shapeClassCount);
+	for(std::size_t i = 0; i < shapeClassCount; i++) {
+		const ShapeClassRecord& record = shapeClassRecords[i];
+		const ShapeClass* shapeClass;
+		if(record.kind == ShapeClassKind::POLYHEDRON) {
+			std::size_t vertexBlockSize = MeshPrototype::getPaddedSize(record.vertexCount) * 3 * sizeof(float);
+			std::size_t triangleBlockSize = MeshPrototype::getPaddedSize(record.triangleCount) * 3 * sizeof(int);
+			if(record.offset % SECTION_ALIGNMENT != 0 || record.size != vertexBlockSize + triangleBlockSize) {
+				throw SerializationException("Polyhedron " + std::to_string(i) + " of mapped world file has an invalid layout");
+			}
+			char* meshData = view.getRange(Section::MESH_DATA, record.offset, record.size);
+			if(owner) {
+				// the polyhedron adopts the blocks in place, the shape class keeps them mapped
+				shapeClass = new PolyhedronShapeClass(Polyhedron(
+					UniqueAlignedPointer<float>::borrow(reinterpret_cast<float*>(meshData)),
+					UniqueAlignedPointer<int>::borrow(reinterpret_cast<int*>(meshData + vertexBlockSize)),
+					record.vertexCount, record.triangleCount), owner);
+			} else {
+				shapeClass = new PolyhedronShapeClass(Polyhedron(
+					copyMeshBlock<float>(meshData, vertexBlockSize),
+					copyMeshBlock<int>(meshData + vertexBlockSize, triangleBlockSize),
+					record.vertexCount, record.triangleCount));
+			}
+		} else if(record.kind == ShapeClassKind::STREAM) {
+			view.setStreamRange(stream, Section::BLOB, BlobRange{record.offset, record.size});
+			shapeClass = dynamicShapeClassSerializer.deserialize(stream);
+		} else {
+			throw SerializationException("Unknown shape class kind " + std::to_string(static_cast<std::uint32_t>(record.kind)));
+		}
+		shapeDeserializer.sharedShapeClassDeserializer.addDynamic(shapeClass);
+	}
+
+	world.age = worldRecord.age;
+
+	world.layers.clear();
+	world.layers.reserve(worldRecord.layerCount);
+	for(std::uint32_t i = 0; i < worldRecord.layerCount; i++) {
+		world.layers.emplace_back(&world, false);
+	}
+	const char* layerColissions = view.getTable<char>(Section::LAYER_COLISSIONS, std::size_t(worldRecord.layerCount) * (worldRecord.layerCount + 1) / 2);
+	for(int i = 0; i < world.getLayerCount(); i++) {
+		for(int j = 0; j <= i; j++) {
+			world.setLayersCollide(i, j, *layerColissions++ != 0);
+		}
+	}
+
+	const PartRecord* partRecords = view.getTable<PartRecord>(Section::PARTS, worldRecord.partCount);
+	std::size_t layerIDCount = world.layers.size() * ColissionLayer::NUMBER_OF_SUBLAYERS;
+	auto createPart = [&](std::uint32_t partIndex, const GlobalCFrame& cframe) {
+		if(partIndex >= worldRecord.partCount) throw SerializationException("Part index " + std::to_string(partIndex) + " of mapped world file is out of bounds");
+		const PartRecord& record = partRecords[partIndex];
+		if(record.layerID >= layerIDCount) throw SerializationException("Layer " + std::to_string(record.layerID) + " of mapped world file does not exist");
+
+		Shape shape(shapeDeserializer.sharedShapeClassDeserializer.getObject(record.shapeClassID), record.width, record.height, record.depth);
+		view.setStreamRange(stream, Section::BLOB, record.externalData);
+		Part* result = this->deserializePartExternalData(Part(shape, cframe, record.properties), stream);
+		result->layer = getLayerByID(world.layers, record.layerID);
+		return result;
+	};
+	auto createRigidBody = [&](const PhysicalRecord& record, const GlobalCFrame& cframeOfMain) {
+		if(record.partCount == 0) throw SerializationException("Physical of mapped world file has no parts");
+		if(record.firstPart > worldRecord.partCount || record.partCount > worldRecord.partCount - record.firstPart) {
+			throw SerializationException("Parts of physical of mapped world file are out of bounds");
+		}
+		RigidBody result(createPart(record.firstPart, cframeOfMain));
+		result.parts.reserve(record.partCount - 1);
+		for(std::uint32_t i = 1; i < record.partCount; i++) {
+			const CFrame& attach = partRecords[record.firstPart + i].attachment;
+			result.parts.push_back(AttachedPart{attach, createPart(record.firstPart + i, cframeOfMain.localToGlobal(attach))});
+		}
+		return result;
+	};
+
+	if(worldRecord.terrainPartCount > worldRecord.partCount) throw SerializationException("Terrain parts of mapped world file are out of bounds");
+	for(std::uint32_t i = 0; i < worldRecord.terrainPartCount; i++) {
+		Part* newPart = createPart(i, partRecords[i].cframe);
+		newPart->layer->addPart(newPart);
+		world.objectCount++;
+	}
+
+	// indexToPhysicalMap doubles as the lookup from record index to Physical, records are depth first so parents are always created first
+	const PhysicalRecord* physicalRecords = view.getTable<PhysicalRecord>(Section::PHYSICALS, worldRecord.physicalCount);
+	std::size_t firstPhysicalIndex = indexToPhysicalMap.size();
+	indexToPhysicalMap.reserve(firstPhysicalIndex + worldRecord.physicalCount);
+	MotorizedPhysical* currentMotorPhys = nullptr;
+	std::uint32_t currentMotorPhysIndex = 0;
+	for(std::uint32_t i = 0; i < worldRecord.physicalCount; i++) {
+		const PhysicalRecord& record = physicalRecords[i];
+		Physical* newPhys;
+		if(record.parentIndex == NO_PARENT) {
+			if(currentMotorPhys != nullptr) {
+				currentMotorPhys->refreshPhysicalProperties();
+				world.addPhysicalWithExistingLayers(currentMotorPhys);
+			}
+			currentMotorPhys = new MotorizedPhysical(createRigidBody(record, record.cframe));
+			currentMotorPhys->motionOfCenterOfMass = record.motionOfCenterOfMass;
+			currentMotorPhysIndex = i;
+			newPhys = currentMotorPhys;
+		} else {
+			if(currentMotorPhys == nullptr || record.parentIndex < currentMotorPhysIndex || record.parentIndex >= i) {
+				throw SerializationException("Physical " + std::to_string(i) + " of mapped world file has an invalid parent");
+			}
+			Physical& parent = *indexToPhysicalMap[firstPhysicalIndex + record.parentIndex];
+			// the children of every physical are reserved up front, the ConnectedPhysicals must not move once they are in indexToPhysicalMap
+			if(parent.childPhysicals.size() >= physicalRecords[record.parentIndex].childCount) {
+				throw SerializationException("Physical " + std::to_string(record.parentIndex) + " of mapped world file has more children than it declares");
+			}
+
+			view.setStreamRange(stream, Section::BLOB, record.hardConstraint);
+			HardPhysicalConnection connection(std::unique_ptr<HardConstraint>(dynamicHardConstraintSerializer.deserialize(stream)), record.attachOnChild, record.attachOnParent);
+			GlobalCFrame cframeOfConnectedPhys = parent.getCFrame().localToGlobal(connection.getRelativeCFrameToParent());
+			parent.childPhysicals.emplace_back(createRigidBody(record, cframeOfConnectedPhys), &parent, std::move(connection));
+			newPhys = &parent.childPhysicals.back();
+		}
+		newPhys->childPhysicals.reserve(record.childCount);
+		indexToPhysicalMap.push_back(newPhys);
+	}
+	if(currentMotorPhys != nullptr) {
+		currentMotorPhys->refreshPhysicalProperties();
+		world.addPhysicalWithExistingLayers(currentMotorPhys);
+	}
+
+	stream.setRange(view.getSection(Section::CONSTRAINTS), view.getSection(Section::CONSTRAINTS) + view.getSectionSize(Section::CONSTRAINTS));
+	deserializeConstraints(world, stream);
+	stream.setRange(view.getSection(Section::EXTERNAL_FORCES), view.getSection(Section::EXTERNAL_FORCES) + view.getSectionSize(Section::EXTERNAL_FORCES));
+	deserializeExternalForces(world, stream);
+}
+
+#pragma endregion
+
 #pragma region dynamic serializers
 
 static DynamicSerializerRegistry<HardConstraint>::ConcreteDynamicSerializer<FixedConstraint> fixedConstraintSerializer
@@ -521,6 +953,10 @@ static DynamicSerializerRegistry<HardConstraint>::ConcreteDynamicSerializer<Moto
 
 static DynamicSerializerRegistry<ShapeClass>::ConcreteDynamicSerializer<PolyhedronShapeClass> polyhedronSerializer
 (serializePolyhedronShapeClass, deserializePolyhedronShapeClass, 0);
+static DynamicSerializerRegistry<ShapeClass>::ConcreteDynamicSerializer<TriangleMeshShapeClass> triangleMeshSerializer
+(serializeTriangleMeshShapeClass, deserializeTriangleMeshShapeClass, 1);
+static DynamicSerializerRegistry<ShapeClass>::ConcreteDynamicSerializer<HeightfieldShapeClass> heightfieldSerializer
+(serializeHeightfieldShapeClass, deserializeHeightfieldShapeClass, 2);
 
 static DynamicSerializerRegistry<ExternalForce>::ConcreteDynamicSerializer<DirectionalGravity> gravitySerializer
 (serializeDirectionalGravity, deserializeDirectionalGravity, 0);
@@ -535,7 +971,14 @@ DynamicSerializerRegistry<HardConstraint> dynamicHardConstraintSerializer{
 	{typeid(MotorConstraintTemplate<SineWaveController>), &sinusiodalMotorConstraintSerializer}
 };
 DynamicSerializerRegistry<ShapeClass> dynamicShapeClassSerializer{
-	{typeid(PolyhedronShapeClass), &polyhedronSerializer}
+	{typeid(PolyhedronShapeClass), &polyhedronSerializer},
+	// the SIMD variants polyhedronShape creates, these are loaded back as a plain PolyhedronShapeClass
+	{typeid(PolyhedronShapeClassAVX), &polyhedronSerializer},
+	{typeid(PolyhedronShapeClassSSE), &polyhedronSerializer},
+	{typeid(PolyhedronShapeClassSSE4), &polyhedronSerializer},
+	{typeid(PolyhedronShapeClassFallback), &polyhedronSerializer},
+	{typeid(TriangleMeshShapeClass), &triangleMeshSerializer},
+	{typeid(HeightfieldShapeClass), &heightfieldSerializer}
 };
 DynamicSerializerRegistry<ExternalForce> dynamicExternalForceSerializer{
 	{typeid(DirectionalGravity), &gravitySerializer}
@@ -7,6 +7,7 @@
 #include <vector>
 #include <set>
 #include <map>
+#include <memory>
 #include <unordered_map>
 
 #include "../math/fix.h"
@@ -83,6 +84,9 @@ private:
 
 	void serializeWorldLayer(const WorldLayer& layer, std::ostream& ostream);
 	void serializeConstraintInContext(const PhysicalConstraint& constraint, std::ostream& ostream);
+	void serializeConstraints(const WorldPrototype& world, std::ostream& ostream);
+
+	void collectWorldInformation(const WorldPrototype& world);
 
 protected:
 	virtual void collectPartInformation(const Part& part);
@@ -98,6 +102,11 @@ public:
 	SerializationSessionPrototype(const std::vector<const ShapeClass*>& knownShapeClasses = std::vector<const ShapeClass*>());
 
 	void serializeWorld(const WorldPrototype& world, std::ostream& ostream);
+	/*
+		Serializes the world in the section based format of mappedWorldFormat.h, which can be loaded with deserializeWorldMapped without copying its polyhedra
+		The external data of every part is still written by serializePartExternalData, serializeCollectedHeaderInformation is not used
+	*/
+	void serializeWorldMapped(const WorldPrototype& world, std::ostream& ostream);
 	void serializeParts(const Part* const parts[], size_t partCount, std::ostream& ostream);
 };
 
@@ -107,6 +116,7 @@ private:
 	void deserializeConnectionsOfPhysicalWithContext(std::vector<ColissionLayer>& layers, Physical& physToPopulate, std::istream& istream);
 	RigidBody deserializeRigidBodyWithContext(const GlobalCFrame& cframeOfMain, std::vector<ColissionLayer>& layers, std::istream& istream);
 	PhysicalConstraint deserializeConstraintInContext(std::istream& istream);
+	void deserializeConstraints(WorldPrototype& world, std::istream& istream);
 	void deserializeWorldLayer(WorldLayer& layer, std::istream& istream);
 protected:
 	ShapeDeserializer shapeDeserializer;
@@ -126,6 +136,14 @@ public:
 
 
 	void deserializeWorld(WorldPrototype& world, std::istream& istream);
+	/*
+		Loads a world written by serializeWorldMapped from data, usually a MappedFile
+		data must be aligned to MappedWorldFormat::SECTION_ALIGNMENT
+		With an owner of data, the polyhedra of the loaded ShapeClasses point into data and share the ownership of it, so data stays
+		valid for as long as any of these ShapeClasses exists. Without one the polyhedra are copied out, and data may be released afterwards
+		The external data of every part is read by deserializePartExternalData, deserializeAndCollectHeaderInformation is not used
+	*/
+	void deserializeWorldMapped(WorldPrototype& world, char* data, size_t size, std::shared_ptr<const void> owner = nullptr);
 	std::vector<Part*> deserializeParts(std::istream& istream);
 };
 
@@ -165,6 +183,9 @@ public:
 	void serializeWorld(const World<ExtendedPartType>& world, std::ostream& ostream) {
 		SerializationSessionPrototype::serializeWorld(world, ostream);
 	}
+	void serializeWorldMapped(const World<ExtendedPartType>& world, std::ostream& ostream) {
+		SerializationSessionPrototype::serializeWorldMapped(world, ostream);
+	}
 
 	void serializeParts(const ExtendedPartType* const parts[], size_t partCount, std::ostream& ostream) {
 		std::vector<const Part*> baseParts(partCount);
@@ -191,6 +212,9 @@ public:
 	using DeSerializationSessionPrototype::DeSerializationSessionPrototype;
 
 	void deserializeWorld(World<ExtendedPartType>& world, std::istream& istream) { DeSerializationSessionPrototype::deserializeWorld(world, istream); }
+	void deserializeWorldMapped(World<ExtendedPartType>& world, char* data, size_t size, std::shared_ptr<const void> owner = nullptr) {
+		DeSerializationSessionPrototype::deserializeWorldMapped(world, data, size, std::move(owner));
+	}
 	std::vector<ExtendedPartType*> deserializeParts(std::istream& istream) {
 		return castVector<ExtendedPartType>(DeSerializationSessionPrototype::deserializeParts(istream));
 	}
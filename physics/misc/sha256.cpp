@@ -0,0 +1,98 @@
+#include "sha256.h"
+
+#include <cstring>
+#include <algorithm>
+
+static constexpr std::uint32_t ROUND_CONSTANTS[64]{
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline std::uint32_t rotateRight(std::uint32_t x, int bits) {
+	return (x >> bits) | (x << (32 - bits));
+}
+
+SHA256::SHA256() : state{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19} {}
+
+void SHA256::processBlock(const std::uint8_t* data) {
+	std::uint32_t w[64];
+	for(int i = 0; i < 16; i++) {
+		w[i] = (std::uint32_t(data[i * 4]) << 24) | (std::uint32_t(data[i * 4 + 1]) << 16) | (std::uint32_t(data[i * 4 + 2]) << 8) | std::uint32_t(data[i * 4 + 3]);
+	}
+	for(int i = 16; i < 64; i++) {
+		std::uint32_t s0 = rotateRight(w[i - 15], 7) ^ rotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+		std::uint32_t s1 = rotateRight(w[i - 2], 17) ^ rotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+		w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+	}
+
+	std::uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], f = state[5], g = state[6], h = state[7];
+	for(int i = 0; i < 64; i++) {
+		std::uint32_t s1 = rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25);
+		std::uint32_t choice = (e & f) ^ (~e & g);
+		std::uint32_t t1 = h + s1 + choice + ROUND_CONSTANTS[i] + w[i];
+		std::uint32_t s0 = rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22);
+		std::uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+		std::uint32_t t2 = s0 + majority;
+		h = g; g = f; f = e; e = d + t1;
+		d = c; c = b; b = a; a = t1 + t2;
+	}
+	state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+	state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+void SHA256::add(const void* data, std::size_t size) {
+	const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+	totalSize += size;
+
+	if(blockSize != 0) {
+		std::size_t taken = std::min(size, sizeof(block) - blockSize);
+		std::memcpy(block + blockSize, bytes, taken);
+		blockSize += taken;
+		bytes += taken;
+		size -= taken;
+		if(blockSize != sizeof(block)) return;
+		processBlock(block);
+		blockSize = 0;
+	}
+	for(; size >= sizeof(block); bytes += sizeof(block), size -= sizeof(block)) {
+		processBlock(bytes);
+	}
+	std::memcpy(block, bytes, size);
+	blockSize = size;
+}
+
+SHA256::Digest SHA256::finish() {
+	std::uint64_t bitCount = totalSize * 8;
+
+	block[blockSize++] = 0x80;
+	if(blockSize > sizeof(block) - 8) {
+		std::memset(block + blockSize, 0, sizeof(block) - blockSize);
+		processBlock(block);
+		blockSize = 0;
+	}
+	std::memset(block + blockSize, 0, sizeof(block) - 8 - blockSize);
+	for(int i = 0; i < 8; i++) {
+		block[sizeof(block) - 1 - i] = static_cast<std::uint8_t>(bitCount >> (i * 8));
+	}
+	processBlock(block);
+
+	Digest result;
+	for(int i = 0; i < 8; i++) {
+		for(int j = 0; j < 4; j++) {
+			result[i * 4 + j] = static_cast<std::uint8_t>(state[i] >> (24 - j * 8));
+		}
+	}
+	return result;
+}
+
+SHA256::Digest SHA256::hash(const void* data, std::size_t size) {
+	SHA256 hasher;
+	hasher.add(data, size);
+	return hasher.finish();
+}
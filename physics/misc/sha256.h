@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+
+/*
+	SHA-256 as specified in FIPS 180-4, for content that must be identified without trusting a weak hash, such as the
+	meshes of the ShapeClassCache. Not meant for hashing simulation state every tick, see StateHasher for that.
+*/
+class SHA256 {
+public:
+	typedef std::array<std::uint8_t, 32> Digest;
+
+private:
+	std::uint32_t state[8];
+	std::uint8_t block[64];
+	std::size_t blockSize = 0;
+	std::uint64_t totalSize = 0;
+
+	void processBlock(const std::uint8_t* data);
+
+public:
+	SHA256();
+
+	void add(const void* data, std::size_t size);
+	// pads the message and returns its digest, the hasher can't be added to afterwards
+	Digest finish();
+
+	static Digest hash(const void* data, std::size_t size);
+};
@@ -0,0 +1,164 @@
+#include "shapeClassCache.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../geometry/polyhedron.h"
+#include "../geometry/builtinShapeClasses.h"
+
+#include "../../util/cpuid.h"
+#include "../../util/serializeBasicTypes.h"
+
+#define DERIVED_DATA_CACHE_VERSION 2
+
+ShapeClassCache ShapeClassCache::instance;
+
+static std::size_t getVertexBlockSize(const MeshPrototype& mesh) {
+	return MeshPrototype::getPaddedSize(mesh.vertexCount) * 3 * sizeof(float);
+}
+
+static std::size_t getTriangleBlockSize(const MeshPrototype& mesh) {
+	return MeshPrototype::getPaddedSize(mesh.triangleCount) * 3 * sizeof(int);
+}
+
+// the padding of the buffers is part of the content, TriangleMesh always fills it with copies of the last element
+static bool isSameMesh(const MeshPrototype& a, const MeshPrototype& b) {
+	return a.vertexCount == b.vertexCount && a.triangleCount == b.triangleCount &&
+		std::memcmp(a.getVertexBuffer(), b.getVertexBuffer(), getVertexBlockSize(a)) == 0 &&
+		std::memcmp(a.getTriangleBuffer(), b.getTriangleBuffer(), getTriangleBlockSize(a)) == 0;
+}
+
+static PolyhedronShapeClass* newPolyhedronShapeClass(Polyhedron&& poly, const ShapeClassCache::DerivedData& data) {
+	if(Util::CPUIDCheck::hasTechnology(Util::CPUIDCheck::AVX | Util::CPUIDCheck::AVX2 | Util::CPUIDCheck::FMA)) {
+		return new PolyhedronShapeClassAVX(std::move(poly), data.volume, data.centerOfMass, data.inertia);
+	} else if(Util::CPUIDCheck::hasTechnology(Util::CPUIDCheck::SSE | Util::CPUIDCheck::SSE2)) {
+		if(Util::CPUIDCheck::hasTechnology(Util::CPUIDCheck::SSE4_1)) {
+			return new PolyhedronShapeClassSSE4(std::move(poly), data.volume, data.centerOfMass, data.inertia);
+		} else {
+			return new PolyhedronShapeClassSSE(std::move(poly), data.volume, data.centerOfMass, data.inertia);
+		}
+	} else {
+		return new PolyhedronShapeClassFallback(std::move(poly), data.volume, data.centerOfMass, data.inertia);
+	}
+}
+
+// the digest is already uniformly distributed, any part of it makes a good bucket hash
+std::size_t ShapeClassCache::MeshKeyHash::operator()(const MeshKey& key) const {
+	std::size_t result;
+	std::memcpy(&result, key.digest.data(), sizeof(result));
+	return result;
+}
+
+// the counts are hashed as well, they decide where the vertex block ends and the triangle block starts
+ShapeClassCache::MeshKey ShapeClassCache::getKey(const Polyhedron& poly) {
+	SHA256 hasher;
+	hasher.add(&poly.vertexCount, sizeof(poly.vertexCount));
+	hasher.add(&poly.triangleCount, sizeof(poly.triangleCount));
+	hasher.add(poly.getVertexBuffer(), getVertexBlockSize(poly));
+	hasher.add(poly.getTriangleBuffer(), getTriangleBlockSize(poly));
+	return MeshKey{hasher.finish(), poly.vertexCount, poly.triangleCount};
+}
+
+const PolyhedronShapeClass* ShapeClassCache::getPolyhedronClass(Polyhedron&& normalizedPoly) {
+	MeshKey key = getKey(normalizedPoly);
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	auto range = classes.equal_range(key);
+	for(auto iter = range.first; iter != range.second; ++iter) {
+		if(isSameMesh(iter->second->getPolyhedron(), normalizedPoly)) {
+			return iter->second.get();
+		}
+	}
+
+	PolyhedronShapeClass* result;
+	auto found = derivedData.find(key);
+	// a mesh with a colliding hash can't use the derived data of the other mesh
+	if(found != derivedData.end() && range.first == range.second) {
+		result = newPolyhedronShapeClass(std::move(normalizedPoly), found->second);
+	} else {
+		DerivedData data{normalizedPoly.getVolume(), normalizedPoly.getCenterOfMass(), normalizedPoly.getScalableInertiaAroundCenterOfMass()};
+		derivedData.emplace(key, data);
+		computedCount++;
+		result = newPolyhedronShapeClass(std::move(normalizedPoly), data);
+	}
+
+	classes.emplace(key, std::unique_ptr<PolyhedronShapeClass>(result));
+	return result;
+}
+
+std::size_t ShapeClassCache::getClassCount() const {
+	std::lock_guard<std::mutex> guard(lock);
+	return classes.size();
+}
+
+std::size_t ShapeClassCache::getComputedCount() const {
+	std::lock_guard<std::mutex> guard(lock);
+	return computedCount;
+}
+
+// every field of an entry goes through the entry checksum as well
+template<typename T>
+static void serializeChecked(const T& value, std::ostream& ostream, SHA256& checksum) {
+	::serialize<T>(value, ostream);
+	checksum.add(&value, sizeof(T));
+}
+
+template<typename T>
+static T deserializeChecked(std::istream& istream, SHA256& checksum) {
+	T value = ::deserialize<T>(istream);
+	checksum.add(&value, sizeof(T));
+	return value;
+}
+
+void ShapeClassCache::serializeDerivedData(std::ostream& ostream) const {
+	std::lock_guard<std::mutex> guard(lock);
+
+	::serialize<int>(DERIVED_DATA_CACHE_VERSION, ostream);
+	::serialize<std::uint64_t>(derivedData.size(), ostream);
+	for(const std::pair<const MeshKey, DerivedData>& entry : derivedData) {
+		SHA256 checksum;
+		serializeChecked<SHA256::Digest>(entry.first.digest, ostream, checksum);
+		serializeChecked<int>(entry.first.vertexCount, ostream, checksum);
+		serializeChecked<int>(entry.first.triangleCount, ostream, checksum);
+		serializeChecked<double>(entry.second.volume, ostream, checksum);
+		serializeChecked<Vec3>(entry.second.centerOfMass, ostream, checksum);
+		serializeChecked<ScalableInertialMatrix>(entry.second.inertia, ostream, checksum);
+		::serialize<SHA256::Digest>(checksum.finish(), ostream);
+	}
+}
+
+void ShapeClassCache::deserializeDerivedData(std::istream& istream) {
+	int version = ::deserialize<int>(istream);
+	if(version != DERIVED_DATA_CACHE_VERSION) {
+		throw SerializationException("Unsupported shape class cache version " + std::to_string(version));
+	}
+
+	std::uint64_t entryCount = ::deserialize<std::uint64_t>(istream);
+	std::vector<std::pair<MeshKey, DerivedData>> entries;
+	for(std::uint64_t i = 0; i < entryCount; i++) {
+		SHA256 checksum;
+		MeshKey key;
+		key.digest = deserializeChecked<SHA256::Digest>(istream, checksum);
+		key.vertexCount = deserializeChecked<int>(istream, checksum);
+		key.triangleCount = deserializeChecked<int>(istream, checksum);
+		double volume = deserializeChecked<double>(istream, checksum);
+		Vec3 centerOfMass = deserializeChecked<Vec3>(istream, checksum);
+		ScalableInertialMatrix inertia = deserializeChecked<ScalableInertialMatrix>(istream, checksum);
+		SHA256::Digest storedChecksum = ::deserialize<SHA256::Digest>(istream);
+		if(!istream) {
+			throw SerializationException("Unexpected end of shape class cache");
+		}
+		if(storedChecksum != checksum.finish()) {
+			throw SerializationException("Corrupt shape class cache entry " + std::to_string(i));
+		}
+		entries.emplace_back(key, DerivedData{volume, centerOfMass, inertia});
+	}
+
+	// only added once the whole stream was read, so a broken cache adds nothing
+	std::lock_guard<std::mutex> guard(lock);
+	for(const std::pair<MeshKey, DerivedData>& entry : entries) {
+		derivedData.emplace(entry.first, entry.second);
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "sha256.h"
+#include "../math/linalg/vec.h"
+#include "../geometry/scalableInertialMatrix.h"
+
+class Polyhedron;
+class PolyhedronShapeClass;
+
+/*
+	Shares the ShapeClasses of identical polyhedra
+
+	Polyhedra are identified by the SHA-256 of their normalized vertex and triangle buffers, along with their vertex and triangle counts. Creating the class of a polyhedron
+	that was seen before returns the existing class instead of a new copy. The data derived from the mesh (volume, center
+	of mass and inertia) is remembered separately, it can be saved and loaded so later runs don't have to compute it again.
+	Every saved entry carries a checksum, a cache file that was damaged in any way is rejected as a whole rather than
+	handing out wrong mass properties.
+
+	The cache owns the classes it creates, they live as long as the cache.
+*/
+class ShapeClassCache {
+public:
+	struct DerivedData {
+		double volume;
+		Vec3 centerOfMass;
+		ScalableInertialMatrix inertia;
+	};
+
+private:
+	struct MeshKey {
+		SHA256::Digest digest;
+		int vertexCount;
+		int triangleCount;
+
+		bool operator==(const MeshKey& other) const {
+			return digest == other.digest && vertexCount == other.vertexCount && triangleCount == other.triangleCount;
+		}
+	};
+	struct MeshKeyHash {
+		std::size_t operator()(const MeshKey& key) const;
+	};
+
+	mutable std::mutex lock;
+	// a multimap, so polyhedra with colliding hashes each still get their own class
+	std::unordered_multimap<MeshKey, std::unique_ptr<PolyhedronShapeClass>, MeshKeyHash> classes;
+	std::unordered_map<MeshKey, DerivedData, MeshKeyHash> derivedData;
+	std::size_t computedCount = 0;
+
+	static MeshKey getKey(const Polyhedron& poly);
+
+public:
+	static ShapeClassCache instance;
+
+	/*
+		Returns the shared class of normalizedPoly, which must already be scaled to fit the -1..1 box of a ShapeClass
+		Thread safe
+	*/
+	const PolyhedronShapeClass* getPolyhedronClass(Polyhedron&& normalizedPoly);
+
+	std::size_t getClassCount() const;
+	// the number of times derived data was computed rather than taken from the cache
+	std::size_t getComputedCount() const;
+
+	void serializeDerivedData(std::ostream& ostream) const;
+	// adds the derived data of the stream to the cache, throws SerializationException if the stream is not a derived data cache
+	void deserializeDerivedData(std::istream& istream);
+};
@@ -0,0 +1,256 @@
+#include "stateHash.h"
+
+#include <cstring>
+#include <cassert>
+#include <type_traits>
+
+#include "../world.h"
+#include "../part.h"
+#include "../physical.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define STATE_HASH_SSE2
+#endif
+
+#define STRIPE_SIZE 32
+
+static_assert(sizeof(GlobalCFrame) % STRIPE_SIZE == 0 && std::is_trivially_copyable<GlobalCFrame>::value, "GlobalCFrame must be hashable in whole stripes");
+static_assert(sizeof(Motion) % STRIPE_SIZE == 0 && std::is_trivially_copyable<Motion>::value, "Motion must be hashable in whole stripes");
+
+static constexpr std::uint64_t PRIME32_1 = 0x9E3779B1ULL;
+static constexpr std::uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static constexpr std::uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static constexpr std::uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+
+alignas(32) static constexpr std::uint64_t LANE_KEYS[4]{0xBE4BA423396CFEB8ULL, 0x1CAD21F72C81017CULL, 0xDB979083E96DD4DEULL, 0x1F67B3B7A4A44072ULL};
+
+#pragma region lanes
+
+/*
+	Every 64 bit word w of a stripe is mixed into its lane with a round, k being the key of the lane:
+		lane = rotl(lane + lo32(w ^ k) * hi32(w ^ k) + w, 31) * PRIME32_1
+	Rotating and multiplying after every word makes the lane depend on the order of its words, not just their sum
+	The multiplications are built from the 32x32->64 one that both SSE2 and AVX2 have
+	Scrambling is lane = (lane ^ (lane >> 47) ^ k) * PRIME32_1
+*/
+
+#if defined(__AVX2__)
+
+// 64x32 bit multiply, from the two 32x32 halves
+static __m256i multiplyByPrime(__m256i value, __m256i prime) {
+	__m256i low = _mm256_mul_epu32(value, prime);
+	__m256i high = _mm256_mul_epu32(_mm256_srli_epi64(value, 32), prime);
+	return _mm256_add_epi64(low, _mm256_slli_epi64(high, 32));
+}
+
+static void accumulate(std::uint64_t* lanes, const char* data, std::size_t stripes) {
+	__m256i acc = _mm256_load_si256(reinterpret_cast<const __m256i*>(lanes));
+	const __m256i key = _mm256_load_si256(reinterpret_cast<const __m256i*>(LANE_KEYS));
+	const __m256i prime = _mm256_set1_epi32(static_cast<int>(PRIME32_1));
+	for(std::size_t s = 0; s < stripes; s++) {
+		__m256i word = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + s * STRIPE_SIZE));
+		__m256i keyed = _mm256_xor_si256(word, key);
+		__m256i product = _mm256_mul_epu32(keyed, _mm256_srli_epi64(keyed, 32));
+		acc = _mm256_add_epi64(acc, _mm256_add_epi64(product, word));
+		acc = _mm256_or_si256(_mm256_slli_epi64(acc, 31), _mm256_srli_epi64(acc, 33));
+		acc = multiplyByPrime(acc, prime);
+	}
+	_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+}
+
+static void scramble(std::uint64_t* lanes) {
+	__m256i acc = _mm256_load_si256(reinterpret_cast<const __m256i*>(lanes));
+	const __m256i key = _mm256_load_si256(reinterpret_cast<const __m256i*>(LANE_KEYS));
+	const __m256i prime = _mm256_set1_epi32(static_cast<int>(PRIME32_1));
+	acc = _mm256_xor_si256(acc, _mm256_srli_epi64(acc, 47));
+	acc = _mm256_xor_si256(acc, key);
+	_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), multiplyByPrime(acc, prime));
+}
+
+#elif defined(STATE_HASH_SSE2)
+
+// 64x32 bit multiply, from the two 32x32 halves
+static __m128i multiplyByPrime(__m128i value, __m128i prime) {
+	__m128i low = _mm_mul_epu32(value, prime);
+	__m128i high = _mm_mul_epu32(_mm_srli_epi64(value, 32), prime);
+	return _mm_add_epi64(low, _mm_slli_epi64(high, 32));
+}
+
+static void accumulate(std::uint64_t* lanes, const char* data, std::size_t stripes) {
+	__m128i acc[2]{_mm_load_si128(reinterpret_cast<const __m128i*>(lanes)), _mm_load_si128(reinterpret_cast<const __m128i*>(lanes + 2))};
+	const __m128i key[2]{_mm_load_si128(reinterpret_cast<const __m128i*>(LANE_KEYS)), _mm_load_si128(reinterpret_cast<const __m128i*>(LANE_KEYS + 2))};
+	const __m128i prime = _mm_set1_epi32(static_cast<int>(PRIME32_1));
+	for(std::size_t s = 0; s < stripes; s++) {
+		for(int h = 0; h < 2; h++) {
+			__m128i word = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + s * STRIPE_SIZE + h * 16));
+			__m128i keyed = _mm_xor_si128(word, key[h]);
+			__m128i product = _mm_mul_epu32(keyed, _mm_srli_epi64(keyed, 32));
+			acc[h] = _mm_add_epi64(acc[h], _mm_add_epi64(product, word));
+			acc[h] = _mm_or_si128(_mm_slli_epi64(acc[h], 31), _mm_srli_epi64(acc[h], 33));
+			acc[h] = multiplyByPrime(acc[h], prime);
+		}
+	}
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc[0]);
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes + 2), acc[1]);
+}
+
+static void scramble(std::uint64_t* lanes) {
+	const __m128i prime = _mm_set1_epi32(static_cast<int>(PRIME32_1));
+	for(int h = 0; h < 2; h++) {
+		__m128i acc = _mm_load_si128(reinterpret_cast<const __m128i*>(lanes + h * 2));
+		acc = _mm_xor_si128(acc, _mm_srli_epi64(acc, 47));
+		acc = _mm_xor_si128(acc, _mm_load_si128(reinterpret_cast<const __m128i*>(LANE_KEYS + h * 2)));
+		_mm_store_si128(reinterpret_cast<__m128i*>(lanes + h * 2), multiplyByPrime(acc, prime));
+	}
+}
+
+#else
+
+static void accumulate(std::uint64_t* lanes, const char* data, std::size_t stripes) {
+	for(std::size_t s = 0; s < stripes; s++) {
+		for(int i = 0; i < 4; i++) {
+			std::uint64_t word;
+			std::memcpy(&word, data + s * STRIPE_SIZE + i * sizeof(std::uint64_t), sizeof(word));
+			std::uint64_t keyed = word ^ LANE_KEYS[i];
+			std::uint64_t lane = lanes[i] + (keyed & 0xFFFFFFFF) * (keyed >> 32) + word;
+			lanes[i] = ((lane << 31) | (lane >> 33)) * PRIME32_1;
+		}
+	}
+}
+
+static void scramble(std::uint64_t* lanes) {
+	for(int i = 0; i < 4; i++) {
+		std::uint64_t lane = lanes[i];
+		lane ^= lane >> 47;
+		lane ^= LANE_KEYS[i];
+		lanes[i] = lane * PRIME32_1;
+	}
+}
+
+#endif
+
+#pragma endregion
+
+StateHasher::StateHasher() : lanes{PRIME64_1, PRIME64_2, PRIME64_3, PRIME32_1} {}
+
+void StateHasher::addStripes(const void* data, std::size_t stripes) {
+	accumulate(lanes, static_cast<const char*>(data), stripes);
+	stripeCount += stripes;
+}
+
+void StateHasher::add(const GlobalCFrame& cframe) {
+	addStripes(&cframe, sizeof(GlobalCFrame) / STRIPE_SIZE);
+}
+
+void StateHasher::add(const Motion& motion) {
+	addStripes(&motion, sizeof(Motion) / STRIPE_SIZE);
+}
+
+void StateHasher::add(const void* data, std::size_t size) {
+	assert(size % STRIPE_SIZE == 0);
+	addStripes(data, size / STRIPE_SIZE);
+}
+
+void StateHasher::endObject() {
+	scramble(lanes);
+}
+
+static std::uint64_t rotateLeft(std::uint64_t value, int bits) {
+	return (value << bits) | (value >> (64 - bits));
+}
+
+std::uint64_t StateHasher::get() const {
+	std::uint64_t result = stripeCount * PRIME64_1;
+	for(int i = 0; i < 4; i++) {
+		result ^= rotateLeft(lanes[i] * PRIME64_2, 31) * PRIME64_1;
+		result = rotateLeft(result, 27) * PRIME64_1 + PRIME64_3;
+	}
+	result ^= result >> 33;
+	result *= PRIME64_2;
+	result ^= result >> 29;
+	result *= PRIME64_3;
+	result ^= result >> 32;
+	return result;
+}
+
+std::uint64_t WorldPrototype::computeStateHash() const {
+	StateHasher hasher;
+	for(const MotorizedPhysical* phys : physicals) {
+		hasher.add(phys->motionOfCenterOfMass);
+		hasher.endObject();
+		phys->forEachPart([&hasher](const Part& part) {
+			hasher.add(part.getCFrame());
+			hasher.endObject();
+		});
+	}
+	return hasher.get();
+}
+
+void computePartStateHashes(const WorldPrototype& world, std::vector<std::uint64_t>& hashes) {
+	hashes.clear();
+	for(const MotorizedPhysical* phys : world.physicals) {
+		bool isMainPart = true;
+		phys->forEachPart([&hashes, &isMainPart, phys](const Part& part) {
+			StateHasher hasher;
+			if(isMainPart) {
+				hasher.add(phys->motionOfCenterOfMass);
+				hasher.endObject();
+				isMainPart = false;
+			}
+			hasher.add(part.getCFrame());
+			hasher.endObject();
+			hashes.push_back(hasher.get());
+		});
+	}
+}
+
+// finds the first part where b differs from a, both must have the same physicals and parts
+static void locateDivergence(const WorldPrototype& a, const WorldPrototype& b, Divergence& result) {
+	std::vector<std::uint64_t> hashesA;
+	std::vector<std::uint64_t> hashesB;
+	computePartStateHashes(a, hashesA);
+	computePartStateHashes(b, hashesB);
+
+	std::size_t partOffset = 0;
+	for(std::size_t physicalIndex = 0; physicalIndex < a.physicals.size(); physicalIndex++) {
+		std::size_t partCount = a.physicals[physicalIndex]->getNumberOfPartsInThisAndChildren();
+		for(std::size_t partIndex = 0; partIndex < partCount; partIndex++) {
+			std::size_t i = partOffset + partIndex;
+			if(i >= hashesB.size() || hashesA[i] != hashesB[i]) {
+				result.physicalIndex = physicalIndex;
+				result.partIndex = partIndex;
+				return;
+			}
+		}
+		partOffset += partCount;
+	}
+	// the parts agree, but the physicals don't line up
+	result.physicalIndex = a.physicals.size();
+	result.partIndex = 0;
+}
+
+Divergence findDivergence(const std::vector<WorldPrototype*>& worlds, std::size_t tickCount) {
+	Divergence result;
+	for(std::size_t t = 0; t < tickCount; t++) {
+		for(WorldPrototype* world : worlds) {
+			world->tick();
+		}
+		std::uint64_t expected = worlds[0]->computeStateHash();
+		for(std::size_t w = 1; w < worlds.size(); w++) {
+			std::uint64_t found = worlds[w]->computeStateHash();
+			if(found != expected || worlds[w]->physicals.size() != worlds[0]->physicals.size()) {
+				result.diverged = true;
+				result.tick = worlds[0]->age;
+				result.worldIndex = w;
+				result.expectedHash = expected;
+				result.foundHash = found;
+				locateDivergence(*worlds[0], *worlds[w], result);
+				return result;
+			}
+		}
+	}
+	return result;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../math/globalCFrame.h"
+#include "../motion.h"
+
+class WorldPrototype;
+class Part;
+
+/*
+	Hash of the simulated state of a world, used to check that a simulation is bit for bit reproducible
+
+	Values are hashed by their bytes, in 32 byte stripes spread over 4 independent 64 bit lanes, so the lanes can be updated with a single AVX2 or two SSE2 operations.
+	The SIMD and the scalar versions give the same result.
+	The hash depends on the order of the hashed values, not just on the values themselves, words are mixed into their lane one at a time.
+*/
+class StateHasher {
+	alignas(32) std::uint64_t lanes[4];
+	std::size_t stripeCount = 0;
+
+	void addStripes(const void* data, std::size_t stripes);
+
+public:
+	StateHasher();
+
+	void add(const GlobalCFrame& cframe);
+	void add(const Motion& motion);
+	// hashes raw bytes, size must be a multiple of 32
+	void add(const void* data, std::size_t size);
+	// marks the end of a hashed object, so the values of consecutive objects can't be swapped without changing the hash
+	void endObject();
+
+	std::uint64_t get() const;
+};
+
+/*
+	Computes the hash of every part of every physical, in the order of world.physicals and forEachPart
+	The motion of a physical is included in the hash of its main part
+*/
+void computePartStateHashes(const WorldPrototype& world, std::vector<std::uint64_t>& hashes);
+
+/*
+	The first place where worlds that should have simulated identically differ
+	physicalIndex and partIndex index world.physicals and its forEachPart order, partIndex counts from the start of the physical
+*/
+struct Divergence {
+	bool diverged = false;
+	// the world.age at which the hashes first differed
+	std::size_t tick = 0;
+	// the world that differed from the first world
+	std::size_t worldIndex = 0;
+	std::size_t physicalIndex = 0;
+	std::size_t partIndex = 0;
+	std::uint64_t expectedHash = 0;
+	std::uint64_t foundHash = 0;
+};
+
+/*
+	Ticks all worlds in lockstep for tickCount ticks, comparing their state hash after every tick
+	The worlds should start in the same state, but may differ in how they are simulated, such as their jobSystem
+	Stops at the first tick where a world differs from worlds[0] and reports the first part that differs
+*/
+Divergence findDivergence(const std::vector<WorldPrototype*>& worlds, std::size_t tickCount);
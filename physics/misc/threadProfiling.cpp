@@ -0,0 +1,248 @@
+#include "threadProfiling.h"
+
+// only locked when a thread profiles for the first time, and while merging
+static std::mutex profilesLock;
+static std::vector<ThreadProfile*> profiles;
+
+static std::atomic<int> nextCounter{0};
+
+// zones are reserved while the globals are constructed, so these are constructed on first use
+static std::mutex& getZoneLabelsLock() {
+	static std::mutex zoneLabelsLock;
+	return zoneLabelsLock;
+}
+static std::vector<const char*>& getZoneLabels() {
+	static std::vector<const char*> zoneLabels;
+	return zoneLabels;
+}
+
+thread_local ThreadProfile* ThreadProfile::current = nullptr;
+std::atomic<bool> ThreadProfile::tracingEnabled{false};
+
+// gives the profile of the thread back when the thread exits
+class ThreadProfileOwner {
+public:
+	ThreadProfile* profile = nullptr;
+
+	~ThreadProfileOwner() {
+		if(profile != nullptr) {
+			ThreadProfile::current = nullptr;
+			profile->owned.store(false, std::memory_order_release);
+		}
+	}
+};
+static thread_local ThreadProfileOwner profileOwner;
+
+#ifdef PROFILER_USES_TSC
+static double measureTickNanoseconds() {
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	std::uint64_t startTicks = profilerTicks();
+	std::chrono::steady_clock::time_point endTime;
+	do {
+		endTime = std::chrono::steady_clock::now();
+	} while(endTime - startTime < std::chrono::milliseconds(10));
+	std::uint64_t endTicks = profilerTicks();
+	return std::chrono::duration<double, std::nano>(endTime - startTime).count() / (endTicks - startTicks);
+}
+#endif
+
+double profilerTickNanoseconds() {
+#ifdef PROFILER_USES_TSC
+	static const double tickNanoseconds = measureTickNanoseconds();
+	return tickNanoseconds;
+#else
+	return 1E9 * std::chrono::steady_clock::period::num / std::chrono::steady_clock::period::den;
+#endif
+}
+
+ThreadProfile::ThreadProfile(int index) : index(index) {
+	for(std::atomic<std::int64_t>& counter : counters) {
+		counter.store(0, std::memory_order_relaxed);
+	}
+}
+
+ThreadProfile& ThreadProfile::claim() {
+	std::lock_guard<std::mutex> lg(profilesLock);
+	ThreadProfile* profile = nullptr;
+	for(ThreadProfile* free : profiles) {
+		if(!free->owned.load(std::memory_order_acquire)) {
+			profile = free;
+			break;
+		}
+	}
+	if(profile == nullptr) {
+		profile = new ThreadProfile(static_cast<int>(profiles.size()));
+		profiles.push_back(profile);
+	}
+	profile->owned.store(true, std::memory_order_relaxed);
+	profile->currentNode = -1;
+	profileOwner.profile = profile;
+	current = profile;
+	return *profile;
+}
+
+int ThreadProfile::findOrAddChild(int parent, int zone) {
+	int& firstChild = (parent == -1) ? rootFirstChild : nodes[parent].firstChild;
+	for(int child = firstChild; child != -1; child = nodes[child].nextSibling) {
+		if(nodes[child].zone == zone) return child;
+	}
+
+	int node = nodeCount.load(std::memory_order_relaxed);
+	if(node == MAX_NODES) return -1;
+	nodes[node].zone = zone;
+	nodes[node].parent = parent;
+	nodes[node].nextSibling = firstChild;
+	firstChild = node;
+	// mergers read zone and parent of every node below nodeCount
+	nodeCount.store(node + 1, std::memory_order_release);
+	return node;
+}
+
+void ThreadProfile::trace(int zone, std::uint64_t start, std::uint64_t end) {
+	TraceEvent* events = traceEvents.load(std::memory_order_relaxed);
+	if(events == nullptr) {
+		events = new TraceEvent[TRACE_CAPACITY];
+		traceEvents.store(events, std::memory_order_release);
+	}
+	std::size_t head = traceHead.load(std::memory_order_relaxed);
+	if(head - traceTail.load(std::memory_order_acquire) == TRACE_CAPACITY) return;
+	events[head % TRACE_CAPACITY] = TraceEvent{zone, index, start, end};
+	traceHead.store(head + 1, std::memory_order_release);
+}
+
+int reserveProfileZones(int count, char const* const* labels) {
+	std::lock_guard<std::mutex> lg(getZoneLabelsLock());
+	std::vector<const char*>& zoneLabels = getZoneLabels();
+	int first = static_cast<int>(zoneLabels.size());
+	zoneLabels.insert(zoneLabels.end(), labels, labels + count);
+	return first;
+}
+
+const char* getProfileZoneLabel(int zone) {
+	std::lock_guard<std::mutex> lg(getZoneLabelsLock());
+	return getZoneLabels()[zone];
+}
+
+void setProfileTracing(bool enabled) {
+	ThreadProfile::tracingEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+void drainThreadTraces(std::vector<TraceEvent>& output) {
+	std::lock_guard<std::mutex> lg(profilesLock);
+	for(ThreadProfile* profile : profiles) {
+		TraceEvent* events = profile->traceEvents.load(std::memory_order_acquire);
+		if(events == nullptr) continue;
+		std::size_t tail = profile->traceTail.load(std::memory_order_relaxed);
+		std::size_t head = profile->traceHead.load(std::memory_order_acquire);
+		for(; tail != head; tail++) {
+			output.push_back(events[tail % ThreadProfile::TRACE_CAPACITY]);
+		}
+		profile->traceTail.store(head, std::memory_order_release);
+	}
+}
+
+int reserveProfileCounters(int count) {
+	int first = nextCounter.fetch_add(count);
+	if(first + count > ThreadProfile::MAX_COUNTERS) throw "Too many profile counters";
+	return first;
+}
+
+void mergeThreadCounters(int firstCounter, int counterCount, std::int64_t* output) {
+	std::lock_guard<std::mutex> lg(profilesLock);
+	for(ThreadProfile* profile : profiles) {
+		for(int i = 0; i < counterCount; i++) {
+			std::int64_t value = profile->counters[firstCounter + i].load(std::memory_order_relaxed);
+			output[i] += value - profile->mergedCounters[firstCounter + i];
+			profile->mergedCounters[firstCounter + i] = value;
+		}
+	}
+}
+
+// the node of output for threadNode, created along with its parents the first time it is needed
+static int getTreeNode(int threadNode, int firstZone, const std::vector<int>& zones, const std::vector<int>& rangeParents, std::vector<int>& treeNodes, ProfileTree& output) {
+	if(treeNodes[threadNode] == -1) {
+		int parent = rangeParents[threadNode];
+		int treeParent = (parent == -1) ? -1 : getTreeNode(parent, firstZone, zones, rangeParents, treeNodes, output);
+		treeNodes[threadNode] = output.findOrAdd(treeParent, zones[threadNode] - firstZone);
+	}
+	return treeNodes[threadNode];
+}
+
+void mergeThreadZones(int firstZone, int zoneCount, ProfileTree& output) {
+	double tickNanoseconds = profilerTickNanoseconds();
+	std::vector<int> zones;
+	// the nearest enclosing node with a zone in the range
+	std::vector<int> rangeParents;
+	std::vector<int> treeNodes;
+
+	std::lock_guard<std::mutex> lg(profilesLock);
+	for(ThreadProfile* profile : profiles) {
+		int nodeCount = profile->nodeCount.load(std::memory_order_acquire);
+		zones.resize(nodeCount);
+		rangeParents.resize(nodeCount);
+		treeNodes.assign(nodeCount, -1);
+
+		// parents always come before their children
+		for(int i = 0; i < nodeCount; i++) {
+			const ThreadProfile::Node& node = profile->nodes[i];
+			zones[i] = node.zone;
+			if(node.parent == -1) {
+				rangeParents[i] = -1;
+			} else {
+				bool parentInRange = zones[node.parent] >= firstZone && zones[node.parent] < firstZone + zoneCount;
+				rangeParents[i] = parentInRange ? node.parent : rangeParents[node.parent];
+			}
+		}
+
+		for(int i = 0; i < nodeCount; i++) {
+			if(zones[i] < firstZone || zones[i] >= firstZone + zoneCount) continue;
+
+			const ThreadProfile::Node& node = profile->nodes[i];
+			std::uint64_t ticks = node.ticks.load(std::memory_order_relaxed);
+			std::uint64_t count = node.count.load(std::memory_order_relaxed);
+			std::uint64_t addedTicks = ticks - profile->mergedTicks[i];
+			std::uint64_t addedCount = count - profile->mergedCounts[i];
+			profile->mergedTicks[i] = ticks;
+			profile->mergedCounts[i] = count;
+			if(addedCount == 0) continue;
+
+			ProfileTree::Node& treeNode = output.nodes[getTreeNode(i, firstZone, zones, rangeParents, treeNodes, output)];
+			treeNode.time += std::chrono::nanoseconds(static_cast<long long>(addedTicks * tickNanoseconds));
+			treeNode.count += static_cast<long long>(addedCount);
+		}
+	}
+}
+
+int ProfileTree::findOrAdd(int parent, int zone) {
+	for(int i = 0; i < static_cast<int>(nodes.size()); i++) {
+		if(nodes[i].parent == parent && nodes[i].zone == zone) return i;
+	}
+	nodes.push_back(Node{zone, parent, std::chrono::nanoseconds(0), 0});
+	return static_cast<int>(nodes.size()) - 1;
+}
+
+void ProfileTree::add(const ProfileTree& other) {
+	std::vector<int> mapped(other.nodes.size());
+	for(std::size_t i = 0; i < other.nodes.size(); i++) {
+		const Node& node = other.nodes[i];
+		mapped[i] = findOrAdd((node.parent == -1) ? -1 : mapped[node.parent], node.zone);
+		nodes[mapped[i]].time += node.time;
+		nodes[mapped[i]].count += node.count;
+	}
+}
+
+std::chrono::nanoseconds ProfileTree::getSelfTime(int node) const {
+	std::chrono::nanoseconds selfTime = nodes[node].time;
+	for(const Node& child : nodes) {
+		if(child.parent == node) selfTime -= child.time;
+	}
+	return selfTime;
+}
+
+std::size_t ProfileTree::getDepth(int node) const {
+	std::size_t depth = 0;
+	for(int parent = nodes[node].parent; parent != -1; parent = nodes[parent].parent) {
+		depth++;
+	}
+	return depth;
+}
@@ -0,0 +1,318 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "profiling.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define PROFILER_USES_TSC
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PROFILER_USES_TSC
+#endif
+
+/*
+	The clock of profile zones, the time stamp counter where there is one as it is read in a few nanoseconds
+	Converted to nanoseconds with profilerTickNanoseconds only when the zones are merged
+*/
+inline std::uint64_t profilerTicks() {
+#ifdef PROFILER_USES_TSC
+	return __rdtsc();
+#else
+	return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+double profilerTickNanoseconds();
+
+class ProfileTree;
+
+// a zone as it appears on a timeline, thread is the index of the ThreadProfile it was recorded in
+struct TraceEvent {
+	int zone;
+	int thread;
+	std::uint64_t start;
+	std::uint64_t end;
+};
+
+/*
+	The zones and counters recorded by one thread, only that thread writes to them so recording takes no lock
+	and no atomic read-modify-write. Mergers read the running totals while the thread records and keep the totals
+	they saw last, the difference is what was recorded since the previous merge.
+	A ThreadProfile outlives its thread and is handed to the next thread that starts profiling.
+
+	While tracing is enabled every zone is also pushed into a ring of TraceEvents, which a single reader drains with
+	drainThreadTraces. Zones that end while the ring is full are not traced.
+*/
+class ThreadProfile {
+public:
+	static constexpr int MAX_NODES = 512;
+	static constexpr int MAX_COUNTERS = 256;
+	static constexpr std::size_t TRACE_CAPACITY = 16384;
+
+	static std::atomic<bool> tracingEnabled;
+
+private:
+	struct Node {
+		std::atomic<std::uint64_t> ticks{0};
+		std::atomic<std::uint64_t> count{0};
+		int zone = 0;
+		int parent = -1;
+		// only used by the owning thread
+		int firstChild = -1;
+		int nextSibling = -1;
+		// the child entered last, which is usually the one entered next
+		int lastChild = -1;
+	};
+
+	Node nodes[MAX_NODES];
+	std::atomic<int> nodeCount{0};
+	int rootFirstChild = -1;
+	int rootLastChild = -1;
+	int currentNode = -1;
+	std::atomic<std::int64_t> counters[MAX_COUNTERS];
+
+	// the totals every merger saw last
+	std::uint64_t mergedTicks[MAX_NODES]{};
+	std::uint64_t mergedCounts[MAX_NODES]{};
+	std::int64_t mergedCounters[MAX_COUNTERS]{};
+
+	// allocated when the thread first traces
+	std::atomic<TraceEvent*> traceEvents{nullptr};
+	std::atomic<std::size_t> traceHead{0};
+	std::atomic<std::size_t> traceTail{0};
+
+	std::atomic<bool> owned{false};
+	int index;
+
+	static thread_local ThreadProfile* current;
+	static ThreadProfile& claim();
+
+	int findOrAddChild(int parent, int zone);
+	void trace(int zone, std::uint64_t start, std::uint64_t end);
+
+	friend class ThreadProfileOwner;
+	friend void mergeThreadCounters(int firstCounter, int counterCount, std::int64_t* output);
+	friend void mergeThreadZones(int firstZone, int zoneCount, ProfileTree& output);
+	friend void drainThreadTraces(std::vector<TraceEvent>& output);
+
+public:
+	explicit ThreadProfile(int index);
+
+	int getIndex() const { return index; }
+
+	static ThreadProfile& local() {
+		ThreadProfile* profile = current;
+		return profile != nullptr ? *profile : claim();
+	}
+
+	// returns the node that was entered, -1 if there was no room for it in which case nothing is recorded
+	int enter(int zone) {
+		int& lastChild = (currentNode == -1) ? rootLastChild : nodes[currentNode].lastChild;
+		if(lastChild != -1 && nodes[lastChild].zone == zone) {
+			currentNode = lastChild;
+			return lastChild;
+		}
+		int node = findOrAddChild(currentNode, zone);
+		if(node != -1) {
+			lastChild = node;
+			currentNode = node;
+		}
+		return node;
+	}
+	void exit(int node, std::uint64_t start, std::uint64_t end) {
+		if(node == -1) return;
+		Node& n = nodes[node];
+		if(tracingEnabled.load(std::memory_order_relaxed)) trace(n.zone, start, end);
+		n.ticks.store(n.ticks.load(std::memory_order_relaxed) + (end - start), std::memory_order_relaxed);
+		n.count.store(n.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		currentNode = n.parent;
+	}
+	// moves the entered node to another zone with the same parent
+	int rename(int node, int zone) {
+		if(node == -1) return -1;
+		int renamed = findOrAddChild(nodes[node].parent, zone);
+		if(renamed != -1) currentNode = renamed;
+		return renamed;
+	}
+	void add(int counter, std::int64_t amount) {
+		std::atomic<std::int64_t>& c = counters[counter];
+		c.store(c.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+	}
+};
+
+/*
+	Merged zones, every node is the total of a zone entered with the same chain of enclosing zones, over all threads
+	Zones entered outside of any other zone are roots, the roots of different threads are merged as well
+	The zones of the nodes count from the first zone of the merged range, parents come before their children
+*/
+class ProfileTree {
+public:
+	struct Node {
+		int zone;
+		int parent;
+		// including the children
+		std::chrono::nanoseconds time;
+		long long count;
+	};
+
+	std::vector<Node> nodes;
+
+	int findOrAdd(int parent, int zone);
+	// adds the nodes of other to the nodes with the same chain of zones
+	void add(const ProfileTree& other);
+	std::chrono::nanoseconds getSelfTime(int node) const;
+	std::size_t getDepth(int node) const;
+	void clear() { nodes.clear(); }
+};
+
+// reserves count consecutive ids, returns the first
+int reserveProfileZones(int count, char const* const* labels);
+int reserveProfileCounters(int count);
+const char* getProfileZoneLabel(int zone);
+
+// adds the counters recorded by every thread since the last merge of these counters
+void mergeThreadCounters(int firstCounter, int counterCount, std::int64_t* output);
+// adds the zones recorded by every thread since the last merge of these zones, zones outside of the range are skipped
+void mergeThreadZones(int firstZone, int zoneCount, ProfileTree& output);
+// appends the zones traced by every thread since the last call, per thread in the order they ended
+void drainThreadTraces(std::vector<TraceEvent>& output);
+// while disabled zones are not traced, disabled by default
+void setProfileTracing(bool enabled);
+
+/*
+	Times the enclosing block as a zone on the calling thread, zone NONE records nothing
+	Zones entered while this one is open become its children
+*/
+class ProfileZone {
+	ThreadProfile* profile;
+	int node;
+	std::uint64_t start;
+
+public:
+	static constexpr int NONE = -1;
+
+	explicit ProfileZone(int zone) {
+		if(zone == NONE) {
+			profile = nullptr;
+			return;
+		}
+		profile = &ThreadProfile::local();
+		node = profile->enter(zone);
+		start = profilerTicks();
+	}
+	~ProfileZone() {
+		if(profile != nullptr) profile->exit(node, start, profilerTicks());
+	}
+	ProfileZone(const ProfileZone&) = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+
+	// the whole time of this zone goes to zone instead, zones already entered inside it stay under the original zone
+	void setZone(int zone) {
+		if(profile != nullptr && zone != NONE) node = profile->rename(node, zone);
+	}
+};
+
+template<typename TimePoint>
+double getAverageTicksPerSecond(const CircularBuffer<TimePoint>& tickHistory) {
+	size_t numTicks = tickHistory.size();
+	if(numTicks != 0) {
+		std::chrono::nanoseconds delta = tickHistory.front() - tickHistory.tail();
+		double timeTaken = delta.count() * 1E-9;
+		return (numTicks - 1) / timeTaken;
+	}
+	return 0.0;
+}
+
+/*
+	Profiles nested zones on any number of threads, the zones are the values of ProcessType
+	history holds the self time of every zone per tick, summed over all threads, so it can exceed the length of the tick
+	when zones run in parallel. The zones of its trees are ProcessType values.
+*/
+template<typename ProcessType>
+class ZoneProfiler : public HistoricTally<std::chrono::nanoseconds, ProcessType> {
+	int firstZone;
+
+	// the trees are read by other threads than the one ending the ticks
+	mutable std::mutex treeLock;
+	ProfileTree lastTick;
+	ProfileTree total;
+	std::size_t totalTickCount = 0;
+
+public:
+	CircularBuffer<std::chrono::high_resolution_clock::time_point> tickHistory;
+
+	ZoneProfiler(char const* const labels[static_cast<size_t>(ProcessType::COUNT)], size_t capacity) : HistoricTally<std::chrono::nanoseconds, ProcessType>(labels, capacity), firstZone(reserveProfileZones(static_cast<int>(ProcessType::COUNT), labels)), tickHistory(capacity) {}
+
+	int getZoneID(ProcessType process) const {
+		return firstZone + static_cast<int>(process);
+	}
+
+	// merges the zones that ended since the last call into a new tick, zones that are still open count for the tick they end in
+	void endTick() {
+		ProfileTree tick;
+		mergeThreadZones(firstZone, static_cast<int>(ProcessType::COUNT), tick);
+		for(int node = 0; node < static_cast<int>(tick.nodes.size()); node++) {
+			this->addToTally(static_cast<ProcessType>(tick.nodes[node].zone), tick.getSelfTime(node));
+		}
+		tickHistory.add(std::chrono::high_resolution_clock::now());
+		this->nextTally();
+
+		std::lock_guard<std::mutex> lg(treeLock);
+		total.add(tick);
+		totalTickCount++;
+		lastTick = std::move(tick);
+	}
+
+	ProfileTree getLastTick() const {
+		std::lock_guard<std::mutex> lg(treeLock);
+		return lastTick;
+	}
+	// the sum of the trees of the ticks since the last reset
+	ProfileTree getTotal() const {
+		std::lock_guard<std::mutex> lg(treeLock);
+		return total;
+	}
+	std::size_t getTotalTickCount() const {
+		std::lock_guard<std::mutex> lg(treeLock);
+		return totalTickCount;
+	}
+	void resetTotal() {
+		std::lock_guard<std::mutex> lg(treeLock);
+		total.clear();
+		totalTickCount = 0;
+	}
+
+	double getAvgTPS() {
+		return getAverageTicksPerSecond(tickHistory);
+	}
+};
+
+/*
+	A HistoricTally that any number of threads add to, every thread adds to counters of its own
+	nextTally merges what was added since the previous call
+*/
+template<typename Unit, typename Category>
+class ThreadTally final : public HistoricTally<Unit, Category> {
+	int firstCounter = reserveProfileCounters(static_cast<int>(Category::COUNT));
+
+public:
+	ThreadTally(char const* const labels[static_cast<size_t>(Category::COUNT)], size_t size) : HistoricTally<Unit, Category>(labels, size) {}
+
+	void addToTally(Category category, Unit amount) override {
+		ThreadProfile::local().add(firstCounter + static_cast<int>(category), static_cast<std::int64_t>(amount));
+	}
+
+	void nextTally() override {
+		std::int64_t added[static_cast<size_t>(Category::COUNT)]{};
+		mergeThreadCounters(firstCounter, static_cast<int>(Category::COUNT), added);
+		for(size_t i = 0; i < static_cast<size_t>(Category::COUNT); i++) {
+			HistoricTally<Unit, Category>::addToTally(static_cast<Category>(i), static_cast<Unit>(added[i]));
+		}
+		HistoricTally<Unit, Category>::nextTally();
+	}
+};
@@ -0,0 +1,144 @@
+#include "tickTrace.h"
+
+#include <fstream>
+#include <iomanip>
+
+#include "../../util/log.h"
+
+TickTraceRecorder::TickTraceRecorder(double capturedSeconds) : capturedSeconds(capturedSeconds) {}
+
+TickTraceRecorder::~TickTraceRecorder() {
+	if(recording.load()) stop();
+}
+
+void TickTraceRecorder::start() {
+	// zones traced while nobody was recording would end up in the first tick
+	std::vector<TraceEvent> stale;
+	drainThreadTraces(stale);
+	{
+		std::lock_guard<std::mutex> lg(ticksLock);
+		ticks.clear();
+	}
+	setProfileTracing(true);
+	recording.store(true);
+}
+
+void TickTraceRecorder::stop() {
+	recording.store(false);
+	setProfileTracing(false);
+}
+
+void TickTraceRecorder::beginTick() {
+	tickStart = profilerTicks();
+}
+
+void TickTraceRecorder::endTick() {
+	std::uint64_t tickEnd = profilerTicks();
+	if(!recording.load()) return;
+
+	double tickNanoseconds = profilerTickNanoseconds();
+	std::uint64_t capturedTicks = static_cast<std::uint64_t>(capturedSeconds * 1E9 / tickNanoseconds);
+
+	TickRecord record{tickIndex++, ThreadProfile::local().getIndex(), tickStart, tickEnd, std::move(spareEvents)};
+	record.events.clear();
+	drainThreadTraces(record.events);
+
+	bool spike = spikeThresholdMillis > 0.0 && (tickEnd - tickStart) * tickNanoseconds > spikeThresholdMillis * 1E6 && tickEnd >= nextSpikeAllowed;
+	double tickMillis = (tickEnd - tickStart) * tickNanoseconds / 1E6;
+	std::size_t spikeTick = record.index;
+
+	{
+		std::lock_guard<std::mutex> lg(ticksLock);
+		ticks.push_back(std::move(record));
+		while(tickEnd - ticks.front().end > capturedTicks) {
+			// the storage of the dropped tick is reused for the next one
+			spareEvents = std::move(ticks.front().events);
+			ticks.pop_front();
+		}
+	}
+
+	if(spike) {
+		std::string path = spikePathPrefix + std::to_string(spikeCount++) + ".json";
+		if(write(path)) {
+			Log::warn("Tick %d took %.3f ms, wrote the trace of the last ticks to %s", static_cast<int>(spikeTick), tickMillis, path.c_str());
+		} else {
+			Log::error("Could not write the trace of tick %d to %s", static_cast<int>(spikeTick), path.c_str());
+		}
+		// counted from after the write, which can take longer than the captured time
+		nextSpikeAllowed = profilerTicks() + capturedTicks;
+	}
+}
+
+void TickTraceRecorder::setSpikeTrigger(double thresholdMillis, const std::string& pathPrefix) {
+	spikeThresholdMillis = thresholdMillis;
+	spikePathPrefix = pathPrefix;
+}
+
+static void writeJSONString(std::ostream& output, const char* text) {
+	output << '"';
+	for(const char* c = text; *c != '\0'; c++) {
+		if(*c == '"' || *c == '\\') output << '\\';
+		output << *c;
+	}
+	output << '"';
+}
+
+// a complete event, times are in microseconds
+static void writeCompleteEvent(std::ostream& output, const char* name, const char* category, int thread, double start, double duration) {
+	output << ",\n{\"name\":";
+	writeJSONString(output, name);
+	output << ",\"cat\":\"" << category << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread << ",\"ts\":" << start << ",\"dur\":" << duration << '}';
+}
+
+void TickTraceRecorder::write(std::ostream& output) const {
+	std::lock_guard<std::mutex> lg(ticksLock);
+
+	std::ios_base::fmtflags oldFlags = output.flags();
+	std::streamsize oldPrecision = output.precision();
+	output << std::fixed << std::setprecision(3);
+
+	// zones of other threads may have started before the first tick
+	std::uint64_t origin = ticks.empty() ? 0 : ticks.front().start;
+	std::vector<bool> seenThreads;
+	for(const TickRecord& tick : ticks) {
+		for(const TraceEvent& event : tick.events) {
+			if(event.start < origin) origin = event.start;
+			if(event.thread >= static_cast<int>(seenThreads.size())) seenThreads.resize(event.thread + 1, false);
+			seenThreads[event.thread] = true;
+		}
+	}
+	int tickThread = ticks.empty() ? -1 : ticks.back().thread;
+	if(tickThread >= static_cast<int>(seenThreads.size())) seenThreads.resize(tickThread + 1, false);
+
+	double tickMicroseconds = profilerTickNanoseconds() / 1E3;
+	output << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	output << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Physics\"}}";
+	for(int thread = 0; thread < static_cast<int>(seenThreads.size()); thread++) {
+		if(!seenThreads[thread] && thread != tickThread) continue;
+		output << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread << ",\"args\":{\"name\":\"";
+		if(thread == tickThread) {
+			output << "Ticking thread\"}}";
+		} else {
+			output << "Thread " << thread << "\"}}";
+		}
+	}
+
+	for(const TickRecord& tick : ticks) {
+		std::string tickName = "Tick " + std::to_string(tick.index);
+		writeCompleteEvent(output, tickName.c_str(), "tick", tick.thread, (tick.start - origin) * tickMicroseconds, (tick.end - tick.start) * tickMicroseconds);
+		for(const TraceEvent& event : tick.events) {
+			writeCompleteEvent(output, getProfileZoneLabel(event.zone), "zone", event.thread, (event.start - origin) * tickMicroseconds, (event.end - event.start) * tickMicroseconds);
+		}
+	}
+	output << "\n]}\n";
+
+	output.flags(oldFlags);
+	output.precision(oldPrecision);
+}
+
+bool TickTraceRecorder::write(const std::string& path) const {
+	std::ofstream file(path);
+	if(!file.is_open()) return false;
+	write(file);
+	return true;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "threadProfiling.h"
+
+/*
+	Keeps the zones of all threads over the last capturedSeconds of ticks, and writes them in the Chrome trace event format,
+	which chrome://tracing and ui.perfetto.dev open. Every thread that ran a zone gets a row, every tick is an event on the row
+	of the thread that ran it.
+
+	beginTick and endTick are called by whoever ticks the world, around every tick. Only one recorder may record at a time,
+	as recording drains the traced zones of every thread.
+
+	With a spike trigger, a tick that takes longer than the threshold writes the captured ticks up to and including it to
+	the next file of the trigger, at most once per capturedSeconds. The file is written on the ticking thread.
+*/
+class TickTraceRecorder {
+	struct TickRecord {
+		std::size_t index;
+		int thread;
+		std::uint64_t start;
+		std::uint64_t end;
+		// the zones that ended during the tick
+		std::vector<TraceEvent> events;
+	};
+
+	double capturedSeconds;
+	std::atomic<bool> recording{false};
+
+	std::uint64_t tickStart = 0;
+	std::size_t tickIndex = 0;
+	std::vector<TraceEvent> spareEvents;
+
+	double spikeThresholdMillis = 0.0;
+	std::string spikePathPrefix;
+	std::size_t spikeCount = 0;
+	std::uint64_t nextSpikeAllowed = 0;
+
+	// ticks are added by the ticking thread and written by any thread
+	mutable std::mutex ticksLock;
+	std::deque<TickRecord> ticks;
+
+public:
+	explicit TickTraceRecorder(double capturedSeconds);
+	~TickTraceRecorder();
+
+	TickTraceRecorder(const TickTraceRecorder&) = delete;
+	TickTraceRecorder& operator=(const TickTraceRecorder&) = delete;
+
+	// enables the tracing of zones, and drops what was recorded before
+	void start();
+	void stop();
+	bool isRecording() const { return recording.load(); }
+
+	void beginTick();
+	void endTick();
+
+	// writes pathPrefix followed by the number of the spike and .json, a threshold of 0 disables the trigger
+	void setSpikeTrigger(double thresholdMillis, const std::string& pathPrefix);
+	std::size_t getSpikeCount() const { return spikeCount; }
+
+	void write(std::ostream& output) const;
+	// returns false if the file could not be opened
+	bool write(const std::string& path) const;
+};
@@ -0,0 +1,152 @@
+#include "worldClone.h"
+
+#include "../layer.h"
+#include "../physical.h"
+#include "../constraints/constraintGroup.h"
+#include "../softlinks/softLink.h"
+
+// plain parts carry nothing beyond the prototype, the original is only needed by WorldCloner for the data of its part type
+Part* WorldClonerPrototype::clonePartExternalData(const Part&, Part&& partPrototype) {
+	return new Part(std::move(partPrototype));
+}
+
+Part* WorldClonerPrototype::clonePart(const Part& original, WorldLayer* targetLayer) {
+	Part prototype;
+	prototype.cframe = original.cframe;
+	prototype.hitbox = original.hitbox;
+	prototype.maxRadius = original.maxRadius;
+	prototype.properties = original.properties;
+
+	Part* clone = clonePartExternalData(original, std::move(prototype));
+	clone->layer = targetLayer;
+	partMap.emplace(&original, clone);
+	return clone;
+}
+
+// copies the structure of the tree, the parts in it are cloned in tree order
+TreeNode WorldClonerPrototype::cloneTreeNode(const TreeNode& original, WorldLayer* targetLayer) {
+	if(original.isLeafNode()) {
+		Part* clone = clonePart(*static_cast<const Part*>(original.object), targetLayer);
+		TreeNode result(clone, original.bounds, original.isGroupHead);
+		result.proxyIndex = original.proxyIndex;
+		return result;
+	}
+
+	TreeNode* subTrees = new TreeNode[MAX_BRANCHES];
+	for(int i = 0; i < original.nodeCount; i++) {
+		subTrees[i] = cloneTreeNode(original.subTrees[i], targetLayer);
+	}
+	TreeNode result(original.bounds, subTrees, original.nodeCount);
+	result.isGroupHead = original.isGroupHead;
+	return result;
+}
+
+void WorldClonerPrototype::cloneLayers(const WorldPrototype& original, WorldPrototype& target) {
+	target.layers.clear();
+	// reserved so the WorldLayers don't move while parts are pointed at them
+	target.layers.reserve(original.layers.size());
+	for(const ColissionLayer& originalLayer : original.layers) {
+		target.layers.emplace_back(&target, originalLayer.collidesInternally);
+		ColissionLayer& targetLayer = target.layers.back();
+
+		for(int i = 0; i < ColissionLayer::NUMBER_OF_SUBLAYERS; i++) {
+			const WorldLayer& originalSubLayer = originalLayer.subLayers[i];
+			WorldLayer& targetSubLayer = targetLayer.subLayers[i];
+
+			if(!originalSubLayer.tree.isEmpty()) {
+				targetSubLayer.tree.rootNode = cloneTreeNode(originalSubLayer.tree.rootNode, &targetSubLayer);
+			}
+			// the cloned leaves have the same proxyIndex as their originals, so the proxies stay valid
+			targetSubLayer.colissionProxies = originalSubLayer.colissionProxies;
+			targetSubLayer.colissionProxiesOutdated = originalSubLayer.colissionProxiesOutdated;
+		}
+	}
+}
+
+RigidBody WorldClonerPrototype::cloneRigidBody(const RigidBody& original) const {
+	RigidBody result;
+	result.mainPart = partMap.at(original.mainPart);
+	result.parts.reserve(original.parts.size());
+	for(const AttachedPart& attachedPart : original.parts) {
+		result.parts.push_back(AttachedPart{attachedPart.attachment, partMap.at(attachedPart.part)});
+	}
+	result.mass = original.mass;
+	result.localCenterOfMass = original.localCenterOfMass;
+	result.inertia = original.inertia;
+	return result;
+}
+
+void WorldClonerPrototype::cloneChildPhysicals(const Physical& original, Physical& target) {
+	// reserved so children that were already cloned don't move, physicalMap points to them
+	target.childPhysicals.reserve(original.childPhysicals.size());
+	for(const ConnectedPhysical& originalChild : original.childPhysicals) {
+		const HardPhysicalConnection& originalConnection = originalChild.connectionToParent;
+		HardPhysicalConnection connection(std::unique_ptr<HardConstraint>(originalConnection.constraintWithParent->clone()), originalConnection.attachOnChild, originalConnection.attachOnParent);
+
+		target.childPhysicals.push_back(ConnectedPhysical(cloneRigidBody(originalChild.rigidBody), &target, std::move(connection)));
+		ConnectedPhysical& clone = target.childPhysicals.back();
+		physicalMap.emplace(&originalChild, &clone);
+
+		cloneChildPhysicals(originalChild, clone);
+	}
+}
+
+MotorizedPhysical* WorldClonerPrototype::cloneMotorizedPhysical(const MotorizedPhysical& original) {
+	MotorizedPhysical* clone = new MotorizedPhysical(cloneRigidBody(original.rigidBody), original);
+	physicalMap.emplace(&original, clone);
+	cloneChildPhysicals(original, *clone);
+	return clone;
+}
+
+void WorldClonerPrototype::cloneWorld(const WorldPrototype& original, WorldPrototype& target) {
+	if(target.getPartCount() != 0) throw "Can only clone into an empty world!";
+
+	partMap.clear();
+	physicalMap.clear();
+	partMap.reserve(original.getPartCount());
+	physicalMap.reserve(original.physicals.size());
+
+	target.deltaT = original.deltaT;
+	target.age = original.age;
+	target.objectCount = original.objectCount;
+	target.colissionMask = original.colissionMask;
+
+	cloneLayers(original, target);
+
+	target.physicals.reserve(target.physicals.size() + original.physicals.size());
+	for(const MotorizedPhysical* phys : original.physicals) {
+		MotorizedPhysical* clone = cloneMotorizedPhysical(*phys);
+		clone->world = &target;
+		target.physicals.push_back(clone);
+	}
+
+	target.constraints.reserve(target.constraints.size() + original.constraints.size());
+	for(const ConstraintGroup& group : original.constraints) {
+		ConstraintGroup clone;
+		clone.constraints.reserve(group.constraints.size());
+		for(const PhysicalConstraint& constraint : group.constraints) {
+			clone.constraints.emplace_back(physicalMap.at(constraint.physA), physicalMap.at(constraint.physB), constraint.constraint->clone());
+		}
+		target.constraints.push_back(std::move(clone));
+	}
+
+	for(const SoftLink* link : original.springLinks) {
+		target.springLinks.push_back(link->clone(partMap.at(link->getPartOfAttach1()), partMap.at(link->getPartOfAttach2())));
+	}
+
+	for(const ExternalForce* force : original.externalForces) {
+		target.externalForces.push_back(force->clone());
+	}
+
+	for(Part& part : target.iterParts()) {
+		target.onPartAdded(&part);
+	}
+}
+
+Part* WorldClonerPrototype::getClone(const Part* original) const {
+	return partMap.at(original);
+}
+
+Physical* WorldClonerPrototype::getClone(const Physical* original) const {
+	return physicalMap.at(original);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "../world.h"
+
+/*
+	Deep copies a world into another, empty, world, to branch a simulation from a common state
+
+	Everything that the world owns is duplicated: parts, physicals with their hard constraints, constraint groups, soft links,
+	external forces and layers. The bounds trees and colission proxies of the layers are copied as they are and the part pointers
+	in them are relocated to the clones, so the clone does not rebuild its trees or recompute the physical properties of its physicals.
+	ShapeClasses are shared between the original and the clone.
+
+	The cloned world steps exactly the same as the original.
+	A cloner can be used for a single cloneWorld, afterwards getClone maps the objects of the original to their clones.
+*/
+class WorldClonerPrototype {
+	std::unordered_map<const Part*, Part*> partMap;
+	std::unordered_map<const Physical*, Physical*> physicalMap;
+
+	Part* clonePart(const Part& original, WorldLayer* targetLayer);
+	TreeNode cloneTreeNode(const TreeNode& original, WorldLayer* targetLayer);
+	void cloneLayers(const WorldPrototype& original, WorldPrototype& target);
+	RigidBody cloneRigidBody(const RigidBody& original) const;
+	void cloneChildPhysicals(const Physical& original, Physical& target);
+	MotorizedPhysical* cloneMotorizedPhysical(const MotorizedPhysical& original);
+
+protected:
+	// creates the clone of original from partPrototype, which already has the shape, cframe and properties of original
+	virtual Part* clonePartExternalData(const Part& original, Part&& partPrototype);
+
+public:
+	// target must not contain any parts
+	void cloneWorld(const WorldPrototype& original, WorldPrototype& target);
+
+	Part* getClone(const Part* original) const;
+	Physical* getClone(const Physical* original) const;
+};
+
+template<typename ExtendedPartType>
+class WorldCloner : private WorldClonerPrototype {
+protected:
+	virtual ExtendedPartType* cloneExtendedPart(const ExtendedPartType& original, Part&& partPrototype) = 0;
+
+private:
+	virtual Part* clonePartExternalData(const Part& original, Part&& partPrototype) final override {
+		return cloneExtendedPart(static_cast<const ExtendedPartType&>(original), std::move(partPrototype));
+	}
+
+public:
+	void cloneWorld(const World<ExtendedPartType>& original, World<ExtendedPartType>& target) {
+		WorldClonerPrototype::cloneWorld(original, target);
+	}
+
+	ExtendedPartType* getClone(const ExtendedPartType* original) const {
+		return static_cast<ExtendedPartType*>(WorldClonerPrototype::getClone(original));
+	}
+	using WorldClonerPrototype::getClone;
+};
@@ -0,0 +1,393 @@
+#include "worldQuery.h"
+
+#include <algorithm>
+#include <queue>
+#include <vector>
+
+#include "../world.h"
+#include "../part.h"
+#include "../layer.h"
+#include "../geometry/intersection.h"
+#include "../threading/jobSystem.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+#define RAY_PACKET_SIZE 4
+// rays in a packet must start at most this far from the first ray of the packet
+#define PACKET_START_SPREAD 8.0
+// rays per job of raycastBatch
+#define RAYCAST_GRAIN_SIZE 256
+// a node is popped before its at most MAX_BRANCHES children are pushed, so this is enough for a tree of MAX_HEIGHT levels
+#define TRAVERSAL_STACK_SIZE (MAX_BRANCHES * MAX_HEIGHT)
+
+template<typename Func>
+static void forEachSelectedTree(const WorldPrototype& world, LayerMask mask, const Func& func) {
+	for(std::size_t layerIndex = 0; layerIndex < world.layers.size(); layerIndex++) {
+		for(int subLayer = 0; subLayer < ColissionLayer::NUMBER_OF_SUBLAYERS; subLayer++) {
+			int worldLayerID = static_cast<int>(layerIndex) * ColissionLayer::NUMBER_OF_SUBLAYERS + subLayer;
+			if(mask & worldLayerMask(worldLayerID)) {
+				func(world.layers[layerIndex].subLayers[subLayer].tree.rootNode);
+			}
+		}
+	}
+}
+
+#pragma region raycast
+
+// zero is replaced by a tiny value, so the slab tests never compute 0 * infinity
+static double safeInverse(double value) {
+	return 1.0 / (value == 0.0 ? 1e-300 : value);
+}
+
+static Vec3 safeInverse(const Vec3& direction) {
+	return Vec3(safeInverse(direction.x), safeInverse(direction.y), safeInverse(direction.z));
+}
+
+// the distance at which the ray enters bounds, or INFINITY if it misses bounds before maxDistance
+static double rayEntryDistance(const Bounds& bounds, const Position& start, const Vec3& inverseDirection, double maxDistance) {
+	Vec3 toMin = bounds.min - start;
+	Vec3 toMax = bounds.max - start;
+	double near = 0.0;
+	double far = maxDistance;
+	for(int axis = 0; axis < 3; axis++) {
+		double t1 = toMin[axis] * inverseDirection[axis];
+		double t2 = toMax[axis] * inverseDirection[axis];
+		near = std::max(near, std::min(t1, t2));
+		far = std::min(far, std::max(t1, t2));
+	}
+	return near <= far ? near : INFINITY;
+}
+
+// hits at or behind the start of the ray are ignored, like the picker does
+static double partIntersectionDistance(const Part& part, const Ray& ray) {
+	const GlobalCFrame& cframe = part.getCFrame();
+	double distance = part.hitbox.getIntersectionDistance(cframe.globalToLocal(ray.start), cframe.relativeToLocal(ray.direction));
+	return distance > 0.0 ? distance : INFINITY;
+}
+
+struct RayStackEntry {
+	const TreeNode* node;
+	double entry;
+};
+
+static void raycastTree(const TreeNode& root, const Ray& ray, const Vec3& inverseDirection, RaycastHit& best) {
+	RayStackEntry stack[TRAVERSAL_STACK_SIZE];
+	int stackSize = 0;
+	stack[stackSize++] = RayStackEntry{&root, 0.0};
+	while(stackSize > 0) {
+		RayStackEntry current = stack[--stackSize];
+		if(current.entry >= best.distance) continue;
+
+		const TreeNode& node = *current.node;
+		if(node.isLeafNode()) {
+			Part* part = static_cast<Part*>(node.object);
+			double distance = partIntersectionDistance(*part, ray);
+			if(distance < best.distance) {
+				best.part = part;
+				best.distance = distance;
+			}
+			continue;
+		}
+
+		// children are pushed furthest first, so the closest one is visited first and its hit can prune the others
+		int firstChild = stackSize;
+		for(const TreeNode& child : node) {
+			double entry = rayEntryDistance(child.bounds, ray.start, inverseDirection, best.distance);
+			if(entry == INFINITY) continue;
+			int i = stackSize++;
+			while(i > firstChild && stack[i - 1].entry < entry) {
+				stack[i] = stack[i - 1];
+				i--;
+			}
+			stack[i] = RayStackEntry{&child, entry};
+		}
+	}
+}
+
+/*
+	Up to RAY_PACKET_SIZE rays that traverse the trees together, one lane per ray
+	The starts are relative to the start of the first ray, so each node's bounds are converted from Fix once per packet instead of once per ray
+	Unused lanes have best = -1, which no node is closer than
+*/
+struct RayPacket {
+	Position reference;
+	alignas(32) double origin[3][RAY_PACKET_SIZE];
+	alignas(32) double inverseDirection[3][RAY_PACKET_SIZE];
+	alignas(32) double best[RAY_PACKET_SIZE];
+};
+
+struct PacketStackEntry {
+	alignas(32) double entries[RAY_PACKET_SIZE];
+	const TreeNode* node;
+	double closest;
+};
+
+// writes the entry distance of every lane into entries, INFINITY for lanes that miss, returns the mask of the lanes that hit
+static int packetEntryDistances(const RayPacket& packet, const Bounds& bounds, double* entries) {
+	Vec3 toMin = bounds.min - packet.reference;
+	Vec3 toMax = bounds.max - packet.reference;
+#if defined(__AVX__)
+	__m256d near = _mm256_setzero_pd();
+	__m256d far = _mm256_load_pd(packet.best);
+	for(int axis = 0; axis < 3; axis++) {
+		__m256d origin = _mm256_load_pd(packet.origin[axis]);
+		__m256d inverse = _mm256_load_pd(packet.inverseDirection[axis]);
+		__m256d t1 = _mm256_mul_pd(_mm256_sub_pd(_mm256_set1_pd(toMin[axis]), origin), inverse);
+		__m256d t2 = _mm256_mul_pd(_mm256_sub_pd(_mm256_set1_pd(toMax[axis]), origin), inverse);
+		near = _mm256_max_pd(near, _mm256_min_pd(t1, t2));
+		far = _mm256_min_pd(far, _mm256_max_pd(t1, t2));
+	}
+	__m256d hit = _mm256_cmp_pd(near, far, _CMP_LE_OQ);
+	_mm256_store_pd(entries, _mm256_blendv_pd(_mm256_set1_pd(INFINITY), near, hit));
+	return _mm256_movemask_pd(hit);
+#else
+	int hitMask = 0;
+	for(int lane = 0; lane < RAY_PACKET_SIZE; lane++) {
+		double near = 0.0;
+		double far = packet.best[lane];
+		for(int axis = 0; axis < 3; axis++) {
+			double t1 = (toMin[axis] - packet.origin[axis][lane]) * packet.inverseDirection[axis][lane];
+			double t2 = (toMax[axis] - packet.origin[axis][lane]) * packet.inverseDirection[axis][lane];
+			near = std::max(near, std::min(t1, t2));
+			far = std::min(far, std::max(t1, t2));
+		}
+		if(near <= far) {
+			entries[lane] = near;
+			hitMask |= 1 << lane;
+		} else {
+			entries[lane] = INFINITY;
+		}
+	}
+	return hitMask;
+#endif
+}
+
+static void raycastTreePacket(const TreeNode& root, RayPacket& packet, const Ray* rays, RaycastHit* hits) {
+	PacketStackEntry stack[TRAVERSAL_STACK_SIZE];
+	int stackSize = 0;
+	PacketStackEntry& first = stack[stackSize++];
+	std::fill(first.entries, first.entries + RAY_PACKET_SIZE, 0.0);
+	first.node = &root;
+	first.closest = 0.0;
+	while(stackSize > 0) {
+		const PacketStackEntry& current = stack[--stackSize];
+		const TreeNode& node = *current.node;
+		// a lane may have found a closer hit since the node was pushed
+		int laneMask = 0;
+		for(int lane = 0; lane < RAY_PACKET_SIZE; lane++) {
+			if(current.entries[lane] < packet.best[lane]) laneMask |= 1 << lane;
+		}
+		if(laneMask == 0) continue;
+
+		if(node.isLeafNode()) {
+			Part* part = static_cast<Part*>(node.object);
+			for(int lane = 0; lane < RAY_PACKET_SIZE; lane++) {
+				if(!(laneMask & (1 << lane))) continue;
+				double distance = partIntersectionDistance(*part, rays[lane]);
+				if(distance < packet.best[lane]) {
+					packet.best[lane] = distance;
+					hits[lane].part = part;
+					hits[lane].distance = distance;
+				}
+			}
+			continue;
+		}
+
+		// the same closest first order as a single ray, by the closest entry of any lane
+		int firstChild = stackSize;
+		for(const TreeNode& child : node) {
+			alignas(32) double entries[RAY_PACKET_SIZE];
+			if(packetEntryDistances(packet, child.bounds, entries) == 0) continue;
+			double closest = *std::min_element(entries, entries + RAY_PACKET_SIZE);
+			int i = stackSize++;
+			while(i > firstChild && stack[i - 1].closest < closest) {
+				stack[i] = stack[i - 1];
+				i--;
+			}
+			std::copy(entries, entries + RAY_PACKET_SIZE, stack[i].entries);
+			stack[i].node = &child;
+			stack[i].closest = closest;
+		}
+	}
+}
+
+static bool isSameOctant(const Vec3& a, const Vec3& b) {
+	return (a.x < 0.0) == (b.x < 0.0) && (a.y < 0.0) == (b.y < 0.0) && (a.z < 0.0) == (b.z < 0.0);
+}
+
+// the number of leading rays, at least 1, that start near the first ray and go in the same octant, these visit mostly the same nodes
+static std::size_t coherentRayCount(const Ray* rays, std::size_t maxCount) {
+	std::size_t count = 1;
+	while(count < maxCount) {
+		const Ray& ray = rays[count];
+		Vec3 offset = ray.start - rays[0].start;
+		if(!isSameOctant(ray.direction, rays[0].direction) || lengthSquared(offset) > PACKET_START_SPREAD * PACKET_START_SPREAD) break;
+		count++;
+	}
+	return count;
+}
+
+static void setHitPoint(const Ray& ray, RaycastHit& hit) {
+	if(hit.hit()) {
+		hit.point = ray.start + ray.direction * hit.distance;
+	} else {
+		hit = RaycastHit();
+	}
+}
+
+static void raycastPacket(const WorldPrototype& world, const Ray* rays, std::size_t rayCount, RaycastHit* hits, LayerMask mask, double maxDistance) {
+	RayPacket packet;
+	packet.reference = rays[0].start;
+	for(std::size_t lane = 0; lane < RAY_PACKET_SIZE; lane++) {
+		bool used = lane < rayCount;
+		Vec3 origin = used ? Vec3(rays[lane].start - packet.reference) : Vec3(0.0, 0.0, 0.0);
+		Vec3 inverseDirection = used ? safeInverse(rays[lane].direction) : Vec3(1.0, 1.0, 1.0);
+		for(int axis = 0; axis < 3; axis++) {
+			packet.origin[axis][lane] = origin[axis];
+			packet.inverseDirection[axis][lane] = inverseDirection[axis];
+		}
+		packet.best[lane] = used ? maxDistance : -1.0;
+	}
+
+	RaycastHit laneHits[RAY_PACKET_SIZE];
+	forEachSelectedTree(world, mask, [&](const TreeNode& root) {
+		raycastTreePacket(root, packet, rays, laneHits);
+	});
+	for(std::size_t lane = 0; lane < rayCount; lane++) {
+		hits[lane] = laneHits[lane];
+		setHitPoint(rays[lane], hits[lane]);
+	}
+}
+
+RaycastHit WorldPrototype::raycast(const Ray& ray, LayerMask mask, double maxDistance) const {
+	RaycastHit best;
+	best.distance = maxDistance;
+	Vec3 inverseDirection = safeInverse(ray.direction);
+	forEachSelectedTree(*this, mask, [&](const TreeNode& root) {
+		raycastTree(root, ray, inverseDirection, best);
+	});
+	setHitPoint(ray, best);
+	return best;
+}
+
+void WorldPrototype::raycastBatch(const Ray* rays, std::size_t rayCount, RaycastHit* hits, LayerMask mask, double maxDistance) const {
+	auto castRange = [this, rays, hits, mask, maxDistance](std::size_t begin, std::size_t end) {
+		std::size_t i = begin;
+		while(i < end) {
+			std::size_t packetSize = coherentRayCount(rays + i, std::min<std::size_t>(RAY_PACKET_SIZE, end - i));
+			if(packetSize == 1) {
+				hits[i] = raycast(rays[i], mask, maxDistance);
+			} else {
+				raycastPacket(*this, rays + i, packetSize, hits + i, mask, maxDistance);
+			}
+			i += packetSize;
+		}
+	};
+	if(jobSystem != nullptr) {
+		jobSystem->parallelFor(rayCount, RAYCAST_GRAIN_SIZE, castRange);
+	} else {
+		castRange(0, rayCount);
+	}
+}
+
+#pragma endregion
+
+#pragma region overlap
+
+template<typename Func>
+static void forEachPartInBounds(const TreeNode& root, const Bounds& bounds, const Func& func) {
+	// the root of a layer with a single part is that part's leaf, children are tested before they are pushed
+	if(root.isLeafNode() && !intersects(root.bounds, bounds)) return;
+	const TreeNode* stack[TRAVERSAL_STACK_SIZE];
+	int stackSize = 0;
+	stack[stackSize++] = &root;
+	while(stackSize > 0) {
+		const TreeNode& node = *stack[--stackSize];
+		if(node.isLeafNode()) {
+			func(static_cast<Part*>(node.object));
+			continue;
+		}
+		for(const TreeNode& child : node) {
+			if(intersects(child.bounds, bounds)) stack[stackSize++] = &child;
+		}
+	}
+}
+
+void WorldPrototype::overlapBounds(const Bounds& bounds, std::vector<Part*>& result, LayerMask mask) const {
+	forEachSelectedTree(*this, mask, [&](const TreeNode& root) {
+		forEachPartInBounds(root, bounds, [&](Part* part) {
+			result.push_back(part);
+		});
+	});
+}
+
+void WorldPrototype::overlapShape(const Shape& shape, const GlobalCFrame& cframe, std::vector<Part*>& result, LayerMask mask) const {
+	Bounds shapeBounds = shape.getBounds(cframe.getRotation()) + cframe.getPosition();
+	forEachSelectedTree(*this, mask, [&](const TreeNode& root) {
+		forEachPartInBounds(root, shapeBounds, [&](Part* part) {
+			CFrame relativeTransform = cframe.globalToLocal(part->getCFrame());
+			if(intersectsTransformed(shape, part->hitbox, relativeTransform)) {
+				result.push_back(part);
+			}
+		});
+	});
+}
+
+#pragma endregion
+
+#pragma region closest
+
+// the squared distance from point to the closest point of bounds, 0 if bounds contains point
+static double distanceSquared(const Bounds& bounds, const Position& point) {
+	Vec3 toMin = bounds.min - point;
+	Vec3 toMax = bounds.max - point;
+	double result = 0.0;
+	for(int axis = 0; axis < 3; axis++) {
+		double gap = std::max(std::max(toMin[axis], -toMax[axis]), 0.0);
+		result += gap * gap;
+	}
+	return result;
+}
+
+struct ClosestNode {
+	double distanceSquared;
+	const TreeNode* node;
+
+	bool operator>(const ClosestNode& other) const { return distanceSquared > other.distanceSquared; }
+};
+
+void WorldPrototype::closestParts(const Position& point, std::size_t k, std::vector<Part*>& result, LayerMask mask, double maxDistance) const {
+	if(k == 0) return;
+
+	/*
+		Best first search over all selected trees at once
+		A node is never closer than its parent, so parts come out of the queue closest first
+	*/
+	std::priority_queue<ClosestNode, std::vector<ClosestNode>, std::greater<ClosestNode>> queue;
+	forEachSelectedTree(*this, mask, [&](const TreeNode& root) {
+		// the bounds of an empty tree are meaningless
+		if(root.nodeCount != 0) queue.push(ClosestNode{distanceSquared(root.bounds, point), &root});
+	});
+
+	double maxDistanceSquared = maxDistance * maxDistance;
+	std::size_t found = 0;
+	while(!queue.empty()) {
+		ClosestNode closest = queue.top();
+		queue.pop();
+		if(closest.distanceSquared > maxDistanceSquared) break;
+
+		const TreeNode& node = *closest.node;
+		if(node.isLeafNode()) {
+			result.push_back(static_cast<Part*>(node.object));
+			if(++found == k) break;
+			continue;
+		}
+		for(const TreeNode& child : node) {
+			queue.push(ClosestNode{distanceSquared(child.bounds, point), &child});
+		}
+	}
+}
+
+#pragma endregion
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#include "../math/position.h"
+#include "../math/ray.h"
+
+class Part;
+
+/*
+	Selects the WorldLayers a query looks at, bit i selects the WorldLayer with getID() == i
+	The free and terrain parts of a ColissionLayer each have a bit. ColissionLayers from index 31 on share the top two bits,
+	selecting one of them selects all of them, so ALL_LAYERS, FREE_PARTS_LAYERS and TERRAIN_PARTS_LAYERS cover every layer
+*/
+typedef std::uint64_t LayerMask;
+
+constexpr LayerMask ALL_LAYERS = ~LayerMask(0);
+// the free parts of every ColissionLayer
+constexpr LayerMask FREE_PARTS_LAYERS = 0x5555555555555555ULL;
+// the terrain parts of every ColissionLayer
+constexpr LayerMask TERRAIN_PARTS_LAYERS = 0xAAAAAAAAAAAAAAAAULL;
+
+constexpr LayerMask worldLayerMask(int worldLayerID) noexcept {
+	return worldLayerID < 64 ? LayerMask(1) << worldLayerID : LayerMask(1) << (62 + worldLayerID % 2);
+}
+// the free and terrain parts of the ColissionLayer at layerIndex
+constexpr LayerMask colissionLayerMask(int layerIndex) noexcept {
+	return layerIndex < 32 ? LayerMask(3) << (layerIndex * 2) : LayerMask(3) << 62;
+}
+
+/*
+	The closest part a ray hits, distance is in units of the length of the ray direction
+	part is nullptr if the ray hit nothing
+*/
+struct RaycastHit {
+	Part* part = nullptr;
+	double distance = INFINITY;
+	Position point;
+
+	bool hit() const { return part != nullptr; }
+};
@@ -0,0 +1,221 @@
+#include "worldSnapshot.h"
+
+#include <algorithm>
+#include <assert.h>
+
+#include "../world.h"
+#include "../part.h"
+#include "../physical.h"
+#include "../layer.h"
+#include "../math/linalg/quat.h"
+
+static void captureTrees(WorldSnapshot& snapshot, const WorldPrototype& world) {
+	snapshot.nodes.clear();
+	// the tree node each snapshot node was copied from, nodes are added breadth first so the children of a node end up next to each other
+	std::vector<const TreeNode*> sources;
+	for(const ColissionLayer& layer : world.layers) {
+		for(const WorldLayer& subLayer : layer.subLayers) {
+			const TreeNode& root = subLayer.tree.rootNode;
+			// the bounds of an empty tree are meaningless
+			if(!root.isLeafNode() && root.nodeCount == 0) continue;
+			snapshot.nodes.push_back(SnapshotTreeNode{root.bounds, 0, 0, false});
+			sources.push_back(&root);
+		}
+	}
+	snapshot.rootCount = snapshot.nodes.size();
+
+	for(std::size_t i = 0; i < sources.size(); i++) {
+		const TreeNode& source = *sources[i];
+		if(source.isLeafNode()) {
+			const PartSnapshot* part = snapshot.find(static_cast<const Part*>(source.object));
+			snapshot.nodes[i].index = static_cast<std::uint32_t>(part - snapshot.parts.data());
+			snapshot.nodes[i].isLeaf = true;
+		} else {
+			snapshot.nodes[i].index = static_cast<std::uint32_t>(snapshot.nodes.size());
+			snapshot.nodes[i].childCount = static_cast<std::uint32_t>(source.nodeCount);
+			for(const TreeNode& child : source) {
+				snapshot.nodes.push_back(SnapshotTreeNode{child.bounds, 0, 0, false});
+				sources.push_back(&child);
+			}
+		}
+	}
+}
+
+void WorldSnapshot::capture(const WorldPrototype& world) {
+	this->age = world.age;
+	this->deltaT = world.deltaT;
+	this->parts.clear();
+	this->parts.reserve(world.getPartCount());
+
+	for(const Part& part : world.iterParts()) {
+		PartSnapshot snap;
+		snap.part = &part;
+		snap.parent = part.parent;
+		snap.mainPhysical = (part.parent != nullptr) ? part.parent->mainPhysical : nullptr;
+		snap.isMainPart = part.isMainPart();
+		snap.isMainPhysical = (part.parent != nullptr) ? part.parent->isMainPhysical() : false;
+		snap.cframe = part.getCFrame();
+		snap.scale = part.hitbox.scale;
+		snap.baseShape = part.hitbox.baseShape;
+		snap.bounds = part.getBounds();
+		Motion motion = part.getMotion();
+		snap.velocity = motion.getVelocity();
+		snap.angularVelocity = motion.getAngularVelocity();
+		snap.tag = world.getSnapshotTag(part);
+		this->parts.push_back(snap);
+	}
+
+	std::sort(this->parts.begin(), this->parts.end(), [](const PartSnapshot& a, const PartSnapshot& b) {
+		return a.part < b.part;
+	});
+
+	captureTrees(*this, world);
+}
+
+const PartSnapshot* WorldSnapshot::find(const Part* part) const {
+	auto found = std::lower_bound(this->parts.begin(), this->parts.end(), part, [](const PartSnapshot& snap, const Part* p) {
+		return snap.part < p;
+	});
+	if(found != this->parts.end() && found->part == part) {
+		return &*found;
+	} else {
+		return nullptr;
+	}
+}
+
+GlobalCFrame interpolate(const GlobalCFrame& a, const GlobalCFrame& b, double alpha) {
+	Vec3 delta(b.getPosition() - a.getPosition());
+	Position position = a.getPosition() + delta * alpha;
+
+	Quaternion<double> qa = a.getRotation().asRotationQuaternion();
+	Quaternion<double> qb = b.getRotation().asRotationQuaternion();
+	// take the shortest path
+	if(dot(qa, qb) < 0.0) qb = -qb;
+	Quaternion<double> q = normalize(qa * (1.0 - alpha) + qb * alpha);
+
+	return GlobalCFrame(position, Rotation::fromRotationQuaternion(q));
+}
+
+static bool sameTransform(const GlobalCFrame& a, const DiagonalMat3& aScale, const GlobalCFrame& b, const DiagonalMat3& bScale) {
+	if(!(a.getPosition() == b.getPosition())) return false;
+	Mat3 aRotation = a.getRotation().asRotationMatrix();
+	Mat3 bRotation = b.getRotation().asRotationMatrix();
+	for(std::size_t i = 0; i < 9; i++) {
+		if(aRotation.data[i] != bRotation.data[i]) return false;
+	}
+	for(std::size_t i = 0; i < 3; i++) {
+		if(aScale[i] != bScale[i]) return false;
+	}
+	return true;
+}
+
+void SnapshotBuffer::findChanges(WorldSnapshot& snapshot, std::size_t since) {
+	snapshot.changes.clear();
+	snapshot.changes.since = since;
+	pendingChanges.clear();
+	nextChangeStates.clear();
+	nextChangeStates.reserve(snapshot.parts.size());
+
+	// both are sorted by part, so they are merged in one pass
+	auto old = changeStates.begin();
+	for(const PartSnapshot& part : snapshot.parts) {
+		while(old != changeStates.end() && old->part < part.part) ++old;
+
+		std::size_t changedAt = snapshot.sequence;
+		// a new part may reuse the memory of a removed one, the tag tells them apart
+		if(old != changeStates.end() && old->part == part.part && old->tag == part.tag && sameTransform(old->cframe, old->scale, part.cframe, part.scale)) {
+			changedAt = old->changedAt;
+		}
+		bool pending = changedAt > since;
+		if(pending) {
+			pendingChanges.push_back(nextChangeStates.size());
+			snapshot.changes.add(part);
+		}
+		nextChangeStates.push_back(ChangeState{part.part, part.tag, part.cframe, part.scale, changedAt, pending});
+	}
+	std::swap(changeStates, nextChangeStates);
+}
+
+// the parts are the same as at the previous publish, so changeStates lines up with snapshot.parts
+void SnapshotBuffer::findChangesOf(WorldSnapshot& snapshot, std::size_t since, const std::vector<const Part*>& movedParts) {
+	for(const Part* part : movedParts) {
+		const PartSnapshot* found = snapshot.find(part);
+		if(found == nullptr) continue;
+		std::size_t index = found - snapshot.parts.data();
+		ChangeState& state = changeStates[index];
+		assert(state.part == part);
+		if(state.tag == found->tag && sameTransform(state.cframe, state.scale, found->cframe, found->scale)) continue;
+
+		state.tag = found->tag;
+		state.cframe = found->cframe;
+		state.scale = found->scale;
+		state.changedAt = snapshot.sequence;
+		if(!state.pending) {
+			state.pending = true;
+			pendingChanges.push_back(index);
+		}
+	}
+	fillChanges(snapshot, since);
+}
+
+// lists the pending changes the reader has not seen yet, and forgets the ones it has
+void SnapshotBuffer::fillChanges(WorldSnapshot& snapshot, std::size_t since) {
+	snapshot.changes.clear();
+	snapshot.changes.since = since;
+	std::size_t kept = 0;
+	for(std::size_t index : pendingChanges) {
+		ChangeState& state = changeStates[index];
+		if(state.changedAt > since) {
+			pendingChanges[kept++] = index;
+			snapshot.changes.add(snapshot.parts[index]);
+		} else {
+			state.pending = false;
+		}
+	}
+	pendingChanges.resize(kept);
+}
+
+// the part count is compared as well, so a world that was cleared and refilled without ticking is not trusted
+bool SnapshotBuffer::onlyTickMovedParts(const WorldPrototype& world, const WorldSnapshot& snapshot) const {
+	return publishCount > 1 && world.age == publishedAge + 1 && world.lastTickMovedPartsComplete &&
+		!world.hasOutdatedColissionProxies() && snapshot.parts.size() == changeStates.size();
+}
+
+void SnapshotBuffer::publish(const WorldPrototype& world) {
+	std::lock_guard<std::mutex> lg(publishLock);
+	WorldSnapshot& snapshot = buffer.getWriteBuffer();
+	snapshot.capture(world);
+	snapshot.sequence = ++publishCount;
+	std::size_t since = pulledSequence.load(std::memory_order_acquire);
+	if(onlyTickMovedParts(world, snapshot)) {
+		findChangesOf(snapshot, since, world.lastTickMovedParts);
+	} else {
+		findChanges(snapshot, since);
+	}
+	publishedAge = world.age;
+	buffer.publish();
+}
+
+bool SnapshotBuffer::pull() {
+	// the read buffer is handed back to the writer by update(), so its contents are moved into previous first
+	std::swap(previous, buffer.getReadBuffer());
+	if(buffer.update()) {
+		pulledSequence.store(buffer.getReadBuffer().sequence, std::memory_order_release);
+		return true;
+	} else {
+		std::swap(previous, buffer.getReadBuffer());
+		return false;
+	}
+}
+
+bool SnapshotBuffer::getInterpolatedCFrame(const Part* part, double alpha, GlobalCFrame& result) const {
+	const PartSnapshot* cur = latest().find(part);
+	if(cur == nullptr) return false;
+	const PartSnapshot* prev = previous.find(part);
+	if(prev == nullptr) {
+		result = cur->cframe;
+	} else {
+		result = interpolate(prev->cframe, cur->cframe, alpha);
+	}
+	return true;
+}
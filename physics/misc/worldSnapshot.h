@@ -0,0 +1,224 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+#include "../math/globalCFrame.h"
+#include "../math/bounds.h"
+#include "../math/linalg/mat.h"
+#include "../math/linalg/vec.h"
+#include "../datastructures/tripleBuffer.h"
+
+class Part;
+class Physical;
+class MotorizedPhysical;
+class WorldPrototype;
+class ShapeClass;
+
+/*
+	Copy of the state of a single part at the end of a tick
+
+	part, parent and mainPhysical are only identifiers, they must not be dereferenced without holding the world lock,
+	as the objects they point to may have been deleted since the snapshot was taken
+	baseShape may be read, shape classes are not modified once they are used by a part
+*/
+struct PartSnapshot {
+	const Part* part;
+	const Physical* parent;
+	const MotorizedPhysical* mainPhysical;
+	bool isMainPart;
+	bool isMainPhysical;
+
+	GlobalCFrame cframe;
+	DiagonalMat3 scale;
+	const ShapeClass* baseShape;
+	Bounds bounds;
+	Vec3 velocity;
+	Vec3 angularVelocity;
+
+	// given by WorldPrototype::getSnapshotTag, lets readers find what the part belongs to without dereferencing it
+	std::uint64_t tag;
+};
+
+/*
+	A node of the copy of the bounds trees of a world in a WorldSnapshot
+	The children of a node are next to each other in WorldSnapshot::nodes, a leaf is a single part
+*/
+struct SnapshotTreeNode {
+	Bounds bounds;
+	// index of the first child in WorldSnapshot::nodes, or of the part in WorldSnapshot::parts for a leaf
+	std::uint32_t index;
+	std::uint32_t childCount;
+	bool isLeaf;
+};
+
+/*
+	The parts whose cframe or scale changed, as parallel arrays so consumers only read what they need
+	tags[i], parts[i], cframes[i] and scales[i] all belong to the same part, parts that were removed are not listed
+*/
+struct PartChangeBatch {
+	// the batch holds the changes made after the snapshot with this sequence number was pulled, with 0 it holds every part
+	std::size_t since = 0;
+	std::vector<std::uint64_t> tags;
+	std::vector<const Part*> parts;
+	std::vector<GlobalCFrame> cframes;
+	std::vector<DiagonalMat3> scales;
+
+	std::size_t size() const { return parts.size(); }
+
+	void clear() {
+		tags.clear();
+		parts.clear();
+		cframes.clear();
+		scales.clear();
+	}
+
+	void add(const PartSnapshot& part) {
+		tags.push_back(part.tag);
+		parts.push_back(part.part);
+		cframes.push_back(part.cframe);
+		scales.push_back(part.scale);
+	}
+};
+
+/*
+	Immutable copy of all part transforms, bounds and velocities of a world, published at the end of each tick
+	parts is sorted by part pointer, so individual parts can be looked up with find()
+	nodes holds the bounds trees of all layers, their roots are the first rootCount nodes
+	changes is filled by SnapshotBuffer, which numbers the snapshots it publishes with sequence, starting at 1
+*/
+struct WorldSnapshot {
+	std::size_t age = 0;
+	std::size_t sequence = 0;
+	double deltaT = 0.0;
+	std::vector<PartSnapshot> parts;
+	std::vector<SnapshotTreeNode> nodes;
+	std::size_t rootCount = 0;
+	PartChangeBatch changes;
+
+	/*
+		Overwrites this snapshot with the current state of world, reuses the existing allocation
+		Must be called while holding at least a shared lock on the world
+	*/
+	void capture(const WorldPrototype& world);
+
+	// returns nullptr if the part was not in the world when this snapshot was taken
+	const PartSnapshot* find(const Part* part) const;
+
+	/*
+		Calls func(const PartSnapshot&) for every part for which filter(const Bounds&) accepts the part and all nodes above it
+		Like iterPartsFiltered on the world, a node the filter rejects is skipped with everything in it
+	*/
+	template<typename Filter, typename Func>
+	void forEachPartFiltered(const Filter& filter, const Func& func) const {
+		// a node is popped before its children are pushed, so this is enough for MAX_BRANCHES * MAX_HEIGHT of a BoundsTree
+		std::uint32_t stack[256];
+		std::size_t stackSize = 0;
+		for(std::size_t root = 0; root < rootCount; root++) {
+			stack[stackSize++] = static_cast<std::uint32_t>(root);
+			while(stackSize > 0) {
+				const SnapshotTreeNode& node = nodes[stack[--stackSize]];
+				if(!filter(node.bounds)) continue;
+				if(node.isLeaf) {
+					func(parts[node.index]);
+					continue;
+				}
+				for(std::uint32_t child = node.index + node.childCount; child-- > node.index;) {
+					stack[stackSize++] = child;
+				}
+			}
+		}
+	}
+
+	/*
+		Calls func(std::uint64_t tag, const GlobalCFrame& cframe, const DiagonalMat3& scale) for the parts that changed after the
+		snapshot with sequence number appliedSequence, for a reader that has applied everything up to that snapshot
+		If changes does not reach back that far every part is passed, nothing is passed if this is that snapshot
+	*/
+	template<typename Func>
+	void forEachChangeSince(std::size_t appliedSequence, const Func& func) const {
+		if(appliedSequence == sequence) return;
+		if(appliedSequence >= changes.since) {
+			for(std::size_t i = 0; i < changes.size(); i++) {
+				func(changes.tags[i], changes.cframes[i], changes.scales[i]);
+			}
+		} else {
+			for(const PartSnapshot& part : parts) {
+				func(part.tag, part.cframe, part.scale);
+			}
+		}
+	}
+};
+
+/*
+	Linearly interpolates the position and normalized-lerps the rotation between two cframes
+	alpha = 0 gives a, alpha = 1 gives b
+*/
+GlobalCFrame interpolate(const GlobalCFrame& a, const GlobalCFrame& b, double alpha);
+
+/*
+	Hands WorldSnapshots from the physics thread to a single reader thread without either of them taking the world lock
+	The reader keeps the last two snapshots, so it can interpolate between them
+
+	Every published snapshot lists the parts that changed since the snapshot the reader pulled last, as seen when it was captured
+	The writer remembers the state of every part and the sequence number of the snapshot in which it last changed, so changes in
+	snapshots the reader skipped are carried over into the next one.
+	If the world was only ticked once since the previous publish and nothing else changed its parts, only the parts in
+	WorldPrototype::lastTickMovedParts are compared, otherwise every part is.
+*/
+class SnapshotBuffer {
+	struct ChangeState {
+		const Part* part;
+		std::uint64_t tag;
+		GlobalCFrame cframe;
+		DiagonalMat3 scale;
+		std::size_t changedAt;
+		// listed in pendingChanges
+		bool pending;
+	};
+
+	TripleBuffer<WorldSnapshot> buffer;
+	WorldSnapshot previous;
+	// only serializes writers, publishing outside of the physics thread is rare so this is practically never contended
+	std::mutex publishLock;
+
+	// writer side, sorted by part like the parts of a snapshot
+	std::vector<ChangeState> changeStates;
+	std::vector<ChangeState> nextChangeStates;
+	// indices in changeStates of the parts that changed after the snapshot the reader had pulled at the last publish
+	std::vector<std::size_t> pendingChanges;
+	std::size_t publishCount = 0;
+	// world.age at the previous publish
+	std::size_t publishedAge = 0;
+	// sequence number of the snapshot the reader pulled last
+	std::atomic<std::size_t> pulledSequence{0};
+
+	void findChanges(WorldSnapshot& snapshot, std::size_t since);
+	void findChangesOf(WorldSnapshot& snapshot, std::size_t since, const std::vector<const Part*>& movedParts);
+	bool onlyTickMovedParts(const WorldPrototype& world, const WorldSnapshot& snapshot) const;
+	void fillChanges(WorldSnapshot& snapshot, std::size_t since);
+
+public:
+	// physics thread, called at the end of a tick, requires at least a shared lock on world
+	void publish(const WorldPrototype& world);
+
+	/*
+		reader thread, picks up the newest published snapshot if there is one
+		returns true if the latest snapshot changed
+	*/
+	bool pull();
+
+	// reader thread, latest snapshot retrieved by pull()
+	const WorldSnapshot& latest() const { return buffer.getReadBuffer(); }
+	// reader thread, the snapshot that was latest before the last successful pull()
+	const WorldSnapshot& beforeLatest() const { return previous; }
+
+	/*
+		reader thread, cframe of part interpolated between beforeLatest() and latest()
+		falls back to the latest cframe for parts that are not in both, returns false if part is in neither
+	*/
+	bool getInterpolatedCFrame(const Part* part, double alpha, GlobalCFrame& result) const;
+};
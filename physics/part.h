@@ -51,6 +51,7 @@ class Part {
 	friend class MotorizedPhysical;
 	friend class WorldPrototype;
 	friend class ConstraintGroup;
+	friend class WorldClonerPrototype;
 
 	GlobalCFrame cframe;
 
@@ -80,6 +80,16 @@ MotorizedPhysical::MotorizedPhysical(RigidBody&& rigidBody) : Physical(std::move
 	refreshPhysicalProperties();
 }
 
+MotorizedPhysical::MotorizedPhysical(RigidBody&& rigidBody, const MotorizedPhysical& original) :
+	Physical(std::move(rigidBody), this),
+	totalForce(original.totalForce),
+	totalMoment(original.totalMoment),
+	totalMass(original.totalMass),
+	totalCenterOfMass(original.totalCenterOfMass),
+	forceResponse(original.forceResponse),
+	momentResponse(original.momentResponse),
+	motionOfCenterOfMass(original.motionOfCenterOfMass) {}
+
 MotorizedPhysical::MotorizedPhysical(Physical&& movedPhys) : Physical(std::move(movedPhys)) {
 	this->setMainPhysicalRecursive(this);
 	refreshPhysicalProperties();
@@ -667,7 +677,7 @@ void MotorizedPhysical::applyForceAtCenterOfMass(Vec3 force) {
 	assert(isVecValid(force));
 	totalForce += force;
 
-	Debug::logVector(getCenterOfMass(), force, Debug::FORCE);
+	DEBUG_LOG_VECTOR(getCenterOfMass(), force, Debug::FORCE);
 }
 
 void MotorizedPhysical::applyForce(Vec3Relative origin, Vec3 force) {
@@ -675,7 +685,7 @@ void MotorizedPhysical::applyForce(Vec3Relative origin, Vec3 force) {
 	assert(isVecValid(force));
 	totalForce += force;
 
-	Debug::logVector(getCenterOfMass() + origin, force, Debug::FORCE);
+	DEBUG_LOG_VECTOR(getCenterOfMass() + origin, force, Debug::FORCE);
 
 	applyMoment(origin % force);
 }
@@ -683,25 +693,25 @@ void MotorizedPhysical::applyForce(Vec3Relative origin, Vec3 force) {
 void MotorizedPhysical::applyMoment(Vec3 moment) {
 	assert(isVecValid(moment));
 	totalMoment += moment;
-	Debug::logVector(getCenterOfMass(), moment, Debug::MOMENT);
+	DEBUG_LOG_VECTOR(getCenterOfMass(), moment, Debug::MOMENT);
 }
 
 void MotorizedPhysical::applyImpulseAtCenterOfMass(Vec3 impulse) {
 	assert(isVecValid(impulse));
-	Debug::logVector(getCenterOfMass(), impulse, Debug::IMPULSE);
+	DEBUG_LOG_VECTOR(getCenterOfMass(), impulse, Debug::IMPULSE);
 	motionOfCenterOfMass.translation.translation[0] += forceResponse * impulse;
 }
 void MotorizedPhysical::applyImpulse(Vec3Relative origin, Vec3Relative impulse) {
 	assert(isVecValid(origin));
 	assert(isVecValid(impulse));
-	Debug::logVector(getCenterOfMass() + origin, impulse, Debug::IMPULSE);
+	DEBUG_LOG_VECTOR(getCenterOfMass() + origin, impulse, Debug::IMPULSE);
 	motionOfCenterOfMass.translation.translation[0] += forceResponse * impulse;
 	Vec3 angularImpulse = origin % impulse;
 	applyAngularImpulse(angularImpulse);
 }
 void MotorizedPhysical::applyAngularImpulse(Vec3 angularImpulse) {
 	assert(isVecValid(angularImpulse));
-	Debug::logVector(getCenterOfMass(), angularImpulse, Debug::ANGULAR_IMPULSE);
+	DEBUG_LOG_VECTOR(getCenterOfMass(), angularImpulse, Debug::ANGULAR_IMPULSE);
 	Vec3 localAngularImpulse = getCFrame().relativeToLocal(angularImpulse);
 	Vec3 localRotAcc = momentResponse * localAngularImpulse;
 	Vec3 rotAcc = getCFrame().localToRelative(localRotAcc);
@@ -710,20 +720,20 @@ void MotorizedPhysical::applyAngularImpulse(Vec3 angularImpulse) {
 
 void MotorizedPhysical::applyDragAtCenterOfMass(Vec3 drag) {
 	assert(isVecValid(drag));
-	Debug::logVector(getCenterOfMass(), drag, Debug::POSITION);
+	DEBUG_LOG_VECTOR(getCenterOfMass(), drag, Debug::POSITION);
 	translate(forceResponse * drag);
 }
 void MotorizedPhysical::applyDrag(Vec3Relative origin, Vec3Relative drag) {
 	assert(isVecValid(origin));
 	assert(isVecValid(drag));
-	Debug::logVector(getCenterOfMass() + origin, drag, Debug::POSITION);
+	DEBUG_LOG_VECTOR(getCenterOfMass() + origin, drag, Debug::POSITION);
 	translateUnsafeRecursive(forceResponse * drag);
 	Vec3 angularDrag = origin % drag;
 	applyAngularDrag(angularDrag);
 }
 void MotorizedPhysical::applyAngularDrag(Vec3 angularDrag) {
 	assert(isVecValid(angularDrag));
-	Debug::logVector(getCenterOfMass(), angularDrag, Debug::INFO_VEC);
+	DEBUG_LOG_VECTOR(getCenterOfMass(), angularDrag, Debug::INFO_VEC);
 	Vec3 localAngularDrag = getCFrame().relativeToLocal(angularDrag);
 	Vec3 localRotAcc = momentResponse * localAngularDrag;
 	Vec3 rotAcc = getCFrame().localToRelative(localRotAcc);
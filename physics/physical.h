@@ -215,6 +215,10 @@ public:
 class MotorizedPhysical : public Physical {
 	friend class Physical;
 	friend class ConnectedPhysical;
+	friend class WorldClonerPrototype;
+
+	// takes over the cached physical properties and motion of original instead of recomputing them, used when cloning worlds
+	MotorizedPhysical(RigidBody&& rigidBody, const MotorizedPhysical& original);
 public:
 	void refreshPhysicalProperties();
 	Vec3 totalForce = Vec3(0.0, 0.0, 0.0);
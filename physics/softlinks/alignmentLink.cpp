@@ -6,6 +6,13 @@ AlignmentLink::AlignmentLink(const AttachedPart& part1, const AttachedPart& part
 	offset = this->attachedPart1.part->getCFrame().rotation.localToGlobal(this->attachedPart2.part->getCFrame().rotation);
 }
 
+SoftLink* AlignmentLink::clone(Part* part1, Part* part2) const {
+	AlignmentLink* result = new AlignmentLink(AttachedPart(attachedPart1.attachment, part1), AttachedPart(attachedPart2.attachment, part2));
+	// the offset is the one at the time this link was created, not that of the current cframes
+	result->offset = offset;
+	return result;
+}
+
 void AlignmentLink::update() {
 	
 	Vec3 momentDir = getGlobalMoment();
@@ -12,6 +12,7 @@ public:
 
 	AlignmentLink(const AttachedPart& part1, const AttachedPart& part2);
 	void update() override;
+	SoftLink* clone(Part* part1, Part* part2) const override;
 
 private:
 	Vec3 getGlobalMoment();
@@ -7,6 +7,10 @@ ElasticLink::ElasticLink(AttachedPart part1, AttachedPart part2, const double re
 
 }
 
+SoftLink* ElasticLink::clone(Part* part1, Part* part2) const {
+	return new ElasticLink(AttachedPart(attachedPart1.attachment, part1), AttachedPart(attachedPart2.attachment, part2), restLength, stiffness);
+}
+
 void ElasticLink::update() {
 	auto optionalVec3 = forceAppliedToTheLink();
 
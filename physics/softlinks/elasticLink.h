@@ -15,6 +15,7 @@ public:
 
 	ElasticLink(AttachedPart part1, AttachedPart part2, const double restLength, const double stiffness);
 	void update() override;
+	SoftLink* clone(Part* part1, Part* part2) const override;
 
 private:
 	std::optional<Vec3> forceAppliedToTheLink();
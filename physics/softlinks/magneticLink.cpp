@@ -7,6 +7,10 @@ MagneticLink::MagneticLink(const AttachedPart& part1, const AttachedPart& part2,
 
 }
 
+SoftLink* MagneticLink::clone(Part* part1, Part* part2) const {
+	return new MagneticLink(AttachedPart(attachedPart1.attachment, part1), AttachedPart(attachedPart2.attachment, part2), magneticStrength);
+}
+
 void MagneticLink::update() {
 
 	Vec3 force = forceAppliedToTheLink();
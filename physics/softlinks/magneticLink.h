@@ -13,6 +13,7 @@ public:
 	MagneticLink(const AttachedPart& part1, const AttachedPart& part2, const double magneticStrength);
 
 	void update() override;
+	SoftLink* clone(Part* part1, Part* part2) const override;
 
 private:
 	Vec3 forceAppliedToTheLink();
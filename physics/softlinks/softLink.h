@@ -24,6 +24,8 @@ public:
 
 	virtual ~SoftLink();
 	virtual void update() = 0;
+	// returns a new link with the same settings between the given parts, which take the place of the parts of this link
+	virtual SoftLink* clone(Part* part1, Part* part2) const = 0;
 
 	SoftLink(const AttachedPart& part1, const AttachedPart& part2);
 
@@ -45,4 +47,7 @@ public:
 	Vec3 getRelativePositionOfAttach1() const;
 	Vec3 getRelativePositionOfAttach2() const;
 
+	Part* getPartOfAttach1() const { return attachedPart1.part; }
+	Part* getPartOfAttach2() const { return attachedPart2.part; }
+
 };
\ No newline at end of file
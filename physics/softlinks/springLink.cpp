@@ -9,6 +9,10 @@ SpringLink::SpringLink(AttachedPart part1, AttachedPart part2, double restLength
 
 }
 
+SoftLink* SpringLink::clone(Part* part1, Part* part2) const {
+	return new SpringLink(AttachedPart(attachedPart1.attachment, part1), AttachedPart(attachedPart2.attachment, part2), restLength, stiffness);
+}
+
 void SpringLink::update() {
 	Vec3 force = forceAppliedToTheLink();
 	this->attachedPart2.part->applyForce(this->getRelativePositionOfAttach1(), force);
@@ -13,6 +13,7 @@ public:
 	SpringLink(AttachedPart part1, AttachedPart part2,  double restLength, double stiffness);
 
 	void update() override;
+	SoftLink* clone(Part* part1, Part* part2) const override;
 
 private:
 	Vec3 forceAppliedToTheLink() noexcept;
@@ -1,57 +1,120 @@
 #pragma once
 
-#include <queue>
 #include <mutex>
 #include <shared_mutex>
-#include <functional>
+#include <atomic>
+#include <thread>
 
 #include "world.h"
 #include "sharedLockGuard.h"
 #include "misc/physicsProfiler.h"
+#include "misc/worldSnapshot.h"
+#include "datastructures/mpscQueue.h"
+#include "datastructures/smallFunction.h"
+
+/*
+	Returned by asyncModification and asyncReadOnlyOperation
+	Allows the caller to find out whether a possibly deferred operation has been executed yet
+*/
+class OperationFuture {
+	const std::atomic<std::size_t>* completedCount;
+	std::size_t ticket;
+
+public:
+	// an already completed operation
+	OperationFuture() : completedCount(nullptr), ticket(0) {}
+	OperationFuture(const std::atomic<std::size_t>* completedCount, std::size_t ticket) : completedCount(completedCount), ticket(ticket) {}
+
+	bool isDone() const {
+		return completedCount == nullptr || completedCount->load(std::memory_order_acquire) >= ticket;
+	}
+	/*
+		Blocks until the operation has been executed
+		Must not be called from within a tick of the world, or from another queued operation
+	*/
+	void wait() const {
+		while(!isDone()) {
+			std::this_thread::yield();
+		}
+	}
+};
 
 template<typename T = Part>
 class SynchronizedWorld : public World<T> {
+public:
+	typedef SmallFunction<48> Operation;
+	static constexpr std::size_t QUEUE_CAPACITY = 4096;
+
+private:
 	mutable std::shared_mutex lock;
-	mutable std::mutex queueLock;
-	mutable std::mutex readQueueLock;
 
-	std::queue<std::function<void()>> waitingOperations;
-	mutable std::queue<std::function<void()>> waitingReadOnlyOperations;
+	/*
+		Operations that could not get the lock immediately, pushed lock-free by any thread and drained by the ticking thread
+		If a queue is full the pushing thread yields until the next tick frees up space. Queued operations must therefore not
+		push more than QUEUE_CAPACITY new operations themselves.
+	*/
+	BoundedMPSCQueue<Operation> waitingOperations;
+	mutable BoundedMPSCQueue<Operation> waitingReadOnlyOperations;
+
+	// number of operations from each queue which have finished executing, used by OperationFuture
+	std::atomic<std::size_t> completedOperations{0};
+	mutable std::atomic<std::size_t> completedReadOnlyOperations{0};
+
+	mutable SnapshotBuffer snapshots;
+
+	static std::size_t pushTo(BoundedMPSCQueue<Operation>& queue, Operation&& operation) {
+		std::size_t position;
+		while(!queue.tryPush(std::move(operation), position)) {
+			std::this_thread::yield();
+		}
+		return position;
+	}
 
 	template<typename Func>
-	void pushOperation(const Func& func) {
-		std::lock_guard<std::mutex> lg(queueLock);
-		waitingOperations.emplace(func);
+	OperationFuture pushOperation(const Func& func) {
+		std::size_t position = pushTo(waitingOperations, Operation(func));
+		return OperationFuture(&completedOperations, position + 1);
 	}
 	template<typename Func>
-	void pushReadOnlyOperation(const Func& func) const {
-		std::lock_guard<std::mutex> lg(readQueueLock);
-		waitingReadOnlyOperations.emplace(func);
+	OperationFuture pushReadOnlyOperation(const Func& func) const {
+		std::size_t position = pushTo(waitingReadOnlyOperations, Operation(func));
+		return OperationFuture(&completedReadOnlyOperations, position + 1);
 	}
 
 	void processQueue() {
-		std::lock_guard<std::mutex> lg(queueLock);
-
-		while (!waitingOperations.empty()) {
-			std::function<void()>& operation = waitingOperations.front();
+		waitingOperations.drain([this](Operation& operation, std::size_t position) {
 			operation();
-			waitingOperations.pop();
-		}
+			completedOperations.store(position + 1, std::memory_order_release);
+		});
 	}
 
 	void processReadQueue() const {
-		std::lock_guard<std::mutex> lg(readQueueLock);
-
-		while (!waitingReadOnlyOperations.empty()) {
-			std::function<void()>& operation = waitingReadOnlyOperations.front();
+		waitingReadOnlyOperations.drain([this](Operation& operation, std::size_t position) {
 			operation();
-			waitingReadOnlyOperations.pop();
-		}
+			completedReadOnlyOperations.store(position + 1, std::memory_order_release);
+		});
 	}
 
 public:
 
-	SynchronizedWorld<T>(double deltaT) : World<T>(deltaT) {}
+	SynchronizedWorld<T>(double deltaT) : World<T>(deltaT), waitingOperations(QUEUE_CAPACITY), waitingReadOnlyOperations(QUEUE_CAPACITY) {}
+
+	/*
+		Picks up the snapshot published at the end of the latest tick, without taking the world lock
+		Only one thread may read snapshots, usually the render thread
+		Returns true if a new snapshot was available
+	*/
+	bool pullSnapshot() { return snapshots.pull(); }
+	/*
+		Publishes a snapshot of the current state outside of tick(), for when the world is not being ticked
+		Takes a shared lock on the world
+	*/
+	void publishSnapshot() const {
+		SharedLockGuard lg(lock);
+		snapshots.publish(*this);
+	}
+	// snapshots of the last two ticks, as retrieved by pullSnapshot()
+	const SnapshotBuffer& getSnapshots() const { return snapshots; }
 
 	template<typename Func>
 	void syncModification(const Func& function) {
@@ -59,12 +122,13 @@ public:
 		function();
 	}
 	template<typename Func>
-	void asyncModification(const Func& function) {
+	OperationFuture asyncModification(const Func& function) {
 		if (lock.try_lock()) {
 			UnlockOnDestroy lg(lock);
 			function();
+			return OperationFuture();
 		} else {
-			pushOperation(function);
+			return pushOperation(function);
 		}
 	}
 	template<typename Func>
@@ -73,40 +137,54 @@ public:
 		function();
 	}
 	template<typename Func>
-	void asyncReadOnlyOperation(const Func& function) const {
+	OperationFuture asyncReadOnlyOperation(const Func& function) const {
 		if (lock.try_lock_shared()) {
 			UnlockSharedOnDestroy lg(lock);
 			function();
+			return OperationFuture();
 		} else {
-			pushReadOnlyOperation(function);
+			return pushReadOnlyOperation(function);
 		}
 	}
 
 	virtual void tick() override {
 		SharedLockGuard mutLock(lock);
-		
+
 		this->findColissions();
-		
-		physicsMeasure.mark(PhysicsProcess::EXTERNALS);
-		this->applyExternalForces();
+
+		{
+			PhysicsZone zone(PhysicsProcess::EXTERNALS);
+			this->applyExternalForces();
+		}
 
 		this->handleColissions();
 
-		intersectionStatistics.nextTally();
+		if(physicsStatisticsEnabled) intersectionStatistics.nextTally();
 
 		this->handleConstraints();
 
-		physicsMeasure.mark(PhysicsProcess::WAIT_FOR_LOCK);
-		mutLock.upgrade();
+		{
+			PhysicsZone zone(PhysicsProcess::WAIT_FOR_LOCK);
+			mutLock.upgrade();
+		}
 		this->update();
 
-		physicsMeasure.mark(PhysicsProcess::QUEUE);
-		processQueue();
-		
-		physicsMeasure.mark(PhysicsProcess::WAIT_FOR_LOCK);
-		mutLock.downgrade();
+		{
+			PhysicsZone zone(PhysicsProcess::QUEUE);
+			processQueue();
+		}
+
+		{
+			PhysicsZone zone(PhysicsProcess::WAIT_FOR_LOCK);
+			mutLock.downgrade();
+		}
+
+		{
+			PhysicsZone zone(PhysicsProcess::QUEUE);
+			processReadQueue();
+		}
 
-		physicsMeasure.mark(PhysicsProcess::QUEUE);
-		processReadQueue();
+		PhysicsZone zone(PhysicsProcess::SNAPSHOT);
+		snapshots.publish(*this);
 	}
 };
@@ -0,0 +1,112 @@
+#include "jobSystem.h"
+
+#include <chrono>
+
+// index of the queue owned by the current thread, 0 for threads that are not workers of any JobSystem
+static thread_local const JobSystem* currentJobSystem = nullptr;
+static thread_local std::size_t currentQueueIndex = 0;
+
+std::size_t JobSystem::defaultWorkerCount() {
+	unsigned int hardwareThreads = std::thread::hardware_concurrency();
+	return (hardwareThreads > 1) ? hardwareThreads - 1 : 0;
+}
+
+JobSystem::JobSystem(std::size_t workerCount) : queues(new JobQueue[workerCount + 1]), queueCount(workerCount + 1) {
+	workers.reserve(workerCount);
+	for(std::size_t i = 0; i < workerCount; i++) {
+		workers.emplace_back([this, i]() { workerLoop(i + 1); });
+	}
+}
+
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> lg(sleepLock);
+		stopping.store(true);
+	}
+	wakeUp.notify_all();
+	for(std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+std::size_t JobSystem::getOwnQueueIndex() const {
+	return (currentJobSystem == this) ? currentQueueIndex : 0;
+}
+
+void JobSystem::submit(Job&& job, JobCounter& counter) {
+	counter.remaining.fetch_add(1, std::memory_order_relaxed);
+	queuedJobCount.fetch_add(1, std::memory_order_release);
+	JobQueue& queue = queues[getOwnQueueIndex()];
+	{
+		std::lock_guard<std::mutex> lg(queue.lock);
+		queue.jobs.push_back(QueuedJob{std::move(job), &counter});
+	}
+	if(!workers.empty()) {
+		// take the lock so a worker that is about to sleep cannot miss this notification
+		{ std::lock_guard<std::mutex> lg(sleepLock); }
+		wakeUp.notify_one();
+	}
+}
+
+bool JobSystem::tryPopOwn(std::size_t queueIndex, QueuedJob& result) {
+	JobQueue& queue = queues[queueIndex];
+	std::lock_guard<std::mutex> lg(queue.lock);
+	if(queue.jobs.empty()) return false;
+	if(queueIndex == 0) {
+		// the shared queue is used as a FIFO, it has no single owner whose newest work is hot in cache
+		result = std::move(queue.jobs.front());
+		queue.jobs.pop_front();
+	} else {
+		result = std::move(queue.jobs.back());
+		queue.jobs.pop_back();
+	}
+	return true;
+}
+
+bool JobSystem::trySteal(std::size_t thiefIndex, QueuedJob& result) {
+	for(std::size_t offset = 1; offset < queueCount; offset++) {
+		JobQueue& victim = queues[(thiefIndex + offset) % queueCount];
+		std::lock_guard<std::mutex> lg(victim.lock);
+		if(!victim.jobs.empty()) {
+			result = std::move(victim.jobs.front());
+			victim.jobs.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+bool JobSystem::tryRunOne(std::size_t queueIndex) {
+	if(queuedJobCount.load(std::memory_order_acquire) == 0) return false;
+	QueuedJob queued;
+	if(!tryPopOwn(queueIndex, queued) && !trySteal(queueIndex, queued)) return false;
+	queuedJobCount.fetch_sub(1, std::memory_order_relaxed);
+
+	queued.job();
+	queued.job.reset();
+	queued.counter->remaining.fetch_sub(1, std::memory_order_acq_rel);
+	return true;
+}
+
+void JobSystem::wait(JobCounter& counter) {
+	std::size_t queueIndex = getOwnQueueIndex();
+	while(!counter.isDone()) {
+		if(!tryRunOne(queueIndex)) {
+			// the remaining jobs are running on other threads
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::workerLoop(std::size_t queueIndex) {
+	currentJobSystem = this;
+	currentQueueIndex = queueIndex;
+	while(!stopping.load(std::memory_order_acquire)) {
+		if(tryRunOne(queueIndex)) continue;
+
+		std::unique_lock<std::mutex> lk(sleepLock);
+		wakeUp.wait_for(lk, std::chrono::milliseconds(10), [this]() {
+			return stopping.load(std::memory_order_acquire) || queuedJobCount.load(std::memory_order_acquire) != 0;
+		});
+	}
+}
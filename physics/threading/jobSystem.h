@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <memory>
+
+#include "../datastructures/smallFunction.h"
+
+/*
+	Tracks a group of submitted jobs, done once every job submitted with it has finished
+*/
+class JobCounter {
+	friend class JobSystem;
+	std::atomic<std::size_t> remaining{0};
+
+public:
+	bool isDone() const { return remaining.load(std::memory_order_acquire) == 0; }
+};
+
+/*
+	Work stealing job system
+
+	Each worker owns a queue, it runs its own jobs newest first and steals the oldest jobs of other queues when it runs dry.
+	Threads that are not workers submit to a shared queue. Waiting on a JobCounter runs pending jobs instead of blocking,
+	so a JobSystem with 0 workers simply runs everything on the waiting thread.
+*/
+class JobSystem {
+public:
+	typedef SmallFunction<48> Job;
+
+private:
+	struct QueuedJob {
+		Job job;
+		JobCounter* counter;
+	};
+	struct JobQueue {
+		std::mutex lock;
+		std::deque<QueuedJob> jobs;
+	};
+
+	std::vector<std::thread> workers;
+	// queues[0] is shared by all non-worker threads, queues[i+1] belongs to workers[i]
+	std::unique_ptr<JobQueue[]> queues;
+	std::size_t queueCount;
+
+	std::atomic<std::size_t> queuedJobCount{0};
+	std::atomic<bool> stopping{false};
+	std::mutex sleepLock;
+	std::condition_variable wakeUp;
+
+	std::size_t getOwnQueueIndex() const;
+	bool tryPopOwn(std::size_t queueIndex, QueuedJob& result);
+	bool trySteal(std::size_t thiefIndex, QueuedJob& result);
+	bool tryRunOne(std::size_t queueIndex);
+	void workerLoop(std::size_t queueIndex);
+
+public:
+	// defaults to one worker less than the hardware thread count, the thread that waits on jobs makes up for the last one
+	explicit JobSystem(std::size_t workerCount = defaultWorkerCount());
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	static std::size_t defaultWorkerCount();
+	std::size_t getWorkerCount() const { return workers.size(); }
+
+	void submit(Job&& job, JobCounter& counter);
+
+	// runs pending jobs on this thread until every job of counter has finished
+	void wait(JobCounter& counter);
+
+	/*
+		Calls func(begin, end) for consecutive ranges of at most grainSize elements covering [0, count), and waits for all of them
+		The ranges may run on any thread in any order, func must be safe to call concurrently
+	*/
+	template<typename Func>
+	void parallelFor(std::size_t count, std::size_t grainSize, const Func& func) {
+		if(count == 0) return;
+		if(grainSize == 0) grainSize = 1;
+		if(count <= grainSize || workers.empty()) {
+			func(std::size_t(0), count);
+			return;
+		}
+		JobCounter counter;
+		for(std::size_t begin = grainSize; begin < count; begin += grainSize) {
+			std::size_t end = (begin + grainSize < count) ? begin + grainSize : count;
+			submit(Job([&func, begin, end]() { func(begin, end); }), counter);
+		}
+		func(std::size_t(0), grainSize);
+		wait(counter);
+	}
+};
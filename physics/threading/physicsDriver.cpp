@@ -0,0 +1,120 @@
+#include "physicsDriver.h"
+
+#include <cmath>
+
+#include "../misc/physicsProfiler.h"
+#include "../../util/log.h"
+
+PhysicsDriver::PhysicsDriver(WorldPrototype& world, std::size_t maxSubstepsPerUpdate, std::size_t workerCount) :
+	world(world),
+	jobs(workerCount),
+	maxSubstepsPerUpdate(maxSubstepsPerUpdate) {
+	world.jobSystem = &jobs;
+}
+
+PhysicsDriver::~PhysicsDriver() {
+	stop();
+	world.jobSystem = nullptr;
+}
+
+void PhysicsDriver::start() {
+	if(!stopped.exchange(false)) return;
+
+	accumulator.store(0.0);
+	thread = std::thread([this]() { runLoop(); });
+}
+
+void PhysicsDriver::stop() {
+	stopped.store(true);
+	if(thread.joinable()) thread.join();
+}
+
+void PhysicsDriver::runLoop() {
+	using namespace std::chrono;
+
+	steady_clock::time_point lastTime = steady_clock::now();
+	while(!stopped.load()) {
+		steady_clock::time_point curTime = steady_clock::now();
+		advance(duration<double>(curTime - lastTime).count());
+		lastTime = curTime;
+
+		double curSpeed = speed.load();
+		if(curSpeed > 0.0) {
+			double secondsUntilNextTick = (world.deltaT - accumulator.load()) / curSpeed;
+			if(secondsUntilNextTick > 0.0) {
+				std::this_thread::sleep_until(curTime + duration_cast<steady_clock::duration>(duration<double>(secondsUntilNextTick)));
+			}
+		} else {
+			std::this_thread::sleep_for(milliseconds(10));
+		}
+	}
+}
+
+void PhysicsDriver::runTick() {
+	if(traceRecorder != nullptr) traceRecorder->beginTick();
+	{
+		PhysicsZone tickZone(PhysicsProcess::OTHER);
+
+		if(onTickStart) onTickStart();
+		world.tick();
+		if(onTickEnd) onTickEnd();
+	}
+
+	if(physicsStatisticsEnabled) endPhysicsStatisticsTick();
+	if(traceRecorder != nullptr) traceRecorder->endTick();
+
+	std::lock_guard<std::mutex> lg(timingLock);
+	for(std::size_t i = 0; i < static_cast<std::size_t>(TickPhase::COUNT); i++) {
+		phaseTimeTotals[i] += world.lastTickPhaseTimes[i];
+	}
+	timedTickCount++;
+}
+
+std::size_t PhysicsDriver::advance(double realSeconds) {
+	double dt = world.deltaT;
+	double pending = accumulator.load() + realSeconds * speed.load();
+
+	std::size_t ticksRun = 0;
+	while(pending >= dt && ticksRun < maxSubstepsPerUpdate) {
+		runTick();
+		pending -= dt;
+		ticksRun++;
+	}
+
+	if(pending >= dt) {
+		std::size_t skipped = static_cast<std::size_t>(pending / dt);
+		Log::warn("Can't keep up! Skipping %d ticks!", static_cast<int>(skipped));
+		pending = std::fmod(pending, dt);
+
+		std::lock_guard<std::mutex> lg(timingLock);
+		droppedTickCount += skipped;
+	}
+
+	accumulator.store(pending);
+	return ticksRun;
+}
+
+void PhysicsDriver::getAveragePhaseTimes(PhaseTimes& result) const {
+	std::lock_guard<std::mutex> lg(timingLock);
+	for(std::size_t i = 0; i < static_cast<std::size_t>(TickPhase::COUNT); i++) {
+		if(timedTickCount != 0) {
+			result[i] = std::chrono::nanoseconds(phaseTimeTotals[i].count() / static_cast<std::chrono::nanoseconds::rep>(timedTickCount));
+		} else {
+			result[i] = std::chrono::nanoseconds(0);
+		}
+	}
+}
+
+std::size_t PhysicsDriver::getDroppedTickCount() const {
+	std::lock_guard<std::mutex> lg(timingLock);
+	return droppedTickCount;
+}
+
+void PhysicsDriver::resetTimings() {
+	std::lock_guard<std::mutex> lg(timingLock);
+	for(std::chrono::nanoseconds& total : phaseTimeTotals) {
+		total = std::chrono::nanoseconds(0);
+	}
+	timedTickCount = 0;
+	droppedTickCount = 0;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "jobSystem.h"
+#include "../world.h"
+#include "../misc/tickTrace.h"
+
+/*
+	Drives a world at a fixed tick rate
+
+	Real time is accumulated and paid out in ticks of world.deltaT. When ticks fall behind, at most maxSubstepsPerUpdate ticks
+	are run to catch up, the rest of the backlog is dropped. The narrowphase of each tick runs on a work stealing JobSystem.
+
+	Can either run on its own thread with start() and stop(), or be advanced manually with advance(), for headless use.
+*/
+class PhysicsDriver {
+public:
+	typedef std::chrono::nanoseconds PhaseTimes[static_cast<std::size_t>(TickPhase::COUNT)];
+
+private:
+	WorldPrototype& world;
+	JobSystem jobs;
+
+	std::thread thread;
+	std::atomic<bool> stopped{true};
+
+	std::atomic<double> speed{1.0};
+	std::size_t maxSubstepsPerUpdate;
+
+	// simulated seconds that have not been turned into ticks yet
+	std::atomic<double> accumulator{0.0};
+
+	mutable std::mutex timingLock;
+	PhaseTimes phaseTimeTotals{};
+	std::size_t timedTickCount = 0;
+	std::size_t droppedTickCount = 0;
+
+	void runLoop();
+
+public:
+	// optional hooks that run on the ticking thread around every tick
+	std::function<void()> onTickStart;
+	std::function<void()> onTickEnd;
+	// optional, gets every tick while it is recording, must be set before the driver starts
+	TickTraceRecorder* traceRecorder = nullptr;
+
+	PhysicsDriver(WorldPrototype& world, std::size_t maxSubstepsPerUpdate = 8, std::size_t workerCount = JobSystem::defaultWorkerCount());
+	~PhysicsDriver();
+
+	PhysicsDriver(const PhysicsDriver&) = delete;
+	PhysicsDriver& operator=(const PhysicsDriver&) = delete;
+
+	void start();
+	void stop();
+	bool isRunning() const { return !stopped.load(); }
+
+	// runs a single tick right now, must not be called while the driver is running
+	void runTick();
+
+	/*
+		Adds realSeconds of elapsed time and runs the ticks that became due, at most maxSubstepsPerUpdate
+		Returns the number of ticks that were run
+		Must not be called while the driver is running on its own thread
+	*/
+	std::size_t advance(double realSeconds);
+
+	// fraction of a tick that has accumulated since the last tick, to interpolate rendering between the last two ticks
+	double getInterpolationAlpha() const { return accumulator.load() / world.deltaT; }
+
+	double getTPS() const { return 1.0 / world.deltaT; }
+
+	// the workers of the narrowphase, other work of the program should run on them too instead of starting more threads
+	JobSystem& getJobSystem() { return jobs; }
+
+	void setSpeed(double newSpeed) { this->speed.store(newSpeed); }
+	double getSpeed() const { return this->speed.load(); }
+
+	/*
+		Average time spent in each TickPhase per tick since the last call to resetTimings()
+		Safe to call from any thread
+	*/
+	void getAveragePhaseTimes(PhaseTimes& result) const;
+	std::size_t getDroppedTickCount() const;
+	void resetTimings();
+};
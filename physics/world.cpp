@@ -80,6 +80,15 @@ static std::pair<int, int> pairLayers(int layer1, int layer2) {
 	}
 }
 
+bool WorldPrototype::hasOutdatedColissionProxies() const {
+	for(const ColissionLayer& layer : layers) {
+		for(const WorldLayer& subLayer : layer.subLayers) {
+			if(subLayer.colissionProxiesOutdated) return true;
+		}
+	}
+	return false;
+}
+
 bool WorldPrototype::doLayersCollide(int layer1, int layer2) const {
 	if(layer1 == layer2) {
 		return layers[layer1].collidesInternally;
@@ -159,7 +168,7 @@ void WorldPrototype::addPart(Part* part, int layerIndex) {
 	part->parent->mainPhysical->forEachPart([worldLayer](Part& p) {
 		p.layer = worldLayer;
 	});
-	worldLayer->tree.add(createNodeFor(part->parent->mainPhysical));
+	worldLayer->addNode(createNodeFor(part->parent->mainPhysical));
 
 
 	objectCount += part->parent->mainPhysical->getNumberOfPartsInThisAndChildren();
@@ -189,6 +198,8 @@ void WorldPrototype::addPhysicalWithExistingLayers(MotorizedPhysical* motorPhys)
 		l.layer->addNode(std::move(newNode));
 	}
 
+	objectCount += motorPhys->getNumberOfPartsInThisAndChildren();
+
 	ASSERT_VALID;
 }
 
@@ -234,6 +245,7 @@ void WorldPrototype::clear() {
 	for(ColissionLayer& cl : this->layers) {
 		for(WorldLayer& layer : cl.subLayers) {
 			layer.tree.clear();
+			layer.markColissionProxiesOutdated();
 		}
 	}
 	for(Part* p : partsToDelete) {
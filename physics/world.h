@@ -10,11 +10,40 @@
 #include "datastructures/iteratorEnd.h"
 #include "layer.h"
 #include "colissionBuffer.h"
+#include "misc/worldQuery.h"
+#include "misc/memoryUsage.h"
 
 #include <memory>
+#include <chrono>
+#include <cstdint>
 
 class ExternalForce;
 class WorldLayer;
+class JobSystem;
+
+/*
+	The phases of a tick, in the order they run
+	Every phase depends on the results of the previous one
+*/
+enum class TickPhase {
+	BROADPHASE,
+	NARROWPHASE,
+	RESPONSE,
+	CONSTRAINTS,
+	INTEGRATE,
+	REFIT,
+	COUNT
+};
+
+/*
+	Told about every TickPhase on the ticking thread, right before and right after the phase runs
+*/
+class TickPhaseListener {
+public:
+	virtual ~TickPhaseListener() {}
+	virtual void beginPhase(TickPhase phase) = 0;
+	virtual void endPhase(TickPhase phase) = 0;
+};
 
 template<bool IsConst>
 class WorldLayerIter {
@@ -154,6 +183,7 @@ private:
 	friend class Part;
 	friend class WorldLayer;
 	friend class ColissionLayer;
+	friend class WorldClonerPrototype;
 
 
 	/*
@@ -191,6 +221,10 @@ protected:
 	virtual void handleConstraints();
 	virtual void update();
 
+	// parts of findColissions
+	void findColissionCandidates();
+	void refineColissions();
+
 
 	// event handlers
 	virtual void onPartAdded(Part* newPart);
@@ -222,6 +256,37 @@ public:
 	size_t objectCount = 0;
 	double deltaT;
 
+	/*
+		If set, the narrowphase is spread over the workers of this job system
+		Results are identical to running without one
+	*/
+	JobSystem* jobSystem = nullptr;
+
+	// duration of each TickPhase during the last tick
+	std::chrono::nanoseconds lastTickPhaseTimes[static_cast<size_t>(TickPhase::COUNT)]{};
+	// not owned, the time it takes is not part of the phase times
+	TickPhaseListener* phaseListener = nullptr;
+
+	/*
+		If set, lastStateHash is set to computeStateHash() at the end of every tick
+		This rehashes every part each tick, O(parts). Every part the tick moves changes its hash, and the hash depends on the
+		order of the parts, so there is little to gain by keeping it up to date incrementally. It reads each part's cframe once,
+		about 20ns per part, under 1% of the tick of a world of 500 cubes.
+	*/
+	bool stateHashingEnabled = false;
+	std::uint64_t lastStateHash = 0;
+
+	/*
+		The parts of every MotorizedPhysical that the last tick integrated, filled by update(), lets SnapshotBuffer compare only these
+		Anything else that changes parts, such as Part::setCFrame or adding and removing parts, marks the colission proxies of a layer
+		outdated. lastTickMovedPartsComplete is false if that happened between the previous tick and this one
+	*/
+	std::vector<const Part*> lastTickMovedParts;
+	bool lastTickMovedPartsComplete = false;
+
+	// the scratch memory used by the last tick
+	TickMemoryUsage lastTickMemory;
+
 
 	WorldPrototype(double deltaT);
 	~WorldPrototype();
@@ -240,6 +305,9 @@ public:
 	virtual void removePart(Part* part);
 	void addTerrainPart(Part* part, int layerIndex = 0);
 
+	// true if parts were changed outside of a tick since the last refit, see lastTickMovedPartsComplete
+	bool hasOutdatedColissionProxies() const;
+
 	bool doLayersCollide(int layer1, int layer2) const;
 	void setLayersCollide(int layer1, int layer2, bool collide);
 
@@ -271,6 +339,41 @@ public:
 
 	virtual bool isValid() const;
 
+	/*
+		Hash of the motionOfCenterOfMass of every physical and the cframes of its parts, in the order of physicals
+		Worlds that simulated bit for bit identically have the same hash, see misc/stateHash.h
+		Terrain parts are not included, the simulation does not move them
+	*/
+	std::uint64_t computeStateHash() const;
+
+	/*
+		The bytes held by this world, per subsystem, defined in misc/memoryUsage.cpp
+		Walks all trees, parts and physicals, so it is meant to be called now and then, not every tick
+		Only reads the world, like the queries below
+	*/
+	MemoryUsage getMemoryUsage() const;
+
+	// stored in the PartSnapshot of part, worlds that know what their parts belong to can give it to the readers of snapshots
+	virtual std::uint64_t getSnapshotTag(const Part&) const { return 0; }
+
+	/*
+		Queries on the parts in the layers selected by mask, defined in misc/worldQuery.cpp
+		They walk the bounds trees of the layers and only read the world, so they may run concurrently with each other, but not with a tick or a modification
+	*/
+	// the closest part the ray hits within maxDistance
+	RaycastHit raycast(const Ray& ray, LayerMask mask = ALL_LAYERS, double maxDistance = INFINITY) const;
+	/*
+		Sets hits[i] to raycast(rays[i], mask, maxDistance), spread over the workers of jobSystem if it is set
+		Consecutive rays that start close together and go in the same octant traverse the trees as one packet, so sensors should pass their rays next to each other
+	*/
+	void raycastBatch(const Ray* rays, std::size_t rayCount, RaycastHit* hits, LayerMask mask = ALL_LAYERS, double maxDistance = INFINITY) const;
+	// appends the parts whose bounds intersect bounds
+	void overlapBounds(const Bounds& bounds, std::vector<Part*>& result, LayerMask mask = ALL_LAYERS) const;
+	// appends the parts that intersect shape placed at cframe
+	void overlapShape(const Shape& shape, const GlobalCFrame& cframe, std::vector<Part*>& result, LayerMask mask = ALL_LAYERS) const;
+	// appends the at most k parts with bounds closest to point and within maxDistance of it, closest first
+	void closestParts(const Position& point, std::size_t k, std::vector<Part*>& result, LayerMask mask = ALL_LAYERS, double maxDistance = INFINITY) const;
+
 	IteratorFactory<std::vector<MotorizedPhysical*>::iterator> iterPhysicals() { return IteratorFactory<std::vector<MotorizedPhysical*>::iterator>(physicals.begin(), physicals.end()); }
 	IteratorFactory<std::vector<MotorizedPhysical*>::const_iterator> iterPhysicals() const { return IteratorFactory<std::vector<MotorizedPhysical*>::const_iterator>(physicals.begin(), physicals.end()); }
 
@@ -330,6 +433,8 @@ public:
 		}
 		return total;
 	}
+	// returns a new copy of this force, used when worlds are cloned
+	virtual ExternalForce* clone() const = 0;
 };
 
 template<typename T = Part>
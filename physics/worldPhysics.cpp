@@ -8,20 +8,20 @@
 
 #include "misc/debug.h"
 #include "misc/physicsProfiler.h"
+#include "threading/jobSystem.h"
 #include "constants.h"
 #include "../util/log.h"
 
 #include <vector>
 #include <cmath>
 #include <algorithm>
-#include <thread>
-#include <mutex>
+#include <chrono>
 
 /*
 	exitVector is the distance p2 must travel so that the shapes are no longer colliding
 */
 void handleCollision(Part& part1, Part& part2, Position collisionPoint, Vec3 exitVector) {
-	Debug::logPoint(collisionPoint, Debug::INTERSECTION);
+	DEBUG_LOG_POINT(collisionPoint, Debug::INTERSECTION);
 	Physical& parent1 = *part1.parent;
 	Physical& parent2 = *part2.parent;
 
@@ -109,7 +109,7 @@ void handleCollision(Part& part1, Part& part2, Position collisionPoint, Vec3 exi
 	exitVector is the distance p2 must travel so that the shapes are no longer colliding
 */
 void handleTerrainCollision(Part& part1, Part& part2, Position collisionPoint, Vec3 exitVector) {
-	Debug::logPoint(collisionPoint, Debug::INTERSECTION);
+	DEBUG_LOG_POINT(collisionPoint, Debug::INTERSECTION);
 	Physical& parent1 = *part1.parent;
 	MotorizedPhysical& phys1 = *parent1.mainPhysical;
 
@@ -188,16 +188,21 @@ void WorldPrototype::tick() {
 	
 	findColissions();
 
-	physicsMeasure.mark(PhysicsProcess::EXTERNALS);
-	applyExternalForces();
+	{
+		PhysicsZone zone(PhysicsProcess::EXTERNALS);
+		applyExternalForces();
+	}
 
 	handleColissions();
 
-	intersectionStatistics.nextTally();
+	if(physicsStatisticsEnabled) intersectionStatistics.nextTally();
 	
 	handleConstraints();
 
 	update();
+
+	// a full pass over the parts, see stateHashingEnabled
+	if(stateHashingEnabled) lastStateHash = computeStateHash();
 }
 
 void WorldPrototype::applyExternalForces() {
@@ -228,40 +233,98 @@ static PartIntersection safeIntersects(const Part& p1, const Part& p2) {
 #endif
 }
 
-//Multithread.
-static void refineColission(std::vector<Colission>& colissions) {
-	
-	unsigned int threadCount = std::thread::hardware_concurrency();
-	std::vector<std::thread> threads;
-	std::mutex mt; 
+// colission pairs handed to a single narrowphase job
+#define NARROWPHASE_GRAIN_SIZE 32
 
-	for(size_t i = 0; i < colissions.size(); ) {
+/*
+	Records the time spent in one TickPhase into world.lastTickPhaseTimes, and tells the phaseListener of the world
+*/
+class PhaseTimer {
+	WorldPrototype& world;
+	TickPhase phase;
+	std::chrono::high_resolution_clock::time_point start;
+public:
+	PhaseTimer(WorldPrototype& world, TickPhase phase) : world(world), phase(phase) {
+		if(world.phaseListener != nullptr) world.phaseListener->beginPhase(phase);
+		start = std::chrono::high_resolution_clock::now();
+	}
+	~PhaseTimer() {
+		world.lastTickPhaseTimes[static_cast<size_t>(phase)] = std::chrono::high_resolution_clock::now() - start;
+		if(world.phaseListener != nullptr) world.phaseListener->endPhase(phase);
+	}
+};
+
+// returns the bytes of scratch memory it used
+static std::size_t refineColission(std::vector<Colission>& colissions, JobSystem* jobSystem) {
+	if(jobSystem == nullptr || jobSystem->getWorkerCount() == 0) {
+		for(size_t i = 0; i < colissions.size(); ) {
+			Colission& col = colissions[i];
+			PartIntersection result = safeIntersects(*col.p1, *col.p2);
+			if(result.intersects) {
+				if(physicsStatisticsEnabled) intersectionStatistics.addToTally(IntersectionResult::COLISSION, 1);
+				// add extra information
+
+				col.intersection = result.intersection;
+				col.exitVector = result.exitVector;
+				i++;
+			} else {
+				if(physicsStatisticsEnabled) intersectionStatistics.addToTally(IntersectionResult::GJK_REJECT, 1);
+				// remove if no colission
+				col = std::move(colissions.back());
+				colissions.pop_back();
+			}
+		}
+		return 0;
+	}
 
-		Colission& col = colissions[i];
-		PartIntersection result = safeIntersects(*col.p1, *col.p2);
+	// Intersect all pairs in parallel, then compact exactly like the serial path so the resulting order does not depend on the job system
+	std::vector<PartIntersection> results(colissions.size());
+	// the workers record into profiles of their own, as long as the ticking thread records at all
+	bool recordStatistics = physicsStatisticsEnabled;
+	jobSystem->parallelFor(colissions.size(), NARROWPHASE_GRAIN_SIZE, [&colissions, &results, recordStatistics](size_t begin, size_t end) {
+		PhysicsStatisticsDisabler noStatistics(!recordStatistics);
+		PhysicsZone zone(PhysicsProcess::NARROWPHASE);
+		for(size_t i = begin; i < end; i++) {
+			results[i] = safeIntersects(*colissions[i].p1, *colissions[i].p2);
+		}
+	});
+
+	for(size_t i = 0; i < colissions.size(); ) {
+		// results is kept in step with colissions, removed pairs are replaced by the last one in both
+		PartIntersection& result = results[i];
 		if(result.intersects) {
-			intersectionStatistics.addToTally(IntersectionResult::COLISSION, 1);
-			// add extra information
-				
-			col.intersection = result.intersection;
-			col.exitVector = result.exitVector;
-			i++;
+			if(physicsStatisticsEnabled) intersectionStatistics.addToTally(IntersectionResult::COLISSION, 1);
 
+			colissions[i].intersection = result.intersection;
+			colissions[i].exitVector = result.exitVector;
+			i++;
 		} else {
-			
-			intersectionStatistics.addToTally(IntersectionResult::GJK_REJECT, 1);
-			// remove if no colission
-			col = std::move(colissions.back());
+			if(physicsStatisticsEnabled) intersectionStatistics.addToTally(IntersectionResult::GJK_REJECT, 1);
+			colissions[i] = std::move(colissions.back());
 			colissions.pop_back();
+			results[i] = results.back();
+			results.pop_back();
 		}
 	}
-	
+	return results.capacity() * sizeof(PartIntersection);
 }
 
 void WorldPrototype::findColissions() {
-	physicsMeasure.mark(PhysicsProcess::COLISSION_OTHER);
+	findColissionCandidates();
+	refineColissions();
+}
+
+void WorldPrototype::findColissionCandidates() {
+	PhaseTimer timer(*this, TickPhase::BROADPHASE);
+	PhysicsZone zone(PhysicsProcess::COLISSION_OTHER);
 	curColissions.clear();
 
+	// the refit at the end of the previous tick left every layer up to date
+	lastTickMovedPartsComplete = !hasOutdatedColissionProxies();
+	for(ColissionLayer& layer : layers) {
+		layer.updateColissionProxiesIfOutdated();
+	}
+
 	for(const ColissionLayer& layer : layers) {
 		if(layer.collidesInternally) {
 			layer.getInternalColissions(curColissions);
@@ -271,13 +334,20 @@ void WorldPrototype::findColissions() {
 	for(std::pair<int, int> collidingLayers : colissionMask) {
 		getColissionsBetween(layers[collidingLayers.first], layers[collidingLayers.second], curColissions);
 	}
+}
 
-	refineColission(curColissions.freePartColissions);
-	refineColission(curColissions.freeTerrainColissions);
+void WorldPrototype::refineColissions() {
+	PhaseTimer timer(*this, TickPhase::NARROWPHASE);
+	PhysicsZone zone(PhysicsProcess::NARROWPHASE);
+	lastTickMemory.colissions = (curColissions.freePartColissions.size() + curColissions.freeTerrainColissions.size()) * sizeof(Colission);
+	std::size_t freePartScratch = refineColission(curColissions.freePartColissions, jobSystem);
+	std::size_t terrainScratch = refineColission(curColissions.freeTerrainColissions, jobSystem);
+	lastTickMemory.narrowphaseScratch = std::max(freePartScratch, terrainScratch);
 }
 
 void WorldPrototype::handleColissions() {
-	physicsMeasure.mark(PhysicsProcess::COLISSION_HANDLING);
+	PhaseTimer timer(*this, TickPhase::RESPONSE);
+	PhysicsZone zone(PhysicsProcess::COLISSION_HANDLING);
 	for (Colission c : curColissions.freePartColissions) {
 		handleCollision(*c.p1, *c.p2, c.intersection, c.exitVector);
 	}
@@ -286,19 +356,32 @@ void WorldPrototype::handleColissions() {
 	}
 }
 void WorldPrototype::handleConstraints() {
-	physicsMeasure.mark(PhysicsProcess::CONSTRAINTS);
+	PhaseTimer timer(*this, TickPhase::CONSTRAINTS);
+	PhysicsZone zone(PhysicsProcess::CONSTRAINTS);
+	std::size_t largestScratch = 0;
 	for (const ConstraintGroup& group : constraints) {
-		group.apply();
+		largestScratch = std::max(largestScratch, group.apply());
 	}
+	lastTickMemory.constraintScratch = largestScratch;
 }
 void WorldPrototype::update() {
-	physicsMeasure.mark(PhysicsProcess::UPDATING);
-	for (MotorizedPhysical* physical : iterPhysicals()) {
-		physical->update(this->deltaT);
+	PhysicsZone zone(PhysicsProcess::UPDATING);
+	{
+		PhaseTimer timer(*this, TickPhase::INTEGRATE);
+		lastTickMovedParts.clear();
+		for (MotorizedPhysical* physical : iterPhysicals()) {
+			physical->update(this->deltaT);
+			physical->forEachPart([this](const Part& part) {
+				lastTickMovedParts.push_back(&part);
+			});
+		}
 	}
 
-	for(ColissionLayer& layer : layers) {
-		layer.refresh();
+	{
+		PhaseTimer timer(*this, TickPhase::REFIT);
+		for(ColissionLayer& layer : layers) {
+			layer.refresh();
+		}
 	}
 	age++;
 
@@ -0,0 +1,135 @@
+#include "testsMain.h"
+
+#include "compare.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../benchmarks/benchmarkStatistics.h"
+
+#define ASSERT(x) ASSERT_STRICT(x)
+
+static BenchmarkSample makeSample(double runMillis) {
+	BenchmarkSample sample;
+	sample.initMillis = runMillis / 10.0;
+	sample.runMillis = runMillis;
+	for(std::int64_t& count : sample.counters.values) count = -1;
+	return sample;
+}
+
+static BenchmarkBaseline makeBaseline(double median, double mad) {
+	return BenchmarkBaseline{"bench", median, mad};
+}
+
+static BenchmarkSummary makeSummary(double median, double mad) {
+	std::vector<BenchmarkSample> samples{makeSample(median)};
+	BenchmarkSummary summary = summarizeBenchmark("bench", 0, samples);
+	summary.mad = mad;
+	return summary;
+}
+
+TEST_CASE(benchmarkSummaryPercentilesAndMAD) {
+	std::vector<BenchmarkSample> samples;
+	for(double runMillis : {5.0, 1.0, 3.0, 2.0, 4.0}) {
+		samples.push_back(makeSample(runMillis));
+		samples.back().workAmount = 10.0;
+		samples.back().workUnit = "parts";
+		samples.back().counters.values[static_cast<std::size_t>(PerfCounter::INSTRUCTIONS)] = static_cast<std::int64_t>(runMillis * 100);
+	}
+	// a counter that is missing in one sample is missing in the summary
+	samples[2].counters.values[static_cast<std::size_t>(PerfCounter::PAGE_FAULTS)] = 7;
+
+	BenchmarkSummary summary = summarizeBenchmark("bench", 2, samples);
+
+	ASSERT(summary.warmup == 2);
+	ASSERT(summary.samples.size() == 5);
+	ASSERT(summary.samples[0] == 5.0);
+	ASSERT(summary.median == 3.0);
+	ASSERT(summary.min == 1.0);
+	ASSERT(summary.max == 5.0);
+	// interpolated between the closest ranks, the 10th percentile of 5 samples lies at rank 0.4
+	ASSERT_TOLERANT(summary.p10 == 1.4, 1e-9);
+	ASSERT_TOLERANT(summary.p90 == 4.6, 1e-9);
+	// the deviations from the median are 2, 2, 1, 1 and 0
+	ASSERT(summary.mad == 1.0);
+	ASSERT_TOLERANT(summary.initMedian == 0.3, 1e-9);
+	// 10 parts in 3ms
+	ASSERT_TOLERANT(summary.throughput == 10.0 / 3.0 * 1000.0, 1e-6);
+	ASSERT_TRUE(summary.workUnit == "parts");
+	ASSERT(summary.counters[PerfCounter::INSTRUCTIONS] == 300);
+	ASSERT_FALSE(summary.counters.has(PerfCounter::PAGE_FAULTS));
+	ASSERT_FALSE(summary.counters.has(PerfCounter::CYCLES));
+}
+
+TEST_CASE(benchmarkSummaryMADIgnoresOutliers) {
+	std::vector<BenchmarkSample> samples;
+	for(double runMillis : {10.0, 10.0, 11.0, 9.0, 1000.0}) {
+		samples.push_back(makeSample(runMillis));
+	}
+
+	BenchmarkSummary summary = summarizeBenchmark("bench", 0, samples);
+
+	ASSERT(summary.median == 10.0);
+	ASSERT(summary.mad == 1.0);
+	ASSERT(summary.max == 1000.0);
+	ASSERT_TRUE(summary.workUnit.empty());
+	ASSERT(summary.throughput == 0.0);
+}
+
+TEST_CASE(benchmarkComparisonNeedsThresholdAndNoise) {
+	BenchmarkBaseline baseline = makeBaseline(100.0, 1.0);
+
+	// within 5% of the baseline
+	ASSERT_TRUE(compareToBaseline(makeSummary(104.0, 0.0), baseline, 5.0) == BenchmarkChange::SAME);
+	ASSERT_TRUE(compareToBaseline(makeSummary(96.0, 0.0), baseline, 5.0) == BenchmarkChange::SAME);
+	// beyond both 5% and 3 times the MADs of 1 and 1
+	ASSERT_TRUE(compareToBaseline(makeSummary(110.0, 1.0), baseline, 5.0) == BenchmarkChange::SLOWER);
+	ASSERT_TRUE(compareToBaseline(makeSummary(90.0, 1.0), baseline, 5.0) == BenchmarkChange::FASTER);
+	// beyond 5%, but a MAD of 3 makes the noise 12
+	ASSERT_TRUE(compareToBaseline(makeSummary(110.0, 3.0), baseline, 5.0) == BenchmarkChange::SAME);
+	// the noise of the baseline counts as well
+	ASSERT_TRUE(compareToBaseline(makeSummary(110.0, 1.0), makeBaseline(100.0, 3.0), 5.0) == BenchmarkChange::SAME);
+	// without a threshold only the noise decides
+	ASSERT_TRUE(compareToBaseline(makeSummary(107.0, 0.0), baseline, 0.0) == BenchmarkChange::SLOWER);
+}
+
+TEST_CASE(benchmarkJSONRoundTrip) {
+	std::vector<BenchmarkSummary> summaries;
+	std::vector<BenchmarkSample> samples{makeSample(2.5), makeSample(1.25), makeSample(2.0)};
+	samples[0].workAmount = samples[1].workAmount = samples[2].workAmount = 4.0;
+	samples[0].workUnit = samples[1].workUnit = samples[2].workUnit = "rays";
+	for(BenchmarkSample& sample : samples) {
+		sample.counters.values[static_cast<std::size_t>(PerfCounter::CYCLES)] = 12345;
+	}
+	summaries.push_back(summarizeBenchmark("world/parts:100", 1, samples));
+	summaries.push_back(summarizeBenchmark("quoted \"name\" \\ here", 0, std::vector<BenchmarkSample>{makeSample(0.123456789)}));
+
+	std::stringstream json;
+	writeBenchmarkJSON(json, summaries);
+	std::vector<BenchmarkBaseline> baseline = readBenchmarkBaseline(json);
+
+	ASSERT(baseline.size() == 2);
+	for(std::size_t i = 0; i < 2; i++) {
+		ASSERT_TRUE(baseline[i].name == summaries[i].name);
+		ASSERT_TOLERANT(baseline[i].median == summaries[i].median, 1e-9);
+		ASSERT_TOLERANT(baseline[i].mad == summaries[i].mad, 1e-9);
+	}
+
+	std::stringstream empty;
+	writeBenchmarkJSON(empty, std::vector<BenchmarkSummary>());
+	ASSERT(readBenchmarkBaseline(empty).size() == 0);
+}
+
+TEST_CASE(benchmarkBaselineRejectsMalformedFiles) {
+	for(const char* file : {"", "[]", "{\"benchmarks\":[{\"name\":\"a\",\"median\":}]}", "{\"benchmarks\":[{\"name\":\"a\""}) {
+		std::istringstream input(file);
+		bool failed = false;
+		try {
+			readBenchmarkBaseline(input);
+		} catch(const char*) {
+			failed = true;
+		}
+		ASSERT_TRUE(failed);
+	}
+}
@@ -6,6 +6,14 @@
 #include "../physics/misc/validityHelper.h"
 
 #include "../physics/datastructures/boundsTree.h"
+#include "../physics/datastructures/tripleBuffer.h"
+#include "../physics/misc/debug.h"
+#include "../physics/misc/threadProfiling.h"
+#include "../physics/misc/tickTrace.h"
+
+#include <sstream>
+
+#include <thread>
 
 TEST_CASE(testBoundsTreeGenerationValid) {
 	for(int iter = 0; iter < 1000; iter++) {
@@ -82,3 +90,156 @@ TEST_CASE(testMergeGroups) {
 		}
 	}
 }
+
+TEST_CASE(testTripleBufferHandover) {
+	TripleBuffer<int> buf;
+	ASSERT_FALSE(buf.update());
+
+	buf.getWriteBuffer() = 1;
+	buf.publish();
+	buf.getWriteBuffer() = 2;
+	buf.publish();
+
+	// only the newest published value reaches the reader
+	ASSERT_TRUE(buf.update());
+	ASSERT_STRICT(buf.getReadBuffer() == 2);
+	ASSERT_FALSE(buf.update());
+	ASSERT_STRICT(buf.getReadBuffer() == 2);
+
+	// the writer never gets the buffer the reader holds
+	for(int i = 3; i < 10; i++) {
+		buf.getWriteBuffer() = i;
+		ASSERT_STRICT(buf.getReadBuffer() == 2);
+	}
+	buf.publish();
+	ASSERT_TRUE(buf.update());
+	ASSERT_STRICT(buf.getReadBuffer() == 9);
+}
+
+enum class TestZone {
+	OUTER,
+	INNER,
+	COUNT
+};
+static const char* testZoneLabels[]{"Outer", "Inner"};
+
+TEST_CASE(testZoneProfilerMergesThreads) {
+	ZoneProfiler<TestZone> profiler(testZoneLabels, 10);
+	ThreadTally<long long, TestZone> tally(testZoneLabels, 10);
+
+	{
+		ProfileZone outer(profiler.getZoneID(TestZone::OUTER));
+		for(int i = 0; i < 2; i++) {
+			ProfileZone inner(profiler.getZoneID(TestZone::INNER));
+			tally.addToTally(TestZone::INNER, 1);
+		}
+	}
+	std::thread other([&profiler, &tally]() {
+		ProfileZone inner(profiler.getZoneID(TestZone::INNER));
+		tally.addToTally(TestZone::INNER, 5);
+	});
+	other.join();
+
+	profiler.endTick();
+	tally.nextTally();
+
+	// the inner zones of the other thread were not inside the outer zone
+	ProfileTree tree = profiler.getLastTick();
+	ASSERT_STRICT(tree.nodes.size() == 3);
+	int outer = tree.findOrAdd(-1, static_cast<int>(TestZone::OUTER));
+	int nestedInner = tree.findOrAdd(outer, static_cast<int>(TestZone::INNER));
+	int rootInner = tree.findOrAdd(-1, static_cast<int>(TestZone::INNER));
+	ASSERT_STRICT(tree.nodes.size() == 3);
+	ASSERT_STRICT(tree.nodes[outer].count == 1);
+	ASSERT_STRICT(tree.nodes[nestedInner].count == 2);
+	ASSERT_STRICT(tree.nodes[rootInner].count == 1);
+	ASSERT_TRUE(tree.nodes[nestedInner].time <= tree.nodes[outer].time);
+	ASSERT_STRICT(tally.history.front()[static_cast<size_t>(TestZone::INNER)] == 7);
+
+	// a merge only takes what was recorded since the previous one
+	profiler.endTick();
+	tally.nextTally();
+	ASSERT_STRICT(profiler.getLastTick().nodes.size() == 0);
+	ASSERT_STRICT(tally.history.front()[static_cast<size_t>(TestZone::INNER)] == 0);
+	ASSERT_STRICT(profiler.getTotal().nodes.size() == 3);
+	ASSERT_STRICT(profiler.getTotalTickCount() == 2);
+}
+
+TEST_CASE(testTickTraceRecordsZonesOfTicks) {
+	ZoneProfiler<TestZone> profiler(testZoneLabels, 10);
+	TickTraceRecorder recorder(10.0);
+
+	// zones before the recording are not part of the trace
+	{
+		ProfileZone before(profiler.getZoneID(TestZone::INNER));
+	}
+	recorder.start();
+	recorder.beginTick();
+	{
+		ProfileZone outer(profiler.getZoneID(TestZone::OUTER));
+	}
+	recorder.endTick();
+	recorder.stop();
+	profiler.endTick();
+
+	std::ostringstream trace;
+	recorder.write(trace);
+	std::string json = trace.str();
+	ASSERT_TRUE(json.find("\"traceEvents\"") != std::string::npos);
+	ASSERT_TRUE(json.find("\"Tick 0\"") != std::string::npos);
+	ASSERT_TRUE(json.find("\"Outer\"") != std::string::npos);
+	ASSERT_FALSE(json.find("\"Inner\"") != std::string::npos);
+}
+
+#if DEBUG_LOG_LEVEL > 0
+TEST_CASE(testDebugLogCollectsFromAllThreads) {
+	std::vector<Debug::LogEntry> log;
+	Debug::drainLog(log);
+	log.clear();
+
+	// nothing is recorded while logging is disabled
+	Debug::logPoint(Position(1.0, 2.0, 3.0), Debug::INFO_POINT);
+	Debug::drainLog(log);
+	ASSERT_STRICT(log.size() == 0);
+
+	Debug::setLogEnabled(true);
+	Debug::logVector(Position(0.0, 0.0, 0.0), Vec3(1.0, 0.0, 0.0), Debug::FORCE);
+	std::thread other([]() {
+		for(int i = 0; i < 10; i++) {
+			Debug::logPoint(Position(i, 0.0, 0.0), Debug::CENTER_OF_MASS);
+		}
+	});
+	other.join();
+	Debug::setLogEnabled(false);
+
+	Debug::drainLog(log);
+	ASSERT_STRICT(log.size() == 11);
+	int pointCount = 0;
+	for(const Debug::LogEntry& entry : log) {
+		if(entry.isPoint) {
+			ASSERT_STRICT(entry.type == Debug::CENTER_OF_MASS);
+			pointCount++;
+		} else {
+			ASSERT_STRICT(entry.type == Debug::FORCE);
+		}
+	}
+	ASSERT_STRICT(pointCount == 10);
+
+	// draining empties the rings
+	log.clear();
+	Debug::drainLog(log);
+	ASSERT_STRICT(log.size() == 0);
+}
+#else
+TEST_CASE(testDebugLogRecordsNothingWhenCompiledOut) {
+	Debug::setLogEnabled(true);
+	Debug::logVector(Position(0.0, 0.0, 0.0), Vec3(1.0, 0.0, 0.0), Debug::FORCE);
+	Debug::logPoint(Position(1.0, 2.0, 3.0), Debug::INFO_POINT);
+	Debug::setLogEnabled(false);
+
+	std::vector<Debug::LogEntry> log;
+	Debug::drainLog(log);
+	ASSERT_STRICT(log.size() == 0);
+	ASSERT_STRICT(Debug::getDroppedLogCount() == 0);
+}
+#endif
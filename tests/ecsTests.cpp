@@ -4,6 +4,9 @@
 #include "../engine/ecs/registry.h"
 #include "../util/intrusivePointer.h"
 
+#include <vector>
+#include <stdexcept>
+
 TEST_CASE(idGeneration) {
 	using namespace P3D::Engine;
 	Registry16 registry;
@@ -135,4 +138,211 @@ TEST_CASE(getFromView) {
 		intrusive_ptr<A> component = view.get<A>(entity);
 		ASSERT_TRUE(component->idx > 0 && component->idx < 4);
 	}
-}
\ No newline at end of file
+}
+
+TEST_CASE(generationalIds) {
+	using namespace P3D::Engine;
+	Registry64 registry;
+
+	struct A : public RefCountable {};
+
+	auto id1 = registry.create();
+	registry.add<A>(id1);
+	registry.destroy(id1);
+	auto id2 = registry.create();
+
+	ASSERT_FALSE(id2 == id1);
+	ASSERT_FALSE(registry.contains(id1));
+	ASSERT_TRUE(registry.contains(id2));
+	ASSERT_FALSE(registry.has<A>(id1));
+	ASSERT_FALSE(registry.has<A>(id2));
+	ASSERT_TRUE(registry.get<A>(id1) == nullptr);
+	ASSERT_TRUE(registry.add<A>(id1) == nullptr);
+}
+
+TEST_CASE(removeKeepsOtherComponents) {
+	using namespace P3D::Engine;
+	Registry64 registry;
+
+	struct A : public RefCountable {
+		int idx;
+		A(int idx) : idx(idx) {}
+	};
+
+	std::vector<Registry64::entity_type> ids;
+	for (int i = 0; i < 3000; i++) {
+		ids.push_back(registry.create());
+		registry.add<A>(ids.back(), i);
+	}
+
+	for (int i = 0; i < 3000; i += 3)
+		registry.remove<A>(ids[i]);
+	for (int i = 1; i < 3000; i += 3)
+		registry.destroy(ids[i]);
+
+	for (int i = 0; i < 3000; i++) {
+		Ref<A> component = registry.get<A>(ids[i]);
+		if (i % 3 == 2) {
+			ASSERT_TRUE(component != nullptr);
+			ASSERT_TRUE(component->idx == i);
+		} else {
+			ASSERT_TRUE(component == nullptr);
+		}
+	}
+}
+
+TEST_CASE(eachMatchesView) {
+	struct A : public RefCountable { int idx; A(int idx) : idx(idx) {} };
+	struct B : public RefCountable { int idx; B(int idx) : idx(idx) {} };
+
+	using namespace P3D::Engine;
+	Registry64 registry;
+	for (int i = 0; i < 100; i++) {
+		auto id = registry.create();
+		if (i % 2 == 0)
+			registry.add<A>(id, i);
+		if (i % 3 == 0)
+			registry.add<B>(id, i);
+	}
+
+	std::size_t viewCount = 0;
+	auto view = registry.view<A, B>();
+	for (auto entity : view) {
+		ASSERT_TRUE(view.get<A>(entity)->idx == view.get<B>(entity)->idx);
+		viewCount++;
+	}
+
+	std::size_t eachCount = 0;
+	std::size_t eachErrors = 0;
+	registry.each<A, B>([&eachCount, &eachErrors] (auto entity, A& a, B& b) {
+		if (a.idx != b.idx || a.idx % 6 != 0)
+			eachErrors++;
+		eachCount++;
+	});
+
+	std::size_t singleCount = 0;
+	std::size_t singleErrors = 0;
+	registry.each<A>([&registry, &singleCount, &singleErrors] (auto entity, A& a) {
+		if (registry.get<A>(entity).get() != &a)
+			singleErrors++;
+		singleCount++;
+	});
+
+	ASSERT_TRUE(viewCount == 17);
+	ASSERT_TRUE(eachCount == 17);
+	ASSERT_TRUE(singleCount == 50);
+	ASSERT_TRUE(eachErrors == 0);
+	ASSERT_TRUE(singleErrors == 0);
+}
+
+TEST_CASE(removeKeepsReferencesValid) {
+	using namespace P3D::Engine;
+	Registry64 registry;
+
+	struct A : public RefCountable {
+		int idx;
+		A(int idx) : idx(idx) {}
+	};
+
+	std::vector<Registry64::entity_type> ids;
+	for (int i = 0; i < 3; i++) {
+		ids.push_back(registry.create());
+		registry.add<A>(ids.back(), i);
+	}
+
+	Ref<A> last = registry.get<A>(ids[2]);
+	Ref<A> removed = registry.get<A>(ids[0]);
+	A* lastAddress = last.get();
+
+	registry.remove<A>(ids[0]);
+	registry.destroy(ids[1]);
+
+	// the component of the last entity is not moved into the holes
+	ASSERT_TRUE(last->idx == 2);
+	ASSERT_TRUE(registry.get<A>(ids[2]).get() == lastAddress);
+
+	// a referenced component is not reused by a new one
+	auto id = registry.create();
+	registry.add<A>(id, 3);
+	ASSERT_TRUE(removed->idx == 0);
+	ASSERT_TRUE(registry.get<A>(id).get() != removed.get());
+	ASSERT_TRUE(registry.get<A>(id)->idx == 3);
+
+	std::size_t eachCount = 0;
+	registry.each<A>([&eachCount] (auto entity, A& a) {
+		eachCount++;
+	});
+	ASSERT_TRUE(eachCount == 2);
+}
+
+TEST_CASE(componentGenerationTracksAddAndRemove) {
+	using namespace P3D::Engine;
+	Registry64 registry;
+
+	struct A : public RefCountable {
+		int idx;
+		A(int idx) : idx(idx) {}
+	};
+
+	ASSERT_TRUE(registry.getComponentGeneration<A>() == 0);
+
+	auto first = registry.create();
+	auto second = registry.create();
+	registry.add<A>(first, 0);
+	std::size_t afterAdd = registry.getComponentGeneration<A>();
+	ASSERT_TRUE(afterAdd != 0);
+
+	// replaced in place, a cached pointer still sees the new component
+	A* cached = registry.get<A>(first).get();
+	registry.add<A>(first, 1);
+	ASSERT_TRUE(registry.getComponentGeneration<A>() == afterAdd);
+	ASSERT_TRUE(cached->idx == 1);
+
+	registry.add<A>(second, 2);
+	std::size_t afterSecondAdd = registry.getComponentGeneration<A>();
+	ASSERT_TRUE(afterSecondAdd != afterAdd);
+
+	registry.destroy(first);
+	ASSERT_TRUE(registry.getComponentGeneration<A>() != afterSecondAdd);
+
+	// a reused id keeps its index
+	auto reused = registry.create();
+	ASSERT_TRUE(reused != first);
+	ASSERT_TRUE(Registry64::getIndex(reused) == Registry64::getIndex(first));
+}
+
+/*
+	Fills a registry with capacity entities, returns whether the next create throws while every id still refers to its own entity,
+	and whether destroying one entity makes room for another
+*/
+template<typename Registry>
+static bool holdsExactly(std::size_t capacity) {
+	Registry registry;
+	std::vector<typename Registry::entity_type> ids;
+	for (std::size_t i = 0; i < capacity; i++)
+		ids.push_back(registry.create());
+
+	bool threw = false;
+	try {
+		static_cast<void>(registry.create());
+	} catch (const std::length_error&) {
+		threw = true;
+	}
+	if (!threw)
+		return false;
+
+	for (auto id : ids)
+		if (!registry.contains(id))
+			return false;
+
+	registry.destroy(ids[1]);
+	auto reused = registry.create();
+
+	return registry.contains(reused) && registry.contains(ids.front()) && registry.contains(ids.back());
+}
+
+TEST_CASE(createStopsAtIndexCapacity) {
+	using namespace P3D::Engine;
+	ASSERT_TRUE(holdsExactly<Registry16>(0xFF));
+	ASSERT_TRUE(holdsExactly<Registry32>(0xFFFF));
+}
@@ -11,13 +11,24 @@
 #include "../physics/math/boundingBox.h"
 
 #include "../physics/geometry/shape.h"
+#include "../physics/geometry/shapeCreation.h"
+#include "../physics/geometry/builtinShapeClasses.h"
+#include "../physics/geometry/triangleMeshShapeClass.h"
+#include "../physics/geometry/heightfieldShapeClass.h"
 
 #include "../physics/misc/shapeLibrary.h"
+#include "../physics/misc/shapeClassCache.h"
+#include "../physics/misc/sha256.h"
 
 #include "testValues.h"
 #include "generators.h"
 
 #include "../util/cpuid.h"
+#include "../util/serializeBasicTypes.h"
+
+#include <sstream>
+#include <string>
+#include <cstring>
 
 #define ASSERT(condition) ASSERT_TOLERANT(condition, 0.00001)
 
@@ -258,3 +269,159 @@ TEST_CASE(testTriangleMeshOptimizedFurthestInDirection) {
 		}
 	}
 }
+
+TEST_CASE(identicalPolyhedraShareShapeClass) {
+	ShapeClassCache cache;
+	const PolyhedronShapeClass* icosa1 = cache.getPolyhedronClass(Polyhedron(Library::icosahedron));
+	const PolyhedronShapeClass* icosa2 = cache.getPolyhedronClass(Polyhedron(Library::icosahedron));
+	const PolyhedronShapeClass* house = cache.getPolyhedronClass(Polyhedron(Library::house));
+
+	ASSERT_TRUE(icosa1 == icosa2);
+	ASSERT_TRUE(icosa1 != house);
+	ASSERT_STRICT(cache.getClassCount() == 2);
+	ASSERT_STRICT(cache.getComputedCount() == 2);
+
+	ASSERT_TRUE(polyhedronShape(Library::house).baseShape == polyhedronShape(Library::house).baseShape);
+}
+
+TEST_CASE(shapeClassCacheReusesSavedDerivedData) {
+	std::stringstream stream;
+	double houseVolume;
+	{
+		ShapeClassCache cache;
+		houseVolume = cache.getPolyhedronClass(Polyhedron(Library::house))->volume;
+		cache.serializeDerivedData(stream);
+	}
+
+	ShapeClassCache loadedCache;
+	loadedCache.deserializeDerivedData(stream);
+	const PolyhedronShapeClass* house = loadedCache.getPolyhedronClass(Polyhedron(Library::house));
+
+	ASSERT_STRICT(loadedCache.getComputedCount() == 0);
+	ASSERT_STRICT(house->volume == houseVolume);
+	ASSERT(house->inertia.toMatrix() == Polyhedron(Library::house).getScalableInertiaAroundCenterOfMass().toMatrix());
+}
+
+TEST_CASE(shapeClassCacheRejectsCorruptDerivedData) {
+	std::stringstream stream;
+	{
+		ShapeClassCache cache;
+		cache.getPolyhedronClass(Polyhedron(Library::house));
+		cache.serializeDerivedData(stream);
+	}
+	std::string file = stream.str();
+
+	// the volume follows the version, the entry count, the mesh digest and the two counts
+	std::size_t volumeOffset = sizeof(int) + sizeof(std::uint64_t) + sizeof(SHA256::Digest) + 2 * sizeof(int);
+	double corruptVolume = 1234.5;
+	std::memcpy(&file[volumeOffset], &corruptVolume, sizeof(double));
+
+	std::istringstream corruptStream(file);
+	ShapeClassCache loadedCache;
+	bool rejected = false;
+	try {
+		loadedCache.deserializeDerivedData(corruptStream);
+	} catch(SerializationException&) {
+		rejected = true;
+	}
+	ASSERT_TRUE(rejected);
+
+	const PolyhedronShapeClass* house = loadedCache.getPolyhedronClass(Polyhedron(Library::house));
+	ASSERT_STRICT(loadedCache.getComputedCount() == 1);
+	ASSERT_STRICT(house->volume == Polyhedron(Library::house).getVolume());
+}
+
+static std::string toHex(const SHA256::Digest& digest) {
+	static const char digits[] = "0123456789abcdef";
+	std::string result;
+	for(std::uint8_t byte : digest) {
+		result += digits[byte >> 4];
+		result += digits[byte & 0xF];
+	}
+	return result;
+}
+
+TEST_CASE(sha256MatchesReferenceDigests) {
+	ASSERT_TRUE(toHex(SHA256::hash("", 0)) == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+	ASSERT_TRUE(toHex(SHA256::hash("abc", 3)) == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+	// 56 bytes, the length no longer fits in the block of the padding
+	const char* twoBlocks = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+	ASSERT_TRUE(toHex(SHA256::hash(twoBlocks, 56)) == "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+	// added in pieces that straddle the blocks
+	std::string million(1000000, 'a');
+	SHA256 hasher;
+	for(std::size_t offset = 0; offset < million.size(); offset += 999) {
+		hasher.add(million.data() + offset, std::min<std::size_t>(999, million.size() - offset));
+	}
+	ASSERT_TRUE(toHex(hasher.finish()) == "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+
+static Vec3f minOf(Vec3f a, Vec3f b) {
+	return Vec3f(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z));
+}
+static Vec3f maxOf(Vec3f a, Vec3f b) {
+	return Vec3f(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z));
+}
+
+TEST_CASE(triangleMeshBVHMatchesBruteForce) {
+	for(int iter = 0; iter < 50; iter++) {
+		TriangleMesh mesh = generateTriangleMesh();
+		TriangleMeshShapeClass meshClass(mesh);
+		const TriangleMesh& orderedMesh = meshClass.getMesh();
+		ASSERT_STRICT(orderedMesh.triangleCount == mesh.triangleCount);
+
+		for(int i = 0; i < 20; i++) {
+			Vec3f origin = generateVec3f() * 2.0f - Vec3f(1.0f, 1.0f, 1.0f);
+			Vec3f direction = generateVec3f() - Vec3f(1.0f, 1.0f, 1.0f);
+			ASSERT_STRICT(float(meshClass.getIntersectionDistance(Vec3(origin), Vec3(direction))) == orderedMesh.getIntersectionDistance(origin, direction));
+
+			Vec3f a = generateVec3f();
+			Vec3f b = generateVec3f();
+			BoundingBoxTemplate<float> query(minOf(a, b), maxOf(a, b));
+			std::vector<bool> found(orderedMesh.triangleCount, false);
+			meshClass.getBVH().forEachTriangleIn(query, [&found](int triangleIndex) {
+				found[triangleIndex] = true;
+			});
+			for(int t = 0; t < orderedMesh.triangleCount; t++) {
+				Triangle triangle = orderedMesh.getTriangle(t);
+				Vec3f v0 = orderedMesh.getVertex(triangle.firstIndex);
+				Vec3f v1 = orderedMesh.getVertex(triangle.secondIndex);
+				Vec3f v2 = orderedMesh.getVertex(triangle.thirdIndex);
+				BoundingBoxTemplate<float> triangleBounds(minOf(v0, minOf(v1, v2)), maxOf(v0, maxOf(v1, v2)));
+				if(triangleBounds.intersects(query)) {
+					ASSERT_TRUE(found[t]);
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE(heightfieldRayWalkMatchesBruteForce) {
+	int columnCount = 23;
+	int rowCount = 17;
+	std::vector<std::uint16_t> heights(columnCount * rowCount);
+	for(std::uint16_t& height : heights) {
+		height = generateInt(HeightfieldShapeClass::MAX_SAMPLE + 1);
+	}
+	HeightfieldShapeClass heightfield(std::move(heights), columnCount, rowCount);
+	Polyhedron surface = heightfield.asPolyhedron();
+
+	for(int i = 0; i < 500; i++) {
+		Vec3f origin = generateVec3f() * 2.0f - Vec3f(1.0f, 1.0f, 1.0f);
+		origin.y += 2.0f;
+		Vec3f direction = generateVec3f() - Vec3f(1.0f, 1.0f, 1.0f);
+		if(i % 10 == 0) direction = Vec3f(0.0f, -1.0f, 0.0f);
+
+		float expected = surface.getIntersectionDistance(origin, direction);
+		double found = heightfield.getIntersectionDistance(Vec3(origin), Vec3(direction));
+		if(expected == INFINITY) {
+			ASSERT_TRUE(found == INFINITY);
+		} else {
+			ASSERT(found == expected);
+			Vec3f hit = origin + direction * expected;
+			ASSERT_TRUE(heightfield.containsPoint(Vec3(hit - Vec3f(0.0f, 0.001f, 0.0f))));
+			ASSERT_FALSE(heightfield.containsPoint(Vec3(hit + Vec3f(0.0f, 0.001f, 0.0f))));
+		}
+	}
+}
@@ -8,6 +8,8 @@
 
 #include "../physics/math/mathUtil.h"
 #include "../physics/math/linalg/trigonometry.h"
+#include "../physics/threading/jobSystem.h"
+#include "../graphics/batch/renderList.h"
 
 #include <string>
 #include <vector>
@@ -25,3 +27,58 @@ TEST_CASE(transformationTest) {
 
 	ASSERT_TOLERANT(point == transformedBack, 0.000001);
 }
+
+TEST_CASE(renderListGroupsMeshesAndSortsTransparents) {
+	using namespace P3D::Graphics;
+
+	struct Item {
+		int mesh;
+		float depth;
+		bool transparent;
+		int value;
+	};
+
+	// enough items for several chunks, with meshes and transparents mixed
+	std::vector<Item> items;
+	for(int i = 0; i < 3000; i++) {
+		items.push_back(Item{(i * 7) % 5, float((i * 37) % 1000), i % 9 == 0, i});
+	}
+
+	JobSystem jobs(3);
+	RenderListBuilder<int> builder;
+	RenderList<int> serialList;
+	RenderList<int> parallelList;
+	auto makeUniform = [](const Item& item) { return item.value; };
+	builder.build(items, makeUniform, nullptr, serialList);
+	builder.build(items, makeUniform, &jobs, parallelList);
+
+	ASSERT_TRUE(serialList.instances == parallelList.instances);
+	ASSERT_STRICT(serialList.transparents.size() == parallelList.transparents.size());
+	for(std::size_t i = 0; i < serialList.transparents.size(); i++) {
+		ASSERT_STRICT(serialList.transparents[i].uniform == parallelList.transparents[i].uniform);
+	}
+
+	// every mesh is one contiguous range, holding its opaque items in order
+	ASSERT_STRICT(parallelList.meshRanges.size() == 5);
+	std::size_t opaqueCount = 0;
+	for(const RenderList<int>::MeshRange& range : parallelList.meshRanges) {
+		ASSERT_STRICT(range.first == opaqueCount);
+		opaqueCount += range.count;
+		for(std::size_t i = range.first; i < range.first + range.count; i++) {
+			const Item& item = items[parallelList.instances[i]];
+			ASSERT_STRICT(item.mesh == range.mesh);
+			ASSERT_FALSE(item.transparent);
+			if(i > range.first) ASSERT_TRUE(parallelList.instances[i - 1] < parallelList.instances[i]);
+		}
+	}
+	ASSERT_STRICT(opaqueCount == parallelList.instances.size());
+
+	// transparents are drawn back to front
+	ASSERT_STRICT(opaqueCount + parallelList.transparents.size() == items.size());
+	for(std::size_t i = 0; i < parallelList.transparents.size(); i++) {
+		const RenderList<int>::TransparentDraw& draw = parallelList.transparents[i];
+		ASSERT_TRUE(items[draw.item].transparent);
+		ASSERT_STRICT(draw.uniform == items[draw.item].value);
+		if(i > 0) ASSERT_TRUE(parallelList.transparents[i - 1].depth >= draw.depth);
+	}
+}
@@ -0,0 +1,127 @@
+#include "testsMain.h"
+
+#include "compare.h"
+#include "../physics/misc/toString.h"
+
+#include <sstream>
+#include <string>
+
+#include "../physics/math/linalg/vec.h"
+#include "../physics/geometry/triangleMesh.h"
+#include "../graphics/visualShape.h"
+#include "../engine/io/import.h"
+
+#define ASSERT(x) ASSERT_STRICT(x)
+
+using namespace P3D;
+
+static Graphics::VisualShape loadString(const std::string& content, bool binary) {
+	std::istringstream stream(content);
+	return OBJImport::load(stream, binary);
+}
+
+// the parsers report invalid files by throwing a message
+static bool failsToLoad(const std::string& content, bool binary) {
+	try {
+		loadString(content, binary);
+	} catch(const char*) {
+		return true;
+	}
+	return false;
+}
+
+template<typename T>
+static void appendBinary(std::string& file, const T& value) {
+	file.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// a binary OBJ file of a single triangle with uvs
+static std::string makeBinaryTriangle(Triangle triangle) {
+	std::string file;
+	appendBinary(file, char(2));
+	appendBinary(file, 3);
+	appendBinary(file, 1);
+	appendBinary(file, Vec3f(0.0f, 0.0f, 0.0f));
+	appendBinary(file, Vec3f(1.0f, 0.0f, 0.0f));
+	appendBinary(file, Vec3f(0.0f, 1.0f, 0.0f));
+	appendBinary(file, Vec2f(0.0f, 0.0f));
+	appendBinary(file, Vec2f(1.0f, 0.0f));
+	appendBinary(file, Vec2f(0.0f, 1.0f));
+	appendBinary(file, triangle);
+	return file;
+}
+
+TEST_CASE(textObjSplitsPolygonsIntoTriangles) {
+	Graphics::VisualShape shape = loadString("v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nvn 0 0 1\nf 1//1 2//1 3//1 4//1\n", false);
+
+	ASSERT(shape.vertexCount == 4);
+	ASSERT(shape.triangleCount == 2);
+	ASSERT(shape.getVertex(2) == Vec3f(1.0f, 1.0f, 0.0f));
+	ASSERT_TRUE(shape.getTriangle(1) == (Triangle{0, 2, 3}));
+	ASSERT(shape.normals[3] == Vec3f(0.0f, 0.0f, 1.0f));
+}
+
+TEST_CASE(textObjRejectsInvalidFaces) {
+	ASSERT_TRUE(failsToLoad("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 4\n", false));
+	ASSERT_TRUE(failsToLoad("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1/1 2/1 3/1\n", false));
+	ASSERT_TRUE(failsToLoad("v 0 0 0\nv 1 0 0\nf 1 2\n", false));
+}
+
+TEST_CASE(textObjParsesLargeFilesInChunks) {
+	// large enough to be split into several chunks, which are parsed on the shared workers
+	std::string file;
+	int quadCount = 40000;
+	for(int i = 0; i < quadCount; i++) {
+		file += "v " + std::to_string(i) + " 0 0\nv " + std::to_string(i) + " 1 0\n";
+	}
+	for(int i = 1; i < quadCount; i++) {
+		file += "f " + std::to_string(2 * i - 1) + " " + std::to_string(2 * i + 1) + " " + std::to_string(2 * i + 2) + " " + std::to_string(2 * i) + "\n";
+	}
+
+	// the second import reuses the workers of the first
+	for(int repeat = 0; repeat < 2; repeat++) {
+		Graphics::VisualShape shape = loadString(file, false);
+
+		ASSERT(shape.vertexCount == 2 * quadCount);
+		ASSERT(shape.triangleCount == 2 * (quadCount - 1));
+		ASSERT(shape.getVertex(2 * quadCount - 1) == Vec3f(float(quadCount - 1), 1.0f, 0.0f));
+		ASSERT_TRUE(shape.getTriangle(2 * quadCount - 3) == (Triangle{2 * quadCount - 4, 2 * quadCount - 1, 2 * quadCount - 3}));
+	}
+}
+
+TEST_CASE(binaryObjLoadsTriangle) {
+	Graphics::VisualShape shape = loadString(makeBinaryTriangle(Triangle{0, 1, 2}), true);
+
+	ASSERT(shape.vertexCount == 3);
+	ASSERT(shape.triangleCount == 1);
+	ASSERT(shape.getVertex(1) == Vec3f(1.0f, 0.0f, 0.0f));
+	ASSERT_TRUE(shape.getTriangle(0) == (Triangle{0, 1, 2}));
+	ASSERT(shape.uvs[2] == Vec2f(0.0f, 1.0f));
+	ASSERT_TOLERANT(shape.tangents[0] == Vec3f(1.0f, 0.0f, 0.0f), 0.0001f);
+}
+
+TEST_CASE(binaryObjRejectsTruncatedFiles) {
+	std::string file = makeBinaryTriangle(Triangle{0, 1, 2});
+
+	for(std::size_t size : {std::size_t(0), std::size_t(5), file.size() - sizeof(Triangle), file.size() - 1}) {
+		ASSERT_TRUE(failsToLoad(file.substr(0, size), true));
+	}
+}
+
+TEST_CASE(binaryObjRejectsOutOfRangeInput) {
+	ASSERT_TRUE(failsToLoad(makeBinaryTriangle(Triangle{0, 1, 3}), true));
+	ASSERT_TRUE(failsToLoad(makeBinaryTriangle(Triangle{-1, 1, 2}), true));
+
+	std::string negativeCount;
+	appendBinary(negativeCount, char(0));
+	appendBinary(negativeCount, -3);
+	appendBinary(negativeCount, 1);
+	ASSERT_TRUE(failsToLoad(negativeCount, true));
+
+	// counts that are far larger than the file must fail before anything is allocated for them
+	std::string hugeCount;
+	appendBinary(hugeCount, char(0));
+	appendBinary(hugeCount, 0x7FFFFFFF);
+	appendBinary(hugeCount, 0x7FFFFFFF);
+	ASSERT_TRUE(failsToLoad(hugeCount, true));
+}
@@ -6,9 +6,14 @@
 #include "../physics/geometry/indexedShape.h"
 #include "../physics/geometry/shapeBuilder.h"
 #include "../physics/geometry/convexShapeBuilder.h"
+#include "../physics/geometry/quickHull.h"
+#include "../physics/threading/jobSystem.h"
 #include "../physics/misc/shapeLibrary.h"
 #include "../physics/misc/validityHelper.h"
 
+#include <random>
+#include <vector>
+
 TEST_CASE(testIndexedShape) {
 	Vec3f verts[]{Vec3f(0.0, 0.0, 0.0), Vec3f(1.0, 0.0, 0.0), Vec3f(0.0, 0.0, 1.0), Vec3f(0.0, 1.0, 0.0)};
 	Triangle triangles[]{{0,1,2},{0,3,1},{0,2,3},{1,3,2}};
@@ -89,3 +94,78 @@ TEST_CASE(buildConvexShape) {
 
 	ASSERT_TRUE(isValid(icosaBuilder.toIndexedShape()));
 }
+
+static std::vector<Vec3f> generateSpherePoints(int count, unsigned int seed) {
+	std::mt19937 generator(seed);
+	std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+	std::vector<Vec3f> result;
+	while(result.size() < count) {
+		Vec3f point(distribution(generator), distribution(generator), distribution(generator));
+		if(lengthSquared(point) <= 1.0f) result.push_back(point);
+	}
+	return result;
+}
+
+static bool isBelowAllTriangles(const Polyhedron& hull, const std::vector<Vec3f>& points) {
+	for(Triangle triangle : hull.iterTriangles()) {
+		Vec3f v0 = hull.getVertex(triangle[0]);
+		Vec3f normal = normalize(hull.getNormalVecOfTriangle(triangle));
+		for(Vec3f point : points) {
+			if((point - v0) * normal > 0.0001f) return false;
+		}
+	}
+	return true;
+}
+
+TEST_CASE(quickHullOfCubeWithInnerPoints) {
+	std::vector<Vec3f> points;
+	for(int x = -2; x <= 2; x++) {
+		for(int y = -2; y <= 2; y++) {
+			for(int z = -2; z <= 2; z++) {
+				// includes points on the faces and edges of the cube
+				points.push_back(Vec3f(x * 0.5f, y * 0.5f, z * 0.5f));
+			}
+		}
+	}
+
+	QuickHull hull;
+	hull.build(points.data(), static_cast<int>(points.size()));
+	std::vector<TriangleNeighbors> neighbors(hull.getTriangleCount());
+	IndexedShape shape = hull.toIndexedShape(neighbors.data());
+
+	ASSERT_TRUE(isValid(shape));
+	ASSERT_STRICT(shape.vertexCount == 8);
+	ASSERT_STRICT(shape.triangleCount == 12);
+	ASSERT_TOLERANT(shape.getVolume() == 8.0, 0.0001);
+}
+
+TEST_CASE(quickHullContainsAllPoints) {
+	std::vector<Vec3f> points = generateSpherePoints(5000, 42);
+
+	Polyhedron hull = convexHull(points.data(), static_cast<int>(points.size()));
+	ASSERT_TRUE(isValid(hull));
+	ASSERT_TRUE(isBelowAllTriangles(hull, points));
+
+	Polyhedron reducedHull = convexHull(points.data(), static_cast<int>(points.size()), 32);
+	ASSERT_TRUE(isValid(reducedHull));
+	ASSERT_TRUE(reducedHull.vertexCount <= 32);
+	ASSERT_TRUE(reducedHull.getVolume() <= hull.getVolume());
+}
+
+TEST_CASE(parallelQuickHullsMatchSerial) {
+	std::vector<std::vector<Vec3f>> pointClouds;
+	for(unsigned int i = 0; i < 16; i++) {
+		pointClouds.push_back(generateSpherePoints(200 + i * 50, i));
+	}
+
+	JobSystem jobSystem(2);
+	std::vector<Polyhedron> hulls = convexHulls(pointClouds, jobSystem, 64);
+
+	ASSERT_STRICT(hulls.size() == pointClouds.size());
+	for(std::size_t i = 0; i < pointClouds.size(); i++) {
+		Polyhedron serialHull = convexHull(pointClouds[i].data(), static_cast<int>(pointClouds[i].size()), 64);
+		ASSERT_STRICT(hulls[i].vertexCount == serialHull.vertexCount);
+		ASSERT_STRICT(hulls[i].triangleCount == serialHull.triangleCount);
+		ASSERT_TRUE(isValid(hulls[i]));
+	}
+}
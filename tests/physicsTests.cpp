@@ -7,14 +7,22 @@
 
 #define _USE_MATH_DEFINES
 #include <math.h>
+#include <algorithm>
 
 #include "../physics/world.h"
+#include "../physics/threading/jobSystem.h"
+#include "../physics/misc/stateHash.h"
+#include "../physics/misc/worldClone.h"
+#include "../physics/misc/worldSnapshot.h"
 #include "../physics/inertia.h"
 #include "../physics/misc/shapeLibrary.h"
 #include "../physics/math/linalg/trigonometry.h"
 #include "../physics/math/linalg/eigen.h"
 #include "../physics/geometry/shape.h"
+#include "../physics/geometry/shapeClass.h"
 #include "../physics/geometry/shapeCreation.h"
+#include "../physics/geometry/triangleMesh.h"
+#include "../physics/geometry/intersection.h"
 #include "../physics/externalforces/gravityForce.h"
 #include "../physics/hardconstraints/motorConstraint.h"
 #include "../physics/hardconstraints/sinusoidalPistonConstraint.h"
@@ -1039,3 +1047,540 @@ TEST_CASE(setVelocity) {
 		}
 	}
 }
+
+TEST_CASE(parallelNarrowphaseMatchesSerial) {
+	JobSystem jobs(3);
+
+	WorldPrototype serialWorld(DELTA_T);
+	WorldPrototype parallelWorld(DELTA_T);
+	parallelWorld.jobSystem = &jobs;
+
+	std::vector<Part> serialParts;
+	std::vector<Part> parallelParts;
+	serialParts.reserve(64);
+	parallelParts.reserve(64);
+	for(int i = 0; i < 64; i++) {
+		GlobalCFrame cframe(i % 4 * 0.9, 0.6 + i / 16 * 0.9, i / 4 % 4 * 0.9, Rotation::fromEulerAngles(0.1 * i, 0.2, 0.0));
+		serialParts.emplace_back(boxShape(1.0, 1.0, 1.0), cframe, basicProperties);
+		parallelParts.emplace_back(boxShape(1.0, 1.0, 1.0), cframe, basicProperties);
+	}
+	Part serialFloor(boxShape(20.0, 0.3, 20.0), GlobalCFrame(0.0, 0.0, 0.0), basicProperties);
+	Part parallelFloor(boxShape(20.0, 0.3, 20.0), GlobalCFrame(0.0, 0.0, 0.0), basicProperties);
+
+	for(WorldPrototype* world : {&serialWorld, &parallelWorld}) {
+		world->addExternalForce(new DirectionalGravity(Vec3(0, -10, 0)));
+	}
+	for(int i = 0; i < 64; i++) {
+		serialWorld.addPart(&serialParts[i]);
+		parallelWorld.addPart(&parallelParts[i]);
+	}
+	serialWorld.addTerrainPart(&serialFloor);
+	parallelWorld.addTerrainPart(&parallelFloor);
+
+	for(int i = 0; i < 100; i++) {
+		serialWorld.tick();
+		parallelWorld.tick();
+	}
+
+	for(int i = 0; i < 64; i++) {
+		ASSERT_STRICT(serialParts[i].getPosition() == parallelParts[i].getPosition());
+	}
+}
+
+// checks that the leaves below node point at consecutive proxies in tree order, starting at nextIndex
+static bool leavesIndexProxiesInTreeOrder(const TreeNode& node, const std::vector<ColissionProxy>& proxies, std::uint32_t& nextIndex) {
+	if(node.isLeafNode()) {
+		const Part* part = static_cast<const Part*>(node.object);
+		if(node.proxyIndex != nextIndex++ || node.proxyIndex >= proxies.size()) return false;
+		return proxies[node.proxyIndex].cframe.getPosition() == part->getPosition() && proxies[node.proxyIndex].baseShape == part->hitbox.baseShape;
+	}
+	for(const TreeNode& subNode : node) {
+		if(!leavesIndexProxiesInTreeOrder(subNode, proxies, nextIndex)) return false;
+	}
+	return true;
+}
+
+TEST_CASE(colissionProxiesFollowTreeLeaves) {
+	WorldPrototype world(DELTA_T);
+	world.addExternalForce(new DirectionalGravity(Vec3(0, -10, 0)));
+
+	std::vector<Part> parts;
+	parts.reserve(20);
+	for(int i = 0; i < 20; i++) {
+		parts.emplace_back(boxShape(1.0, 1.0, 1.0), GlobalCFrame(i % 5 * 1.1, 0.7 + i / 5 * 1.1, 0.0), basicProperties);
+		world.addPart(&parts[i]);
+	}
+	Part floor(boxShape(20.0, 0.3, 20.0), GlobalCFrame(0.0, 0.0, 0.0), basicProperties);
+	world.addTerrainPart(&floor);
+
+	for(int i = 0; i < 10; i++) {
+		world.tick();
+	}
+
+	for(ColissionLayer& layer : world.layers) {
+		for(WorldLayer& subLayer : layer.subLayers) {
+			subLayer.updateColissionProxies();
+			if(subLayer.tree.isEmpty()) continue;
+			std::uint32_t nextIndex = 0;
+			ASSERT_TRUE(leavesIndexProxiesInTreeOrder(subLayer.tree.rootNode, subLayer.colissionProxies, nextIndex));
+			ASSERT_STRICT(nextIndex == subLayer.colissionProxies.size());
+		}
+	}
+}
+
+TEST_CASE(stateHashIndependentOfWorkerCount) {
+	WorldPrototype original(DELTA_T);
+	original.addExternalForce(new DirectionalGravity(Vec3(0, -10, 0)));
+	original.addTerrainPart(new Part(boxShape(20.0, 0.3, 20.0), GlobalCFrame(0.0, 0.0, 0.0), basicProperties));
+	for(int i = 0; i < 64; i++) {
+		GlobalCFrame cframe(i % 4 * 0.9, 0.6 + i / 16 * 0.9, i / 4 % 4 * 0.9, Rotation::fromEulerAngles(0.1 * i, 0.2, 0.0));
+		original.addPart(new Part(boxShape(1.0, 1.0, 1.0), cframe, basicProperties));
+	}
+
+	JobSystem oneWorker(1);
+	JobSystem threeWorkers(3);
+	WorldPrototype serialWorld(DELTA_T);
+	WorldPrototype oneWorkerWorld(DELTA_T);
+	WorldPrototype threeWorkerWorld(DELTA_T);
+	oneWorkerWorld.jobSystem = &oneWorker;
+	threeWorkerWorld.jobSystem = &threeWorkers;
+	std::vector<WorldPrototype*> worlds{&serialWorld, &oneWorkerWorld, &threeWorkerWorld};
+	for(WorldPrototype* world : worlds) {
+		WorldClonerPrototype cloner;
+		cloner.cloneWorld(original, *world);
+		ASSERT_STRICT(world->computeStateHash() == original.computeStateHash());
+	}
+
+	Divergence divergence = findDivergence(worlds, 100);
+	ASSERT_FALSE(divergence.diverged);
+
+	// a single disturbed physical must be found, at the tick right after it was disturbed
+	Motion& disturbed = threeWorkerWorld.physicals[0]->motionOfCenterOfMass;
+	disturbed = Motion(disturbed.getVelocity() + Vec3(0.001, 0.0, 0.0), disturbed.getAngularVelocity(), disturbed.getAcceleration(), disturbed.getAngularAcceleration());
+	divergence = findDivergence(worlds, 10);
+	ASSERT_TRUE(divergence.diverged);
+	ASSERT_STRICT(divergence.tick == serialWorld.age);
+	ASSERT_STRICT(divergence.worldIndex == 2);
+	ASSERT_STRICT(divergence.physicalIndex == 0);
+	ASSERT_STRICT(divergence.partIndex == 0);
+
+	for(WorldPrototype* world : worlds) {
+		world->clear();
+	}
+	original.clear();
+}
+
+TEST_CASE(stateHashSeesSwappedFieldsOfOnePart) {
+	WorldPrototype world(DELTA_T);
+	Part part(boxShape(1.0, 1.0, 1.0), GlobalCFrame(0.0, 2.0, 0.0), basicProperties);
+	world.addPart(&part);
+	Motion& motion = world.physicals[0]->motionOfCenterOfMass;
+
+	// the x of the velocity and the y of the acceleration are a whole stripe apart, so they are hashed into the same lane
+	motion = Motion(Vec3(1.0, 0.0, 0.0), Vec3(0.0, 0.0, 0.0), Vec3(0.0, 2.0, 0.0), Vec3(0.0, 0.0, 0.0));
+	ASSERT_STRICT((reinterpret_cast<const char*>(&motion.translation.translation[1].y) - reinterpret_cast<const char*>(&motion)) % 32 == 0);
+	std::uint64_t original = world.computeStateHash();
+
+	motion = Motion(Vec3(2.0, 0.0, 0.0), Vec3(0.0, 0.0, 0.0), Vec3(0.0, 1.0, 0.0), Vec3(0.0, 0.0, 0.0));
+	ASSERT_FALSE(world.computeStateHash() == original);
+}
+
+// a square grid of cellsPerSide x cellsPerSide cells in the xz plane, centered on the origin, with its triangles facing up
+static TriangleMesh flatGridMesh(int cellsPerSide, float cellSize) {
+	int verticesPerSide = cellsPerSide + 1;
+	std::vector<Vec3f> vertices;
+	std::vector<Triangle> triangles;
+	float offset = cellsPerSide * cellSize / 2;
+	for(int z = 0; z < verticesPerSide; z++) {
+		for(int x = 0; x < verticesPerSide; x++) {
+			vertices.push_back(Vec3f(x * cellSize - offset, 0.0f, z * cellSize - offset));
+		}
+	}
+	for(int z = 0; z < cellsPerSide; z++) {
+		for(int x = 0; x < cellsPerSide; x++) {
+			int corner = z * verticesPerSide + x;
+			triangles.push_back(Triangle{{{corner, corner + verticesPerSide, corner + 1}}});
+			triangles.push_back(Triangle{{{corner + 1, corner + verticesPerSide, corner + verticesPerSide + 1}}});
+		}
+	}
+	return TriangleMesh(static_cast<int>(vertices.size()), static_cast<int>(triangles.size()), vertices.data(), triangles.data());
+}
+
+TEST_CASE(boxRestsOnTriangleMeshTerrain) {
+	WorldPrototype world(DELTA_T);
+	world.addExternalForce(new DirectionalGravity(Vec3(0, -10, 0)));
+
+	Part terrain(triangleMeshShape(flatGridMesh(40, 1.0f)), GlobalCFrame(0.0, 0.0, 0.0), basicProperties);
+	Part box(boxShape(1.0, 1.0, 1.0), GlobalCFrame(0.3, 0.6, -0.2), basicProperties);
+	world.addTerrainPart(&terrain);
+	world.addPart(&box);
+
+	for(int i = 0; i < TICKS; i++) {
+		world.tick();
+	}
+
+	// the box lands on the grid and stays there, instead of falling through it
+	Position boxPosition = box.getPosition();
+	ASSERT_TRUE(boxPosition.y > 0.35 && boxPosition.y < 0.6);
+	ASSERT_TRUE(std::abs(box.getVelocity().y) < 0.1);
+}
+
+TEST_CASE(boxRestsOnHeightfieldTerrain) {
+	WorldPrototype world(DELTA_T);
+	world.addExternalForce(new DirectionalGravity(Vec3(0, -10, 0)));
+
+	// a gentle slope from 0 at z = -20 to 2 at z = 20, steep enough that the box must be held by friction
+	int samplesPerSide = 41;
+	std::vector<float> heights(samplesPerSide * samplesPerSide);
+	for(int row = 0; row < samplesPerSide; row++) {
+		for(int column = 0; column < samplesPerSide; column++) {
+			heights[row * samplesPerSide + column] = row * 0.05f;
+		}
+	}
+	Part terrain(heightfieldShape(heights.data(), samplesPerSide, samplesPerSide, 1.0), GlobalCFrame(0.0, 1.0, 0.0), basicProperties);
+	Part box(boxShape(1.0, 1.0, 1.0), GlobalCFrame(0.3, 1.7, -0.2), basicProperties);
+	world.addTerrainPart(&terrain);
+	world.addPart(&box);
+
+	for(int i = 0; i < TICKS; i++) {
+		world.tick();
+	}
+
+	// the surface is at y = 1 + z * 0.05 below the box
+	Position boxPosition = box.getPosition();
+	double surfaceHeight = 1.0 + double(boxPosition.z) * 0.05;
+	ASSERT_TRUE(boxPosition.y > surfaceHeight + 0.35 && boxPosition.y < surfaceHeight + 0.6);
+	ASSERT_TRUE(std::abs(box.getVelocity().y) < 0.1);
+}
+
+TEST_CASE(worldQueriesMatchBruteForce) {
+	WorldPrototype world(DELTA_T);
+	JobSystem jobs(2);
+	world.jobSystem = &jobs;
+
+	std::vector<Part*> freeParts;
+	std::vector<Part*> terrainParts;
+	for(int i = 0; i < 150; i++) {
+		GlobalCFrame cframe(std::sin(i * 1.3) * 20.0, std::cos(i * 0.7) * 5.0, std::sin(i * 0.37) * 20.0, Rotation::fromEulerAngles(0.3 * i, 0.1 * i, 0.0));
+		Shape shape = (i % 3 == 0) ? sphereShape(0.4 + i % 5 * 0.2) : boxShape(0.5 + i % 4 * 0.3, 0.5 + i % 3 * 0.4, 0.7);
+		Part* part = new Part(shape, cframe, basicProperties);
+		if(i % 4 == 0) {
+			world.addTerrainPart(part);
+			terrainParts.push_back(part);
+		} else {
+			world.addPart(part);
+			freeParts.push_back(part);
+		}
+	}
+	std::vector<Part*> allParts = freeParts;
+	allParts.insert(allParts.end(), terrainParts.begin(), terrainParts.end());
+
+	auto bruteForceRaycast = [](const std::vector<Part*>& parts, const Ray& ray) {
+		double best = INFINITY;
+		for(Part* part : parts) {
+			double distance = part->hitbox.getIntersectionDistance(part->getCFrame().globalToLocal(ray.start), part->getCFrame().relativeToLocal(ray.direction));
+			if(distance > 0.0 && distance < best) best = distance;
+		}
+		return best;
+	};
+	// the traversal and the brute force may round the same intersection differently
+	auto sameDistance = [](double a, double b) {
+		return a == b || std::abs(a - b) < 1e-9;
+	};
+
+	// fans of rays from a few origins, so consecutive rays form packets
+	std::vector<Ray> rays;
+	for(int i = 0; i < 400; i++) {
+		Position start(-30.0, (i / 50) * 1.5 - 6.0, (i / 100) * 3.0 - 6.0);
+		rays.push_back(Ray{start, Vec3(1.0, std::sin(i * 0.11) * 0.2, std::cos(i * 0.17) * 0.6)});
+	}
+	std::vector<RaycastHit> hits(rays.size());
+	world.raycastBatch(rays.data(), rays.size(), hits.data());
+	int hitCount = 0;
+	for(std::size_t i = 0; i < rays.size(); i++) {
+		double expected = bruteForceRaycast(allParts, rays[i]);
+		RaycastHit single = world.raycast(rays[i]);
+		ASSERT_TRUE(sameDistance(single.distance, expected));
+		ASSERT_TRUE(sameDistance(hits[i].distance, expected));
+		if(hits[i].hit()) {
+			hitCount++;
+			ASSERT_TRUE(hits[i].point == rays[i].start + rays[i].direction * hits[i].distance);
+		}
+
+		RaycastHit freeHit = world.raycast(rays[i], FREE_PARTS_LAYERS);
+		ASSERT_TRUE(sameDistance(freeHit.distance, bruteForceRaycast(freeParts, rays[i])));
+		ASSERT_TRUE(!freeHit.hit() || std::find(freeParts.begin(), freeParts.end(), freeHit.part) != freeParts.end());
+	}
+	ASSERT_TRUE(hitCount > 20);
+
+	Bounds queryBounds(Position(-5.0, -2.0, -8.0), Position(6.0, 3.0, 4.0));
+	std::vector<Part*> overlapping;
+	world.overlapBounds(queryBounds, overlapping);
+	std::size_t expectedOverlapping = 0;
+	for(Part* part : allParts) {
+		if(intersects(part->getBounds(), queryBounds)) expectedOverlapping++;
+	}
+	ASSERT_STRICT(overlapping.size() == expectedOverlapping);
+	for(Part* part : overlapping) {
+		ASSERT_TRUE(intersects(part->getBounds(), queryBounds));
+	}
+
+	Shape probe = sphereShape(3.0);
+	GlobalCFrame probeCFrame(1.0, 0.0, 2.0);
+	std::vector<Part*> touching;
+	world.overlapShape(probe, probeCFrame, touching, TERRAIN_PARTS_LAYERS);
+	std::size_t expectedTouching = 0;
+	for(Part* part : terrainParts) {
+		if(intersectsTransformed(probe, part->hitbox, probeCFrame.globalToLocal(part->getCFrame()))) expectedTouching++;
+	}
+	ASSERT_STRICT(touching.size() == expectedTouching);
+
+	// the k closest parts by the distance to their bounds, compared by distance as parts may be equally far
+	Position point(2.0, 1.0, -3.0);
+	auto boundsDistance = [&point](Part* part) {
+		Bounds bounds = part->getBounds();
+		Vec3 toMin = bounds.min - point;
+		Vec3 toMax = bounds.max - point;
+		Vec3 gap(std::max(std::max(toMin.x, -toMax.x), 0.0), std::max(std::max(toMin.y, -toMax.y), 0.0), std::max(std::max(toMin.z, -toMax.z), 0.0));
+		return length(gap);
+	};
+	std::vector<Part*> closest;
+	world.closestParts(point, 10, closest);
+	std::vector<double> expectedDistances;
+	for(Part* part : allParts) expectedDistances.push_back(boundsDistance(part));
+	std::sort(expectedDistances.begin(), expectedDistances.end());
+	ASSERT_STRICT(closest.size() == 10);
+	for(std::size_t i = 0; i < closest.size(); i++) {
+		ASSERT_TRUE(boundsDistance(closest[i]) == expectedDistances[i]);
+	}
+
+	world.clear();
+}
+
+TEST_CASE(worldQueriesOnSingleLeafAndHighLayers) {
+	WorldPrototype world(DELTA_T);
+	// the layers are all created before any part is added, adding a layer may move the others
+	int highLayer = 0;
+	for(int i = 0; i < 40; i++) highLayer = world.createLayer(true, false);
+
+	// alone in its layer, the root of the tree is the leaf of this part
+	Part* single = new Part(boxShape(1.0, 1.0, 1.0), GlobalCFrame(0.0, 0.0, 0.0), basicProperties);
+	world.addPart(single);
+	std::vector<Part*> found;
+	world.overlapBounds(Bounds(Position(10.0, 10.0, 10.0), Position(11.0, 11.0, 11.0)), found);
+	ASSERT_STRICT(found.size() == 0);
+	world.overlapShape(boxShape(1.0, 1.0, 1.0), GlobalCFrame(10.0, 0.0, 0.0), found);
+	ASSERT_STRICT(found.size() == 0);
+	world.overlapBounds(Bounds(Position(-0.2, -0.2, -0.2), Position(0.2, 0.2, 0.2)), found);
+	ASSERT_TRUE(found.size() == 1 && found[0] == single);
+
+	// layers past the 32 that have bits of their own are still selected by the masks that select every layer
+	Part* high = new Part(boxShape(1.0, 1.0, 1.0), GlobalCFrame(5.0, 0.0, 0.0), basicProperties);
+	world.addPart(high, highLayer);
+	Bounds aroundHigh(Position(4.8, -0.2, -0.2), Position(5.2, 0.2, 0.2));
+	found.clear();
+	world.overlapBounds(aroundHigh, found);
+	ASSERT_TRUE(found.size() == 1 && found[0] == high);
+	found.clear();
+	world.overlapBounds(aroundHigh, found, FREE_PARTS_LAYERS);
+	ASSERT_STRICT(found.size() == 1);
+	found.clear();
+	world.overlapBounds(aroundHigh, found, colissionLayerMask(highLayer));
+	ASSERT_STRICT(found.size() == 1);
+	found.clear();
+	world.overlapBounds(aroundHigh, found, TERRAIN_PARTS_LAYERS);
+	ASSERT_STRICT(found.size() == 0);
+	ASSERT_TRUE(world.raycast(Ray{Position(5.0, 0.0, -10.0), Vec3(0.0, 0.0, 1.0)}).part == high);
+
+	world.clear();
+}
+
+TEST_CASE(snapshotCullsThroughTrees) {
+	struct TaggingWorld : public WorldPrototype {
+		TaggingWorld() : WorldPrototype(DELTA_T) {}
+		std::uint64_t getSnapshotTag(const Part& part) const override { return static_cast<std::uint64_t>(static_cast<double>(part.getPosition().x)) + 1000; }
+	} world;
+
+	for(int i = 0; i < 300; i++) {
+		Part* part = new Part(boxShape(0.5, 0.5, 0.5), GlobalCFrame(i % 30 * 2.0, i / 30 * 2.0, (i * 7) % 11), basicProperties);
+		if(i % 5 == 0) {
+			world.addTerrainPart(part);
+		} else {
+			world.addPart(part);
+		}
+	}
+
+	WorldSnapshot snapshot;
+	snapshot.capture(world);
+	ASSERT_STRICT(snapshot.rootCount == 2);
+	for(const PartSnapshot& part : snapshot.parts) {
+		ASSERT_STRICT(part.tag == static_cast<std::uint64_t>(static_cast<double>(part.cframe.getPosition().x)) + 1000);
+	}
+
+	Bounds view(Position(5.0, 3.0, 2.0), Position(20.0, 9.0, 6.0));
+	std::size_t testedNodes = 0;
+	auto filter = [&](const Bounds& bounds) {
+		testedNodes++;
+		return intersects(bounds, view);
+	};
+	std::vector<const Part*> found;
+	snapshot.forEachPartFiltered(filter, [&](const PartSnapshot& part) {
+		found.push_back(part.part);
+	});
+
+	std::vector<const Part*> expected;
+	for(const PartSnapshot& part : snapshot.parts) {
+		if(intersects(part.bounds, view)) expected.push_back(part.part);
+	}
+	std::sort(found.begin(), found.end());
+	ASSERT_TRUE(found == expected);
+	// whole subtrees outside of view are never looked at
+	ASSERT_TRUE(testedNodes < snapshot.nodes.size() / 2);
+
+	world.clear();
+}
+
+TEST_CASE(snapshotChangesListMovedParts) {
+	struct TaggingWorld : public WorldPrototype {
+		TaggingWorld() : WorldPrototype(DELTA_T) {}
+		std::uint64_t getSnapshotTag(const Part& part) const override { return reinterpret_cast<std::uintptr_t>(&part); }
+	} world;
+
+	std::vector<Part*> terrain;
+	for(int i = 0; i < 20; i++) {
+		terrain.push_back(new Part(boxShape(0.5, 0.5, 0.5), GlobalCFrame(i * 2.0, 0.0, 0.0), basicProperties));
+		world.addTerrainPart(terrain.back());
+	}
+	Part* moving = new Part(boxShape(0.5, 0.5, 0.5), GlobalCFrame(0.0, 5.0, 0.0), basicProperties);
+	world.addPart(moving);
+	moving->parent->mainPhysical->motionOfCenterOfMass = Motion(Vec3(1.0, 0.0, 0.0), Vec3(0.0, 0.0, 0.0));
+
+	SnapshotBuffer snapshots;
+	auto changedTags = [&]() {
+		std::vector<std::uint64_t> tags(snapshots.latest().changes.tags);
+		std::sort(tags.begin(), tags.end());
+		return tags;
+	};
+
+	// the first snapshot lists every part
+	snapshots.publish(world);
+	ASSERT_TRUE(snapshots.pull());
+	ASSERT_STRICT(snapshots.latest().changes.size() == 21);
+
+	// afterwards only what moved
+	world.tick();
+	snapshots.publish(world);
+	ASSERT_TRUE(snapshots.pull());
+	ASSERT_TRUE(changedTags() == std::vector<std::uint64_t>{reinterpret_cast<std::uintptr_t>(moving)});
+	ASSERT_TRUE(snapshots.latest().changes.cframes[0].getPosition() == moving->getPosition());
+
+	// changes in a snapshot the reader skipped are carried over
+	terrain[3]->setCFrame(GlobalCFrame(6.0, 1.0, 0.0));
+	snapshots.publish(world);
+	snapshots.publish(world);
+	ASSERT_TRUE(snapshots.pull());
+	std::vector<std::uint64_t> expected{reinterpret_cast<std::uintptr_t>(terrain[3])};
+	ASSERT_TRUE(changedTags() == expected);
+
+	// a reader that did not apply the skipped snapshots gets every part
+	std::size_t passed = 0;
+	snapshots.latest().forEachChangeSince(0, [&](std::uint64_t tag, const GlobalCFrame& cframe, const DiagonalMat3& scale) { passed++; });
+	ASSERT_STRICT(passed == 21);
+	passed = 0;
+	snapshots.latest().forEachChangeSince(snapshots.beforeLatest().sequence, [&](std::uint64_t tag, const GlobalCFrame& cframe, const DiagonalMat3& scale) { passed++; });
+	ASSERT_STRICT(passed == 1);
+
+	// nothing moved
+	snapshots.publish(world);
+	ASSERT_TRUE(snapshots.pull());
+	ASSERT_STRICT(snapshots.latest().changes.size() == 0);
+
+	world.clear();
+}
+
+TEST_CASE(snapshotAfterTickComparesOnlyMovedParts) {
+	struct TaggingWorld : public WorldPrototype {
+		TaggingWorld() : WorldPrototype(DELTA_T) {}
+		std::uint64_t getSnapshotTag(const Part& part) const override { return reinterpret_cast<std::uintptr_t>(&part); }
+	} world;
+
+	std::vector<Part*> terrain;
+	for(int i = 0; i < 20; i++) {
+		terrain.push_back(new Part(boxShape(0.5, 0.5, 0.5), GlobalCFrame(i * 2.0, 0.0, 0.0), basicProperties));
+		world.addTerrainPart(terrain.back());
+	}
+	Part* moving = new Part(boxShape(0.5, 0.5, 0.5), GlobalCFrame(0.0, 5.0, 0.0), basicProperties);
+	world.addPart(moving);
+	moving->parent->mainPhysical->motionOfCenterOfMass = Motion(Vec3(1.0, 0.0, 0.0), Vec3(0.0, 0.0, 0.0));
+
+	SnapshotBuffer snapshots;
+	auto changedTags = [&]() {
+		std::vector<std::uint64_t> tags(snapshots.latest().changes.tags);
+		std::sort(tags.begin(), tags.end());
+		return tags;
+	};
+	std::uint64_t movingTag = reinterpret_cast<std::uintptr_t>(moving);
+	std::uint64_t terrainTag = reinterpret_cast<std::uintptr_t>(terrain[3]);
+
+	world.tick();
+	snapshots.publish(world);
+	ASSERT_TRUE(snapshots.pull());
+
+	// nothing but the tick changed the world, so only the parts it moved are compared
+	world.tick();
+	ASSERT_TRUE(world.lastTickMovedPartsComplete);
+	ASSERT_STRICT(world.lastTickMovedParts.size() == 1);
+	snapshots.publish(world);
+	ASSERT_TRUE(snapshots.pull());
+	ASSERT_TRUE(changedTags() == std::vector<std::uint64_t>{movingTag});
+	ASSERT_TRUE(snapshots.latest().changes.cframes[0].getPosition() == moving->getPosition());
+
+	// a part moved between ticks is not in lastTickMovedParts, but still listed
+	terrain[3]->setCFrame(GlobalCFrame(6.0, 1.0, 0.0));
+	world.tick();
+	ASSERT_FALSE(world.lastTickMovedPartsComplete);
+	snapshots.publish(world);
+	ASSERT_TRUE(snapshots.pull());
+	std::vector<std::uint64_t> expected{movingTag, terrainTag};
+	std::sort(expected.begin(), expected.end());
+	ASSERT_TRUE(changedTags() == expected);
+
+	// changes in a snapshot the reader skipped are carried over, the terrain part stops being listed once the reader has seen it
+	world.tick();
+	snapshots.publish(world);
+	world.tick();
+	snapshots.publish(world);
+	ASSERT_TRUE(snapshots.pull());
+	ASSERT_TRUE(changedTags() == std::vector<std::uint64_t>{movingTag});
+	ASSERT_TRUE(snapshots.latest().changes.cframes[0].getPosition() == moving->getPosition());
+
+	world.clear();
+}
+
+TEST_CASE(memoryUsageCountsWorldContents) {
+	WorldPrototype world(DELTA_T);
+	world.addExternalForce(new DirectionalGravity(Vec3(0, -10, 0)));
+
+	Part terrain(triangleMeshShape(flatGridMesh(10, 1.0f)), GlobalCFrame(0.0, 0.0, 0.0), basicProperties);
+	Part boxA(boxShape(1.0, 1.0, 1.0), GlobalCFrame(0.0, 0.45, 0.0), basicProperties);
+	Part boxB(boxShape(2.0, 1.0, 1.0), GlobalCFrame(3.0, 0.45, 0.0), basicProperties);
+	world.addTerrainPart(&terrain);
+	world.addPart(&boxA);
+	world.addPart(&boxB);
+
+	MemoryUsage memory = world.getMemoryUsage();
+	ASSERT_STRICT(memory.parts == 3 * sizeof(Part));
+	ASSERT_STRICT(memory.physicals >= 2 * sizeof(MotorizedPhysical));
+	// both boxes share the cube class, only the mesh has data of its own
+	ASSERT_STRICT(memory.shapeClasses == terrain.hitbox.baseShape->getObjectSize() + boxA.hitbox.baseShape->getObjectSize());
+	ASSERT_STRICT(memory.shapeData == terrain.hitbox.baseShape->getDataSize());
+	ASSERT_TRUE(memory.shapeData > 0);
+	ASSERT_TRUE(memory.treeNodes > 0);
+	ASSERT_TRUE(memory.getTotal() > memory.parts + memory.shapeData);
+
+	// both boxes rest on the terrain
+	world.tick();
+	ASSERT_STRICT(world.lastTickMemory.colissions == 2 * sizeof(Colission));
+	ASSERT_STRICT(world.lastTickMemory.getPeak() >= world.lastTickMemory.colissions);
+	ASSERT_TRUE(world.getMemoryUsage().colissionBuffers >= 2 * sizeof(Colission));
+}
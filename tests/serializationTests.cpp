@@ -0,0 +1,330 @@
+#include "testsMain.h"
+
+#include "compare.h"
+#include "../physics/misc/toString.h"
+
+#include <sstream>
+#include <string>
+#include <cstring>
+#include <memory>
+
+#include "../physics/geometry/shapeCreation.h"
+#include "../physics/geometry/builtinShapeClasses.h"
+#include "../physics/part.h"
+#include "../physics/world.h"
+#include "../physics/hardconstraints/motorConstraint.h"
+#include "../physics/externalforces/gravityForce.h"
+#include "../physics/misc/shapeLibrary.h"
+#include "../physics/misc/serialization.h"
+#include "../physics/misc/mappedWorldFormat.h"
+#include "../physics/misc/recording.h"
+#include "../physics/misc/worldClone.h"
+#include "../physics/datastructures/alignedPtr.h"
+#include "../physics/datastructures/aligned_alloc.h"
+
+#define ASSERT(x) ASSERT_STRICT(x)
+
+class SerializedPart : public Part {
+public:
+	using Part::Part;
+	SerializedPart(Part&& p) : Part(std::move(p)) {}
+};
+
+class TestDeserializer : public DeSerializationSession<SerializedPart> {
+	virtual SerializedPart* deserializeExtendedPart(Part&& partPrototype, std::istream& istream) override {
+		return new SerializedPart(std::move(partPrototype));
+	}
+};
+
+static void buildTestWorld(World<SerializedPart>& world) {
+	PartProperties properties{1.0, 0.7, 0.3};
+
+	world.addTerrainPart(new SerializedPart(boxShape(20.0, 1.0, 20.0), GlobalCFrame(0.0, -1.0, 0.0), properties));
+
+	Shape icosahedronShape(new PolyhedronShapeClass(Polyhedron(Library::icosahedron)), 1.0, 1.0, 1.0);
+	SerializedPart* poly = new SerializedPart(icosahedronShape, GlobalCFrame(2.0, 3.0, 1.0), properties);
+	world.addPart(poly);
+	poly->parent->mainPhysical->motionOfCenterOfMass = Motion(Vec3(0.5, 0.0, -1.0), Vec3(0.0, 2.0, 0.0));
+
+	SerializedPart* base = new SerializedPart(boxShape(2.0, 1.0, 1.0), GlobalCFrame(-3.0, 2.0, 0.0), properties);
+	SerializedPart* attached = new SerializedPart(sphereShape(0.5), GlobalCFrame(), properties);
+	SerializedPart* wheel = new SerializedPart(cylinderShape(0.5, 0.2), GlobalCFrame(), properties);
+	base->attach(attached, CFrame(1.0, 0.0, 0.0));
+	base->attach(wheel, new ConstantSpeedMotorConstraint(1.5, 0.3), CFrame(0.0, 0.0, 0.6), CFrame(0.0, 0.0, -0.2));
+	world.addPart(base);
+
+	world.addExternalForce(new DirectionalGravity(Vec3(0.0, -10.0, 0.0)));
+	world.age = 37;
+}
+
+static std::string serializeLegacy(const World<SerializedPart>& world) {
+	std::ostringstream stream;
+	SerializationSessionPrototype serializer;
+	serializer.serializeWorld(world, stream);
+	return stream.str();
+}
+
+TEST_CASE(mappedWorldRoundTripMatchesLegacy) {
+	World<SerializedPart> original(0.01);
+	buildTestWorld(original);
+
+	std::ostringstream mappedStream;
+	SerializationSession<SerializedPart> serializer;
+	serializer.serializeWorldMapped(original, mappedStream);
+	std::string mapped = mappedStream.str();
+
+	ASSERT_TRUE(MappedWorldFormat::isMappedWorldFile(mapped.data(), mapped.size()));
+	ASSERT(mapped.size() % MappedWorldFormat::SECTION_ALIGNMENT == 0);
+
+	// a memory mapped file is page aligned, a plain aligned buffer stands in for it
+	UniqueAlignedPointer<char> buffer(mapped.size(), MappedWorldFormat::SECTION_ALIGNMENT);
+	std::memcpy(buffer.get(), mapped.data(), mapped.size());
+
+	World<SerializedPart> loaded(0.01);
+	TestDeserializer deserializer;
+	deserializer.deserializeWorldMapped(loaded, buffer.get(), mapped.size());
+
+	ASSERT(loaded.getPartCount() == original.getPartCount());
+	ASSERT(loaded.physicals.size() == original.physicals.size());
+	ASSERT(loaded.age == original.age);
+	ASSERT_TRUE(loaded.isValid());
+	ASSERT_TRUE(serializeLegacy(loaded) == serializeLegacy(original));
+
+	loaded.clear();
+	original.clear();
+}
+
+static const Polyhedron* findPolyhedron(const World<SerializedPart>& world) {
+	for(const Part& part : world.iterParts()) {
+		if(part.hitbox.baseShape->intersectionClassID == CONVEX_POLYHEDRON_CLASS_ID) {
+			return &static_cast<const PolyhedronShapeClass*>(part.hitbox.baseShape)->getPolyhedron();
+		}
+	}
+	return nullptr;
+}
+
+static bool hasIcosahedronVertices(const Polyhedron& poly) {
+	if(poly.vertexCount != Library::icosahedron.vertexCount) return false;
+	for(int i = 0; i < poly.vertexCount; i++) {
+		if(!(poly.getVertex(i) == Library::icosahedron.getVertex(i))) return false;
+	}
+	return true;
+}
+
+TEST_CASE(mappedWorldShapeClassesOwnTheirMesh) {
+	World<SerializedPart> original(0.01);
+	buildTestWorld(original);
+
+	std::ostringstream mappedStream;
+	SerializationSession<SerializedPart> serializer;
+	serializer.serializeWorldMapped(original, mappedStream);
+	std::string mapped = mappedStream.str();
+
+	// with an owner the polyhedron points into the data and keeps it alive after the caller lets go of it
+	std::shared_ptr<char> owned(static_cast<char*>(aligned_malloc(mapped.size(), MappedWorldFormat::SECTION_ALIGNMENT)), aligned_free);
+	std::memcpy(owned.get(), mapped.data(), mapped.size());
+	std::weak_ptr<char> ownedAlive = owned;
+	const char* ownedBegin = owned.get();
+
+	World<SerializedPart> borrowing(0.01);
+	TestDeserializer borrowingDeserializer;
+	borrowingDeserializer.deserializeWorldMapped(borrowing, owned.get(), mapped.size(), owned);
+	owned.reset();
+	// clearing the world does not release the shape classes, which may be used elsewhere
+	const Polyhedron* borrowed = findPolyhedron(borrowing);
+	borrowing.clear();
+
+	ASSERT_FALSE(ownedAlive.expired());
+	const char* borrowedVertices = reinterpret_cast<const char*>(borrowed->getVertexBuffer());
+	ASSERT_TRUE(borrowedVertices >= ownedBegin && borrowedVertices < ownedBegin + mapped.size());
+	ASSERT_TRUE(hasIcosahedronVertices(*borrowed));
+
+	// without one the polyhedron is copied out, the data may be overwritten or freed right after loading
+	const Polyhedron* copied;
+	{
+		UniqueAlignedPointer<char> buffer(mapped.size(), MappedWorldFormat::SECTION_ALIGNMENT);
+		std::memcpy(buffer.get(), mapped.data(), mapped.size());
+
+		World<SerializedPart> copying(0.01);
+		TestDeserializer copyingDeserializer;
+		copyingDeserializer.deserializeWorldMapped(copying, buffer.get(), mapped.size());
+		copied = findPolyhedron(copying);
+		copying.clear();
+		std::memset(buffer.get(), 0xFF, mapped.size());
+	}
+	ASSERT_TRUE(hasIcosahedronVertices(*copied));
+
+	original.clear();
+}
+
+TEST_CASE(mappedWorldRejectsNewerMajorVersion) {
+	World<SerializedPart> original(0.01);
+	buildTestWorld(original);
+
+	std::ostringstream mappedStream;
+	SerializationSession<SerializedPart> serializer;
+	serializer.serializeWorldMapped(original, mappedStream);
+	std::string mapped = mappedStream.str();
+
+	UniqueAlignedPointer<char> buffer(mapped.size(), MappedWorldFormat::SECTION_ALIGNMENT);
+	std::memcpy(buffer.get(), mapped.data(), mapped.size());
+	reinterpret_cast<MappedWorldFormat::FileHeader*>(buffer.get())->majorVersion = MappedWorldFormat::MAJOR_VERSION + 1;
+
+	World<SerializedPart> loaded(0.01);
+	TestDeserializer deserializer;
+	bool threw = false;
+	try {
+		deserializer.deserializeWorldMapped(loaded, buffer.get(), mapped.size());
+	} catch(SerializationException&) {
+		threw = true;
+	}
+	ASSERT_TRUE(threw);
+
+	original.clear();
+}
+
+TEST_CASE(mappedWorldSkipsSectionsOfNewerMinorVersion) {
+	using namespace MappedWorldFormat;
+
+	World<SerializedPart> original(0.01);
+	buildTestWorld(original);
+
+	std::ostringstream mappedStream;
+	SerializationSession<SerializedPart> serializer;
+	serializer.serializeWorldMapped(original, mappedStream);
+	std::string mapped = mappedStream.str();
+
+	// append an unknown section to the table and to the end of the file, as a newer minor version could
+	const std::size_t extraSize = SECTION_ALIGNMENT;
+	UniqueAlignedPointer<char> buffer(mapped.size() + extraSize, SECTION_ALIGNMENT);
+	std::memcpy(buffer.get(), mapped.data(), mapped.size());
+	std::memset(buffer.get() + mapped.size(), 0x5A, extraSize);
+
+	FileHeader* header = reinterpret_cast<FileHeader*>(buffer.get());
+	SectionEntry* entries = reinterpret_cast<SectionEntry*>(buffer.get() + sizeof(FileHeader));
+	ASSERT_TRUE(sizeof(FileHeader) + (header->sectionCount + 1) * sizeof(SectionEntry) <= entries[0].offset);
+	entries[header->sectionCount] = SectionEntry{header->fileSize, extraSize};
+	header->sectionCount++;
+	header->fileSize += extraSize;
+	header->minorVersion = MINOR_VERSION + 1;
+
+	World<SerializedPart> loaded(0.01);
+	TestDeserializer deserializer;
+	deserializer.deserializeWorldMapped(loaded, buffer.get(), mapped.size() + extraSize);
+
+	ASSERT_TRUE(loaded.isValid());
+	ASSERT_TRUE(serializeLegacy(loaded) == serializeLegacy(original));
+
+	loaded.clear();
+	original.clear();
+}
+
+static std::vector<GlobalCFrame> getPartCFrames(const World<SerializedPart>& world) {
+	std::vector<GlobalCFrame> result;
+	for(const MotorizedPhysical* phys : world.physicals) {
+		phys->forEachPart([&result](const Part& part) {
+			result.push_back(part.getCFrame());
+		});
+	}
+	return result;
+}
+
+TEST_CASE(recordingReplaysEveryTick) {
+	World<SerializedPart> world(0.01);
+	buildTestWorld(world);
+
+	RecordingSettings settings;
+	settings.keyframeInterval = 8;
+	settings.worldInterval = 16;
+	settings.maxPendingTicks = 4;
+
+	std::vector<std::vector<GlobalCFrame>> expected;
+	std::stringstream recording;
+	{
+		Recorder recorder(recording, settings);
+		for(int i = 0; i < 30; i++) {
+			if(i == 13) {
+				// changes the structure of the world, which must force a keyframe
+				world.addPart(new SerializedPart(boxShape(0.5, 0.5, 0.5), GlobalCFrame(5.0, 4.0, 0.0), PartProperties{1.0, 0.7, 0.3}));
+			}
+			world.tick();
+			recorder.captureTick(world);
+			expected.push_back(getPartCFrames(world));
+		}
+		recorder.flush();
+		ASSERT(recorder.getStatistics().recordedTicks == 30);
+		ASSERT(recorder.getStatistics().keyframes == 5);
+	}
+
+	Replay replay(recording);
+	std::uint64_t firstTick = replay.getFirstTick();
+	ASSERT(replay.getLastTick() == firstTick + 29);
+
+	// out of order, so both seeking forward from the current tick and restarting at a keyframe are covered
+	for(int i : {0, 5, 6, 21, 14, 13, 29, 3}) {
+		const RecordedFrame& frame = replay.seek(firstTick + i);
+		ASSERT(frame.tick == firstTick + i);
+		ASSERT(frame.cframes.size() == expected[i].size());
+		for(std::size_t p = 0; p < frame.cframes.size(); p++) {
+			ASSERT_TOLERANT(frame.cframes[p] == expected[i][p], 0.0001);
+		}
+	}
+	// the world is stored at the start, when the structure changed at 13, and 16 ticks later at the keyframe of 29
+	replay.seek(firstTick + 10);
+	ASSERT(replay.getKeyframeTick() == firstTick);
+	replay.seek(firstTick + 29);
+	ASSERT(replay.getKeyframeTick() == firstTick + 29);
+	replay.seek(firstTick + 22);
+	ASSERT(replay.getKeyframeTick() == firstTick + 13);
+	ASSERT(replay.seek(firstTick + 14).tick == firstTick + 14);
+	ASSERT(replay.getKeyframeTick() == firstTick + 13);
+	ASSERT_TRUE(replay.stepForward());
+
+	World<SerializedPart> keyframeWorld(0.01);
+	TestDeserializer deserializer;
+	replay.loadKeyframeWorld(deserializer, keyframeWorld);
+	ASSERT(keyframeWorld.getPartCount() == world.getPartCount());
+	ASSERT(keyframeWorld.age == firstTick + 13);
+
+	keyframeWorld.clear();
+	world.clear();
+}
+
+class TestCloner : public WorldCloner<SerializedPart> {
+	virtual SerializedPart* cloneExtendedPart(const SerializedPart& original, Part&& partPrototype) override {
+		return new SerializedPart(std::move(partPrototype));
+	}
+};
+
+TEST_CASE(clonedWorldStepsLikeOriginal) {
+	World<SerializedPart> original(0.01);
+	buildTestWorld(original);
+	for(int i = 0; i < 5; i++) {
+		original.tick();
+	}
+
+	World<SerializedPart> clone(0.5);
+	TestCloner cloner;
+	cloner.cloneWorld(original, clone);
+
+	ASSERT(clone.getPartCount() == original.getPartCount());
+	ASSERT(clone.physicals.size() == original.physicals.size());
+	ASSERT(clone.deltaT == original.deltaT);
+	ASSERT_TRUE(clone.isValid());
+	ASSERT_TRUE(serializeLegacy(clone) == serializeLegacy(original));
+
+	const SerializedPart* originalPart = &*original.iterParts().begin();
+	SerializedPart* clonedPart = cloner.getClone(originalPart);
+	ASSERT_TRUE(clonedPart != originalPart);
+	ASSERT_TOLERANT(clonedPart->getCFrame() == originalPart->getCFrame(), 0.000000001);
+
+	for(int i = 0; i < 20; i++) {
+		original.tick();
+		clone.tick();
+	}
+	ASSERT_TRUE(clone.isValid());
+	ASSERT_TRUE(serializeLegacy(clone) == serializeLegacy(original));
+
+	clone.clear();
+	original.clear();
+}
@@ -42,7 +42,12 @@ public:
 		for(const std::pair<std::type_index, const DynamicSerializer*>& item : initList) {
 			const DynamicSerializer* ds = item.second;
 			serializeRegistry.emplace(item.first, ds);
-			if(deserializeRegistry.find(ds->serializerID) != deserializeRegistry.end()) throw std::logic_error("Duplicate serializerID?");
+			// several types may share a serializer, for example subclasses that only differ in how they compute
+			auto found = deserializeRegistry.find(ds->serializerID);
+			if(found != deserializeRegistry.end()) {
+				if(found->second != ds) throw std::logic_error("Duplicate serializerID?");
+				continue;
+			}
 			deserializeRegistry.emplace(ds->serializerID, ds);
 		}
 	}
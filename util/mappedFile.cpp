@@ -0,0 +1,67 @@
+#include "mappedFile.h"
+
+#ifdef _WIN32
+	#include <Windows.h>
+
+	Util::MappedFile::MappedFile(const std::string& path) {
+		fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if(fileHandle == INVALID_HANDLE_VALUE) throw "Could not open file for mapping!";
+
+		LARGE_INTEGER fileSize;
+		if(!GetFileSizeEx(fileHandle, &fileSize)) {
+			CloseHandle(fileHandle);
+			throw "Could not get the size of the file to map!";
+		}
+		size = static_cast<std::size_t>(fileSize.QuadPart);
+		if(size == 0) return;
+
+		mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+		if(mappingHandle == NULL) {
+			CloseHandle(fileHandle);
+			throw "Could not map file!";
+		}
+		data = static_cast<char*>(MapViewOfFile(mappingHandle, FILE_MAP_COPY, 0, 0, 0));
+		if(data == nullptr) {
+			CloseHandle(mappingHandle);
+			CloseHandle(fileHandle);
+			throw "Could not map file!";
+		}
+	}
+
+	Util::MappedFile::~MappedFile() {
+		if(data != nullptr) UnmapViewOfFile(data);
+		if(mappingHandle != nullptr) CloseHandle(mappingHandle);
+		CloseHandle(fileHandle);
+	}
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+
+	Util::MappedFile::MappedFile(const std::string& path) {
+		int fileDescriptor = open(path.c_str(), O_RDONLY);
+		if(fileDescriptor == -1) throw "Could not open file for mapping!";
+
+		struct stat fileInfo;
+		if(fstat(fileDescriptor, &fileInfo) == -1) {
+			close(fileDescriptor);
+			throw "Could not get the size of the file to map!";
+		}
+		size = static_cast<std::size_t>(fileInfo.st_size);
+		if(size != 0) {
+			void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileDescriptor, 0);
+			if(mapping == MAP_FAILED) {
+				close(fileDescriptor);
+				throw "Could not map file!";
+			}
+			data = static_cast<char*>(mapping);
+		}
+		// the mapping stays valid after the file is closed
+		close(fileDescriptor);
+	}
+
+	Util::MappedFile::~MappedFile() {
+		if(data != nullptr) munmap(data, size);
+	}
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+namespace Util {
+
+/*
+	A whole file mapped into memory
+
+	The pages are mapped copy on write: modifying the data never changes the file, only this process's copy of the modified pages.
+	Data adopted from the mapping, such as the polyhedra of a mapped world file, must not outlive it.
+*/
+class MappedFile {
+	char* data = nullptr;
+	std::size_t size = 0;
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#endif
+
+public:
+	// throws if the file could not be opened or mapped
+	explicit MappedFile(const std::string& path);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// aligned to at least the page size
+	char* getData() const { return data; }
+	std::size_t getSize() const { return size; }
+};
+
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <istream>
+#include <streambuf>
+
+namespace Util {
+
+/*
+	istream that reads directly from a range of memory, without copying it
+	Used to run the stream based deserializers over parts of a buffer or memory mapped file
+*/
+class MemoryInputStream : public std::istream {
+	class RangeBuffer : public std::streambuf {
+	public:
+		void setRange(const char* begin, const char* end) {
+			// the get area is never written to, streambuf just does not have a const interface
+			setg(const_cast<char*>(begin), const_cast<char*>(begin), const_cast<char*>(end));
+		}
+	};
+
+	RangeBuffer buffer;
+
+public:
+	MemoryInputStream() : std::istream(&buffer) {}
+	MemoryInputStream(const char* begin, const char* end) : std::istream(&buffer) {
+		buffer.setRange(begin, end);
+	}
+
+	// starts reading a new range, clearing any error or end of file state of the previous one
+	void setRange(const char* begin, const char* end) {
+		buffer.setRange(begin, end);
+		this->clear();
+	}
+};
+
+};
@@ -48,11 +48,24 @@ public:
 		itemsYetToSerialize.clear();
 	}
 
-	void serializeIDFor(const T& obj, std::ostream& ostream) const {
+	// Like serializeRegistry, but hands the objects to func in the order of their IDs instead of writing them to a stream
+	template<typename Func>
+	void collectRegistry(Func func) {
+		for(const T& item : itemsYetToSerialize) {
+			func(item);
+		}
+		itemsYetToSerialize.clear();
+	}
+
+	SerializeID getIDFor(const T& obj) const {
 		auto found = objectToIDMap.find(obj);
 		if(found == objectToIDMap.end()) throw SerializationException("The given object was not registered!");
 
-		::serialize<SerializeID>((*found).second, ostream);
+		return (*found).second;
+	}
+
+	void serializeIDFor(const T& obj, std::ostream& ostream) const {
+		::serialize<SerializeID>(getIDFor(obj), ostream);
 	}
 };
 
@@ -88,14 +101,22 @@ public:
 		}
 	}
 
-	T deserializeObject(std::istream& istream) const {
-		SerializeID id = ::deserialize<SerializeID>(istream);
+	// registers an object that was deserialized outside of deserializeRegistry, it gets the next ID in the same order
+	void addDynamic(const T& obj) {
+		IDToObjectMap.emplace(curDynamicID, obj);
+		curDynamicID++;
+	}
 
+	T getObject(SerializeID id) const {
 		auto found = IDToObjectMap.find(id);
 		if(found == IDToObjectMap.end()) throw SerializationException("There is no associated object for the id " + std::to_string(id));
 
 		return (*found).second;
 	}
+
+	T deserializeObject(std::istream& istream) const {
+		return getObject(::deserialize<SerializeID>(istream));
+	}
 };
 
 